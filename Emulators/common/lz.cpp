@@ -0,0 +1,198 @@
+#include "common/lz.h"
+
+#include <cstring>
+#include <memory>
+
+// Sequences follow the LZ4 block format: a token with the literal run length in its
+// high nibble and the match length minus 4 in its low one, 255-byte length
+// extensions, the literals, then a 16-bit little-endian match offset. The last
+// sequence has literals only.
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 0xFFFF;
+constexpr int kHashBits = 14;
+
+// The format leaves the last 5 bytes as literals and starts no match in the last 12
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchStartLimit = 12;
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+uint8_t* putLength(uint8_t* op, size_t length) {
+    for (; length >= 255; length -= 255)
+        *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+bool getLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    unsigned byte;
+    do {
+        if (ip == end)
+            return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Bytes a sequence with these run lengths can take, extensions included
+inline size_t sequenceSize(size_t literals, size_t match) {
+    return 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1;
+}
+
+}  // namespace
+
+size_t lzCompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lzCompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    const uint8_t* const end = src + size;
+    const uint8_t* anchor = src;
+    uint8_t* op = dst;
+    uint8_t* const opEnd = dst + capacity;
+
+    if (size > kMatchStartLimit) {
+        // Positions of the last 4-byte sequences seen, by hash
+        std::unique_ptr<uint32_t[]> table(new uint32_t[1 << kHashBits]());
+
+        const uint8_t* const matchStartLimit = end - kMatchStartLimit;
+        const uint8_t* const matchEndLimit = end - kLastLiterals;
+        const uint8_t* ip = src + 1;
+        unsigned misses = 0;
+
+        while (ip < matchStartLimit) {
+            const uint32_t sequence = read32(ip);
+            const uint32_t h = hash(sequence);
+            const uint8_t* ref = src + table[h];
+            table[h] = (uint32_t)(ip - src);
+
+            if (ip - ref > (ptrdiff_t)kMaxOffset || read32(ref) != sequence) {
+                // Step faster through data that does not compress
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+
+            const uint8_t* mp = ip + kMinMatch;
+            const uint8_t* rp = ref + kMinMatch;
+            while (mp + 8 <= matchEndLimit && read64(mp) == read64(rp)) {
+                mp += 8;
+                rp += 8;
+            }
+            while (mp < matchEndLimit && *mp == *rp) {
+                mp++;
+                rp++;
+            }
+
+            const size_t literals = ip - anchor;
+            const size_t match = mp - ip - kMinMatch;
+            if (sequenceSize(literals, match) > (size_t)(opEnd - op))
+                return 0;
+
+            uint8_t* token = op++;
+            *token = (uint8_t)((literals < 15 ? literals : 15) << 4);
+            if (literals >= 15)
+                op = putLength(op, literals - 15);
+            memcpy(op, anchor, literals);
+            op += literals;
+
+            const size_t offset = ip - ref;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+
+            *token |= (uint8_t)(match < 15 ? match : 15);
+            if (match >= 15)
+                op = putLength(op, match - 15);
+
+            ip = anchor = mp;
+            // Seed the table inside the match so the next one can chain off it
+            table[hash(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+        }
+    }
+
+    const size_t literals = end - anchor;
+    if (1 + literals + literals / 255 + 1 > (size_t)(opEnd - op))
+        return 0;
+    uint8_t* token = op++;
+    *token = (uint8_t)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15)
+        op = putLength(op, literals - 15);
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    return op - dst;
+}
+
+bool lzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t size) {
+    const uint8_t* ip = src;
+    const uint8_t* const ipEnd = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* const opEnd = dst + size;
+
+    while (ip < ipEnd) {
+        const unsigned token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !getLength(ip, ipEnd, literals))
+            return false;
+        if (literals > (size_t)(ipEnd - ip) || literals > (size_t)(opEnd - op))
+            return false;
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst))
+            return false;
+
+        size_t match = token & 15;
+        if (match == 15 && !getLength(ip, ipEnd, match))
+            return false;
+        match += kMinMatch;
+        if (match > (size_t)(opEnd - op))
+            return false;
+
+        // An offset shorter than the match repeats the last offset bytes. Copy them
+        // in doubling pieces that never overlap their source.
+        const uint8_t* ref = op - offset;
+        while (match) {
+            size_t piece = op - ref;
+            if (piece > match)
+                piece = match;
+            memcpy(op, ref, piece);
+            op += piece;
+            match -= piece;
+        }
+    }
+
+    return op == opEnd;
+}
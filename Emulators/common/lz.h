@@ -0,0 +1,19 @@
+#ifndef SOOLRA_COMMON_LZ_H_
+#define SOOLRA_COMMON_LZ_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// LZ4-style block codec for the save states and rewind data of both cores. It packs a state several
+// times faster than deflate, at a lower ratio.
+
+// Worst case compressed size of size bytes of input
+size_t lzCompressBound(size_t size);
+
+// Returns the compressed size, or 0 if it does not fit in capacity bytes
+size_t lzCompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+// Decodes srcSize bytes into dst. Fails unless they expand to exactly size bytes.
+bool lzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t size);
+
+#endif  // SOOLRA_COMMON_LZ_H_
@@ -9,7 +9,6 @@
 struct CoreOptions coreOptions = {
     .cpuIsMultiBoot = false,
     .mirroringEnable = false,
-    .useBios = false,
     .skipBios = true,
     .parseDebug = true,
     .speedHack = false,
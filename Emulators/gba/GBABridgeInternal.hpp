@@ -34,9 +34,18 @@ extern int systemBlueShift;
 extern int systemColorDepth;
 extern int systemFrameSkip;
 extern int RGB_LOW_BITS_MASK;
-extern bool emulating;
+extern int emulating;
 extern struct CoreOptions coreOptions;  // Use VBA's CoreOptions definition
 extern uint32_t myROM[];  // Built-in BIOS ROM data
 void updateColorMapping(bool isLcdMode);
 
+// Feeds the samples the sound driver outputs into an active digest trace
+void digestAudioSamples(const float* left, const float* right, int count);
+
+// The VBA-M system hooks are shared by the GBA and GB cores; while SoolraGBBridge
+// has a game running they forward to it
+bool gbBridgeRunning();
+void gbBridgeDrawScreen();
+uint32_t gbBridgeReadJoypad();
+
 #endif /* GBABridgeInternal_hpp */ 
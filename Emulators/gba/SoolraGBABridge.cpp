@@ -7,19 +7,23 @@
 // Include our bridge header first
 #include "SoolraGBABridge.hpp"
 
-#include <memory>
 #include <cstring>     // for strcmp, memcpy, etc.
 #include <cstdio>
 #include <cstdlib>
 #include <unistd.h>
 
+#include <map>         // for std::map
 #include <string>      // for std::string
+#include <vector>      // for std::vector
 #include <sstream>     // for std::istringstream, std::getline
 #include <cctype>      // for isxdigit, isspace
 
 
 // Include our internal header that handles VBA includes
 #include "GBABridgeInternal.hpp"
+#include "core/base/patch.h"
+#include "core/base/file_util.h"
+#include "core/base/battery_writer.h"
 
 // Global variables (non-static since they're extern in header)
 VideoCallback g_videoCallback = nullptr;
@@ -31,6 +35,22 @@ uint32_t g_inputState = 0;
 // Internal state
 static bool g_frameReady = false;
 static bool g_emulating = false;
+static int g_romSize = 0;
+
+// Input the core sees for the current frame, latched from g_inputState or a movie
+static uint32_t g_frameInput = 0;
+static uint32_t movieFrameInput(uint32_t liveInput);
+static void stopMovie();
+static void stopDigestTrace();
+static void traceFrameDone();
+static bool g_traceActive = false;
+
+// Battery saves: the core flags save memory writes in systemSaveUpdateCounter, which is
+// checked every BATTERY_CHECK_FRAMES frames and cleared once the memory is snapshotted
+static const int BATTERY_CHECK_FRAMES = 30;
+static std::string g_batteryPath;
+static int g_batteryFrames = 0;
+static std::vector<uint8_t> g_batteryData;
 
 // Frame timing
 static constexpr double FRAME_TIME = 1.0 / AUDIO_FRAMES_PER_SECOND;
@@ -40,6 +60,59 @@ static const int VIDEO_WIDTH = GBA_WIDTH;
 static const int VIDEO_HEIGHT = GBA_HEIGHT;
 static const int VIDEO_BUFFER_SIZE = VIDEO_WIDTH * VIDEO_HEIGHT * 2;  // 2 bytes per pixel for RGB565
 
+// Duplicate frame detection: hash and copy of the visible part of g_pix from the
+// last drawn frame
+static const int FRAME_HASH_LANES = 4;
+static uint32_t g_frameHash[FRAME_HASH_LANES];
+static uint32_t g_lastFrame[VIDEO_WIDTH * VIDEO_HEIGHT];
+static const uint16_t* g_frameHashTarget = nullptr;
+static bool g_frameHashValid = false;
+
+static const uint32_t* frameLine(int y) {
+    return (const uint32_t*)(g_pix + ((y + 1) * (VIDEO_WIDTH + 1) * 4)) + 1;
+}
+
+// FNV-1a over the source lines, split in lanes so the multiplies can overlap.
+// Returns true if the frame matches the previous one drawn into the same buffer.
+// Only a hash change is taken as proof; equal hashes are checked against the copy.
+static bool frameUnchanged() {
+    static_assert(VIDEO_WIDTH % FRAME_HASH_LANES == 0, "line width must split evenly into lanes");
+    
+    uint32_t lanes[FRAME_HASH_LANES];
+    for (int i = 0; i < FRAME_HASH_LANES; i++) {
+        lanes[i] = 0x811C9DC5u + i;
+    }
+    
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        const uint32_t* srcLine = frameLine(y);
+        
+        for (int x = 0; x < VIDEO_WIDTH; x += FRAME_HASH_LANES) {
+            for (int i = 0; i < FRAME_HASH_LANES; i++) {
+                lanes[i] = (lanes[i] ^ srcLine[x + i]) * 0x01000193u;
+            }
+        }
+    }
+    
+    bool same = g_frameHashValid && g_frameHashTarget == g_videoBuffer;
+    for (int i = 0; i < FRAME_HASH_LANES; i++) {
+        same &= (g_frameHash[i] == lanes[i]);
+        g_frameHash[i] = lanes[i];
+    }
+    
+    for (int y = 0; same && y < VIDEO_HEIGHT; y++) {
+        same = memcmp(&g_lastFrame[y * VIDEO_WIDTH], frameLine(y), VIDEO_WIDTH * 4) == 0;
+    }
+    if (!same) {
+        for (int y = 0; y < VIDEO_HEIGHT; y++) {
+            memcpy(&g_lastFrame[y * VIDEO_WIDTH], frameLine(y), VIDEO_WIDTH * 4);
+        }
+    }
+    
+    g_frameHashTarget = g_videoBuffer;
+    g_frameHashValid = true;
+    return same;
+}
+
 
 void updateColorMapping(bool isLcdMode) {
     switch (systemColorDepth) {
@@ -67,12 +140,25 @@ void systemSendScreen() {
 }
 
 void systemDrawScreen() {
+    if (gbBridgeRunning()) {
+        gbBridgeDrawScreen();
+        return;
+    }
+    
     if (!g_videoBuffer || !g_pix) {
         printf("systemDrawScreen: buffers not ready - g_videoBuffer=%p g_pix=%p\n",
                (void*)g_videoBuffer, (void*)g_pix);
         return;
     }
     
+    if (frameUnchanged()) {
+        if (g_videoCallback) {
+            g_videoCallback(reinterpret_cast<const uint8_t*>(g_videoBuffer), VIDEO_BUFFER_SIZE, true);
+        }
+        g_frameReady = true;
+        return;
+    }
+    
     // Get rid of the first line and the last row
     for (int y = 0; y < VIDEO_HEIGHT; y++) {
         uint32_t* srcLine = (uint32_t*)(g_pix + ((y + 1) * (VIDEO_WIDTH + 1) * 4));
@@ -98,7 +184,7 @@ void systemDrawScreen() {
     
     // Notify Swift through callback
     if (g_videoCallback) {
-        g_videoCallback(reinterpret_cast<const uint8_t*>(g_videoBuffer), VIDEO_BUFFER_SIZE);
+        g_videoCallback(reinterpret_cast<const uint8_t*>(g_videoBuffer), VIDEO_BUFFER_SIZE, false);
     } else {
         printf("systemDrawScreen: Warning - no video callback registered\n");
     }
@@ -108,14 +194,12 @@ void systemDrawScreen() {
 }
 
 void systemOnWriteDataToSoundBuffer(const uint16_t* finalWave, int length) {
-    if (g_audioCallback && g_audioBuffer) {
-        memcpy(g_audioBuffer, finalWave, length);
-        g_audioCallback(g_audioBuffer, length);
-    }
+    // SoolraSoundDriver already forwarded these samples as float
 }
 
 uint32_t systemReadJoypad(int which) {
-    return g_inputState;
+    if (gbBridgeRunning()) return gbBridgeReadJoypad();
+    return g_frameInput;
 }
 
 // Implementation of the bridge functions
@@ -128,11 +212,9 @@ void GBAInitialize(VideoCallback videoCallback, AudioCallback audioCallback) {
         return buffer != nullptr;
     };
     
-    if (!g_bios && allocateBuffer(g_bios, SIZE_BIOS)) {
-        memcpy(g_bios, myROM, SIZE_BIOS);
-    }
-    
-    if (!g_rom) allocateBuffer(g_rom, SIZE_ROM);
+    // The BIOS image is installed by CPUInit
+    if (!g_bios) allocateBuffer(g_bios, SIZE_BIOS);
+    CPUReserveRom();
     if (!g_internalRAM) allocateBuffer(g_internalRAM, SIZE_IRAM);
     if (!g_workRAM) allocateBuffer(g_workRAM, SIZE_WRAM);
     if (!g_paletteRAM) allocateBuffer(g_paletteRAM, SIZE_PRAM);
@@ -176,6 +258,185 @@ void GBAInitialize(VideoCallback videoCallback, AudioCallback audioCallback) {
     g_emulating = true;
 }
 
+// vba-over.ini entries, parsed once per process into a table keyed by game code
+struct RomOverride {
+    bool hasSaveType = false;
+    int saveType = 0;
+    bool hasFlashSize = false;
+    int flashSize = 0;
+    bool hasRtc = false;
+    bool rtcEnabled = false;
+    bool mirroringEnabled = false;
+};
+
+static std::map<std::string, RomOverride> g_romOverrides;
+static bool g_romOverridesLoaded = false;
+
+static void loadRomOverrides() {
+    g_romOverridesLoaded = true;
+    
+    const char* bundlePath = getBundleResourcePath();
+    if (!bundlePath) return;
+    
+    char iniPath[1024];
+    std::snprintf(iniPath, sizeof(iniPath), "%s/vba-over.ini", bundlePath);
+    std::FILE* fp = std::fopen(iniPath, "r");
+    if (!fp) return;
+    
+    char line[256];
+    RomOverride* section = nullptr;
+    
+    while (std::fgets(line, sizeof(line), fp)) {
+        char* newline = std::strchr(line, '\n');
+        if (newline) *newline = 0;
+        if (line[0] == '#' || line[0] == 0) continue;
+        
+        if (line[0] == '[') {
+            char sectionID[5] = {0};
+            std::sscanf(line, "[%4[^]]", sectionID);
+            section = &g_romOverrides[sectionID];
+            continue;
+        }
+        
+        if (section) {
+            if (std::strncmp(line, "saveType=", 9) == 0) {
+                section->hasSaveType = true;
+                section->saveType = std::atoi(line + 9);
+            }
+            else if (std::strncmp(line, "flashSize=", 10) == 0) {
+                section->hasFlashSize = true;
+                section->flashSize = std::atoi(line + 10);
+            }
+            else if (std::strncmp(line, "rtcEnabled=", 11) == 0) {
+                section->hasRtc = true;
+                section->rtcEnabled = std::atoi(line + 11) != 0;
+            }
+            else if (std::strncmp(line, "mirroringEnabled=", 17) == 0) {
+                section->mirroringEnabled = std::atoi(line + 17) != 0;
+            }
+        }
+    }
+    
+    std::fclose(fp);
+}
+
+// Save type detection results, persisted in the cache directory so repeat
+// launches skip the ROM scan. Keyed by game code, ROM size and a CRC of the
+// start of the ROM, which is enough to tell builds apart without reading the
+// whole image. Patched loads add a CRC of the patch file, since a patch can
+// change the save type anywhere in the image.
+struct SaveTypeInfo {
+    int saveType;
+    int flashSize;
+    bool rtcFound;
+};
+
+static const char* SAVE_TYPE_CACHE_FILE = "gba-savetype.cache";
+static const int SAVE_TYPE_KEY_SPAN = 0x10000;
+
+static std::string g_cacheDirectory;
+static std::string g_saveTypeKey;
+// Whole-image key for movies, computed on first use after each load
+static std::string g_romKey;
+static std::map<std::string, SaveTypeInfo> g_saveTypeCache;
+static bool g_saveTypeCacheLoaded = false;
+
+static std::string saveTypeCachePath() {
+    return g_cacheDirectory + "/" + SAVE_TYPE_CACHE_FILE;
+}
+
+static void loadSaveTypeCache() {
+    g_saveTypeCacheLoaded = true;
+    if (g_cacheDirectory.empty()) return;
+    
+    std::FILE* fp = std::fopen(saveTypeCachePath().c_str(), "r");
+    if (!fp) return;
+    
+    char key[48];
+    SaveTypeInfo info;
+    int rtcFound;
+    while (std::fscanf(fp, "%47s %d %d %d", key, &info.saveType, &info.flashSize, &rtcFound) == 4) {
+        info.rtcFound = rtcFound != 0;
+        g_saveTypeCache[key] = info;
+    }
+    std::fclose(fp);
+}
+
+static bool fileCrc(const char* path, uLong* crc) {
+    std::FILE* fp = std::fopen(path, "rb");
+    if (!fp) return false;
+    *crc = crc32(0L, Z_NULL, 0);
+    uint8_t chunk[0x4000];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        *crc = crc32(*crc, chunk, (uInt)read);
+    }
+    std::fclose(fp);
+    return true;
+}
+
+static std::string saveTypeKey(int size, const char* patchPath) {
+    uint32_t gameCode;
+    std::memcpy(&gameCode, g_rom + 0xAC, sizeof(gameCode));
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, g_rom, size < SAVE_TYPE_KEY_SPAN ? size : SAVE_TYPE_KEY_SPAN);
+    
+    char key[48];
+    uLong patchCrc;
+    if (patchPath && fileCrc(patchPath, &patchCrc)) {
+        std::snprintf(key, sizeof(key), "%08X-%08X-%08lX-%08lX", gameCode, size, (unsigned long)crc,
+                      (unsigned long)patchCrc);
+    } else {
+        std::snprintf(key, sizeof(key), "%08X-%08X-%08lX", gameCode, size, (unsigned long)crc);
+    }
+    return key;
+}
+
+// Identifies the ROM an input movie was recorded with, so a movie never plays
+// back on a hack or patched build of the game it was made on. This reads every
+// page of the image, so it is only taken when a movie starts.
+static const std::string& romKey() {
+    if (g_romKey.empty()) {
+        uint32_t gameCode;
+        std::memcpy(&gameCode, g_rom + 0xAC, sizeof(gameCode));
+        uLong crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, g_rom, g_romSize);
+        
+        char key[32];
+        std::snprintf(key, sizeof(key), "%08X-%08X-%08lX", gameCode, g_romSize, (unsigned long)crc);
+        g_romKey = key;
+    }
+    return g_romKey;
+}
+
+static void detectSaveType(int size) {
+    if (!g_saveTypeCacheLoaded) loadSaveTypeCache();
+    
+    const std::string& key = g_saveTypeKey;
+    auto it = g_saveTypeCache.find(key);
+    if (it == g_saveTypeCache.end()) {
+        SaveTypeInfo info;
+        flashScanSaveType(g_rom, size, &info.saveType, &info.flashSize, &info.rtcFound);
+        it = g_saveTypeCache.emplace(key, info).first;
+        
+        if (!g_cacheDirectory.empty()) {
+            std::FILE* fp = std::fopen(saveTypeCachePath().c_str(), "a");
+            if (fp) {
+                std::fprintf(fp, "%s %d %d %d\n", key.c_str(), info.saveType, info.flashSize, info.rtcFound ? 1 : 0);
+                std::fclose(fp);
+            }
+        }
+    }
+    
+    flashApplySaveType(it->second.saveType, it->second.flashSize, it->second.rtcFound);
+}
+
+void GBASetCacheDirectory(const char* path) {
+    g_cacheDirectory = path ? path : "";
+    g_saveTypeCache.clear();
+    g_saveTypeCacheLoaded = false;
+}
+
 void updateRomSettings(const char* romPath, int detectedSaveType, int detectedFlashSize, bool detectedRtc) {
     char gameID[5] = {0};
     if (g_rom) {
@@ -187,53 +448,16 @@ void updateRomSettings(const char* romPath, int detectedSaveType, int detectedFl
     int flashSize = detectedFlashSize;
     bool rtcEnabled = detectedRtc;
     bool mirroringEnabled = false;
-    bool settingsFound = false;
     
-    const char* bundlePath = getBundleResourcePath();
-    if (bundlePath) {
-        char iniPath[1024];
-        std::snprintf(iniPath, sizeof(iniPath), "%s/vba-over.ini", bundlePath);
-        std::FILE* fp = std::fopen(iniPath, "r");
-        
-        if (fp) {
-            char line[256];
-            bool inGameSection = false;
-            
-            while (std::fgets(line, sizeof(line), fp)) {
-                char* newline = std::strchr(line, '\n');
-                if (newline) *newline = 0;
-                if (line[0] == '#' || line[0] == 0) continue;
-                
-                if (line[0] == '[') {
-                    char sectionID[5] = {0};
-                    std::sscanf(line, "[%4[^]]", sectionID);
-                    if (std::strcmp(sectionID, gameID) == 0) {
-                        inGameSection = true;
-                        settingsFound = true;
-                        continue;
-                    } else {
-                        inGameSection = false;
-                    }
-                }
-                
-                if (inGameSection) {
-                    if (std::strncmp(line, "saveType=", 9) == 0) {
-                        saveType = std::atoi(line + 9);
-                    }
-                    else if (std::strncmp(line, "flashSize=", 10) == 0) {
-                        flashSize = std::atoi(line + 10);
-                    }
-                    else if (std::strncmp(line, "rtcEnabled=", 11) == 0) {
-                        rtcEnabled = std::atoi(line + 11) != 0;
-                    }
-                    else if (std::strncmp(line, "mirroringEnabled=", 17) == 0) {
-                        mirroringEnabled = std::atoi(line + 17) != 0;
-                    }
-                }
-            }
-            
-            std::fclose(fp);
-        }
+    if (!g_romOverridesLoaded) loadRomOverrides();
+    
+    auto it = g_romOverrides.find(gameID);
+    if (it != g_romOverrides.end()) {
+        const RomOverride& settings = it->second;
+        if (settings.hasSaveType) saveType = settings.saveType;
+        if (settings.hasFlashSize) flashSize = settings.flashSize;
+        if (settings.hasRtc) rtcEnabled = settings.rtcEnabled;
+        mirroringEnabled = settings.mirroringEnabled;
     }
     
     coreOptions.saveType = saveType;
@@ -252,40 +476,58 @@ void updateRomSettings(const char* romPath, int detectedSaveType, int detectedFl
     }
 }
 
-bool GBALoadGame(const char* path) {
-    if (!path) return false;
-    
-    std::unique_ptr<char[]> romData;
-    size_t fileSize;
+// applyPatch may reallocate the image, so the mapped ROM is patched through a heap copy
+static bool patchRom(const char* patchPath, int* size) {
+    uint8_t* rom = static_cast<uint8_t*>(malloc(*size));
+    if (!rom) return false;
+    memcpy(rom, g_rom, *size);
     
-    {
-        std::FILE* fp = std::fopen(path, "rb");
-        if (!fp) return false;
-        
-        std::fseek(fp, 0, SEEK_END);
-        fileSize = std::ftell(fp);
-        std::fseek(fp, 0, SEEK_SET);
-        
-        romData = std::make_unique<char[]>(fileSize);
-        if (!romData) {
-            std::fclose(fp);
-            return false;
-        }
-        
-        if (std::fread(romData.get(), 1, fileSize, fp) != fileSize) {
-            std::fclose(fp);
-            return false;
-        }
-        std::fclose(fp);
+    int patchedSize = *size;
+    bool patched = applyPatch(patchPath, &rom, &patchedSize) && patchedSize <= SIZE_ROM;
+    if (patched) {
+        memcpy(g_rom, rom, patchedSize);
+        gbaUpdateRomSize(patchedSize);
+        *size = patchedSize;
+    } else {
+        printf("GBALoadPatchedGame: failed to apply %s\n", patchPath);
+    }
+    free(rom);
+    return patched;
+}
+
+static void queueBatterySave(const char* path) {
+    systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
+    if (CPUWriteBatteryData(g_batteryData)) {
+        batteryWriterQueue(path, g_batteryData.data(), g_batteryData.size());
+    }
+}
+
+static void saveChangedBattery() {
+    if (g_emulating && !g_batteryPath.empty() && systemSaveUpdateCounter != SYSTEM_SAVE_NOT_UPDATED) {
+        queueBatterySave(g_batteryPath.c_str());
     }
+}
+
+static bool loadGame(const char* path, const char* patchPath) {
+    if (!path) return false;
     
-    int size = CPULoadRomData(romData.get(), fileSize);
-    if (size <= 0) return false;
+    saveChangedBattery();
+    stopMovie();
+    stopDigestTrace();
+    
+    // Bare images are mapped copy on write, so pages are only read in as the game touches
+    // them. Archives are inflated by fex straight into the ROM space instead.
+    int size = utilIsArchive(path) ? CPULoadRom(path) : CPUMapRom(path);
+    if (size <= 0 || size > SIZE_ROM) return false;
+    if (patchPath && !patchRom(patchPath, &size)) return false;
+    g_romSize = size;
+    g_saveTypeKey = saveTypeKey(size, patchPath);
+    g_romKey.clear();
     
     // Update color mapping first
     updateColorMapping(false);
     
-    flashDetectSaveType(size);
+    detectSaveType(size);
     int detectedSaveType = coreOptions.saveType;
     int detectedFlashSize = g_flashSize;
     bool detectedRtc = coreOptions.rtcEnabled;
@@ -299,11 +541,32 @@ bool GBALoadGame(const char* path) {
     CPUInit(nullptr, false);
     GBASystem.emuReset();
     
+    g_frameHashValid = false;
     g_emulating = true;
     return true;
 }
 
+bool GBALoadGame(const char* path) {
+    return loadGame(path, nullptr);
+}
+
+bool GBALoadPatchedGame(const char* path, const char* patchPath) {
+    return patchPath && loadGame(path, patchPath);
+}
+
+bool GBAIsImageName(const char* name) {
+    // utilIsGBAImage also flags .mb images as multiboot for the next load
+    bool multiBoot = coreOptions.cpuIsMultiBoot;
+    bool accepted = utilIsArchiveMember(name, utilIsGBAImage);
+    coreOptions.cpuIsMultiBoot = multiBoot;
+    return accepted;
+}
+
 void GBAShutdown() {
+    stopMovie();
+    stopDigestTrace();
+    saveChangedBattery();
+    batteryWriterFlush();
     g_emulating = false;
 }
 
@@ -315,6 +578,8 @@ void GBACleanup() {
 void GBARunFrame(bool processVideo) {
     if (!g_emulating) return;
     
+    g_frameInput = movieFrameInput(g_inputState);
+    
     g_frameReady = false;
     int frameAttempts = 0;
     const int MAX_ATTEMPTS = 100;
@@ -323,6 +588,15 @@ void GBARunFrame(bool processVideo) {
         GBASystem.emuMain(GBASystem.emuCount);
         frameAttempts++;
     }
+    
+    if (g_traceActive) {
+        traceFrameDone();
+    }
+    
+    if (++g_batteryFrames == BATTERY_CHECK_FRAMES) {
+        g_batteryFrames = 0;
+        saveChangedBattery();
+    }
 }
 
 double GBAGetFrameTime() {
@@ -407,14 +681,23 @@ void GBAResetCheats()
 
 void GBASaveGameSave(const char* savePath)
 {
-    GBASystem.emuWriteBattery(savePath);
+    // Through the battery writer too, so the file is replaced atomically
+    queueBatterySave(savePath);
+    batteryWriterFlush();
 }
 
 void GBALoadGameSave(const char* savePath)
 {
+    batteryWriterFlush();
     GBASystem.emuReadBattery(savePath);
 }
 
+void GBASetBatterySavePath(const char* path)
+{
+    saveChangedBattery();
+    g_batteryPath = path ? path : "";
+}
+
 void GBASaveState(const char* statePath)
 {
     GBASystem.emuWriteState(statePath);
@@ -425,5 +708,363 @@ void GBALoadState(const char* statePath)
     GBASystem.emuReadState(statePath);
 }
 
+// Input movies
+//
+// File layout, little endian:
+//   "SGBM" magic, u32 version
+//   ROM key (see romKey), NUL padded to MOVIE_KEY_SIZE bytes
+//   u32 frame count, u32 start state size, compressed start state
+//   one record per input change: varint frames since the previous record, u16 input
+// The first record is at frame 0; the last input holds until the frame count is reached.
+
+static const char MOVIE_MAGIC[4] = { 'S', 'G', 'B', 'M' };
+static const uint32_t MOVIE_VERSION = 1;
+static const int MOVIE_KEY_SIZE = 32;
+static const long MOVIE_FRAME_COUNT_OFFSET = sizeof(MOVIE_MAGIC) + 4 + MOVIE_KEY_SIZE;
+static const int MOVIE_MAX_STATE_SIZE = 0x1000000;
+
+static GBAMovieState g_movieState = GBA_MOVIE_NONE;
+static uint32_t g_movieFrame = 0;
+static uint32_t g_movieLength = 0;
+static uint32_t g_movieInput = 0;
+static uint32_t g_movieLastChange = 0;
+
+// Recording streams records to the file; the frame count is patched in on stop
+static std::FILE* g_movieFile = nullptr;
+
+// Playback reads the records from memory
+static std::vector<uint8_t> g_movieData;
+static size_t g_moviePos = 0;
+static uint32_t g_movieNextChange = 0;
+
+static void putMovie32(std::FILE* fp, uint32_t value) {
+    const uint8_t bytes[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+    std::fwrite(bytes, 1, sizeof(bytes), fp);
+}
+
+static uint32_t getMovie32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+}
+
+// Reads the frame distance to the next record; no more records means the input never changes again
+static void readMovieDelta() {
+    uint32_t delta = 0;
+    for (int shift = 0; g_moviePos < g_movieData.size() && shift < 32; shift += 7) {
+        const uint8_t byte = g_movieData[g_moviePos++];
+        delta |= uint32_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            g_movieNextChange = g_movieLastChange + delta;
+            return;
+        }
+    }
+    g_movieNextChange = UINT32_MAX;
+}
+
+static void stopMovie() {
+    if (g_movieFile) {
+        std::fseek(g_movieFile, MOVIE_FRAME_COUNT_OFFSET, SEEK_SET);
+        putMovie32(g_movieFile, g_movieFrame);
+        std::fclose(g_movieFile);
+        g_movieFile = nullptr;
+    }
+    g_movieData.clear();
+    g_movieData.shrink_to_fit();
+    g_movieState = GBA_MOVIE_NONE;
+}
+
+static uint32_t movieFrameInput(uint32_t liveInput) {
+    if (g_movieState == GBA_MOVIE_RECORDING) {
+        if (g_movieFrame == 0 || liveInput != g_movieInput) {
+            uint32_t delta = g_movieFrame - g_movieLastChange;
+            while (delta >= 0x80) {
+                std::fputc(int(delta & 0x7F) | 0x80, g_movieFile);
+                delta >>= 7;
+            }
+            std::fputc(int(delta), g_movieFile);
+            std::fputc(int(liveInput & 0xFF), g_movieFile);
+            std::fputc(int((liveInput >> 8) & 0xFF), g_movieFile);
+            g_movieInput = liveInput;
+            g_movieLastChange = g_movieFrame;
+        }
+        g_movieFrame++;
+        return liveInput;
+    }
+    
+    if (g_movieState == GBA_MOVIE_PLAYING) {
+        if (g_movieFrame >= g_movieLength) {
+            stopMovie();
+            return liveInput;
+        }
+        if (g_movieFrame == g_movieNextChange && g_moviePos + 2 <= g_movieData.size()) {
+            g_movieInput = g_movieData[g_moviePos] | (g_movieData[g_moviePos + 1] << 8);
+            g_moviePos += 2;
+            g_movieLastChange = g_movieFrame;
+            readMovieDelta();
+        }
+        g_movieFrame++;
+        return g_movieInput;
+    }
+    
+    return liveInput;
+}
+
+bool GBAStartMovieRecording(const char* path) {
+    if (!path || !g_emulating) return false;
+    stopMovie();
+    
+    std::vector<char> state(0x100000);
+    long stateSize = 0;
+    while (!GBASystem.emuWriteMemState(state.data(), (int)state.size(), stateSize)) {
+        if (state.size() >= MOVIE_MAX_STATE_SIZE) return false;
+        state.resize(state.size() * 2);
+    }
+    
+    g_movieFile = std::fopen(path, "wb");
+    if (!g_movieFile) return false;
+    
+    char key[MOVIE_KEY_SIZE] = {};
+    std::strncpy(key, romKey().c_str(), sizeof(key) - 1);
+    
+    std::fwrite(MOVIE_MAGIC, 1, sizeof(MOVIE_MAGIC), g_movieFile);
+    putMovie32(g_movieFile, MOVIE_VERSION);
+    std::fwrite(key, 1, sizeof(key), g_movieFile);
+    putMovie32(g_movieFile, 0);
+    putMovie32(g_movieFile, (uint32_t)stateSize);
+    std::fwrite(state.data(), 1, stateSize, g_movieFile);
+    
+    g_movieState = GBA_MOVIE_RECORDING;
+    g_movieFrame = 0;
+    g_movieLastChange = 0;
+    return true;
+}
+
+bool GBAStartMoviePlayback(const char* path) {
+    if (!path || !g_emulating) return false;
+    stopMovie();
+    
+    std::FILE* fp = std::fopen(path, "rb");
+    if (!fp) return false;
+    std::vector<uint8_t> data;
+    uint8_t chunk[0x4000];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    std::fclose(fp);
+    
+    const size_t header = MOVIE_FRAME_COUNT_OFFSET + 8;
+    if (data.size() < header || std::memcmp(data.data(), MOVIE_MAGIC, sizeof(MOVIE_MAGIC)) != 0 ||
+        getMovie32(&data[4]) != MOVIE_VERSION) {
+        printf("GBAStartMoviePlayback: %s is not a movie file\n", path);
+        return false;
+    }
+    
+    char key[MOVIE_KEY_SIZE] = {};
+    std::strncpy(key, romKey().c_str(), sizeof(key) - 1);
+    if (std::memcmp(&data[8], key, sizeof(key)) != 0) {
+        printf("GBAStartMoviePlayback: movie was recorded with a different ROM\n");
+        return false;
+    }
+    
+    const uint32_t length = getMovie32(&data[MOVIE_FRAME_COUNT_OFFSET]);
+    const uint32_t stateSize = getMovie32(&data[MOVIE_FRAME_COUNT_OFFSET + 4]);
+    if (stateSize > data.size() - header ||
+        !GBASystem.emuReadMemState(reinterpret_cast<char*>(&data[header]), (int)stateSize)) {
+        printf("GBAStartMoviePlayback: bad start state\n");
+        return false;
+    }
+    
+    g_movieData = std::move(data);
+    g_moviePos = header + stateSize;
+    g_movieState = GBA_MOVIE_PLAYING;
+    g_movieLength = length;
+    g_movieFrame = 0;
+    g_movieInput = 0;
+    g_movieLastChange = 0;
+    g_frameHashValid = false;
+    readMovieDelta();
+    return true;
+}
+
+void GBAStopMovie() {
+    stopMovie();
+}
+
+GBAMovieState GBAGetMovieState() {
+    return g_movieState;
+}
+
+uint32_t GBAGetMovieFrame() {
+    return g_movieFrame;
+}
+
+// Golden traces
+//
+// File layout, native endian: "SGBD" magic, u32 interval, u32 GBA_DIGEST_PARTS,
+// then one GBAFrameDigest every interval frames.
+
+static const char TRACE_MAGIC[4] = { 'S', 'G', 'B', 'D' };
+static const uint32_t DIGEST_BASIS = 0x811C9DC5u;
+static const int SOUND_REGS_START = 0x60;
+static const int SOUND_REGS_END = 0xB0;
+
+static uint32_t g_traceInterval = 0;
+static uint32_t g_traceFrame = 0;
+static uint32_t g_traceAudio = DIGEST_BASIS;
+static std::FILE* g_traceFile = nullptr;             // recording
+static std::vector<GBAFrameDigest> g_traceGolden;    // verifying
+static size_t g_traceNext = 0;
+static bool g_traceDiverged = false;
+static uint32_t g_traceDivergedFrame = 0;
+static uint32_t g_traceDivergedParts = 0;
+
+// FNV-1a a word at a time; every region hashed here is a multiple of 4 bytes
+static uint32_t digestWords(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i + 4 <= size; i += 4) {
+        uint32_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0x01000193u;
+    }
+    return hash;
+}
+
+void digestAudioSamples(const float* left, const float* right, int count) {
+    if (!g_traceActive) return;
+    
+    g_traceAudio = digestWords(g_traceAudio, left, count * sizeof(float));
+    g_traceAudio = digestWords(g_traceAudio, right, count * sizeof(float));
+}
+
+void GBAGetFrameDigest(GBAFrameDigest* digest) {
+    digest->frame = g_traceFrame;
+    for (uint32_t& part : digest->parts) {
+        part = DIGEST_BASIS;
+    }
+    
+    if (!g_emulating) return;
+    
+    const uint32_t flags[] = {
+        N_FLAG, C_FLAG, Z_FLAG, V_FLAG, armState, armIrqEnable, armNextPC, (uint32_t)armMode
+    };
+    
+    uint32_t* parts = digest->parts;
+    parts[GBA_DIGEST_VIDEO] = digestWords(DIGEST_BASIS, g_pix, SIZE_PIX);
+    parts[GBA_DIGEST_AUDIO] = g_traceAudio;
+    parts[GBA_DIGEST_CPU] = digestWords(digestWords(DIGEST_BASIS, reg, sizeof(reg)), flags, sizeof(flags));
+    parts[GBA_DIGEST_RAM] = digestWords(digestWords(DIGEST_BASIS, g_internalRAM, SIZE_IRAM), g_workRAM, SIZE_WRAM);
+    parts[GBA_DIGEST_VRAM] = digestWords(digestWords(DIGEST_BASIS, g_vram, SIZE_VRAM), g_paletteRAM, SIZE_PRAM);
+    parts[GBA_DIGEST_OAM] = digestWords(DIGEST_BASIS, g_oam, SIZE_OAM);
+    parts[GBA_DIGEST_APU] = digestWords(DIGEST_BASIS, g_ioMem + SOUND_REGS_START, SOUND_REGS_END - SOUND_REGS_START);
+    parts[GBA_DIGEST_IO] = digestWords(digestWords(DIGEST_BASIS, g_ioMem, SOUND_REGS_START),
+                                       g_ioMem + SOUND_REGS_END, SIZE_IOMEM - SOUND_REGS_END);
+}
+
+static void traceFrameDone() {
+    if (++g_traceFrame % g_traceInterval != 0) return;
+    
+    GBAFrameDigest digest;
+    GBAGetFrameDigest(&digest);
+    g_traceAudio = DIGEST_BASIS;
+    
+    if (g_traceFile) {
+        std::fwrite(&digest, sizeof(digest), 1, g_traceFile);
+        return;
+    }
+    
+    if (g_traceDiverged) return;
+    
+    // Ran past the end of the golden: the trace lengths differ
+    if (g_traceNext >= g_traceGolden.size()) {
+        g_traceDiverged = true;
+        g_traceDivergedFrame = digest.frame;
+        g_traceDivergedParts = 0;
+        return;
+    }
+    
+    const GBAFrameDigest& golden = g_traceGolden[g_traceNext++];
+    uint32_t differs = 0;
+    for (int i = 0; i < GBA_DIGEST_PARTS; i++) {
+        if (golden.parts[i] != digest.parts[i]) differs |= 1u << i;
+    }
+    
+    if (golden.frame != digest.frame || differs) {
+        g_traceDiverged = true;
+        g_traceDivergedFrame = digest.frame;
+        g_traceDivergedParts = differs;
+    }
+}
+
+static void stopDigestTrace() {
+    if (g_traceFile) {
+        std::fclose(g_traceFile);
+        g_traceFile = nullptr;
+    }
+    g_traceGolden.clear();
+    g_traceGolden.shrink_to_fit();
+    g_traceNext = 0;
+    g_traceDiverged = false;
+    g_traceActive = false;
+}
+
+bool GBAStartDigestTrace(const char* path, uint32_t interval, bool verify) {
+    if (!path || !g_emulating || interval == 0) return false;
+    stopDigestTrace();
+    
+    uint32_t header[2] = { interval, GBA_DIGEST_PARTS };
+    
+    if (verify) {
+        std::FILE* fp = std::fopen(path, "rb");
+        if (!fp) return false;
+        
+        char magic[sizeof(TRACE_MAGIC)];
+        bool valid = std::fread(magic, sizeof(magic), 1, fp) == 1 &&
+                     std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0 &&
+                     std::fread(header, sizeof(header), 1, fp) == 1 &&
+                     header[1] == GBA_DIGEST_PARTS;
+        
+        GBAFrameDigest digest;
+        while (valid && std::fread(&digest, sizeof(digest), 1, fp) == 1) {
+            g_traceGolden.push_back(digest);
+        }
+        std::fclose(fp);
+        
+        if (!valid) {
+            printf("GBAStartDigestTrace: %s is not a digest trace\n", path);
+            return false;
+        }
+    } else {
+        g_traceFile = std::fopen(path, "wb");
+        if (!g_traceFile) return false;
+        
+        std::fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), g_traceFile);
+        std::fwrite(header, sizeof(header), 1, g_traceFile);
+    }
+    
+    g_traceInterval = header[0];
+    g_traceFrame = 0;
+    g_traceAudio = DIGEST_BASIS;
+    g_traceActive = true;
+    return true;
+}
+
+void GBAStopDigestTrace() {
+    stopDigestTrace();
+}
+
+bool GBAGetDigestDivergence(uint32_t* frame, uint32_t* partMask) {
+    // Stopped short of the end of the golden: the trace lengths differ
+    if (!g_traceDiverged && g_traceActive && !g_traceFile && g_traceNext < g_traceGolden.size()) {
+        *frame = g_traceGolden[g_traceNext].frame;
+        *partMask = 0;
+        return true;
+    }
+    if (!g_traceDiverged) return false;
+    
+    *frame = g_traceDivergedFrame;
+    *partMask = g_traceDivergedParts;
+    return true;
+}
+
 #pragma clang diagnostic pop
 
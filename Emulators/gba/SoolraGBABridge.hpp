@@ -25,17 +25,46 @@ enum GBAAudioConstants {
     AUDIO_SAMPLE_RATE = 44100,
     AUDIO_FRAMES_PER_SECOND = 60,
     AUDIO_CHANNELS = 2,
-    AUDIO_BYTES_PER_SAMPLE = 2,
+    AUDIO_BYTES_PER_SAMPLE = 4,  /* float32, planar */
     AUDIO_SAMPLES_PER_FRAME = AUDIO_SAMPLE_RATE / AUDIO_FRAMES_PER_SECOND,
     AUDIO_FRAME_SIZE = AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS * AUDIO_BYTES_PER_SAMPLE
 };
 
 // Audio buffer - size matches Swift's calculation
-// (44100Hz / 60fps) * 2 channels * 2 bytes per sample = 2940 bytes per frame
-const int AUDIO_BUFFER_SIZE = 2940;  // One frame of stereo audio at 44100Hz
+// (44100Hz / 60fps) * 2 channels * 4 bytes per sample = 5880 bytes per frame,
+// the left channel's samples followed by the right channel's
+const int AUDIO_BUFFER_SIZE = AUDIO_FRAME_SIZE;  // One frame of stereo audio at 44100Hz
+
+// Input movie modes
+typedef enum GBAMovieState {
+    GBA_MOVIE_NONE,
+    GBA_MOVIE_RECORDING,
+    GBA_MOVIE_PLAYING
+} GBAMovieState;
+
+// Subsystems covered by a frame digest
+typedef enum GBADigestPart {
+    GBA_DIGEST_VIDEO,   // frame as last drawn by the core
+    GBA_DIGEST_AUDIO,   // samples output since the previous digest
+    GBA_DIGEST_CPU,     // registers of every mode and the flags
+    GBA_DIGEST_RAM,     // internal and work RAM
+    GBA_DIGEST_VRAM,    // VRAM and palette RAM
+    GBA_DIGEST_OAM,
+    GBA_DIGEST_APU,     // sound registers and wave RAM
+    GBA_DIGEST_IO,      // the remaining I/O registers
+    GBA_DIGEST_PARTS
+} GBADigestPart;
+
+typedef struct GBAFrameDigest {
+    uint32_t frame;     // frames run since the trace started
+    uint32_t parts[GBA_DIGEST_PARTS];
+} GBAFrameDigest;
 
 // Callback type definitions
-typedef void (*VideoCallback)(const uint8_t* buffer, int32_t size);
+// unchanged is set when the frame is identical to the previous one; the buffer
+// then still holds that frame and the host can skip its upload.
+typedef void (*VideoCallback)(const uint8_t* buffer, int32_t size, bool unchanged);
+// size is in bytes; the buffer holds size / 8 left samples followed by as many right ones.
 typedef void (*AudioCallback)(const uint8_t* buffer, int32_t size);
 
 // External declarations
@@ -49,7 +78,14 @@ const char* getBundleResourcePath(void);
 
 // Initialization and cleanup
 void GBAInitialize(VideoCallback videoCallback, AudioCallback audioCallback);
+// Directory for per-ROM caches (save type detection); caching stays in memory if unset
+void GBASetCacheDirectory(const char* path);
+// path may also be a zip, 7z, rar or gz archive; its first GBA member is loaded
 bool GBALoadGame(const char* path);
+// The rule GBALoadGame picks archive members by (.gba, .agb, .bin, .elf, .mb)
+bool GBAIsImageName(const char* name);
+// Loads path with an IPS, UPS, BPS or PPF patch applied in memory; the file is untouched
+bool GBALoadPatchedGame(const char* path, const char* patchPath);
 void GBAShutdown();
 void GBACleanup();
 
@@ -80,6 +116,27 @@ void GBASaveState(const char* path);
 void GBASaveGameSave(const char* path);
 void GBALoadState(const char* path);
 void GBALoadGameSave(const char* path);
+// Save memory is written to this path in the background a moment after the game changes it
+void GBASetBatterySavePath(const char* path);
+
+// Input movies: the current state plus every frame's input changes, tied to the loaded ROM.
+// Playback restores the recorded start state and returns to live input after the last frame.
+bool GBAStartMovieRecording(const char* path);
+bool GBAStartMoviePlayback(const char* path);
+void GBAStopMovie();
+GBAMovieState GBAGetMovieState();
+uint32_t GBAGetMovieFrame();
+
+// Golden traces: per-subsystem digests taken every interval frames, usually while a movie
+// plays, to check that a core change leaves emulation bit-exact. Recording writes them to
+// path; verifying compares against a recorded trace (whose interval wins) and keeps the
+// first frame that differs along with a mask of the differing parts (1 << GBADigestPart).
+// A golden that is longer or shorter than the run diverges with an empty mask, at the
+// first frame one of them lacks.
+bool GBAStartDigestTrace(const char* path, uint32_t interval, bool verify);
+void GBAStopDigestTrace();
+bool GBAGetDigestDivergence(uint32_t* frame, uint32_t* partMask);
+void GBAGetFrameDigest(GBAFrameDigest* digest);
 
 #if defined(__cplusplus)
 }
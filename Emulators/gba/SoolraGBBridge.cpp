@@ -0,0 +1,278 @@
+//
+//  SOOLRA
+//
+//  Copyright © 2025 SOOLRA. All rights reserved.
+//
+
+#include "SoolraGBBridge.hpp"
+#include "SoolraGBABridge.hpp"  // shared audio buffer and callback
+
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "GBABridgeInternal.hpp"
+#include "core/base/battery_writer.h"
+#include "core/base/sizes.h"
+#include "core/gb/gb.h"
+#include "core/gb/gbCheats.h"
+#include "core/gb/gbGlobals.h"
+#include "core/gb/gbSound.h"
+
+static GBVideoCallback g_gbVideoCallback = nullptr;
+static bool g_gbEmulating = false;
+static uint32_t g_gbInputState = 0;
+
+// Input the core sees for the current frame, latched in GB_RunFrame
+static uint32_t g_gbFrameInput = 0;
+
+// 4194304 Hz / 70224 clocks per frame
+static constexpr double GB_FRAME_TIME = 70224.0 / 4194304.0;
+
+// gbEmulate returns at the end of every frame; the budget only bounds a frame that never ends
+static const int GB_FRAME_TICK_BUDGET = 4 * 70224;
+
+// With a 16-bit colour depth gbDrawLine writes g_pix one line below the top, each line
+// kGBWidth pixels plus two spare ones
+static const int GB_PITCH = kGBWidth + 2;
+
+// Battery saves, as in the GBA bridge
+static const int GB_BATTERY_CHECK_FRAMES = 30;
+static std::string g_gbBatteryPath;
+static int g_gbBatteryFrames = 0;
+static std::vector<uint8_t> g_gbBatteryData;
+
+// Duplicate frame detection, as in the GBA bridge
+static uint32_t g_gbFrameHash = 0;
+static uint16_t g_gbLastFrame[GB_WIDTH * GB_HEIGHT];
+static bool g_gbFrameHashValid = false;
+
+static const uint16_t* visibleFrame() {
+    return reinterpret_cast<const uint16_t*>(g_pix) + GB_PITCH;
+}
+
+static bool gbFrameUnchanged() {
+    uint32_t hash = 0x811C9DC5u;
+    const uint16_t* line = visibleFrame();
+
+    for (int y = 0; y < GB_HEIGHT; y++, line += GB_PITCH) {
+        const uint32_t* pairs = reinterpret_cast<const uint32_t*>(line);
+        for (int x = 0; x < GB_WIDTH / 2; x++) {
+            hash = (hash ^ pairs[x]) * 0x01000193u;
+        }
+    }
+
+    // A matching hash is confirmed against the copy of the last frame
+    bool same = g_gbFrameHashValid && hash == g_gbFrameHash;
+    line = visibleFrame();
+    for (int y = 0; same && y < GB_HEIGHT; y++, line += GB_PITCH) {
+        same = memcmp(&g_gbLastFrame[y * GB_WIDTH], line, GB_WIDTH * 2) == 0;
+    }
+    if (!same) {
+        line = visibleFrame();
+        for (int y = 0; y < GB_HEIGHT; y++, line += GB_PITCH) {
+            memcpy(&g_gbLastFrame[y * GB_WIDTH], line, GB_WIDTH * 2);
+        }
+    }
+
+    g_gbFrameHash = hash;
+    g_gbFrameHashValid = true;
+    return same;
+}
+
+// --- System hooks, forwarded by the GBA bridge while a GB game runs ---
+
+bool gbBridgeRunning() {
+    return g_gbEmulating;
+}
+
+void gbBridgeDrawScreen() {
+    if (!g_pix) return;
+
+    const bool unchanged = gbFrameUnchanged();
+    if (g_gbVideoCallback) {
+        g_gbVideoCallback(visibleFrame(), GB_WIDTH, GB_HEIGHT, GB_PITCH, unchanged);
+    }
+}
+
+uint32_t gbBridgeReadJoypad() {
+    return g_gbFrameInput;
+}
+
+// --- Bridge functions ---
+
+void GB_Initialize(GBVideoCallback videoCallback, GBAudioCallback audioCallback) {
+    g_gbVideoCallback = videoCallback;
+    g_audioCallback = audioCallback;
+
+    // RGB565 straight out of the line renderer: green keeps its 5 bits, the sixth stays 0
+    systemColorDepth = 16;
+    systemRedShift = 11;
+    systemGreenShift = 6;
+    systemBlueShift = 0;
+    RGB_LOW_BITS_MASK = 0x0821;
+    updateColorMapping(false);
+
+    coreOptions.skipBios = true;
+    coreOptions.useBios = 0;
+
+    soundInit();
+    gbSoundSetSampleRate(AUDIO_SAMPLE_RATE);
+    soundSetVolume(0.8f);
+    soundSetEnable(0x3ff);
+}
+
+static void queueBatterySave(const char* path) {
+    systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
+    if (gbWriteBatteryData(g_gbBatteryData)) {
+        batteryWriterQueue(path, g_gbBatteryData.data(), g_gbBatteryData.size());
+    }
+}
+
+static void saveChangedBattery() {
+    if (g_gbEmulating && !g_gbBatteryPath.empty() && systemSaveUpdateCounter != SYSTEM_SAVE_NOT_UPDATED) {
+        queueBatterySave(g_gbBatteryPath.c_str());
+    }
+}
+
+static bool loadGame(const char* path, const char* patchPath) {
+    if (!path) return false;
+
+    saveChangedBattery();
+    g_gbEmulating = false;
+    emulating = 0;
+    if (!gbLoadRom(path)) {
+        printf("GB_LoadGame: failed to load %s\n", path);
+        return false;
+    }
+    // gbApplyPatch re-runs the header checks on the patched image
+    if (patchPath && !gbApplyPatch(patchPath)) {
+        printf("GB_LoadPatchedGame: failed to apply %s\n", patchPath);
+        return false;
+    }
+
+    GBSystem.emuReset();
+
+    g_gbFrameHashValid = false;
+    g_gbEmulating = true;
+    // gbEmulate and the sound driver both idle while this is clear
+    emulating = 1;
+    return true;
+}
+
+bool GB_LoadGame(const char* path) {
+    return loadGame(path, nullptr);
+}
+
+bool GB_LoadPatchedGame(const char* path, const char* patchPath) {
+    return patchPath && loadGame(path, patchPath);
+}
+
+void GB_Shutdown(void) {
+    saveChangedBattery();
+    batteryWriterFlush();
+    g_gbEmulating = false;
+    emulating = 0;
+}
+
+void GB_Cleanup(void) {
+    g_gbEmulating = false;
+    emulating = 0;
+    GBSystem.emuCleanUp();
+    soundShutdown();
+}
+
+void GB_RunFrame(void) {
+    if (!g_gbEmulating) return;
+
+    g_gbFrameInput = g_gbInputState;
+    GBSystem.emuMain(GB_FRAME_TICK_BUDGET);
+
+    if (++g_gbBatteryFrames == GB_BATTERY_CHECK_FRAMES) {
+        g_gbBatteryFrames = 0;
+        saveChangedBattery();
+    }
+}
+
+double GB_GetFrameTime(void) {
+    return GB_FRAME_TIME;
+}
+
+bool GB_IsColor(void) {
+    return g_gbEmulating && gbCgbMode;
+}
+
+void GB_ActivateInput(int button) {
+    g_gbInputState |= button;
+}
+
+void GB_DeactivateInput(int button) {
+    g_gbInputState &= ~button;
+}
+
+void GB_ResetInputs(void) {
+    g_gbInputState = 0;
+}
+
+void GB_SetAudioBuffer(uint8_t* buffer) {
+    g_audioBuffer = buffer;
+}
+
+bool GB_AddCheatCode(const char* cheatCode) {
+    std::istringstream stream(cheatCode);
+    std::string line;
+
+    while (std::getline(stream, line)) {
+        // Remove leading/trailing whitespace
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        if (line.empty()) continue;
+
+        for (char& c : line) {
+            c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+        }
+
+        if (gbVerifyGsCode(line.c_str())) {
+            if (!gbAddGsCheat(line.c_str(), "code")) return false;
+        } else if (gbVerifyGgCode(line.c_str())) {
+            if (!gbAddGgCheat(line.c_str(), "code")) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GB_ResetCheats(void) {
+    gbCheatRemoveAll();
+}
+
+// Save/ Load Game States
+
+void GB_SaveState(const char* path) {
+    GBSystem.emuWriteState(path);
+}
+
+void GB_LoadState(const char* path) {
+    GBSystem.emuReadState(path);
+}
+
+void GB_SaveGameSave(const char* path) {
+    // Through the battery writer too, so the file is replaced atomically
+    queueBatterySave(path);
+    batteryWriterFlush();
+}
+
+void GB_LoadGameSave(const char* path) {
+    batteryWriterFlush();
+    GBSystem.emuReadBattery(path);
+}
+
+void GB_SetBatterySavePath(const char* path) {
+    saveChangedBattery();
+    g_gbBatteryPath = path ? path : "";
+}
@@ -0,0 +1,73 @@
+//
+//  SOOLRA
+//
+//  Copyright © 2025 SOOLRA. All rights reserved.
+//
+
+#ifndef SoolraGBBridge_hpp
+#define SoolraGBBridge_hpp
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Game Boy and Game Boy Color on VBA-M's gb core. It shares that core with the GBA
+// bridge, so only one of the two can have a game loaded: call GBACleanup before
+// GB_Initialize, and GB_Cleanup before going back to the GBA.
+
+enum GBVideoConstants {
+    GB_WIDTH = 160,
+    GB_HEIGHT = 144
+};
+
+// RGB565 pixels straight from the core's line renderer, pitch pixels apart. The
+// buffer belongs to the core and stays valid until the next GB_RunFrame.
+// unchanged is set when the frame is identical to the previous one.
+typedef void (*GBVideoCallback)(const uint16_t* pixels, int32_t width, int32_t height,
+                                int32_t pitch, bool unchanged);
+// Same format as the GBA bridge: size is in bytes, size / 8 left float samples
+// followed by as many right ones, written to the buffer set with GB_SetAudioBuffer.
+typedef void (*GBAudioCallback)(const uint8_t* buffer, int32_t size);
+
+// Initialization and cleanup
+void GB_Initialize(GBVideoCallback videoCallback, GBAudioCallback audioCallback);
+// .gb, .gbc, .sgb and .dmg files, also inside zip/7z archives
+bool GB_LoadGame(const char* path);
+// Loads path with an IPS, UPS, BPS or PPF patch applied in memory; the file is untouched
+bool GB_LoadPatchedGame(const char* path, const char* patchPath);
+void GB_Shutdown(void);
+void GB_Cleanup(void);
+
+// Frame execution and timing
+void GB_RunFrame(void);
+double GB_GetFrameTime(void);
+bool GB_IsColor(void);
+
+// Input handling, same bits as the GBA buttons (A, B, Select, Start, Right, Left, Up, Down)
+void GB_ActivateInput(int button);
+void GB_DeactivateInput(int button);
+void GB_ResetInputs(void);
+
+// Buffer management
+void GB_SetAudioBuffer(uint8_t* buffer);
+
+// Cheats: GameShark (01xxxxxx) or Game Genie (xxx-xxx or xxx-xxx-xxx), one per line
+bool GB_AddCheatCode(const char* cheatCode);
+void GB_ResetCheats(void);
+
+// Save and Load game states
+void GB_SaveState(const char* path);
+void GB_LoadState(const char* path);
+void GB_SaveGameSave(const char* path);
+void GB_LoadGameSave(const char* path);
+// Battery RAM is written to this path in the background a moment after the game changes it
+void GB_SetBatterySavePath(const char* path);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* SoolraGBBridge_hpp */
@@ -82,6 +82,37 @@ void SoolraSoundDriver::write(uint16_t* finalWave, int length) {
     }
 }
 
+void SoolraSoundDriver::write_float(const float* left, const float* right, int count) {
+    // Not gated on init(): the core only flushes samples while a game is running,
+    // and this is the only path the bridge's audio takes.
+    if (count <= 0) {
+        return;
+    }
+    
+    digestAudioSamples(left, right, count);
+    
+    if (!g_audioBuffer || isPaused) {
+        return;
+    }
+    
+    const int maxCount = AUDIO_BUFFER_SIZE / static_cast<int>(AUDIO_CHANNELS * sizeof(float));
+    if (count > maxCount) {
+        printf("SoolraSoundDriver: Warning - truncating audio data %d -> %d frames\n",
+               count, maxCount);
+        count = maxCount;
+    }
+    
+    // Planar layout: all left samples, then all right samples
+    float* planes = reinterpret_cast<float*>(g_audioBuffer);
+    memcpy(planes, left, count * sizeof(float));
+    memcpy(planes + count, right, count * sizeof(float));
+    
+    // Forward to Swift through callback
+    if (g_audioCallback) {
+        g_audioCallback(g_audioBuffer, count * AUDIO_CHANNELS * sizeof(float));
+    }
+}
+
 void SoolraSoundDriver::setThrottle(unsigned short throttle) {
     // Throttle is not implemented for GBA
 } 
@@ -27,6 +27,8 @@ public:
     void reset() override;
     void resume() override;
     void write(uint16_t* finalWave, int length) override;
+    bool float_output() const override { return true; }
+    void write_float(const float* left, const float* right, int count) override;
     void setThrottle(unsigned short throttle) override;
     
 private:
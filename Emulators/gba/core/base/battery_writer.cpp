@@ -0,0 +1,161 @@
+#include "core/base/battery_writer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/base/file_util.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Quiet time after the last snapshot before a file is written
+constexpr auto kSettleTime = std::chrono::milliseconds(1000);
+// Longest a change waits while the game keeps writing
+constexpr auto kMaxDelay = std::chrono::milliseconds(5000);
+
+struct PendingSave {
+    std::vector<uint8_t> data;
+    Clock::time_point firstQueued;
+    Clock::time_point lastQueued;
+};
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    const std::string temp = path + ".tmp";
+    FILE* file = utilOpenFile(temp.c_str(), "wb");
+    if (file == NULL)
+        return false;
+
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+class BatteryWriter {
+public:
+    BatteryWriter() : thread_(&BatteryWriter::run, this) {}
+
+    ~BatteryWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void queue(const char* path, const void* data, size_t size) {
+        const Clock::time_point now = Clock::now();
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(path);
+        if (it == pending_.end()) {
+            it = pending_.emplace(path, PendingSave()).first;
+            it->second.firstQueued = now;
+        }
+        it->second.data.assign(bytes, bytes + size);
+        it->second.lastQueued = now;
+        wake_.notify_one();
+    }
+
+    bool flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        flushing_++;
+        wake_.notify_one();
+        idle_.wait(lock, [this] { return pending_.empty() && writing_ == 0; });
+        flushing_--;
+
+        const bool ok = !failed_;
+        failed_ = false;
+        return ok;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            const Clock::time_point now = Clock::now();
+            Clock::time_point next = Clock::time_point::max();
+            auto due = pending_.end();
+
+            for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+                Clock::time_point when = std::min(it->second.lastQueued + kSettleTime,
+                                                  it->second.firstQueued + kMaxDelay);
+                if (flushing_ || quit_ || when <= now) {
+                    due = it;
+                    break;
+                }
+                next = std::min(next, when);
+            }
+
+            if (due != pending_.end()) {
+                const std::string path = due->first;
+                const std::vector<uint8_t> data = std::move(due->second.data);
+                pending_.erase(due);
+                writing_++;
+
+                lock.unlock();
+                const bool ok = writeFile(path, data);
+                lock.lock();
+
+                writing_--;
+                if (!ok)
+                    failed_ = true;
+                if (pending_.empty() && writing_ == 0)
+                    idle_.notify_all();
+                continue;
+            }
+
+            if (quit_)
+                return;
+            if (next == Clock::time_point::max())
+                wake_.wait(lock);
+            else
+                wake_.wait_until(lock, next);
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::map<std::string, PendingSave> pending_;
+    int writing_ = 0;
+    int flushing_ = 0;
+    bool failed_ = false;
+    bool quit_ = false;
+    std::thread thread_;
+};
+
+// Started with the first save, and drained of pending saves at exit
+BatteryWriter& writer() {
+    static BatteryWriter instance;
+    return instance;
+}
+
+}  // namespace
+
+void batteryWriterQueue(const char* path, const void* data, size_t size) {
+    writer().queue(path, data, size);
+}
+
+bool batteryWriterFlush() {
+    return writer().flush();
+}
@@ -0,0 +1,19 @@
+#ifndef VBAM_CORE_BASE_BATTERY_WRITER_H_
+#define VBAM_CORE_BASE_BATTERY_WRITER_H_
+
+#include <cstddef>
+
+// Battery saves written from a background thread, shared by the NES, GBA and GB
+// bridges. Snapshots queued for the same file replace each other, and a file is
+// written once its game has left save RAM alone for a moment, or a few seconds after
+// the first unwritten change if it never does. Files are replaced through a temporary
+// file and a rename, so a crash mid-write leaves the previous save in place.
+
+// Copies size bytes of save RAM to be written to path
+void batteryWriterQueue(const char* path, const void* data, size_t size);
+
+// Writes every queued save now and waits for them. Returns false if any write
+// since the last flush failed.
+bool batteryWriterFlush();
+
+#endif  // VBAM_CORE_BASE_BATTERY_WRITER_H_
@@ -41,6 +41,15 @@ void utilReadDataMem(const uint8_t *&data, variable_desc *);
 
 // strip .gz or .z off end
 void utilStripDoubleExtension(const char *, char *);
+// true for zip, 7z, rar and gzip files as opposed to bare images
+bool utilIsArchive(const char *);
+// true when utilLoad would take the archive member called name, by accept()
+bool utilIsArchiveMember(const char *name, bool (*accept)(const char *));
+
+// Format of the save states utilGzOpen and utilMemGzOpen write. States in either
+// format read back whichever is selected, the stream header tells them apart.
+enum StateCodec { STATE_CODEC_ZLIB, STATE_CODEC_LZ };
+void utilSetStateCodec(StateCodec codec);
 
 gzFile utilAutoGzOpen(const char *file, const char *mode);
 gzFile utilGzOpen(const char *file, const char *mode);
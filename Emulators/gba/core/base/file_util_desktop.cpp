@@ -8,6 +8,7 @@
 #include <cstring>
 
 #include "core/base/internal/file_util_internal.h"
+#include "core/base/internal/lzio.h"
 #include "core/base/internal/memgzio.h"
 #include "core/base/message.h"
 #include "core/fex/fex.h"
@@ -48,12 +49,10 @@ fex_t* scanArchive(const char* file, bool (*accept)(const char*), char (&buffer)
     // Scan filenames
     bool found = false;
     while (!fex_done(fe)) {
-        strncpy(buffer, fex_name(fe), sizeof buffer);
-        buffer[sizeof buffer - 1] = '\0';
-
-        utilStripDoubleExtension(buffer, buffer);
-
-        if (accept(buffer)) {
+        if (utilIsArchiveMember(fex_name(fe), accept)) {
+            strncpy(buffer, fex_name(fe), sizeof buffer);
+            buffer[sizeof buffer - 1] = '\0';
+            utilStripDoubleExtension(buffer, buffer);
             found = true;
             break;
         }
@@ -100,6 +99,18 @@ int(ZEXPORT* utilGzWriteFunc)(gzFile, const voidp, unsigned int) = nullptr;
 int(ZEXPORT* utilGzReadFunc)(gzFile, voidp, unsigned int) = nullptr;
 int(ZEXPORT* utilGzCloseFunc)(gzFile) = nullptr;
 z_off_t(ZEXPORT* utilGzSeekFunc)(gzFile, z_off_t, int) = nullptr;
+long(ZEXPORT* utilGzTellFunc)(gzFile) = nullptr;
+
+// Deflate costs milliseconds per GBA state, the LZ codec a fraction of one
+StateCodec utilStateCodec = STATE_CODEC_LZ;
+
+void utilUseLzFuncs() {
+    utilGzWriteFunc = lzwrite;
+    utilGzReadFunc = lzread;
+    utilGzCloseFunc = lzclose;
+    utilGzSeekFunc = lzseek;
+    utilGzTellFunc = lztell;
+}
 
 }  // namespace
 
@@ -148,6 +159,22 @@ uint8_t* utilLoad(const char* file, bool (*accept)(const char*), uint8_t* data,
     return image;
 }
 
+bool utilIsArchive(const char* file) {
+    fex_type_t type;
+    if (fex_identify_file(&type, file) || !type)
+        return false;
+    // The binary type, which fex falls back to for any other file, has no extension
+    return *fex_type_extension(type) != '\0';
+}
+
+bool utilIsArchiveMember(const char* name, bool (*accept)(const char*)) {
+    char buffer[2048];
+    strncpy(buffer, name, sizeof buffer);
+    buffer[sizeof buffer - 1] = '\0';
+    utilStripDoubleExtension(buffer, buffer);
+    return accept(buffer);
+}
+
 IMAGE_TYPE utilFindType(const char* file) {
     char buffer[2048];
     return utilFindType(file, buffer);
@@ -182,20 +209,50 @@ gzFile utilAutoGzOpen(const char* file, const char* mode) {
 #endif  // defined(_WIN32)
 }
 
+void utilSetStateCodec(StateCodec codec) {
+    utilStateCodec = codec;
+}
+
 gzFile utilGzOpen(const char* file, const char* mode) {
+    if (mode[0] == 'w' && utilStateCodec == STATE_CODEC_LZ) {
+        utilUseLzFuncs();
+        return lzfopen(utilOpenFile(file, "wb"), mode);
+    }
+    if (mode[0] == 'r') {
+        FILE* f = utilOpenFile(file, "rb");
+        if (f != nullptr) {
+            char header[sizeof(kLzStateMagic)];
+            if (fread(header, 1, sizeof(header), f) == sizeof(header) &&
+                lzIsStateHeader(header, sizeof(header))) {
+                rewind(f);
+                utilUseLzFuncs();
+                return lzfopen(f, mode);
+            }
+            fclose(f);
+        }
+    }
+
     utilGzWriteFunc = (int(ZEXPORT*)(gzFile, void* const, unsigned int))gzwrite;
     utilGzReadFunc = gzread;
     utilGzCloseFunc = gzclose;
     utilGzSeekFunc = gzseek;
+    utilGzTellFunc = nullptr;
 
     return utilAutoGzOpen(file, mode);
 }
 
 gzFile utilMemGzOpen(char* memory, int available, const char* mode) {
+    if (mode[0] == 'w' ? utilStateCodec == STATE_CODEC_LZ
+                       : lzIsStateHeader(memory, available > 0 ? (size_t)available : 0)) {
+        utilUseLzFuncs();
+        return lzmemopen(memory, available, mode);
+    }
+
     utilGzWriteFunc = memgzwrite;
     utilGzReadFunc = memgzread;
     utilGzCloseFunc = memgzclose;
     utilGzSeekFunc = memgzseek;
+    utilGzTellFunc = memtell;
 
     return memgzopen(memory, available, mode);
 }
@@ -217,7 +274,7 @@ z_off_t utilGzSeek(gzFile file, z_off_t offset, int whence) {
 }
 
 long utilGzMemTell(gzFile file) {
-    return memtell(file);
+    return utilGzTellFunc(file);
 }
 
 void utilWriteData(gzFile gzFile, variable_desc* data) {
@@ -0,0 +1,253 @@
+#include "core/base/internal/lzio.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "common/lz.h"
+
+namespace {
+
+// Matches reach back 64KB at most, so larger blocks would barely pack better
+constexpr size_t kBlockSize = 0x10000;
+constexpr size_t kBlockHeaderSize = 8;
+
+struct LzStream {
+    bool writing = false;
+    bool error = false;
+
+    // File streams
+    FILE* file = nullptr;
+
+    // Memory streams. offset keeps counting past available when writing, so
+    // lztell reports the size the state needs.
+    char* memory = nullptr;
+    size_t available = 0;
+    size_t offset = 0;
+
+    // State bytes waiting to be packed (writing) or unpacked from the current
+    // block (reading)
+    std::vector<uint8_t> block;
+    size_t blockPos = 0;
+    std::vector<uint8_t> packed;
+    z_off_t position = 0;
+};
+
+void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool putBytes(LzStream* s, const void* data, size_t size) {
+    if (s->file)
+        return fwrite(data, 1, size, s->file) == size;
+
+    if (s->offset + size <= s->available)
+        memcpy(s->memory + s->offset, data, size);
+    s->offset += size;
+    return s->offset <= s->available;
+}
+
+bool getBytes(LzStream* s, void* data, size_t size) {
+    if (s->file)
+        return fread(data, 1, size, s->file) == size;
+
+    if (size > s->available - s->offset)
+        return false;
+    memcpy(data, s->memory + s->offset, size);
+    s->offset += size;
+    return true;
+}
+
+bool writeBlock(LzStream* s, const uint8_t* data, size_t size) {
+    s->packed.resize(kBlockHeaderSize + lzCompressBound(size));
+    uint8_t* payload = &s->packed[kBlockHeaderSize];
+    size_t packedSize = lzCompress(data, size, payload, s->packed.size() - kBlockHeaderSize);
+    if (packedSize == 0 || packedSize >= size) {
+        packedSize = size;
+        memcpy(payload, data, size);
+    }
+    put32(&s->packed[0], (uint32_t)size);
+    put32(&s->packed[4], (uint32_t)packedSize);
+
+    return putBytes(s, s->packed.data(), kBlockHeaderSize + packedSize);
+}
+
+bool flushBlock(LzStream* s) {
+    if (s->block.empty())
+        return true;
+
+    bool ok = writeBlock(s, s->block.data(), s->block.size());
+    s->block.clear();
+    return ok;
+}
+
+bool loadBlock(LzStream* s) {
+    uint8_t header[kBlockHeaderSize];
+    if (!getBytes(s, header, sizeof(header)))
+        return false;
+
+    const uint32_t size = get32(&header[0]);
+    const uint32_t packedSize = get32(&header[4]);
+    if (size == 0 || size > kBlockSize || packedSize > size)
+        return false;
+
+    s->block.resize(size);
+    s->blockPos = 0;
+    if (packedSize == size)
+        return getBytes(s, s->block.data(), size);
+
+    s->packed.resize(packedSize);
+    return getBytes(s, s->packed.data(), packedSize) &&
+           lzDecompress(s->packed.data(), packedSize, s->block.data(), size);
+}
+
+gzFile openStream(LzStream* s, const char* mode) {
+    s->writing = mode[0] == 'w';
+    if (s->writing) {
+        s->block.reserve(kBlockSize);
+        s->error = !putBytes(s, kLzStateMagic, sizeof(kLzStateMagic));
+    } else {
+        char magic[sizeof(kLzStateMagic)];
+        if (!getBytes(s, magic, sizeof(magic)) || !lzIsStateHeader(magic, sizeof(magic))) {
+            if (s->file)
+                fclose(s->file);
+            delete s;
+            return NULL;
+        }
+    }
+    return (gzFile)s;
+}
+
+}  // namespace
+
+bool lzIsStateHeader(const void* header, size_t size) {
+    return size >= sizeof(kLzStateMagic) && memcmp(header, kLzStateMagic, sizeof(kLzStateMagic)) == 0;
+}
+
+gzFile lzfopen(FILE* file, const char* mode) {
+    if (file == NULL)
+        return NULL;
+
+    LzStream* s = new LzStream;
+    s->file = file;
+    return openStream(s, mode);
+}
+
+gzFile lzmemopen(char* memory, int available, const char* mode) {
+    if (memory == NULL || available < 0)
+        return NULL;
+
+    LzStream* s = new LzStream;
+    s->memory = memory;
+    s->available = (size_t)available;
+    return openStream(s, mode);
+}
+
+int ZEXPORT lzread(gzFile file, voidp buf, unsigned len) {
+    LzStream* s = (LzStream*)file;
+    if (s == NULL || s->writing)
+        return -1;
+
+    uint8_t* out = (uint8_t*)buf;
+    unsigned done = 0;
+    while (done < len) {
+        if (s->blockPos == s->block.size() && (s->error || !loadBlock(s))) {
+            s->error = true;
+            break;
+        }
+
+        size_t n = s->block.size() - s->blockPos;
+        if (n > len - done)
+            n = len - done;
+        memcpy(out + done, &s->block[s->blockPos], n);
+        s->blockPos += n;
+        done += (unsigned)n;
+    }
+
+    s->position += done;
+    return (int)done;
+}
+
+int ZEXPORT lzwrite(gzFile file, const voidp buf, unsigned len) {
+    LzStream* s = (LzStream*)file;
+    if (s == NULL || !s->writing)
+        return 0;
+
+    const uint8_t* in = (const uint8_t*)buf;
+    unsigned done = 0;
+    while (done < len) {
+        // Whole blocks of a large write are packed straight from the caller's buffer
+        if (s->block.empty() && len - done >= kBlockSize) {
+            if (!writeBlock(s, in + done, kBlockSize))
+                s->error = true;
+            done += (unsigned)kBlockSize;
+            continue;
+        }
+
+        size_t n = kBlockSize - s->block.size();
+        if (n > len - done)
+            n = len - done;
+        s->block.insert(s->block.end(), in + done, in + done + n);
+        done += (unsigned)n;
+
+        if (s->block.size() == kBlockSize && !flushBlock(s))
+            s->error = true;
+    }
+
+    s->position += len;
+    return s->error ? 0 : (int)len;
+}
+
+int ZEXPORT lzclose(gzFile file) {
+    LzStream* s = (LzStream*)file;
+    if (s == NULL)
+        return Z_STREAM_ERROR;
+
+    bool ok = !s->error;
+    if (s->writing && !flushBlock(s))
+        ok = false;
+    if (s->file && fclose(s->file) != 0)
+        ok = false;
+
+    delete s;
+    return ok ? Z_OK : Z_ERRNO;
+}
+
+long ZEXPORT lztell(gzFile file) {
+    LzStream* s = (LzStream*)file;
+    if (s == NULL)
+        return Z_STREAM_ERROR;
+
+    if (s->writing && !flushBlock(s))
+        s->error = true;
+    return s->file ? ftell(s->file) : (long)s->offset;
+}
+
+z_off_t ZEXPORT lzseek(gzFile file, z_off_t off, int whence) {
+    LzStream* s = (LzStream*)file;
+    if (s == NULL || s->writing)
+        return -1;
+
+    if (whence == SEEK_SET)
+        off -= s->position;
+    else if (whence != SEEK_CUR)
+        return -1;
+    if (off < 0)
+        return -1;
+
+    uint8_t skip[256];
+    while (off > 0) {
+        const unsigned n = off > (z_off_t)sizeof(skip) ? (unsigned)sizeof(skip) : (unsigned)off;
+        if (lzread(file, skip, n) != (int)n)
+            return -1;
+        off -= n;
+    }
+    return s->position;
+}
@@ -0,0 +1,33 @@
+#ifndef VBAM_CORE_BASE_INTERNAL_LZIO_H_
+#define VBAM_CORE_BASE_INTERNAL_LZIO_H_
+
+/* lzio - IO on save state streams packed with the LZ codec in common/lz.h.
+ * Same gzFile interface as memgzio, so utilGzOpen and utilMemGzOpen can hand out
+ * either kind of stream.
+ *
+ * A stream starts with kLzStateMagic, followed by blocks of up to 64KB of state:
+ * u32 size, u32 packed size (little endian), then the packed bytes. A block that
+ * does not shrink is stored as it is, with packed size == size.
+ */
+
+#include <cstddef>
+#include <cstdio>
+
+#include <zlib.h>
+
+static constexpr char kLzStateMagic[4] = {'V', 'B', 'L', 'Z'};
+
+bool lzIsStateHeader(const void* header, size_t size);
+
+// Takes ownership of file, which is closed by lzclose
+gzFile lzfopen(FILE* file, const char* mode);
+gzFile lzmemopen(char* memory, int available, const char* mode);
+int ZEXPORT lzread(gzFile file, voidp buf, unsigned len);
+int ZEXPORT lzwrite(gzFile file, const voidp buf, unsigned len);
+int ZEXPORT lzclose(gzFile file);
+// Bytes written so far, pending state included; as memtell, meant for memory streams
+long ZEXPORT lztell(gzFile file);
+// Forward seeks only, as with memgzio
+z_off_t ZEXPORT lzseek(gzFile file, z_off_t off, int whence);
+
+#endif  // VBAM_CORE_BASE_INTERNAL_LZIO_H_
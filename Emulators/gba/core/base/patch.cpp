@@ -4,284 +4,331 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <future>
+#include <vector>
+
 #if !defined(__LIBRETRO__)
 #include <zlib.h>
 #include <zconf.h>
 #endif
 
-
-#if defined(__FreeBSD__) || defined(__NetBSD__)
-#include <sys/param.h>
-#define fopen64     fopen
-#define fseeko64    fseeko
-#define fseek64     fseek
-#define ftell64     ftell
-#define ftello64    ftello
-#endif
-
 #ifndef __LIBRETRO__
 
-#ifdef __linux__
-#ifndef _GNU_SOURCE
-#define _GNU_SOURCE
-#endif
-#include <features.h>
-#ifndef __USE_GNU
-#define __MUSL__
-#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #include "core/base/file_util.h"
 
-#ifdef __GNUC__
-#if defined(__MUSL__) || defined(__APPLE__) || defined(BSD) || defined(__NetBSD__)
-typedef off_t __off64_t; /* off_t is 64 bits on BSD. */
-#define fseeko64 fseeko
-#define ftello64 ftello
-#else
-typedef off64_t __off64_t;
-#endif /* __APPLE__ || BSD */
-#endif /* __GNUC__ */
-
 #ifndef _MSC_VER
 #define _stricmp strcasecmp
 #endif // ! _MSC_VER
 
-#ifdef _MSC_VER
-#define fseeko64 _fseeki64
-#define ftello64 _ftelli64
-typedef __int64 __off64_t;
+namespace {
+
+// The bytes of a patch file. Mapped read only where the platform allows it, so a large
+// patch costs no more than the pages the decoder touches; read in one go otherwise.
+class PatchFile {
+public:
+    explicit PatchFile(const char* name)
+    {
+#ifndef _WIN32
+        int fd = open(name, O_RDONLY);
+        if (fd >= 0) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map != MAP_FAILED) {
+                    map_ = map;
+                    data_ = (const uint8_t*)map;
+                    size_ = (size_t)st.st_size;
+                }
+            }
+            close(fd);
+            if (map_)
+                return;
+        }
 #endif
+        FILE* f = utilOpenFile(name, "rb");
+        if (!f)
+            return;
+        uint8_t chunk[4096];
+        size_t readed;
+        while ((readed = fread(chunk, 1, sizeof(chunk), f)) > 0)
+            buffer_.insert(buffer_.end(), chunk, chunk + readed);
+        fclose(f);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
 
-static int readInt2(FILE* f)
-{
-    int res = 0;
-    int c = fgetc(f);
-    if (c == EOF)
-        return -1;
-    res = c;
-    c = fgetc(f);
-    if (c == EOF)
-        return -1;
-    return c + (res << 8);
-}
+    ~PatchFile()
+    {
+#ifndef _WIN32
+        if (map_)
+            munmap(map_, size_);
+#endif
+    }
 
-static int readInt3(FILE* f)
-{
-    int res = 0;
-    int c = fgetc(f);
-    if (c == EOF)
-        return -1;
-    res = c;
-    c = fgetc(f);
-    if (c == EOF)
-        return -1;
-    res = c + (res << 8);
-    c = fgetc(f);
-    if (c == EOF)
-        return -1;
-    return c + (res << 8);
-}
+    PatchFile(const PatchFile&) = delete;
+    PatchFile& operator=(const PatchFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void* map_ = nullptr;
+    std::vector<uint8_t> buffer_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Reads the patch formats' fields out of the patch bytes. Like the stdio readers these
+// replace, the readInt* functions return -1 once the data runs out.
+class PatchReader {
+public:
+    PatchReader(const uint8_t* data, size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
 
-static int64_t readInt4(FILE* f)
-{
-    int64_t tmp, res = 0;
-    int c;
+    size_t size() const { return size_; }
+    size_t tell() const { return pos_; }
+    void seek(size_t pos) { pos_ = pos < size_ ? pos : size_; }
+    void skip(size_t len) { seek(pos_ + len); }
 
-    for (int i = 0; i < 4; i++) {
-        c = fgetc(f);
-        if (c == EOF)
-            return -1;
-        tmp = c;
-        res = res + (tmp << (i * 8));
+    int readByte()
+    {
+        return pos_ < size_ ? data_[pos_++] : -1;
     }
 
-    return res;
-}
+    // Points at the next len bytes and moves past them, or returns NULL if there are fewer
+    const uint8_t* readBlock(size_t len)
+    {
+        if (len > size_ - pos_)
+            return NULL;
+        const uint8_t* block = data_ + pos_;
+        pos_ += len;
+        return block;
+    }
 
-static int64_t readInt8(FILE* f)
-{
-    int64_t tmp, res = 0;
-    int c;
+    bool startsWith(const char* magic) const
+    {
+        size_t len = strlen(magic);
+        return size_ >= len && memcmp(data_, magic, len) == 0;
+    }
 
-    for (int i = 0; i < 8; i++) {
-        c = fgetc(f);
-        if (c == EOF)
+    int readInt2()
+    {
+        if (size_ - pos_ < 2)
             return -1;
-        tmp = c;
-        res = res + (tmp << (i * 8));
+        int res = (data_[pos_] << 8) | data_[pos_ + 1];
+        pos_ += 2;
+        return res;
     }
 
-    return res;
-}
+    int readInt3()
+    {
+        if (size_ - pos_ < 3)
+            return -1;
+        int res = (data_[pos_] << 16) | (data_[pos_ + 1] << 8) | data_[pos_ + 2];
+        pos_ += 3;
+        return res;
+    }
 
-static int64_t readVarPtr(FILE* f)
-{
-    int64_t offset = 0, shift = 1;
-    for (;;) {
-        int c = fgetc(f);
-        if (c == EOF)
-            return 0;
-        offset += (c & 0x7F) * shift;
-        if (c & 0x80)
-            break;
-        shift <<= 7;
-        offset += shift;
+    int64_t readInt4()
+    {
+        return readLittleEndian(4);
     }
-    return offset;
-}
 
-static uint32_t readSignVarPtr(FILE* f)
-{
-    int64_t offset = readVarPtr(f);
-    bool sign =  offset & 1;
+    int64_t readInt8()
+    {
+        return readLittleEndian(8);
+    }
 
-    offset = offset >> 1;
-    if (sign) {
-        offset = -offset;
+    int64_t readVarPtr()
+    {
+        int64_t offset = 0, shift = 1;
+        while (pos_ < size_) {
+            uint8_t c = data_[pos_++];
+            offset += (c & 0x7F) * shift;
+            if (c & 0x80)
+                return offset;
+            // Eight bytes already hold 56 bits; a longer number is corrupt
+            if (shift > ((int64_t)1 << 42))
+                return 0;
+            shift <<= 7;
+            offset += shift;
+        }
+        return 0;
     }
-    return (uint32_t)(offset);
-}
 
-#ifndef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
-#endif
+    uint32_t readSignVarPtr()
+    {
+        int64_t offset = readVarPtr();
+        bool sign = offset & 1;
 
-static uLong computePatchCRC(FILE* f, unsigned int size)
-{
-    Bytef buf[4096];
-    long readed;
+        offset = offset >> 1;
+        if (sign) {
+            offset = -offset;
+        }
+        return (uint32_t)(offset);
+    }
+
+private:
+    int64_t readLittleEndian(int bytes)
+    {
+        if (size_ - pos_ < (size_t)bytes)
+            return -1;
+        int64_t res = 0;
+        for (int i = 0; i < bytes; i++)
+            res += (int64_t)data_[pos_ + i] << (i * 8);
+        pos_ += bytes;
+        return res;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+// Below this much data, a second thread costs more than the CRC it would take over
+const size_t kParallelCrcThreshold = 256 * 1024;
 
+uint32_t computeCRC(const uint8_t* data, size_t size)
+{
     uLong crc = crc32(0L, Z_NULL, 0);
-    do {
-        readed = (long)(fread(buf, 1, MIN(size, sizeof(buf)), f));
-        crc = crc32(crc, buf, readed);
-        size -= readed;
-    } while (readed > 0);
-    return crc;
+    while (size > 0) {
+        uInt chunk = size > 0x40000000 ? 0x40000000 : (uInt)size;
+        crc = crc32(crc, data, chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return (uint32_t)crc;
+}
+
+// The UPS and BPS checks need the CRCs of both the patch body and the ROM before anything
+// else can happen; when there is enough data the two run side by side
+void computePatchAndRomCRC(const uint8_t* patch, size_t patchSize, const uint8_t* rom,
+    size_t romSize, uint32_t* patchCRC, uint32_t* romCRC)
+{
+    if (patchSize + romSize < kParallelCrcThreshold) {
+        *patchCRC = computeCRC(patch, patchSize);
+        *romCRC = computeCRC(rom, romSize);
+        return;
+    }
+
+    std::future<uint32_t> patchJob = std::async(std::launch::async, computeCRC, patch, patchSize);
+    *romCRC = computeCRC(rom, romSize);
+    *patchCRC = patchJob.get();
 }
 
-static bool patchApplyIPS(const char* patchname, uint8_t** r, int* s)
+bool patchApplyIPS(PatchReader& f, uint8_t** r, int* s)
 {
     // from the IPS spec at http://zerosoft.zophar.net/ips.htm
-    FILE* f = utilOpenFile(patchname, "rb");
-    if (!f)
+    if (!f.startsWith("PATCH"))
         return false;
-
-    bool result = false;
+    f.seek(5);
 
     uint8_t* rom = *r;
     int size = *s;
-    if (fgetc(f) == 'P' && fgetc(f) == 'A' && fgetc(f) == 'T' && fgetc(f) == 'C' && fgetc(f) == 'H') {
-        int b;
-        int offset;
-        int len;
 
-        result = true;
-
-        for (;;) {
-            // read offset
-            offset = readInt3(f);
-            // if offset == EOF, end of patch
-            if (offset == 0x454f46 || offset == -1)
+    for (;;) {
+        // read offset
+        int offset = f.readInt3();
+        // if offset == EOF, end of patch
+        if (offset == 0x454f46 || offset == -1)
+            break;
+        // read length
+        int len = f.readInt2();
+        int b;
+        if (len == -1)
+            break;
+        if (!len) {
+            // len == 0, RLE block
+            len = f.readInt2();
+            // byte to fill
+            b = f.readByte();
+            if (len == -1 || b == -1)
                 break;
-            // read length
-            len = readInt2(f);
-            if (!len) {
-                // len == 0, RLE block
-                len = readInt2(f);
-                // byte to fill
-                int c = fgetc(f);
-                if (c == -1)
-                    break;
-                b = (uint8_t)c;
-            } else
-                b = -1;
-            // check if we need to reallocate our ROM
-            if ((offset + len) >= size) {
+        } else
+            b = -1;
+        // check if we need to reallocate our ROM
+        if ((offset + len) >= size) {
+            if (size <= 0)
+                size = 1;
+            while ((offset + len) >= size)
                 size *= 2;
-                rom = (uint8_t*)realloc(rom, size);
-                *r = rom;
-                *s = size;
-            }
-            if (b == -1) {
-                // normal block, just read the data
-                if (fread(&rom[offset], 1, len, f) != (size_t)len)
-                    break;
-            } else {
-                // fill the region with the given byte
-                while (len--) {
-                    rom[offset++] = (uint8_t)(b&0xff);
-                }
-            }
+            rom = (uint8_t*)realloc(rom, size);
+            *r = rom;
+            *s = size;
+        }
+        if (b == -1) {
+            // normal block, just copy the data
+            const uint8_t* data = f.readBlock(len);
+            if (!data)
+                break;
+            memcpy(&rom[offset], data, len);
+        } else {
+            // fill the region with the given byte
+            memset(&rom[offset], b, len);
         }
     }
-    // close the file
-    fclose(f);
 
-    return result;
+    return true;
 }
 
-static bool patchApplyUPS(const char* patchname, uint8_t** rom, int* size)
+// Checks the trailing CRCs shared by UPS and BPS. Returns the CRCs and leaves the reader
+// just after the magic.
+bool patchCheckCRCs(PatchReader& f, uint8_t* rom, int size, int64_t* srcCRC, int64_t* dstCRC, uint32_t* romCRC)
 {
-    int64_t srcCRC, dstCRC, patchCRC;
-
-    FILE* f = utilOpenFile(patchname, "rb");
-    if (!f)
-        return false;
-
-    fseeko64(f, 0, SEEK_END);
-    __off64_t patchSize = ftello64(f);
-    if (patchSize < 20) {
-        fclose(f);
+    if (f.size() < 20)
         return false;
-    }
 
-    fseeko64(f, 0, SEEK_SET);
-    if (fgetc(f) != 'U' || fgetc(f) != 'P' || fgetc(f) != 'S' || fgetc(f) != '1') {
-        fclose(f);
+    f.seek(f.size() - 12);
+    *srcCRC = f.readInt4();
+    *dstCRC = f.readInt4();
+    int64_t patchCRC = f.readInt4();
+    if (*srcCRC == -1 || *dstCRC == -1 || patchCRC == -1)
         return false;
-    }
 
-    fseeko64(f, -12, SEEK_END);
-    srcCRC = readInt4(f);
-    dstCRC = readInt4(f);
-    patchCRC = readInt4(f);
-    if (srcCRC == -1 || dstCRC == -1 || patchCRC == -1) {
-        fclose(f);
+    f.seek(0);
+    const uint8_t* patch = f.readBlock(f.size());
+    uint32_t crc;
+    computePatchAndRomCRC(patch, f.size() - 4, rom, size, &crc, romCRC);
+    if (crc != patchCRC)
         return false;
-    }
 
-    fseeko64(f, 0, SEEK_SET);
-    uint32_t crc = computePatchCRC(f, (unsigned)(patchSize - 4));
+    f.seek(4);
+    return true;
+}
 
-    if (crc != patchCRC) {
-        fclose(f);
+bool patchApplyUPS(PatchReader& f, uint8_t** rom, int* size)
+{
+    if (!f.startsWith("UPS1"))
         return false;
-    }
 
-    crc = crc32(0L, Z_NULL, 0);
-    crc = crc32(crc, *rom, *size);
+    int64_t srcCRC, dstCRC;
+    uint32_t crc;
+    if (!patchCheckCRCs(f, *rom, *size, &srcCRC, &dstCRC, &crc))
+        return false;
 
-    fseeko64(f, 4, SEEK_SET);
     int64_t dataSize;
-    int64_t srcSize = readVarPtr(f);
-    int64_t dstSize = readVarPtr(f);
+    int64_t srcSize = f.readVarPtr();
+    int64_t dstSize = f.readVarPtr();
 
     if (crc == srcCRC) {
-        if (srcSize != *size) {
-            fclose(f);
+        if (srcSize != *size)
             return false;
-        }
         dataSize = dstSize;
     } else if (crc == dstCRC) {
-        if (dstSize != *size) {
-            fclose(f);
+        if (dstSize != *size)
             return false;
-        }
         dataSize = srcSize;
     } else {
-        fclose(f);
         return false;
     }
     if (dataSize > *size) {
@@ -291,152 +338,143 @@ static bool patchApplyUPS(const char* patchname, uint8_t** rom, int* size)
     }
 
     int64_t relative = 0;
-    uint8_t* mem;
-    while (ftello64(f) < patchSize - 12) {
-        relative += readVarPtr(f);
+    const size_t end = f.size() - 12;
+    while (f.tell() < end) {
+        relative += f.readVarPtr();
         if (relative > dataSize)
             continue;
-        mem = *rom + relative;
-        for (int64_t i = relative; i < dataSize; i++) {
-            int x = fgetc(f);
+        // XOR run up to its zero terminator, clipped to the ROM
+        uint8_t* mem = *rom + relative;
+        while (f.tell() < end) {
+            int x = f.readByte();
             relative++;
             if (!x)
                 break;
-            if (i < dataSize) {
+            if (relative <= dataSize)
                 *mem++ ^= x;
-            }
         }
     }
 
-    fclose(f);
     return true;
 }
 
-static bool patchApplyBPS(const char* patchname, uint8_t** rom, int* size)
+bool patchApplyBPS(PatchReader& f, uint8_t** rom, int* size)
 {
-    int64_t srcCRC, dstCRC, patchCRC;
-
-    FILE* f = utilOpenFile(patchname, "rb");
-    if (!f)
+    if (!f.startsWith("BPS1"))
         return false;
 
-    fseeko64(f, 0, SEEK_END);
-    __off64_t patchSize = ftello64(f);
-    if (patchSize < 20) {
-        fclose(f);
+    int64_t srcCRC, dstCRC;
+    uint32_t crc;
+    if (!patchCheckCRCs(f, *rom, *size, &srcCRC, &dstCRC, &crc))
         return false;
-    }
 
-    fseeko64(f, 0, SEEK_SET);
-    if (fgetc(f) != 'B' || fgetc(f) != 'P' || fgetc(f) != 'S' || fgetc(f) != '1') {
-        fclose(f);
-        return false;
-    }
-
-    fseeko64(f, -12, SEEK_END);
-    srcCRC = readInt4(f);
-    dstCRC = readInt4(f);
-    patchCRC = readInt4(f);
-    if (srcCRC == -1 || dstCRC == -1 || patchCRC == -1) {
-        fclose(f);
-        return false;
-    }
-
-    fseeko64(f, 0, SEEK_SET);
-    uint32_t crc = computePatchCRC(f, (unsigned)(patchSize - 4));
-
-    if (crc != patchCRC) {
-        fclose(f);
-        return false;
-    }
-
-    crc = crc32(0L, Z_NULL, 0);
-    crc = crc32(crc, *rom, *size);
-
-    fseeko64(f, 4, SEEK_SET);
     int dataSize;
-    const int64_t srcSize = readVarPtr(f);
-    const int64_t dstSize = readVarPtr(f);
-    const int64_t mtdSize = readVarPtr(f);
-    fseeko64(f, mtdSize, SEEK_CUR);
+    const int64_t srcSize = f.readVarPtr();
+    const int64_t dstSize = f.readVarPtr();
+    const int64_t mtdSize = f.readVarPtr();
+    f.skip(mtdSize);
 
     if (crc == srcCRC) {
-        if (srcSize != *size) {
-            fclose(f);
+        if (srcSize != *size)
             return false;
-        }
         dataSize = (int)(dstSize);
     } else if (crc == dstCRC) {
-        if (dstSize != *size) {
-            fclose(f);
+        if (dstSize != *size)
             return false;
-        }
         dataSize = (int)(srcSize);
     } else {
-        fclose(f);
         return false;
     }
 
+    const uint8_t* source = *rom;
+    const int64_t sourceSize = *size;
     uint8_t* new_rom = (uint8_t*)calloc(1, dataSize);
+    if (!new_rom)
+        return false;
 
     int64_t length = 0;
     uint8_t action = 0;
-    uint32_t outputOffset = 0, sourceRelativeOffset = 0, targetRelativeOffset = 0;
-
-    while (ftello64(f) < patchSize - 12) {
-        length = readVarPtr(f);
-        action = length & 3 ;
-        length = (length>>2) + 1;
-        switch(action){
+    int64_t outputOffset = 0, sourceRelativeOffset = 0, targetRelativeOffset = 0;
+    bool valid = true;
+    const size_t end = f.size() - 12;
+
+    while (valid && f.tell() < end) {
+        length = f.readVarPtr();
+        action = length & 3;
+        length = (length >> 2) + 1;
+        if (outputOffset + length > dataSize) {
+            valid = false;
+            break;
+        }
+        switch (action) {
         case 0: // sourceRead
-            while(length--) {
-                new_rom[outputOffset] = rom[0][outputOffset];
-                outputOffset++;
+            if (outputOffset + length > sourceSize) {
+                valid = false;
+                break;
             }
+            memcpy(new_rom + outputOffset, source + outputOffset, length);
+            outputOffset += length;
             break;
-        case 1: // patchRead
-            while(length--) {
-                new_rom[outputOffset++] = (uint8_t)(fgetc(f) & 0xff);
+        case 1: { // patchRead
+            const uint8_t* data = f.readBlock(length);
+            if (!data) {
+                valid = false;
+                break;
             }
+            memcpy(new_rom + outputOffset, data, length);
+            outputOffset += length;
             break;
+        }
         case 2: // sourceCopy
-            sourceRelativeOffset += readSignVarPtr(f);
-            while(length--) {
-                new_rom[outputOffset++] = rom[0][sourceRelativeOffset++];
+            sourceRelativeOffset += (int32_t)f.readSignVarPtr();
+            if (sourceRelativeOffset < 0 || sourceRelativeOffset + length > sourceSize) {
+                valid = false;
+                break;
             }
+            memcpy(new_rom + outputOffset, source + sourceRelativeOffset, length);
+            outputOffset += length;
+            sourceRelativeOffset += length;
             break;
         case 3: // targetCopy
-            targetRelativeOffset += readSignVarPtr(f);
-            while(length--) { // yes, copy from alredy patched rom, and only 1 byte at time (pseudo-rle)
-                new_rom[outputOffset++] = new_rom[targetRelativeOffset++];
+            targetRelativeOffset += (int32_t)f.readSignVarPtr();
+            if (targetRelativeOffset < 0 || targetRelativeOffset >= outputOffset) {
+                valid = false;
+                break;
+            }
+            if (targetRelativeOffset + length <= outputOffset) {
+                memcpy(new_rom + outputOffset, new_rom + targetRelativeOffset, length);
+                outputOffset += length;
+                targetRelativeOffset += length;
+            } else {
+                // overlaps the output, copied a byte at a time on purpose (pseudo-rle)
+                while (length--)
+                    new_rom[outputOffset++] = new_rom[targetRelativeOffset++];
             }
             break;
         }
     }
 
-    crc = crc32(0L, Z_NULL, 0);
-    crc = crc32(crc, new_rom, dataSize);
-
-    if(crc == dstCRC)
-    {
-        if (dataSize > *size) {
-            *rom = (uint8_t*)realloc(*rom, dataSize);
-        }
-        memcpy(*rom, new_rom, dataSize);
-        *size = dataSize;
+    if (!valid || computeCRC(new_rom, dataSize) != dstCRC) {
         free(new_rom);
+        return false;
+    }
+
+    if (dataSize > *size) {
+        *rom = (uint8_t*)realloc(*rom, dataSize);
     }
+    memcpy(*rom, new_rom, dataSize);
+    *size = dataSize;
+    free(new_rom);
 
-    fclose(f);
     return true;
 }
 
-static int ppfVersion(FILE* f)
+int ppfVersion(PatchReader& f)
 {
-    fseeko64(f, 0, SEEK_SET);
-    if (fgetc(f) != 'P' || fgetc(f) != 'P' || fgetc(f) != 'F') //-V501
+    if (!f.startsWith("PPF") || f.size() < 4)
         return 0;
-    switch (fgetc(f)) {
+    f.seek(3);
+    switch (f.readByte()) {
     case '1':
         return 1;
     case '2':
@@ -448,120 +486,106 @@ static int ppfVersion(FILE* f)
     }
 }
 
-static int ppfFileIdLen(FILE* f, int version)
+int ppfFileIdLen(PatchReader& f, int version)
 {
-    if (version == 2) {
-        fseeko64(f, -8, SEEK_END);
-    } else {
-        fseeko64(f, -6, SEEK_END);
-    }
+    size_t tail = (version == 2) ? 8 : 6;
+    if (f.size() < tail)
+        return 0;
+    f.seek(f.size() - tail);
 
-    if (fgetc(f) != '.' || fgetc(f) != 'D' || fgetc(f) != 'I' || fgetc(f) != 'Z')
+    const uint8_t* diz = f.readBlock(4);
+    if (!diz || memcmp(diz, ".DIZ", 4) != 0)
         return 0;
 
-    return (version == 2) ? int(readInt4(f)) : readInt2(f);
+    return (version == 2) ? int(f.readInt4()) : f.readInt2();
 }
 
-static bool patchApplyPPF1(FILE* f, uint8_t** rom, int* size)
+// PPF records: an offset, a length byte and the data to put there
+bool ppfApplyRecords(PatchReader& f, uint8_t* mem, int size, int count, int offsetBytes, bool undo)
 {
-    fseek(f, 0, SEEK_END);
-    int count = ftell(f);
-    if (count < 56)
-        return false;
-    count -= 56;
-
-    fseek(f, 56, SEEK_SET);
-
-    uint8_t* mem = *rom;
-
     while (count > 0) {
-        int64_t offset_read = readInt4(f);
-        if (offset_read == -1)
+        // A short read returns -1, and an eight-byte offset past 2^63 reads as negative too
+        int64_t offset = (offsetBytes == 8) ? f.readInt8() : f.readInt4();
+        if (offset < 0)
             break;
-        int offset = (int)(offset_read);
-        int len = fgetc(f);
-        if (len == EOF)
+        int len = f.readByte();
+        if (len == -1)
             break;
-        if (offset + len > *size)
+        if (len > size || offset > size - len)
             break;
-        if (fread(&mem[offset], 1, len, f) != (size_t)len)
+        const uint8_t* data = f.readBlock(len);
+        if (!data)
             break;
-        count -= 4 + 1 + len;
+        memcpy(&mem[offset], data, len);
+        if (undo)
+            f.skip(len);
+        count -= offsetBytes + 1 + len;
+        if (undo)
+            count -= len;
     }
 
     return (count == 0);
 }
 
-static bool patchApplyPPF2(FILE* f, uint8_t** rom, int* size)
+bool patchApplyPPF1(PatchReader& f, uint8_t** rom, int* size)
+{
+    if (f.size() < 56)
+        return false;
+    int count = (int)f.size() - 56;
+
+    f.seek(56);
+    return ppfApplyRecords(f, *rom, *size, count, 4, false);
+}
+
+bool patchApplyPPF2(PatchReader& f, uint8_t** rom, int* size)
 {
-    fseek(f, 0, SEEK_END);
-    int count = ftell(f);
-    if (count < 56 + 4 + 1024)
+    if (f.size() < 56 + 4 + 1024)
         return false;
-    count -= 56 + 4 + 1024;
+    int count = (int)f.size() - (56 + 4 + 1024);
 
-    fseek(f, 56, SEEK_SET);
+    f.seek(56);
 
-    int64_t datalen_read = readInt4(f);
+    int64_t datalen_read = f.readInt4();
     if (datalen_read == -1)
         return false;
 
     int datalen = (int)(datalen_read);
-    if (datalen != *size)
+    if (datalen != *size || *size < 0x9320 + 1024)
         return false;
 
     uint8_t* mem = *rom;
 
-    uint8_t block[1024];
-    if (fread(&block, 1, 1024, f) == 0 ||
-            memcmp(&mem[0x9320], &block, 1024) != 0)
+    const uint8_t* block = f.readBlock(1024);
+    if (!block || memcmp(&mem[0x9320], block, 1024) != 0)
         return false;
 
     int idlen = ppfFileIdLen(f, 2);
     if (idlen > 0)
         count -= 16 + 16 + idlen;
 
-    fseek(f, 56 + 4 + 1024, SEEK_SET);
-
-    while (count > 0) {
-        int64_t offset_read = readInt4(f);
-        if (offset_read == -1)
-            break;
-        int offset = (int)(offset_read);
-        int len = fgetc(f);
-        if (len == EOF)
-            break;
-        if (offset + len > *size)
-            break;
-        if (fread(&mem[offset], 1, len, f) != (size_t)len)
-            break;
-        count -= 4 + 1 + len;
-    }
-
-    return (count == 0);
+    f.seek(56 + 4 + 1024);
+    return ppfApplyRecords(f, mem, *size, count, 4, false);
 }
 
-static bool patchApplyPPF3(FILE* f, uint8_t** rom, int* size)
+bool patchApplyPPF3(PatchReader& f, uint8_t** rom, int* size)
 {
-    fseek(f, 0, SEEK_END);
-    int count = ftell(f);
-    if (count < 56 + 4 + 1024)
+    if (f.size() < 56 + 4 + 1024)
         return false;
-    count -= 56 + 4;
+    int count = (int)f.size() - (56 + 4);
 
-    fseek(f, 56, SEEK_SET);
+    f.seek(56);
 
-    int imagetype = fgetc(f);
-    int blockcheck = fgetc(f);
-    int undo = fgetc(f);
-    fgetc(f);
+    int imagetype = f.readByte();
+    int blockcheck = f.readByte();
+    int undo = f.readByte();
+    f.readByte();
 
     uint8_t* mem = *rom;
 
     if (blockcheck) {
-        uint8_t block[1024];
-        if (fread(&block, 1, 1024, f) == 0 ||
-                memcmp(&mem[(imagetype == 0) ? 0x9320 : 0x80A0], &block, 1024) != 0)
+        int blockOffset = (imagetype == 0) ? 0x9320 : 0x80A0;
+        const uint8_t* block = f.readBlock(1024);
+        if (!block || *size < blockOffset + 1024 || memcmp(&mem[blockOffset], block, 1024) != 0)
             return false;
         count -= 1024;
     }
@@ -570,54 +594,25 @@ static bool patchApplyPPF3(FILE* f, uint8_t** rom, int* size)
     if (idlen > 0)
         count -= 16 + 16 + idlen;
 
-    fseek(f, 56 + 4 + (blockcheck ? 1024 : 0), SEEK_SET);
-
-    while (count > 0) {
-        __off64_t offset = readInt8(f);
-        if (offset == -1)
-            break;
-        int len = fgetc(f);
-        if (len == EOF)
-            break;
-        if (offset + len > *size)
-            break;
-        if (fread(&mem[offset], 1, len, f) != (size_t)len)
-            break;
-        if (undo)
-            fseeko64(f, len, SEEK_CUR);
-        count -= 8 + 1 + len;
-        if (undo)
-            count -= len;
-    }
-
-    return (count == 0);
+    f.seek(56 + 4 + (blockcheck ? 1024 : 0));
+    return ppfApplyRecords(f, mem, *size, count, 8, undo != 0);
 }
 
-static bool patchApplyPPF(const char* patchname, uint8_t** rom, int* size)
+bool patchApplyPPF(PatchReader& f, uint8_t** rom, int* size)
 {
-    FILE* f = utilOpenFile(patchname, "rb");
-    if (!f)
-        return false;
-
-    bool res = false;
-
-    int version = ppfVersion(f);
-    switch (version) {
+    switch (ppfVersion(f)) {
     case 1:
-        res = patchApplyPPF1(f, rom, size);
-        break;
+        return patchApplyPPF1(f, rom, size);
     case 2:
-        res = patchApplyPPF2(f, rom, size);
-        break;
+        return patchApplyPPF2(f, rom, size);
     case 3:
-        res = patchApplyPPF3(f, rom, size);
-        break;
+        return patchApplyPPF3(f, rom, size);
     }
-
-    fclose(f);
-    return res;
+    return false;
 }
 
+} // namespace
+
 #endif
 
 bool applyPatch(const char* patchname, uint8_t** rom, int* size)
@@ -628,14 +623,41 @@ bool applyPatch(const char* patchname, uint8_t** rom, int* size)
     const char* p = strrchr(patchname, '.');
     if (p == NULL)
         return false;
+
+    bool (*apply)(PatchReader&, uint8_t**, int*) = NULL;
     if (_stricmp(p, ".ips") == 0)
-        return patchApplyIPS(patchname, rom, size);
-    if (_stricmp(p, ".ups") == 0)
-        return patchApplyUPS(patchname, rom, size);
-    if (_stricmp(p, ".bps") == 0)
-        return patchApplyBPS(patchname, rom, size);
-    if (_stricmp(p, ".ppf") == 0)
-        return patchApplyPPF(patchname, rom, size);
+        apply = patchApplyIPS;
+    else if (_stricmp(p, ".ups") == 0)
+        apply = patchApplyUPS;
+    else if (_stricmp(p, ".bps") == 0)
+        apply = patchApplyBPS;
+    else if (_stricmp(p, ".ppf") == 0)
+        apply = patchApplyPPF;
+    if (!apply)
+        return false;
+
+    PatchFile file(patchname);
+    if (!file.data())
+        return false;
+    PatchReader reader(file.data(), file.size());
+    return apply(reader, rom, size);
+#else
+    return false;
+#endif
+}
+
+bool applyPatchData(const uint8_t* patch, size_t patchSize, uint8_t** rom, int* size)
+{
+#ifndef __LIBRETRO__
+    PatchReader reader(patch, patchSize);
+    if (reader.startsWith("PATCH"))
+        return patchApplyIPS(reader, rom, size);
+    if (reader.startsWith("UPS1"))
+        return patchApplyUPS(reader, rom, size);
+    if (reader.startsWith("BPS1"))
+        return patchApplyBPS(reader, rom, size);
+    if (reader.startsWith("PPF"))
+        return patchApplyPPF(reader, rom, size);
 #endif
     return false;
 }
@@ -1,8 +1,13 @@
 #ifndef VBAM_CORE_BASE_PATCH_H_
 #define VBAM_CORE_BASE_PATCH_H_
 
+#include <cstddef>
 #include <cstdint>
 
+// IPS, UPS, BPS and PPF soft patching. *rom must come from malloc, it is reallocated
+// when the patched ROM is larger.
 bool applyPatch(const char *patchname, uint8_t **rom, int *size);
+// Same for a patch that is already in memory, its format taken from its header
+bool applyPatchData(const uint8_t *patch, size_t patchSize, uint8_t **rom, int *size);
 
 #endif  // VBAM_CORE_BASE_PATCH_H_
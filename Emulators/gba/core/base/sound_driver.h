@@ -42,6 +42,13 @@ public:
     // Write length bytes of data from the finalWave buffer to the driver output buffer.
     virtual void write(uint16_t* finalWave, int length) = 0;
 
+    // Drivers returning true get planar float32 samples through write_float()
+    // instead of interleaved 16-bit ones through write().
+    virtual bool float_output() const { return false; }
+
+    // Write count stereo frames, scaled to [-1, 1), from the left and right planes.
+    virtual void write_float(const float* /*left*/, const float* /*right*/, int /*count*/) {}
+
     virtual void setThrottle(unsigned short throttle) = 0;
 };
 
@@ -1256,8 +1256,14 @@ bool gbIsGameboyRom(char* file)
 
 void gbCopyMemory(uint16_t d, uint16_t s, int count)
 {
+    if (d >= 0xfe00 && d < 0xfea0)
+        gbInvalidateSprites();
+
     while (count) {
-        gbMemoryMap[d >> 12][d & 0x0fff] = gbMemoryMap[s >> 12][s & 0x0fff];
+        uint8_t* dest = &gbMemoryMap[d >> 12][d & 0x0fff];
+        *dest = gbMemoryMap[s >> 12][s & 0x0fff];
+        if (d >= 0x8000 && d < 0x9800)
+            gbInvalidateTile(dest);
         s++;
         d++;
         count--;
@@ -1345,8 +1351,12 @@ void gbWriteMemory(uint16_t address, uint8_t value)
 
     if (address < 0xa000) {
 
-        if (gbVramWriteAccessValid())
-            gbMemoryMap[address >> 12][address & 0x0fff] = value;
+        if (gbVramWriteAccessValid()) {
+            uint8_t* vram = &gbMemoryMap[address >> 12][address & 0x0fff];
+            *vram = value;
+            if (address < 0x9800)
+                gbInvalidateTile(vram);
+        }
         return;
     }
 
@@ -1381,6 +1391,7 @@ void gbWriteMemory(uint16_t address, uint8_t value)
             return;
         else {
             gbMemory[address] = value;
+            gbInvalidateSprites();
             return;
         }
     }
@@ -2146,9 +2157,9 @@ void gbWriteMemory(uint16_t address, uint8_t value)
     gbMemory[address] = value;
 }
 
-uint8_t gbReadMemory(uint16_t address)
+static uint8_t gbReadMemorySlow(uint16_t address)
 {
-    if (gbCheatMap[address])
+    if (gbCheatPageMap[address >> 8] && gbCheatMap[address])
         return gbCheatRead(address);
 
     if (address < 0x8000)
@@ -2186,6 +2197,10 @@ uint8_t gbReadMemory(uint16_t address)
     }
 
     if (address >= 0xff00) {
+        // HRAM
+        if ((address >= 0xff80) && (address < 0xffff))
+            return gbMemoryMap[address >> 12][address & 0x0fff];
+
         switch (address & 0x00ff) {
         case 0x00: {
             if (gbSgbMode) {
@@ -2432,6 +2447,16 @@ uint8_t gbReadMemory(uint16_t address)
     return gbMemoryMap[address >> 12][address & 0x0fff];
 }
 
+// ROM and WRAM have no access rules or side effects, so unless a cheat patches the page
+// their reads go straight through the memory map
+uint8_t gbReadMemory(uint16_t address)
+{
+    if (((address < 0x8000) || ((address & 0xe000) == 0xc000)) && !gbCheatPageMap[address >> 8])
+        return gbMemoryMap[address >> 12][address & 0x0fff];
+
+    return gbReadMemorySlow(address);
+}
+
 void gbVblank_interrupt()
 {
     gbCheatWrite(false); // Emulates GS codes.
@@ -3137,6 +3162,8 @@ void gbReset()
     gbScreenOn = true;
     gbSystemMessage = false;
 
+    gbInvalidateGfx();
+
     gbCheatWrite(true); // Emulates GS codes.
 }
 
@@ -3599,6 +3626,8 @@ static bool gbReadSaveState(gzFile gzFile)
         gbMemoryMap[0x0d] = &gbWram[value * 0x1000];
     }
 
+    gbInvalidateGfx();
+
     gbSoundReadGame(version, gzFile);
 
     if (gbCgbMode && gbSgbMode) {
@@ -3867,8 +3896,14 @@ int gbGetNextEvent(int _clockTicks)
     if (gbSerialOn && (gbSerialTicks < _clockTicks))
         _clockTicks = gbSerialTicks;
 
-    if (gbTimerOn && (((gbInternalTimer)&gbTimerMask[gbTimerMode]) + 1 < _clockTicks))
-        _clockTicks = ((gbInternalTimer)&gbTimerMask[gbTimerMode]) + 1;
+    // TIMA increments have no side effect until it overflows, and the timer emulation
+    // below catches up on any number of them at once
+    if (gbTimerOn) {
+        int timerTicks = ((gbInternalTimer)&gbTimerMask[gbTimerMode]) + 1
+            + (0xff - (register_TIMA & 0xff)) * gbTimerClockTicks;
+        if (timerTicks < _clockTicks)
+            _clockTicks = timerTicks;
+    }
 
     //if(soundTicks && (soundTicks < _clockTicks))
     //  _clockTicks = soundTicks;
@@ -3879,6 +3914,77 @@ int gbGetNextEvent(int _clockTicks)
     return _clockTicks;
 }
 
+// Number of ticks a "ldh a,(LY) / cp n / jr cc,loop" poll starting at address can be
+// fast-forwarded by, 0 if it cannot. Until the next event LY cannot change, so once A and
+// the flags hold what one pass of the loop leaves in them, whole passes up to that event
+// change nothing but the clock.
+static int gbIdleLoopSkip(uint16_t address, int ticksToStop)
+{
+    // Only code in ROM, WRAM or HRAM, where the reads below have no side effects
+    if (!(address < 0x7ffa || (address >= 0xc000 && address < 0xdffa) || (address >= 0xff80 && address < 0xfffa)))
+        return 0;
+
+    if (gbReadMemory(address + 1) != 0x44 || gbReadMemory(address + 2) != 0xfe
+        || gbReadMemory(address + 5) != 0xfa)
+        return 0;
+
+    // Pending interrupts, EI delays and the SIO counter all run per instruction
+    if ((IFF & 0x38) || gbInterruptWait || gbSerialOn || (gbSgbMode && gbSgbPacketTimeout))
+        return 0;
+    if ((register_IE & register_IF & 0x1f) && (IFF & 1))
+        return 0;
+
+    // These models read LY as 0 for a single tick of line 153
+    if ((gbHardware & 7) && (gbLcdMode == 1))
+        return 0;
+
+    uint8_t ly = gbReadMemory(0xff44);
+    uint8_t value = gbReadMemory(address + 3);
+    gbRegister result;
+    result.W = ly - value;
+    uint8_t flags = GB_N_FLAG | (result.B.B1 ? GB_C_FLAG : 0) | ZeroTable[result.B.B0]
+        | ((ly ^ value ^ result.B.B0) & 0x10 ? GB_H_FLAG : 0);
+    if (AF.B.B1 != ly || AF.B.B0 != flags)
+        return 0;
+
+    uint8_t branch = gbReadMemory(address + 4);
+    bool taken;
+    switch (branch) {
+    case 0x20:
+        taken = !(flags & GB_Z_FLAG);
+        break;
+    case 0x28:
+        taken = (flags & GB_Z_FLAG) != 0;
+        break;
+    case 0x30:
+        taken = !(flags & GB_C_FLAG);
+        break;
+    case 0x38:
+        taken = (flags & GB_C_FLAG) != 0;
+        break;
+    default:
+        taken = false;
+        break;
+    }
+    if (!taken)
+        return 0;
+
+    // The taken branch costs one tick on top of its table entry
+    int loopTicks = gbCycles[0xf0] + gbCycles[0xfe] + gbCycles[branch] + 1;
+
+    // Stop short of the next event, of ticksToStop and of the mid-frame sound flush
+    int horizon = gbGetNextEvent(ticksToStop);
+    int soundHorizon = (SOUND_CLOCK_TICKS - soundTicks) / (gbSpeed ? 1 : 2);
+    if (soundHorizon < horizon)
+        horizon = soundHorizon;
+
+    int loops = (horizon - 1) / loopTicks;
+    if (loops < 2)
+        return 0;
+
+    return loops * loopTicks;
+}
+
 void gbDrawLine()
 {
     switch (systemColorDepth) {
@@ -4075,24 +4181,33 @@ void gbEmulate(int ticksToStop)
 
             opcode2 = opcode1 = opcode = gbReadMemory(PC.W++);
 
-            // If HALT state was launched while IME = 0 and (register_IF & register_IE & 0x1F),
-            // PC.W is not incremented for the first byte of the next instruction.
-            if (IFF & 2) {
-                PC.W--;
-                IFF &= ~2;
-            }
+            int idleTicks;
+            if ((opcode == 0xf0) && !(IFF & 2) && ((idleTicks = gbIdleLoopSkip(oldPCW, ticksToStop)) > 0)) {
+                // Spend the LY poll's time without running it, split like an instruction's
+                PC.W = oldPCW;
+                execute = false;
+                gbOldClockTicks = idleTicks - 1;
+                gbIntBreak = 1;
+            } else {
+                // If HALT state was launched while IME = 0 and (register_IF & register_IE & 0x1F),
+                // PC.W is not incremented for the first byte of the next instruction.
+                if (IFF & 2) {
+                    PC.W--;
+                    IFF &= ~2;
+                }
 
-            clockTicks = gbCycles[opcode];
+                clockTicks = gbCycles[opcode];
 
-            switch (opcode) {
-            case 0xCB:
-                // extended opcode
-                opcode2 = opcode = gbReadMemory(PC.W++);
-                clockTicks = gbCyclesCB[opcode];
-                break;
+                switch (opcode) {
+                case 0xCB:
+                    // extended opcode
+                    opcode2 = opcode = gbReadMemory(PC.W++);
+                    clockTicks = gbCyclesCB[opcode];
+                    break;
+                }
+                gbOldClockTicks = clockTicks - 1;
+                gbIntBreak = 1;
             }
-            gbOldClockTicks = clockTicks - 1;
-            gbIntBreak = 1;
         }
 
         if (!emulating)
@@ -4937,6 +5052,19 @@ bool gbLoadRomData(const char* data, size_t size) {
 }
 
 #ifndef __LIBRETRO__
+bool gbWriteBatteryData(std::vector<uint8_t>& data) {
+    if (g_gbBatteryError || !g_gbCartData.has_battery()) {
+        return false;
+    }
+
+    data.clear();
+    for (const VBamIoVec& vec : g_vbamIoVecs) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(vec.data);
+        data.insert(data.end(), bytes, bytes + vec.length);
+    }
+    return true;
+}
+
 bool gbApplyPatch(const char* patchName) {
     int size = g_gbCartData.rom_size();
     if (!applyPatch(patchName, &gbRom, &size)) {
@@ -5213,6 +5341,8 @@ bool gbReadSaveState(const uint8_t* data)
         gbMemoryMap[0x0d] = &gbWram[value * 0x1000];
     }
 
+    gbInvalidateGfx();
+
     gbSoundReadGame(data);
 
     if (gbCgbMode && gbSgbMode) {
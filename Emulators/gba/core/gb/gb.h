@@ -2,6 +2,7 @@
 #define VBAM_CORE_GB_GB_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "core/gb/gbCartData.h"
 
@@ -34,6 +35,10 @@ bool gbLoadRomData(const char* romData, size_t romSize);
 // Attempts to apply `patchName` to the currently loaded ROM. Returns true on
 // success.
 bool gbApplyPatch(const char* patchName);
+
+// Fills `data` with the battery RAM and clock as WriteBatteryFile stores them.
+// Returns false if the cartridge has no battery or its save failed to load.
+bool gbWriteBatteryData(std::vector<uint8_t>& data);
 #endif  // __LIBRETRO__
 
 void gbEmulate(int);
@@ -47,5 +47,7 @@ bool gbVerifyGgCode(const char* code);
 extern int gbCheatNumber;
 extern gbCheat gbCheatList[MAX_CHEATS];
 extern bool gbCheatMap[0x10000];
+// One entry per 256 byte page, set when any address in it has an enabled cheat
+extern bool gbCheatPageMap[0x100];
 
 #endif // VBAM_CORE_GB_GBCHEATS_H_
@@ -2,6 +2,15 @@
 
 #include <memory.h>
 
+#include <algorithm>
+#include <array>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "core/base/system.h"
 #include "core/gb/gbGlobals.h"
 #include "core/gb/gbSGB.h"
@@ -41,6 +50,169 @@ uint8_t gbInvertTab[256] = {
     0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff
 };
 
+// Spreads the 8 bits of a tile plane byte over the 8 bytes of a word, leftmost pixel in
+// the lowest byte, so one row of 2bpp pixels decodes with two lookups
+static constexpr std::array<uint64_t, 256> kGbTilePlane = [] {
+    std::array<uint64_t, 256> table{};
+    for (int value = 0; value < 256; value++) {
+        for (int pixel = 0; pixel < 8; pixel++) {
+            if (value & (0x80 >> pixel))
+                table[value] |= uint64_t(1) << (pixel * 8);
+        }
+    }
+    return table;
+}();
+
+// Colour indices 0-3 of a tile row, one per byte
+static inline uint64_t gbDecodeTileRow(uint8_t tile_a, uint8_t tile_b)
+{
+    return kGbTilePlane[tile_a] | (kGbTilePlane[tile_b] << 1);
+}
+
+static inline uint8_t gbTileRowPixel(uint64_t row, int pixel)
+{
+    return (row >> (pixel * 8)) & 3;
+}
+
+// Decoded rows of the 384 tiles in each VRAM bank, as drawn and mirrored. A tile is
+// decoded on first use after a write to it; gbInvalidateTile and gbInvalidateGfx drop it.
+static uint64_t gbTileRows[2][0x1800 / 2][2];
+static bool gbTileDecoded[2][0x1800 / 16];
+
+#if defined(__SSE2__)
+
+// planes holds a tile row's low plane byte in lanes 0-7 and its high plane byte in 8-15
+static inline void gbStoreTileRow(__m128i planes, __m128i bits, uint64_t* row)
+{
+    const __m128i weights = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2);
+    __m128i set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(planes, bits), bits), weights);
+    set = _mm_or_si128(set, _mm_srli_si128(set, 8));
+    _mm_storel_epi64((__m128i*)row, set);
+}
+
+static void gbDecodeTile(const uint8_t* tile, uint64_t (*rows)[2])
+{
+    const __m128i bits = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+    const __m128i mirrored = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+    // Widen each plane byte of the 8 interleaved rows to 8 lanes, one row per vector
+    const __m128i data = _mm_loadu_si128((const __m128i*)tile);
+    for (int half = 0; half < 2; half++) {
+        const __m128i pairs = half ? _mm_unpackhi_epi8(data, data) : _mm_unpacklo_epi8(data, data);
+        for (int quarter = 0; quarter < 2; quarter++) {
+            const __m128i quads = quarter ? _mm_unpackhi_epi16(pairs, pairs) : _mm_unpacklo_epi16(pairs, pairs);
+            const int y = half * 4 + quarter * 2;
+            const __m128i first = _mm_unpacklo_epi32(quads, quads);
+            const __m128i second = _mm_unpackhi_epi32(quads, quads);
+            gbStoreTileRow(first, bits, &rows[y][0]);
+            gbStoreTileRow(first, mirrored, &rows[y][1]);
+            gbStoreTileRow(second, bits, &rows[y + 1][0]);
+            gbStoreTileRow(second, mirrored, &rows[y + 1][1]);
+        }
+    }
+}
+
+#elif defined(__ARM_NEON)
+
+static void gbDecodeTile(const uint8_t* tile, uint64_t (*rows)[2])
+{
+    static const uint8_t kBits[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    static const uint8_t kMirrored[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+    const uint8x8_t bits = vld1_u8(kBits);
+    const uint8x8_t mirrored = vld1_u8(kMirrored);
+    const uint8x8_t one = vdup_n_u8(1);
+    const uint8x8_t two = vdup_n_u8(2);
+
+    // Split the interleaved rows into the low and high bit planes
+    const uint8x8x2_t planes = vld2_u8(tile);
+    uint8_t low[8], high[8];
+    vst1_u8(low, planes.val[0]);
+    vst1_u8(high, planes.val[1]);
+
+    for (int y = 0; y < 8; y++) {
+        const uint8x8_t a = vdup_n_u8(low[y]);
+        const uint8x8_t b = vdup_n_u8(high[y]);
+        vst1_u8((uint8_t*)&rows[y][0], vorr_u8(vand_u8(vtst_u8(a, bits), one), vand_u8(vtst_u8(b, bits), two)));
+        vst1_u8((uint8_t*)&rows[y][1], vorr_u8(vand_u8(vtst_u8(a, mirrored), one), vand_u8(vtst_u8(b, mirrored), two)));
+    }
+}
+
+#else
+
+static void gbDecodeTile(const uint8_t* tile, uint64_t (*rows)[2])
+{
+    for (int y = 0; y < 8; y++) {
+        const uint8_t a = tile[y * 2];
+        const uint8_t b = tile[y * 2 + 1];
+        rows[y][0] = gbDecodeTileRow(a, b);
+        rows[y][1] = gbDecodeTileRow(gbInvertTab[a], gbInvertTab[b]);
+    }
+}
+
+#endif
+
+// The tile row at address (0x0000-0x17ff in bank), mirrored if flip is set
+static inline uint64_t gbTileRow(int bank, const uint8_t* vram, int address, bool flip)
+{
+    const int tile = address >> 4;
+    if (!gbTileDecoded[bank][tile]) {
+        gbDecodeTile(&vram[tile << 4], &gbTileRows[bank][tile << 3]);
+        gbTileDecoded[bank][tile] = true;
+    }
+    return gbTileRows[bank][address >> 1][flip];
+}
+
+void gbInvalidateTile(const uint8_t* vram)
+{
+    int bank = 0;
+    ptrdiff_t offset;
+    if (gbVram != nullptr && vram >= gbVram && vram < gbVram + 0x4000) {
+        offset = vram - gbVram;
+        bank = int(offset >> 13);
+        offset &= 0x1fff;
+    } else {
+        offset = vram - &gbMemory[0x8000];
+    }
+    if (offset >= 0 && offset < 0x1800)
+        gbTileDecoded[bank][offset >> 4] = false;
+}
+
+// OAM indices of the sprites on each line, in OAM order and at most 10, as the hardware
+// picks them; rebuilt on the first line drawn after OAM or the sprite size changed
+static uint8_t gbLineSprites[160][10];
+static uint8_t gbLineSpriteCount[160];
+static bool gbLineSpritesValid = false;
+static int gbLineSpritesSize = 0;
+
+static void gbBuildLineSprites(int size)
+{
+    const int height = size ? 16 : 8;
+    memset(gbLineSpriteCount, 0, sizeof(gbLineSpriteCount));
+    for (int i = 0; i < 40; i++) {
+        const int y = gbMemory[0xfe00 + i * 4];
+        const int x = gbMemory[0xfe00 + i * 4 + 1];
+        if (x > 0 && y > 0 && x < 168 && y < 160) {
+            for (int line = std::max(y - 16, 0); line < y - 16 + height; line++) {
+                if (gbLineSpriteCount[line] < 10)
+                    gbLineSprites[line][gbLineSpriteCount[line]++] = uint8_t(i);
+            }
+        }
+    }
+    gbLineSpritesSize = size;
+    gbLineSpritesValid = true;
+}
+
+void gbInvalidateSprites()
+{
+    gbLineSpritesValid = false;
+}
+
+void gbInvalidateGfx()
+{
+    memset(gbTileDecoded, 0, sizeof(gbTileDecoded));
+    gbLineSpritesValid = false;
+}
+
 uint16_t gbLineMix[160];
 uint16_t gbWindowColor[160];
 extern int inUseRegister_WY;
@@ -84,7 +256,8 @@ void gbRenderLine()
     int tx = sx >> 3;
     int ty = sy >> 3;
 
-    int bx = 1 << (7 - (sx & 7));
+    // Column within the current tile
+    int px = sx & 7;
     int by = sy & 7;
 
     int tile_map_line_y = tile_map + ty * 32;
@@ -104,45 +277,35 @@ void gbRenderLine()
 
     int tile_pattern_address = tile_pattern + tile * 16 + by * 2;
 
+    // Per line state the pixel loops would otherwise reload for every pixel
+    const bool dmgCompatPalette = gbCgbMode && (gbMemory[0xff6c] & 1);
+    const bool colorOption = gbColorOption;
+
     if (register_LCDC & 0x80) {
         if ((register_LCDC & 0x01 || gbCgbMode) && (coreOptions.layerSettings & 0x0100)) {
             while (x < 160) {
 
-                uint8_t tile_a = 0;
-                uint8_t tile_b = 0;
-
                 if (attrs & 0x40) {
                     tile_pattern_address = tile_pattern + tile * 16 + (7 - by) * 2;
                 }
 
-                if (attrs & 0x08) {
-                    tile_a = bank1[tile_pattern_address++];
-                    tile_b = bank1[tile_pattern_address];
-                } else {
-                    tile_a = bank0[tile_pattern_address++];
-                    tile_b = bank0[tile_pattern_address];
-                }
-
-                if (attrs & 0x20) {
-                    tile_a = gbInvertTab[tile_a];
-                    tile_b = gbInvertTab[tile_b];
-                }
+                const uint64_t row = (attrs & 0x08)
+                    ? gbTileRow(1, bank1, tile_pattern_address, attrs & 0x20)
+                    : gbTileRow(0, bank0, tile_pattern_address, attrs & 0x20);
+                const uint16_t priority = (attrs & 0x80) ? 0x300 : 0;
+                const int cgbPalette = (attrs & 7) * 4;
 
-                while (bx > 0) {
-                    uint8_t c = (tile_a & bx) ? 1 : 0;
-                    c += ((tile_b & bx) ? 2 : 0);
+                while (px < 8) {
+                    uint8_t c = gbTileRowPixel(row, px);
 
-                    gbLineBuffer[x] = c; // mark the gbLineBuffer color
-
-                    if (attrs & 0x80)
-                        gbLineBuffer[x] |= 0x300;
+                    gbLineBuffer[x] = c | priority; // mark the gbLineBuffer color
 
                     if (gbCgbMode) {
                         // Use the DMG palette if we are in compat mode.
-                        if (gbMemory[0xff6c] & 1) {
+                        if (dmgCompatPalette) {
                             c = gbBgp[c];
                         } else {
-                            c = c + (attrs & 7) * 4;
+                            c = c + cgbPalette;
                         }
                     } else {
                         c = (gbBgpLine[x + (gbSpeed ? 5 : 11) + SpritesTicks] >> (c << 1)) & 3;
@@ -158,14 +321,14 @@ void gbRenderLine()
                             c = c + 4 * palette;
                         }
                     }
-                    gbLineMix[x] = gbColorOption ? gbColorFilter[gbPalette[c] & 0x7FFF] : gbPalette[c] & 0x7FFF;
+                    gbLineMix[x] = colorOption ? gbColorFilter[gbPalette[c] & 0x7FFF] : gbPalette[c] & 0x7FFF;
                     x++;
                     if (x >= 160)
                         break;
-                    bx >>= 1;
+                    px++;
                 }
 
-                bx = 128;
+                px = 0;
 
                 SpritesTicks = gbSpritesTicks[x] * (gbSpeed ? 2 : 4);
 
@@ -249,18 +412,18 @@ void gbRenderLine()
                     tx = 0;
                     ty = gbWindowLine >> 3;
 
-                    bx = 128;
+                    px = 0;
                     by = gbWindowLine & 7;
 
                     // Tries to emulate the 'window scrolling bug' when wx == 0 (ie. wx-7 == -7).
                     // Nothing close to perfect, but good enought for now...
                     if (wx == -7) {
                         swx = 7 - ((gbSCXLine[0] - 1) & 7);
-                        bx >>= ((gbSCXLine[0] + ((swx != 1) ? 1 : 0)) & 7);
+                        px += ((gbSCXLine[0] + ((swx != 1) ? 1 : 0)) & 7);
                         if (swx == 1)
                             swx = 2;
 
-                        //bx >>= ((gbSCXLine[0]+(((swx>1) && (swx != 7)) ? 1 : 0)) & 7);
+                        //px += ((gbSCXLine[0]+(((swx>1) && (swx != 7)) ? 1 : 0)) & 7);
 
                         if (swx == 7) {
                             //wx = 0;
@@ -268,7 +431,7 @@ void gbRenderLine()
                                 swx = 0;
                         }
                     } else if (wx < 0) {
-                        bx >>= (-wx);
+                        px += (-wx);
                         wx = 0;
                     }
 
@@ -298,42 +461,28 @@ void gbRenderLine()
                             gbLineMix[i] = gbWindowColor[i];
 
                     while (x < 160) {
-                        uint8_t tile_a = 0;
-                        uint8_t tile_b = 0;
-
                         if (attrs & 0x40) {
                             tile_pattern_address = tile_pattern + tile * 16 + (7 - by) * 2;
                         }
 
-                        if (attrs & 0x08) {
-                            tile_a = bank1[tile_pattern_address++];
-                            tile_b = bank1[tile_pattern_address];
-                        } else {
-                            tile_a = bank0[tile_pattern_address++];
-                            tile_b = bank0[tile_pattern_address];
-                        }
+                        const uint64_t row = (attrs & 0x08)
+                            ? gbTileRow(1, bank1, tile_pattern_address, attrs & 0x20)
+                            : gbTileRow(0, bank0, tile_pattern_address, attrs & 0x20);
+                        const uint16_t priority = (attrs & 0x80) ? 0x300 : 0x100;
+                        const int cgbPalette = (attrs & 7) * 4;
 
-                        if (attrs & 0x20) {
-                            tile_a = gbInvertTab[tile_a];
-                            tile_b = gbInvertTab[tile_b];
-                        }
-
-                        while (bx > 0) {
-                            uint8_t c = (tile_a & bx) != 0 ? 1 : 0;
-                            c += ((tile_b & bx) != 0 ? 2 : 0);
+                        while (px < 8) {
+                            uint8_t c = gbTileRowPixel(row, px);
 
                             if (x >= 0) {
-                                if (attrs & 0x80)
-                                    gbLineBuffer[x] = 0x300 + c;
-                                else
-                                    gbLineBuffer[x] = 0x100 + c;
+                                gbLineBuffer[x] = priority + c;
 
                                 if (gbCgbMode) {
                                     // Use the DMG palette if we are in compat mode.
-                                    if (gbMemory[0xff6c] & 1) {
+                                    if (dmgCompatPalette) {
                                         c = gbBgp[c];
                                     } else {
-                                        c = c + (attrs & 7) * 4;
+                                        c = c + cgbPalette;
                                     }
                                 } else {
                                     c = (gbBgpLine[x + (gbSpeed ? 5 : 11) + gbSpritesTicks[x] * (gbSpeed ? 2 : 4)] >> (c << 1)) & 3;
@@ -349,17 +498,17 @@ void gbRenderLine()
                                         c = c + 4 * palette;
                                     }
                                 }
-                                gbLineMix[x] = gbColorOption ? gbColorFilter[gbPalette[c] & 0x7FFF] : gbPalette[c] & 0x7FFF;
+                                gbLineMix[x] = colorOption ? gbColorFilter[gbPalette[c] & 0x7FFF] : gbPalette[c] & 0x7FFF;
                             }
                             x++;
                             if (x >= 160)
                                 break;
-                            bx >>= 1;
+                            px++;
                         }
                         tx++;
                         if (tx == 32)
                             tx = 0;
-                        bx = 128;
+                        px = 0;
                         tile = bank0[tile_map_line_y + tx];
                         if (bank1)
                             attrs = bank1[tile_map_line_y + tx];
@@ -430,32 +579,25 @@ void gbDrawSpriteTile(int tile, int x, int y, int t, int flags,
 
     int prio = flags & 0x80;
 
-    int address = tile * 16 + 2 * t;
-    int a = 0;
-    int b = 0;
+    const int address = tile * 16 + 2 * t;
+    const uint64_t row = (gbCgbMode && (flags & 0x08))
+        ? gbTileRow(1, bank1, address, flipx)
+        : gbTileRow(0, bank0, address, flipx);
 
-    if (gbCgbMode && (flags & 0x08)) {
-        a = bank1[address++];
-        b = bank1[address++];
-    } else {
-        a = bank0[address++];
-        b = bank0[address++];
-    }
+    // Fully transparent row
+    if (row == 0)
+        return;
+
+    const bool dmgCompatPalette = gbCgbMode && (gbMemory[0xff6c] & 1);
 
     for (int xx = 0; xx < 8; xx++) {
-        uint8_t mask = 1 << (7 - xx);
-        uint8_t c = 0;
-        if ((a & mask))
-            c++;
-        if ((b & mask))
-            c += 2;
+        uint8_t c = gbTileRowPixel(row, xx);
 
         if (c == 0)
             continue;
 
+        // The mirrored row already has flipped sprites the right way round
         int xxx = xx + x;
-        if (flipx)
-            xxx = (7 - xx + x);
 
         if (xxx < 0 || xxx > 159)
             continue;
@@ -496,7 +638,7 @@ void gbDrawSpriteTile(int tile, int x, int y, int t, int flags,
         // make sure that sprites will work even in CGB mode
         if (gbCgbMode) {
             // Use the DMG palette if we are in compat mode.
-            if (gbMemory[0xff6c] & 1) {
+            if (dmgCompatPalette) {
                 c = pal[c] + ((flags & 0x10) >> 4) * 4 + 32;
             } else {
                 c = c + (flags & 0x07) * 4 + 32;
@@ -540,8 +682,13 @@ void gbDrawSprites(bool draw)
     if ((register_LCDC & 2) && (coreOptions.layerSettings & 0x1000)) {
         int yc = register_LY;
 
-        int address = 0xfe00;
-        for (int i = 0; i < 40; i++) {
+        if (!gbLineSpritesValid || gbLineSpritesSize != size)
+            gbBuildLineSprites(size);
+
+        const int sprites = yc < 160 ? gbLineSpriteCount[yc] : 0;
+        for (; count < sprites; count++) {
+            const int i = gbLineSprites[yc][count];
+            int address = 0xfe00 + i * 4;
             y = gbMemory[address++];
             x = gbMemory[address++];
             int tile = gbMemory[address++];
@@ -549,27 +696,23 @@ void gbDrawSprites(bool draw)
                 tile &= 254;
             int flags = gbMemory[address++];
 
-            if (x > 0 && y > 0 && x < 168 && y < 160) {
-                // check if sprite intersects current line
-                int t = yc - y + 16;
-                if ((size && t >= 0 && t < 16) || (!size && t >= 0 && t < 8)) {
-                    if (draw)
-                        gbDrawSpriteTile(tile, x - 8, yc, t, flags, size, i);
-                    else {
-                        for (int j = x - 8; j < 300; j++)
-                            if (j >= 0) {
-                                if (gbSpeed)
-                                    gbSpritesTicks[j] += 5;
-                                else
-                                    gbSpritesTicks[j] += 2 + (count & 1);
-                            }
-                    }
-                    count++;
-                }
+            int t = yc - y + 16;
+            if (draw)
+                gbDrawSpriteTile(tile, x - 8, yc, t, flags, size, i);
+            else {
+                // Each sprite delays every pixel from its left edge on; record the step
+                // here and sum the steps up once the line's sprites are known
+                int j = (x - 8 < 0) ? 0 : x - 8;
+                if (gbSpeed)
+                    gbSpritesTicks[j] += 5;
+                else
+                    gbSpritesTicks[j] += 2 + (count & 1);
             }
-            // sprite limit reached!
-            if (count >= 10)
-                break;
+        }
+
+        if (!draw && count) {
+            for (int j = 1; j < 300; j++)
+                gbSpritesTicks[j] += gbSpritesTicks[j - 1];
         }
     }
     return;
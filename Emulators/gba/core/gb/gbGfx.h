@@ -1,7 +1,16 @@
 #ifndef VBAM_CORE_GB_GBGFX_H_
 #define VBAM_CORE_GB_GBGFX_H_
 
+#include <cstdint>
+
 void gbRenderLine();
 void gbDrawSprites(bool);
 
+// The renderer keeps decoded tile rows and the sprites on each line. Writes to tile
+// data report the byte written, writes to OAM just that they happened; gbInvalidateGfx
+// is for VRAM and OAM replaced wholesale (reset, state loads).
+void gbInvalidateTile(const uint8_t* vram);
+void gbInvalidateSprites();
+void gbInvalidateGfx();
+
 #endif  // VBAM_CORE_GB_GBGFX_H_
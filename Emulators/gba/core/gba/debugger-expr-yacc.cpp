@@ -81,6 +81,7 @@
 #include "core/base/port.h"
 #include "core/gba/gba.h"
 #include "core/gba/gbaGlobals.h"
+#include "core/gba/gbaInline.h"
 
 #include <string>
 #include <map>
@@ -92,14 +93,11 @@ extern char *dexp_text;
 
 std::map<std::string, uint32_t> dexp_vars;
 
-#define readWord(addr) \
-  READ32LE((&map[(addr)>>24].address[(addr) & map[(addr)>>24].mask]))
+#define readWord(addr) CPUReadMemoryQuick(addr)
 
-#define readHalfWord(addr) \
-  READ16LE((&map[(addr)>>24].address[(addr) & map[(addr)>>24].mask]))
+#define readHalfWord(addr) CPUReadHalfWordQuick(addr)
 
-#define readByte(addr) \
-  map[(addr)>>24].address[(addr) & map[(addr)>>24].mask]
+#define readByte(addr) CPUReadByteQuick(addr)
 
 
 
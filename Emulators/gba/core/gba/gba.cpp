@@ -10,6 +10,13 @@
 #include <strings.h>
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "core/base/file_util.h"
 #include "core/base/message.h"
 #include "core/base/port.h"
@@ -475,20 +482,99 @@ variable_desc saveGameStruct[] = {
 
 static int romSize = SIZE_ROM;
 
+// g_rom is a SIZE_ROM address space reservation. Pages are only committed
+// when touched, so the unused tail of the cartridge space costs nothing and
+// its open-bus contents are computed by the ROM read path (see g_romEnd).
+static uint8_t* romReserve()
+{
+    memset(g_romTailPages, 0, sizeof(g_romTailPages));
+#ifdef _WIN32
+    return (uint8_t*)calloc(1, SIZE_ROM);
+#else
+    void* rom = mmap(NULL, SIZE_ROM, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    return rom == MAP_FAILED ? NULL : (uint8_t*)rom;
+#endif
+}
+
+static void romRelease()
+{
+#ifdef _WIN32
+    free(g_rom);
+#else
+    munmap(g_rom, SIZE_ROM);
+#endif
+    g_rom = NULL;
+    g_romEnd = 0;
+    memset(g_romTailPages, 0, sizeof(g_romTailPages));
+}
+
+#ifndef _WIN32
+// Loads `size` bytes of `fd` at `dest`. Over g_rom the file is mapped copy on
+// write, so only the pages the game reads are paged in and cheats or patches
+// still apply in memory.
+static bool romLoadFile(uint8_t* dest, int fd, int size)
+{
+    if (dest == g_rom) {
+        void* rom = mmap(g_rom, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if (rom != MAP_FAILED)
+            return true;
+    }
+    int done = 0;
+    while (done < size) {
+        int res = (int)read(fd, dest + done, size - done);
+        if (res <= 0)
+            return false;
+        done += res;
+    }
+    return true;
+}
+#endif
+
+static void romWriteOpenBus(uint32_t start, uint32_t end)
+{
+    uint16_t* temp = (uint16_t*)(g_rom + start);
+    for (uint32_t i = start; i < end; i += 2) {
+        WRITE16LE(temp, (i >> 1) & 0xFFFF);
+        temp++;
+    }
+}
+
+// Materializes the open-bus pattern in [g_romEnd, end) so the range can be
+// copied around like regular ROM data.
+static void romFillOpenBus(uint32_t end)
+{
+    if (end > g_romEnd) {
+        romWriteOpenBus(g_romEnd, end);
+        g_romEnd = end;
+    }
+}
+
+void gbaRomMaterialize(uint32_t offset, uint32_t size)
+{
+    if (g_rom == NULL || size == 0)
+        return;
+    offset &= 0x1FFFFFF;
+    uint32_t end = offset + size;
+    if (end > SIZE_ROM)
+        end = SIZE_ROM;
+    for (uint32_t page = offset & ~0xFFF; page < end; page += 0x1000) {
+        if (page + 0x1000 <= g_romEnd)
+            continue;
+        uint8_t& bits = g_romTailPages[page >> 15];
+        const uint8_t bit = (uint8_t)(1 << ((page >> 12) & 7));
+        if (bits & bit)
+            continue;
+        romWriteOpenBus(page < g_romEnd ? g_romEnd : page, page + 0x1000);
+        bits |= bit;
+    }
+}
+
 void gbaUpdateRomSize(int size)
 {
-    // Only change memory block if new size is larger
+    // Only change the readable extent if new size is larger
     if (size > romSize) {
         romSize = size;
-
-        uint8_t* tmp = (uint8_t*)realloc(g_rom, SIZE_ROM);
-        g_rom = tmp;
-
-        uint16_t* temp = (uint16_t*)(g_rom + ((romSize + 1) & ~1));
-        for (int i = (romSize + 1) & ~1; i < SIZE_ROM; i += 2) {
-            WRITE16LE(temp, (i >> 1) & 0xFFFF);
-            temp++;
-        }
+        g_romEnd = (romSize + 1) & ~1;
     }
 }
 
@@ -984,6 +1070,25 @@ bool CPUExportEepromFile(const char* fileName)
     return true;
 }
 
+// The save memory in use and its size; size is 0 if the game saves nothing
+static const uint8_t* CPUBatteryData(size_t* size)
+{
+    *size = 0;
+    if (!coreOptions.saveType || coreOptions.saveType == GBA_SAVE_NONE)
+        return NULL;
+
+    // only save if Flash/Sram in use or EEprom in use
+    if (eepromInUse) { // save eeprom type
+        *size = eepromSize;
+        return eepromData;
+    }
+    if (coreOptions.saveType == GBA_SAVE_FLASH) // save flash type
+        *size = g_flashSize;
+    else if (coreOptions.saveType == GBA_SAVE_SRAM) // save sram type
+        *size = 0x8000;
+    return flashSaveMemory;
+}
+
 bool CPUWriteBatteryFile(const char* fileName)
 {
     if ((coreOptions.saveType) && (coreOptions.saveType != GBA_SAVE_NONE)) {
@@ -995,30 +1100,25 @@ bool CPUWriteBatteryFile(const char* fileName)
             return false;
         }
 
-        // only save if Flash/Sram in use or EEprom in use
-        if (!eepromInUse) {
-            if (coreOptions.saveType == GBA_SAVE_FLASH) { // save flash type
-                if (fwrite(flashSaveMemory, 1, g_flashSize, file) != (size_t)g_flashSize) {
-                    fclose(file);
-                    return false;
-                }
-            } else if (coreOptions.saveType == GBA_SAVE_SRAM) { // save sram type
-                if (fwrite(flashSaveMemory, 1, 0x8000, file) != 0x8000) {
-                    fclose(file);
-                    return false;
-                }
-            }
-        } else { // save eeprom type
-            if (fwrite(eepromData, 1, eepromSize, file) != (size_t)eepromSize) {
-                fclose(file);
-                return false;
-            }
+        size_t size;
+        const uint8_t* data = CPUBatteryData(&size);
+        if (fwrite(data, 1, size, file) != size) {
+            fclose(file);
+            return false;
         }
         fclose(file);
     }
     return true;
 }
 
+bool CPUWriteBatteryData(std::vector<uint8_t>& data)
+{
+    size_t size;
+    const uint8_t* memory = CPUBatteryData(&size);
+    data.assign(memory, memory + size);
+    return size != 0;
+}
+
 bool CPUReadGSASnapshot(const char* fileName)
 {
     int i;
@@ -1385,8 +1485,7 @@ void CPUCleanUp()
 #endif
 
     if (g_rom != NULL) {
-        free(g_rom);
-        g_rom = NULL;
+        romRelease();
     }
 
     if (g_vram != NULL) {
@@ -1488,7 +1587,7 @@ int CPULoadRom(const char* szFile)
 
     systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
 
-    g_rom = (uint8_t*)malloc(SIZE_ROM);
+    g_rom = romReserve();
     if (g_rom == NULL) {
         systemMessage(MSG_OUT_OF_MEMORY, N_("Failed to allocate memory for %s"),
             "ROM");
@@ -1509,16 +1608,14 @@ int CPULoadRom(const char* szFile)
         if (!f) {
             systemMessage(MSG_ERROR_OPENING_IMAGE, N_("Error opening image %s"),
                 szFile);
-            free(g_rom);
-            g_rom = NULL;
+            romRelease();
             free(g_workRAM);
             g_workRAM = NULL;
             return 0;
         }
         bool res = elfRead(szFile, romSize, f);
         if (!res || romSize == 0) {
-            free(g_rom);
-            g_rom = NULL;
+            romRelease();
             free(g_workRAM);
             g_workRAM = NULL;
             elfCleanUp();
@@ -1531,20 +1628,14 @@ int CPULoadRom(const char* szFile)
                 utilIsGBAImage,
                 whereToLoad,
                 romSize)) {
-            free(g_rom);
-            g_rom = NULL;
+            romRelease();
             free(g_workRAM);
             g_workRAM = NULL;
             return 0;
         }
     }
 
-    uint16_t* temp = (uint16_t*)(g_rom + ((romSize + 1) & ~1));
-    int i;
-    for (i = (romSize + 1) & ~1; i < SIZE_ROM; i += 2) {
-        WRITE16LE(temp, (i >> 1) & 0xFFFF);
-        temp++;
-    }
+    g_romEnd = (romSize + 1) & ~1;
 
     g_bios = (uint8_t*)calloc(1, SIZE_BIOS);
     if (g_bios == NULL) {
@@ -1582,7 +1673,7 @@ int CPULoadRom(const char* szFile)
         return 0;
     }
 
-    g_pix = (uint8_t*)calloc(1, 4 * 241 * 162);
+    g_pix = (uint8_t*)calloc(1, SIZE_PIX);
     if (g_pix == NULL) {
         systemMessage(MSG_OUT_OF_MEMORY, N_("Failed to allocate memory for %s"),
             "PIX");
@@ -1605,7 +1696,8 @@ int CPULoadRom(const char* szFile)
     return romSize;
 }
 
-int CPULoadRomData(const char* data, int size)
+// Loads a raw ROM image either from `data` or, if that is NULL, from `fd`.
+static int CPULoadRomImage(const char* data, int fd, int size)
 {
     romSize = SIZE_ROM;
     if (g_rom != NULL) {
@@ -1614,7 +1706,12 @@ int CPULoadRomData(const char* data, int size)
 
     systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
 
-    g_rom = (uint8_t*)malloc(SIZE_ROM);
+    if (size <= 0 || size > SIZE_ROM) {
+        systemMessage(MSG_UNSUPPORTED_ROM_SIZE, N_("Unsupported rom size %d"), size);
+        return 0;
+    }
+
+    g_rom = romReserve();
     if (g_rom == NULL) {
         systemMessage(MSG_OUT_OF_MEMORY, N_("Failed to allocate memory for %s"),
             "ROM");
@@ -1630,14 +1727,19 @@ int CPULoadRomData(const char* data, int size)
     uint8_t* whereToLoad = coreOptions.cpuIsMultiBoot ? g_workRAM : g_rom;
 
     romSize = size % 2 == 0 ? size : size + 1;
-    memcpy(whereToLoad, data, size);
-
-    uint16_t* temp = (uint16_t*)(g_rom + ((romSize + 1) & ~1));
-    int i;
-    for (i = (romSize + 1) & ~1; i < SIZE_ROM; i += 2) {
-        WRITE16LE(temp, (i >> 1) & 0xFFFF);
-        temp++;
+    if (data != NULL) {
+        memcpy(whereToLoad, data, size);
     }
+#ifndef _WIN32
+    else if (!romLoadFile(whereToLoad, fd, size)) {
+        systemMessage(MSG_ERROR_READING_IMAGE, N_("Error reading image %s"), "ROM");
+        CPUCleanUp();
+        return 0;
+    }
+#else
+    (void)fd;
+#endif
+    g_romEnd = romSize;
 
     g_bios = (uint8_t*)calloc(1, SIZE_BIOS);
     if (g_bios == NULL) {
@@ -1675,7 +1777,7 @@ int CPULoadRomData(const char* data, int size)
         return 0;
     }
 
-    g_pix = (uint8_t*)calloc(1, 4 * 240 * 160);
+    g_pix = (uint8_t*)calloc(1, SIZE_PIX);
     if (g_pix == NULL) {
         systemMessage(MSG_OUT_OF_MEMORY, N_("Failed to allocate memory for %s"),
             "PIX");
@@ -1698,6 +1800,40 @@ int CPULoadRomData(const char* data, int size)
     return romSize;
 }
 
+int CPULoadRomData(const char* data, int size)
+{
+    return CPULoadRomImage(data, -1, size);
+}
+
+int CPUMapRom(const char* szFile)
+{
+#ifdef _WIN32
+    (void)szFile;
+    return 0;
+#else
+    int fd = open(szFile, O_RDONLY);
+    if (fd < 0) {
+        systemMessage(MSG_ERROR_OPENING_IMAGE, N_("Error opening image %s"), szFile);
+        return 0;
+    }
+    struct stat st;
+    int size = 0;
+    if (fstat(fd, &st) == 0 && st.st_size <= SIZE_ROM)
+        size = (int)st.st_size;
+    // The mapping outlives the descriptor.
+    int res = CPULoadRomImage(NULL, fd, size);
+    close(fd);
+    return res;
+#endif
+}
+
+bool CPUReserveRom()
+{
+    if (g_rom == NULL)
+        g_rom = romReserve();
+    return g_rom != NULL;
+}
+
 void doMirroring(bool b)
 {
     if (static_cast<size_t>(romSize) > k32MiB)
@@ -1716,10 +1852,12 @@ void doMirroring(bool b)
     if ((mirroredRomSize <= 0x800000) && (b)) {
         if (mirroredRomSize == 0)
             mirroredRomSize = 0x100000;
+        romFillOpenBus(mirroredRomSize);
         while (mirroredRomAddress < 0x01000000) {
             memcpy((uint16_t*)(g_rom + mirroredRomAddress), (uint16_t*)(g_rom), mirroredRomSize);
             mirroredRomAddress += mirroredRomSize;
         }
+        g_romEnd = mirroredRomAddress;
     }
 }
 
@@ -3396,6 +3534,7 @@ void CPUInit(const char* biosFileName, bool useBiosFile)
         ioReadable[i] = false;
 
     if (romSize < 0x1fe2000) {
+        gbaRomMaterialize(0x1fe209c, 4);
         *((uint16_t*)&g_rom[0x1fe209c]) = 0xdffa; // SWI 0xFA
         *((uint16_t*)&g_rom[0x1fe209e]) = 0x4770; // BX LR
     } else {
@@ -3714,6 +3853,69 @@ void CPUInterrupt()
 static uint32_t joy;
 static bool has_frames;
 
+// What a GbaContext keeps per machine on top of saveGameStruct: the memory it
+// owns, the bus, DMA and timer bookkeeping, the event scheduler, the frame skip
+// counter and the speed meter's clock.
+variable_desc cpuContextState[] = {
+    { &reg[0], sizeof(reg) },
+    { &map[0], sizeof(map) },
+    { &ioReadable[0], sizeof(ioReadable) },
+    { &stop, sizeof(uint32_t) },
+    { &g_bios, sizeof(uint8_t*) },
+    { &g_rom, sizeof(uint8_t*) },
+    { &g_romEnd, sizeof(uint32_t) },
+    { &g_romTailPages[0], sizeof(g_romTailPages) },
+    { &romSize, sizeof(int) },
+    { &g_internalRAM, sizeof(uint8_t*) },
+    { &g_workRAM, sizeof(uint8_t*) },
+    { &g_paletteRAM, sizeof(uint8_t*) },
+    { &g_vram, sizeof(uint8_t*) },
+    { &g_pix, sizeof(uint8_t*) },
+    { &g_oam, sizeof(uint8_t*) },
+    { &g_ioMem, sizeof(uint8_t*) },
+    { &biosProtected[0], sizeof(biosProtected) },
+    { &cpuPrefetch[0], sizeof(cpuPrefetch) },
+    { &memoryWait[0], sizeof(memoryWait) },
+    { &memoryWait32[0], sizeof(memoryWait32) },
+    { &memoryWaitSeq[0], sizeof(memoryWaitSeq) },
+    { &memoryWaitSeq32[0], sizeof(memoryWaitSeq32) },
+    { &busPrefetch, sizeof(bool) },
+    { &busPrefetchEnable, sizeof(bool) },
+    { &busPrefetchCount, sizeof(uint32_t) },
+    { &cpuDmaTicksToUpdate, sizeof(int) },
+    { &cpuDmaCount, sizeof(int) },
+    { &cpuDmaRunning, sizeof(bool) },
+    { &cpuDmaLast, sizeof(uint32_t) },
+    { &cpuDmaPC, sizeof(uint32_t) },
+    { &dummyAddress, sizeof(int) },
+    { &cpuBreakLoop, sizeof(bool) },
+    { &cpuNextEvent, sizeof(int) },
+    { &cpuTotalTicks, sizeof(int) },
+    { &intState, sizeof(bool) },
+    { &stopState, sizeof(bool) },
+    { &IRQTicks, sizeof(int) },
+    { &SWITicks, sizeof(int) },
+    { &layerEnableDelay, sizeof(int) },
+    { &timerOnOffDelay, sizeof(uint8_t) },
+    { &timer0Value, sizeof(uint16_t) },
+    { &timer1Value, sizeof(uint16_t) },
+    { &timer2Value, sizeof(uint16_t) },
+    { &timer3Value, sizeof(uint16_t) },
+    { &cpuSramEnabled, sizeof(bool) },
+    { &cpuFlashEnabled, sizeof(bool) },
+    { &cpuEEPROMEnabled, sizeof(bool) },
+    { &cpuEEPROMSensorEnabled, sizeof(bool) },
+    { &cpuSaveGameFunc, sizeof(cpuSaveGameFunc) },
+    { &renderLine, sizeof(renderLine) },
+    { &joy, sizeof(uint32_t) },
+    { &has_frames, sizeof(bool) },
+    { &frameCount, sizeof(int) },
+    { &lastTime, sizeof(uint32_t) },
+    { &mastercode, sizeof(uint32_t) },
+    { &coreOptions, sizeof(coreOptions) },
+    { NULL, 0 }
+};
+
 static void gbaUpdateJoypads(void)
 {
     // update joystick information
@@ -2,6 +2,7 @@
 #define VBAM_CORE_GBA_GBA_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "core/base/system.h"
 
@@ -125,6 +126,8 @@ extern bool CPUReadGSASnapshot(const char*);
 extern bool CPUReadGSASPSnapshot(const char*);
 extern bool CPUWriteGSASnapshot(const char*, const char*, const char*, const char*);
 extern bool CPUWriteBatteryFile(const char*);
+// Fills data with the save memory as CPUWriteBatteryFile stores it; false if there is none
+extern bool CPUWriteBatteryData(std::vector<uint8_t>& data);
 extern bool CPUReadBatteryFile(const char*);
 extern bool CPUExportEepromFile(const char*);
 extern bool CPUImportEepromFile(const char*);
@@ -144,6 +147,10 @@ extern bool CPUWriteState(const char*);
 #endif
 extern int CPULoadRom(const char*);
 extern int CPULoadRomData(const char* data, int size);
+// Maps a raw ROM image copy on write instead of reading it into memory.
+extern int CPUMapRom(const char* szFile);
+// Reserves an empty cartridge space so the CPU can be reset before a load.
+extern bool CPUReserveRom();
 extern void doMirroring(bool);
 extern void CPUUpdateRegister(uint32_t, uint16_t);
 extern void applyTimer();
@@ -167,8 +174,11 @@ void SetLoadDotCodeFile(const char* szFile);
 void ResetSaveDotCodeFile();
 void SetSaveDotCodeFile(const char* szFile);
 
-// Updates romSize and realloc rom pointer if needed after soft-patching
+// Updates romSize and the readable ROM extent after soft-patching
 void gbaUpdateRomSize(int size);
+// Makes [offset, offset + size) of cartridge space past the end of the ROM
+// writable: the open-bus pattern is stored there and later reads see it
+void gbaRomMaterialize(uint32_t offset, uint32_t size);
 
 extern struct EmulatedSystem GBASystem;
 
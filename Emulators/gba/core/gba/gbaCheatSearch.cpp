@@ -1,8 +1,15 @@
 #include "core/gba/gbaCheatSearch.h"
 
+#include <bitset>
 #include <cstdlib>
 #include <cstring>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 CheatSearchBlock cheatSearchBlocks[4];
 
 CheatSearchData cheatSearchData = {
@@ -10,84 +17,338 @@ CheatSearchData cheatSearchData = {
     cheatSearchBlocks
 };
 
-static bool cheatSearchEQ(uint32_t a, uint32_t b)
+// Searches run over 64 bytes of a block at a time, which is one 64-bit word of its
+// candidate bits: bit n of the word is byte n. A word with no candidates left is
+// skipped without reading the memory behind it. Within the word, 16 bytes are
+// compared at once and the result is already one bit per byte, set across every
+// byte of the values that fail. As in the scalar search, a value is only dropped
+// if the bit of its first byte is still set, and then all of its bytes are.
+static const int SEARCH_CHUNK = 64;
+static const int SEARCH_LANES = 16;
+
+// Every compare is one of these, possibly inverted: a != b is !(a == b),
+// a <= b is !(a > b), a >= b is !(b > a)
+enum { SEARCH_OP_EQ,
+    SEARCH_OP_GT,
+    SEARCH_OP_LT };
+
+static void cheatSearchOp(int compare, int* op, bool* invert)
 {
-    return a == b;
+    static const int ops[] = { SEARCH_OP_EQ, SEARCH_OP_EQ, SEARCH_OP_LT, SEARCH_OP_GT, SEARCH_OP_GT, SEARCH_OP_LT };
+    *op = ops[compare];
+    *invert = compare == SEARCH_NE || compare == SEARCH_LE || compare == SEARCH_GE;
 }
 
-static bool cheatSearchNE(uint32_t a, uint32_t b)
+static bool cheatSearchCompare(int compare, int64_t a, int64_t b)
 {
-    return a != b;
+    switch (compare) {
+    case SEARCH_EQ:
+        return a == b;
+    case SEARCH_NE:
+        return a != b;
+    case SEARCH_LT:
+        return a < b;
+    case SEARCH_LE:
+        return a <= b;
+    case SEARCH_GT:
+        return a > b;
+    default:
+        return a >= b;
+    }
 }
 
-static bool cheatSearchLT(uint32_t a, uint32_t b)
+template <bool Signed>
+static inline int64_t cheatSearchReadAs(const uint8_t* data, int off, int size)
 {
-    return a < b;
+    if (Signed)
+        return cheatSearchSignedRead((uint8_t*)data, off, size);
+    return cheatSearchRead((uint8_t*)data, off, size);
 }
 
-static bool cheatSearchLE(uint32_t a, uint32_t b)
+// Bits of the values whose first byte is still a candidate
+template <int Size>
+static inline uint64_t cheatSearchSpread(uint64_t alive)
 {
-    return a <= b;
+    if (Size == BITS_16) {
+        alive &= 0x5555555555555555ull;
+        return alive | (alive << 1);
+    }
+    if (Size == BITS_32)
+        return (alive & 0x1111111111111111ull) * 0xf;
+    return alive;
 }
 
-static bool cheatSearchGT(uint32_t a, uint32_t b)
+static inline uint64_t cheatSearchLoadBits(const uint8_t* bits)
 {
-    return a > b;
+    uint64_t word = 0;
+    for (int i = 0; i < 8; i++)
+        word |= (uint64_t)bits[i] << (i * 8);
+    return word;
 }
 
-static bool cheatSearchGE(uint32_t a, uint32_t b)
+static inline void cheatSearchStoreBits(uint8_t* bits, uint64_t word)
 {
-    return a >= b;
+    for (int i = 0; i < 8; i++)
+        bits[i] = (uint8_t)(word >> (i * 8));
 }
 
-static bool cheatSearchSignedEQ(int32_t a, int32_t b)
+#if defined(__SSE2__)
+
+typedef __m128i SearchVec;
+
+static inline SearchVec searchLoad(const uint8_t* p)
 {
-    return a == b;
+    return _mm_loadu_si128((const __m128i*)p);
 }
 
-static bool cheatSearchSignedNE(int32_t a, int32_t b)
+template <int Size>
+static inline SearchVec searchSplat(uint32_t value)
 {
-    return a != b;
+    if (Size == BITS_8)
+        return _mm_set1_epi8((char)value);
+    if (Size == BITS_16)
+        return _mm_set1_epi16((short)value);
+    return _mm_set1_epi32((int)value);
 }
 
-static bool cheatSearchSignedLT(int32_t a, int32_t b)
+template <int Size>
+static inline SearchVec searchEqual(SearchVec a, SearchVec b)
 {
-    return a < b;
+    if (Size == BITS_8)
+        return _mm_cmpeq_epi8(a, b);
+    if (Size == BITS_16)
+        return _mm_cmpeq_epi16(a, b);
+    return _mm_cmpeq_epi32(a, b);
 }
 
-static bool cheatSearchSignedLE(int32_t a, int32_t b)
+// SSE2 only compares signed lanes; flipping the sign bits orders unsigned ones the same way
+template <int Size, bool Signed>
+static inline SearchVec searchGreater(SearchVec a, SearchVec b)
 {
-    return a <= b;
+    if (!Signed) {
+        const SearchVec bias = searchSplat<Size>(Size == BITS_8 ? 0x80 : Size == BITS_16 ? 0x8000 : 0x80000000);
+        a = _mm_xor_si128(a, bias);
+        b = _mm_xor_si128(b, bias);
+    }
+    if (Size == BITS_8)
+        return _mm_cmpgt_epi8(a, b);
+    if (Size == BITS_16)
+        return _mm_cmpgt_epi16(a, b);
+    return _mm_cmpgt_epi32(a, b);
 }
 
-static bool cheatSearchSignedGT(int32_t a, int32_t b)
+static inline uint32_t searchMask(SearchVec m)
 {
-    return a > b;
+    return (uint32_t)_mm_movemask_epi8(m);
 }
 
-static bool cheatSearchSignedGE(int32_t a, int32_t b)
+#elif defined(__ARM_NEON)
+
+typedef uint8x16_t SearchVec;
+
+static inline SearchVec searchLoad(const uint8_t* p)
 {
-    return a >= b;
+    return vld1q_u8(p);
 }
 
-static bool (*cheatSearchFunc[])(uint32_t, uint32_t) = {
-    cheatSearchEQ,
-    cheatSearchNE,
-    cheatSearchLT,
-    cheatSearchLE,
-    cheatSearchGT,
-    cheatSearchGE
-};
+template <int Size>
+static inline SearchVec searchSplat(uint32_t value)
+{
+    if (Size == BITS_8)
+        return vdupq_n_u8((uint8_t)value);
+    if (Size == BITS_16)
+        return vreinterpretq_u8_u16(vdupq_n_u16((uint16_t)value));
+    return vreinterpretq_u8_u32(vdupq_n_u32(value));
+}
+
+template <int Size>
+static inline SearchVec searchEqual(SearchVec a, SearchVec b)
+{
+    if (Size == BITS_8)
+        return vceqq_u8(a, b);
+    if (Size == BITS_16)
+        return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+    return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+}
+
+template <int Size, bool Signed>
+static inline SearchVec searchGreater(SearchVec a, SearchVec b)
+{
+    if (Size == BITS_8)
+        return Signed ? vcgtq_s8(vreinterpretq_s8_u8(a), vreinterpretq_s8_u8(b)) : vcgtq_u8(a, b);
+    if (Size == BITS_16)
+        return vreinterpretq_u8_u16(Signed ? vcgtq_s16(vreinterpretq_s16_u8(a), vreinterpretq_s16_u8(b))
+                                           : vcgtq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+    return vreinterpretq_u8_u32(Signed ? vcgtq_s32(vreinterpretq_s32_u8(a), vreinterpretq_s32_u8(b))
+                                       : vcgtq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+}
+
+// NEON has no movemask: weight each byte by its bit, then add the halves up pairwise
+static inline uint32_t searchMask(SearchVec m)
+{
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t t = vandq_u8(m, vld1q_u8(weights));
+    uint8x8_t sum = vpadd_u8(vget_low_u8(t), vget_high_u8(t));
+    sum = vpadd_u8(sum, sum);
+    sum = vpadd_u8(sum, sum);
+    return vget_lane_u8(sum, 0) | ((uint32_t)vget_lane_u8(sum, 1) << 8);
+}
+
+#else
 
-static bool (*cheatSearchSignedFunc[])(int32_t, int32_t) = {
-    cheatSearchSignedEQ,
-    cheatSearchSignedNE,
-    cheatSearchSignedLT,
-    cheatSearchSignedLE,
-    cheatSearchSignedGT,
-    cheatSearchSignedGE
+struct SearchVec {
+    uint8_t b[SEARCH_LANES];
 };
 
+static inline SearchVec searchLoad(const uint8_t* p)
+{
+    SearchVec v;
+    memcpy(v.b, p, SEARCH_LANES);
+    return v;
+}
+
+template <int Size>
+static inline SearchVec searchSplat(uint32_t value)
+{
+    const int width = 1 << Size;
+    SearchVec v;
+    for (int i = 0; i < SEARCH_LANES; i++)
+        v.b[i] = (uint8_t)(value >> ((i % width) * 8));
+    return v;
+}
+
+template <int Size>
+static inline SearchVec searchEqual(SearchVec a, SearchVec b)
+{
+    const int width = 1 << Size;
+    SearchVec m;
+    for (int i = 0; i < SEARCH_LANES; i += width)
+        memset(m.b + i, cheatSearchReadAs<false>(a.b, i, Size) == cheatSearchReadAs<false>(b.b, i, Size) ? 0xff : 0, width);
+    return m;
+}
+
+template <int Size, bool Signed>
+static inline SearchVec searchGreater(SearchVec a, SearchVec b)
+{
+    const int width = 1 << Size;
+    SearchVec m;
+    for (int i = 0; i < SEARCH_LANES; i += width)
+        memset(m.b + i, cheatSearchReadAs<Signed>(a.b, i, Size) > cheatSearchReadAs<Signed>(b.b, i, Size) ? 0xff : 0, width);
+    return m;
+}
+
+static inline uint32_t searchMask(SearchVec m)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < SEARCH_LANES; i++)
+        mask |= (uint32_t)(m.b[i] >> 7) << i;
+    return mask;
+}
+
+#endif
+
+template <int Size, bool Signed>
+static inline uint32_t searchPass(SearchVec a, SearchVec b, int op)
+{
+    switch (op) {
+    case SEARCH_OP_EQ:
+        return searchMask(searchEqual<Size>(a, b));
+    case SEARCH_OP_GT:
+        return searchMask(searchGreater<Size, Signed>(a, b));
+    default:
+        return searchMask(searchGreater<Size, Signed>(b, a));
+    }
+}
+
+// Compares every candidate of the block with the same offset in saved, or with value
+// when saved is NULL
+template <int Size, bool Signed>
+static void cheatSearchBlock(CheatSearchBlock* block, const uint8_t* saved, uint32_t value, int compare)
+{
+    int op;
+    bool invert;
+    cheatSearchOp(compare, &op, &invert);
+
+    const SearchVec splat = searchSplat<Size>(value);
+    const int size = block->size;
+    const uint8_t* data = block->data;
+    uint8_t* bits = block->bits;
+    int j = 0;
+
+    for (; j + SEARCH_CHUNK <= size; j += SEARCH_CHUNK) {
+        const uint64_t alive = cheatSearchLoadBits(bits + (j >> 3));
+        if (!alive)
+            continue;
+
+        uint64_t pass = 0;
+        for (int k = 0; k < SEARCH_CHUNK; k += SEARCH_LANES) {
+            const SearchVec b = saved ? searchLoad(saved + j + k) : splat;
+            pass |= (uint64_t)searchPass<Size, Signed>(searchLoad(data + j + k), b, op) << k;
+        }
+        const uint64_t fail = invert ? pass : ~pass;
+        cheatSearchStoreBits(bits + (j >> 3), alive & ~(fail & cheatSearchSpread<Size>(alive)));
+    }
+
+    // Blocks that do not end on a chunk, such as GB HRAM, finish one value at a time
+    const int inc = 1 << Size;
+    for (; j + inc <= size; j += inc) {
+        if (!(IS_BIT_SET(bits, j)))
+            continue;
+
+        const int64_t a = cheatSearchReadAs<Signed>(data, j, Size);
+        const int64_t b = saved ? cheatSearchReadAs<Signed>(saved, j, Size) : Signed ? (int64_t)(int32_t)value : (int64_t)value;
+        if (!cheatSearchCompare(compare, a, b)) {
+            for (int k = 0; k < inc; k++)
+                CLEAR_BIT(bits, j + k);
+        }
+    }
+}
+
+template <int Size>
+static void cheatSearchBlock(CheatSearchBlock* block, const uint8_t* saved, uint32_t value, int compare, bool isSigned)
+{
+    if (isSigned)
+        cheatSearchBlock<Size, true>(block, saved, value, compare);
+    else
+        cheatSearchBlock<Size, false>(block, saved, value, compare);
+}
+
+static void cheatSearchBlocksFor(const CheatSearchData* cs, int compare, int size, bool isSigned, bool useSaved, uint32_t value)
+{
+    for (int i = 0; i < cs->count; i++) {
+        CheatSearchBlock* block = &cs->blocks[i];
+        const uint8_t* saved = useSaved ? block->saved : NULL;
+
+        switch (size) {
+        case BITS_16:
+            cheatSearchBlock<BITS_16>(block, saved, value, compare, isSigned);
+            break;
+        case BITS_32:
+            cheatSearchBlock<BITS_32>(block, saved, value, compare, isSigned);
+            break;
+        default:
+            cheatSearchBlock<BITS_8>(block, saved, value, compare, isSigned);
+            break;
+        }
+    }
+}
+
+static void cheatSearchClear(const CheatSearchData* cs, int size)
+{
+    const int inc = 1 << size;
+
+    for (int i = 0; i < cs->count; i++) {
+        CheatSearchBlock* block = &cs->blocks[i];
+
+        for (int j = 0; j + inc <= block->size; j += inc) {
+            if (!(IS_BIT_SET(block->bits, j)))
+                continue;
+            for (int k = 0; k < inc; k++)
+                CLEAR_BIT(block->bits, j + k);
+        }
+    }
+}
+
 void cheatSearchCleanup(CheatSearchData* cs)
 {
     int count = cs->count;
@@ -150,67 +411,8 @@ void cheatSearch(const CheatSearchData* cs, int compare, int size,
 {
     if (compare < 0 || compare > SEARCH_GE)
         return;
-    int inc = 1;
-    if (size == BITS_16)
-        inc = 2;
-    else if (size == BITS_32)
-        inc = 4;
 
-    if (isSigned) {
-        bool (*func)(int32_t, int32_t) = cheatSearchSignedFunc[compare];
-
-        for (int i = 0; i < cs->count; i++) {
-            CheatSearchBlock* block = &cs->blocks[i];
-            int size2 = block->size;
-            uint8_t* bits = block->bits;
-            uint8_t* data = block->data;
-            uint8_t* saved = block->saved;
-
-            for (int j = 0; j < size2; j += inc) {
-                if (IS_BIT_SET(bits, j)) {
-                    int32_t a = cheatSearchSignedRead(data, j, size);
-                    int32_t b = cheatSearchSignedRead(saved, j, size);
-
-                    if (!func(a, b)) {
-                        CLEAR_BIT(bits, j);
-                        if (size == BITS_16)
-                            CLEAR_BIT(bits, j + 1);
-                        if (size == BITS_32) {
-                            CLEAR_BIT(bits, j + 2);
-                            CLEAR_BIT(bits, j + 3);
-                        }
-                    }
-                }
-            }
-        }
-    } else {
-        bool (*func)(uint32_t, uint32_t) = cheatSearchFunc[compare];
-
-        for (int i = 0; i < cs->count; i++) {
-            CheatSearchBlock* block = &cs->blocks[i];
-            int size2 = block->size;
-            uint8_t* bits = block->bits;
-            uint8_t* data = block->data;
-            uint8_t* saved = block->saved;
-
-            for (int j = 0; j < size2; j += inc) {
-                if (IS_BIT_SET(bits, j)) {
-                    uint32_t a = cheatSearchRead(data, j, size);
-                    uint32_t b = cheatSearchRead(saved, j, size);
-
-                    if (!func(a, b)) {
-                        CLEAR_BIT(bits, j);
-                        if (size == BITS_16)
-                            CLEAR_BIT(bits, j + 1);
-                        if (size == BITS_32) {
-                            CLEAR_BIT(bits, j + 2);
-                            CLEAR_BIT(bits, j + 3);
-                        }
-                    }
-                }
-            }
-        }
-    }
+    cheatSearchBlocksFor(cs, compare, size, isSigned, true, 0);
 }
 
 void cheatSearchValue(const CheatSearchData* cs, int compare, int size,
@@ -218,68 +420,31 @@ void cheatSearchValue(const CheatSearchData* cs, int compare, int size,
 {
     if (compare < 0 || compare > SEARCH_GE)
         return;
-    int inc = 1;
-    if (size == BITS_16)
-        inc = 2;
-    else if (size == BITS_32)
-        inc = 4;
 
-    if (isSigned) {
-        bool (*func)(int32_t, int32_t) = cheatSearchSignedFunc[compare];
-
-        for (int i = 0; i < cs->count; i++) {
-            CheatSearchBlock* block = &cs->blocks[i];
-            int size2 = block->size;
-            uint8_t* bits = block->bits;
-            uint8_t* data = block->data;
-
-            for (int j = 0; j < size2; j += inc) {
-                if (IS_BIT_SET(bits, j)) {
-                    int32_t a = cheatSearchSignedRead(data, j, size);
-                    int32_t b = (int32_t)value;
-
-                    if (!func(a, b)) {
-                        CLEAR_BIT(bits, j);
-                        if (size == BITS_16)
-                            CLEAR_BIT(bits, j + 1);
-                        if (size == BITS_32) {
-                            CLEAR_BIT(bits, j + 2);
-                            CLEAR_BIT(bits, j + 3);
-                        }
-                    }
-                }
-            }
-        }
-    } else {
-        bool (*func)(uint32_t, uint32_t) = cheatSearchFunc[compare];
-
-        for (int i = 0; i < cs->count; i++) {
-            CheatSearchBlock* block = &cs->blocks[i];
-            int size2 = block->size;
-            uint8_t* bits = block->bits;
-            uint8_t* data = block->data;
-
-            for (int j = 0; j < size2; j += inc) {
-                if (IS_BIT_SET(bits, j)) {
-                    uint32_t a = cheatSearchRead(data, j, size);
-
-                    if (!func(a, value)) {
-                        CLEAR_BIT(bits, j);
-                        if (size == BITS_16)
-                            CLEAR_BIT(bits, j + 1);
-                        if (size == BITS_32) {
-                            CLEAR_BIT(bits, j + 2);
-                            CLEAR_BIT(bits, j + 3);
-                        }
-                    }
-                }
-            }
+    // A value the width cannot hold compares the same way with every candidate, so the
+    // search either keeps them all or drops them all
+    if (size == BITS_8 || size == BITS_16) {
+        const int bits = size == BITS_8 ? 8 : 16;
+        const int64_t wanted = isSigned ? (int64_t)(int32_t)value : (int64_t)value;
+        const int64_t min = isSigned ? -((int64_t)1 << (bits - 1)) : 0;
+        const int64_t max = isSigned ? ((int64_t)1 << (bits - 1)) - 1 : ((int64_t)1 << bits) - 1;
+
+        if (wanted < min || wanted > max) {
+            if (!cheatSearchCompare(compare, wanted < min ? max : min, wanted))
+                cheatSearchClear(cs, size);
+            return;
         }
     }
+
+    cheatSearchBlocksFor(cs, compare, size, isSigned, false, value);
 }
 
 int cheatSearchGetCount(const CheatSearchData* cs, int size)
 {
+    // Only the first byte of each value counts
+    static const uint64_t firstBytes[] = { ~0ull, 0x5555555555555555ull, 0x1111111111111111ull };
+    const uint64_t counted = firstBytes[size == BITS_16 ? 1 : size == BITS_32 ? 2 : 0];
+
     int res = 0;
     int inc = 1;
     if (size == BITS_16)
@@ -292,7 +457,10 @@ int cheatSearchGetCount(const CheatSearchData* cs, int size)
 
         int size2 = block->size;
         uint8_t* bits = block->bits;
-        for (int j = 0; j < size2; j += inc) {
+        int j = 0;
+        for (; j + SEARCH_CHUNK <= size2; j += SEARCH_CHUNK)
+            res += (int)std::bitset<64>(cheatSearchLoadBits(bits + (j >> 3)) & counted).count();
+        for (; j < size2; j += inc) {
             if (IS_BIT_SET(bits, j))
                 res++;
         }
@@ -200,6 +200,24 @@ uint8_t cheatsCBACurrentSeed[12] = {
 uint32_t seeds_v1[4];
 uint32_t seeds_v3[4];
 
+// What a GbaContext keeps per machine besides the cheatsList entries in use:
+// the list length, ROM patches and the CodeBreaker/Action Replay decryption
+// state. The CodeBreaker table is derived data and shared.
+variable_desc cheatsContextState[] = {
+    { &cheatsNumber, sizeof(int) },
+    { &rompatch2addr[0], sizeof(rompatch2addr) },
+    { &rompatch2val[0], sizeof(rompatch2val) },
+    { &rompatch2oldval[0], sizeof(rompatch2oldval) },
+    { &cheatsCBASeedBuffer[0], sizeof(cheatsCBASeedBuffer) },
+    { &cheatsCBASeed[0], sizeof(cheatsCBASeed) },
+    { &cheatsCBATemporaryValue, sizeof(uint32_t) },
+    { &super, sizeof(uint16_t) },
+    { &cheatsCBACurrentSeed[0], sizeof(cheatsCBACurrentSeed) },
+    { &seeds_v1[0], sizeof(seeds_v1) },
+    { &seeds_v3[0], sizeof(seeds_v3) },
+    { NULL, 0 }
+};
+
 uint32_t seed_gen(uint8_t upper, uint8_t seed, uint8_t* deadtable1, uint8_t* deadtable2);
 
 //seed tables for AR v1
@@ -278,31 +296,43 @@ uint8_t v3_deadtable2[256] = {
     0xFC, 0x31, 0x09, 0x48, 0xA3, 0xFF, 0x92, 0x12, 0x58, 0xE9, 0xFA, 0xAE, 0x4F, 0xE2, 0xB4, 0xCC
 };
 
-#define debuggerReadMemory(addr) \
-    READ32LE((&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
+#define debuggerReadMemory(addr) CPUReadMemoryQuick(addr)
 
-#define debuggerReadHalfWord(addr) \
-    READ16LE((&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
+#define debuggerReadHalfWord(addr) CPUReadHalfWordQuick(addr)
 
-#define debuggerReadByte(addr) \
-    map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]
+#define debuggerReadByte(addr) CPUReadByteQuick(addr)
 
-#define debuggerWriteMemory(addr, value) \
-    WRITE32LE(&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask], value)
+#define debuggerWriteMemory(addr, value)                                           \
+    do {                                                                           \
+        CPUMaterializeRom((addr), 4);                                              \
+        WRITE32LE(&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask], value); \
+    } while (0)
 
-#define debuggerWriteHalfWord(addr, value) \
-    WRITE16LE(&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask], value)
+#define debuggerWriteHalfWord(addr, value)                                         \
+    do {                                                                           \
+        CPUMaterializeRom((addr), 2);                                              \
+        WRITE16LE(&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask], value); \
+    } while (0)
 
-#define debuggerWriteByte(addr, value) \
-    map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask] = (value)
+#define debuggerWriteByte(addr, value)                                             \
+    do {                                                                           \
+        CPUMaterializeRom((addr), 1);                                              \
+        map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask] = (value);       \
+    } while (0)
 
 #define CHEAT_IS_HEX(a) (((a) >= 'A' && (a) <= 'F') || ((a) >= '0' && (a) <= '9'))
 
-#define CHEAT_PATCH_ROM_16BIT(a, v) \
-    WRITE16LE(((uint16_t*)&g_rom[(a)&0x1ffffff]), v);
-
-#define CHEAT_PATCH_ROM_32BIT(a, v) \
-    WRITE32LE(((uint32_t*)&g_rom[(a)&0x1ffffff]), v);
+#define CHEAT_PATCH_ROM_16BIT(a, v)                           \
+    do {                                                      \
+        gbaRomMaterialize((a)&0x1ffffff, 2);                  \
+        WRITE16LE(((uint16_t*)&g_rom[(a)&0x1ffffff]), v);     \
+    } while (0)
+
+#define CHEAT_PATCH_ROM_32BIT(a, v)                           \
+    do {                                                      \
+        gbaRomMaterialize((a)&0x1ffffff, 4);                  \
+        WRITE32LE(((uint32_t*)&g_rom[(a)&0x1ffffff]), v);     \
+    } while (0)
 
 static bool isMultilineWithData(int i)
 {
@@ -0,0 +1,144 @@
+#include "core/gba/gbaContext.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "core/base/file_util.h"
+#include "core/gba/gba.h"
+#include "core/gba/gbaCheats.h"
+#include "core/gba/gbaCpu.h"
+#include "core/gba/gbaGlobals.h"
+#include "core/gba/gbaSound.h"
+
+extern variable_desc saveGameStruct[];
+extern variable_desc cpuContextState[];
+extern variable_desc gfxContextState[];
+extern variable_desc eepromContextState[];
+extern variable_desc flashContextState[];
+extern variable_desc rtcContextState[];
+extern variable_desc soundContextState[];
+extern variable_desc cheatsContextState[];
+
+// saveGameStruct covers the I/O register mirrors, timers and DMA; the rest is
+// state the save format rebuilds on load or never needed
+static variable_desc* const contextTables[] = {
+    saveGameStruct,
+    cpuContextState,
+    gfxContextState,
+    eepromContextState,
+    flashContextState,
+    rtcContextState,
+    soundContextState,
+    cheatsContextState,
+};
+
+struct GbaContext {
+    std::vector<uint8_t> parked; // state while another context is live
+    std::vector<CheatsData> cheats; // the cheatsNumber entries of cheatsList in use
+};
+
+static GbaContext defaultContext;
+static GbaContext* liveContext = &defaultContext;
+
+static size_t contextSize()
+{
+    static size_t size = 0;
+    if (size == 0) {
+        for (variable_desc* table : contextTables) {
+            for (variable_desc* var = table; var->address; var++)
+                size += var->size;
+        }
+    }
+    return size;
+}
+
+static void contextPark(GbaContext* context)
+{
+    context->parked.resize(contextSize());
+    uint8_t* data = context->parked.data();
+    for (variable_desc* table : contextTables) {
+        for (variable_desc* var = table; var->address; var++) {
+            memcpy(data, var->address, var->size);
+            data += var->size;
+        }
+    }
+    context->cheats.assign(cheatsList, cheatsList + cheatsNumber);
+}
+
+static void contextRestore(GbaContext* context)
+{
+    const uint8_t* data = context->parked.data();
+    for (variable_desc* table : contextTables) {
+        for (variable_desc* var = table; var->address; var++) {
+            memcpy(var->address, data, var->size);
+            data += var->size;
+        }
+    }
+    std::copy(context->cheats.begin(), context->cheats.end(), cheatsList);
+}
+
+GbaContext* gbaContextDefault()
+{
+    return &defaultContext;
+}
+
+GbaContext* gbaContextCurrent()
+{
+    return liveContext;
+}
+
+GbaContext* gbaContextCreate()
+{
+    GbaContext* context = new GbaContext;
+
+    // Snapshot the live machine with its memory and sound buffers taken out,
+    // then put everything back
+    contextPark(liveContext);
+
+    g_bios = NULL;
+    g_rom = NULL;
+    g_romEnd = 0;
+    memset(g_romTailPages, 0, sizeof(g_romTailPages));
+    g_internalRAM = NULL;
+    g_workRAM = NULL;
+    g_paletteRAM = NULL;
+    g_vram = NULL;
+    g_pix = NULL;
+    g_oam = NULL;
+    g_ioMem = NULL;
+    memset(map, 0, sizeof(map));
+    soundDetachContext();
+    cheatsNumber = 0;
+    mastercode = 0;
+
+    contextPark(context);
+    contextRestore(liveContext);
+    return context;
+}
+
+void gbaContextDestroy(GbaContext* context)
+{
+    if (context == liveContext || context == &defaultContext)
+        return;
+
+    GbaContext* live = liveContext;
+    contextPark(live);
+    contextRestore(context);
+
+    CPUCleanUp();
+    soundReleaseContext();
+
+    contextRestore(live);
+    delete context;
+}
+
+void gbaContextActivate(GbaContext* context)
+{
+    if (context == liveContext)
+        return;
+
+    contextPark(liveContext);
+    contextRestore(context);
+    liveContext = context;
+}
@@ -0,0 +1,35 @@
+#ifndef VBAM_CORE_GBA_GBACONTEXT_H_
+#define VBAM_CORE_GBA_GBACONTEXT_H_
+
+// One emulated GBA. The core itself runs on globals, so exactly one context
+// is live at a time: activating another one parks the live machine (CPU, I/O,
+// timers, renderer, backup chip, RTC and APU state, plus the pointers to the
+// memory it owns) in its context and moves the other one in. That copies about
+// 150 KB each way, most of it the flash backup image, plus the cheats in use.
+// Cheats and frame skip/speed timing belong to the context.
+//
+// Host-side pieces are shared by all contexts: the system* callbacks, the
+// sound driver and mixer settings and color maps.
+//
+// Single-threaded only. Because the live context is the process-wide globals,
+// two contexts can never run at the same time: create, destroy, activate and
+// run them all from one thread, and never call into the core from another
+// thread while a switch may happen.
+struct GbaContext;
+
+// The context that owns whatever state the core was in before the first call
+// into this API. It is never destroyed.
+GbaContext* gbaContextDefault();
+GbaContext* gbaContextCurrent();
+
+// A new machine with the live context's options but no memory, sound buffers
+// or cheats of its own. Activate it and set it up like a fresh core: allocate
+// memory, soundInit(), CPUInit() and load a ROM.
+GbaContext* gbaContextCreate();
+
+// Frees the context's memory and sound buffers. Must not be the live context.
+void gbaContextDestroy(GbaContext* context);
+
+void gbaContextActivate(GbaContext* context);
+
+#endif // VBAM_CORE_GBA_GBACONTEXT_H_
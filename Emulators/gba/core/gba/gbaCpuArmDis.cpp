@@ -8,6 +8,7 @@
 #include "core/base/port.h"
 #include "core/gba/gba.h"
 #include "core/gba/gbaElf.h"
+#include "core/gba/gbaInline.h"
 
 struct Opcodes {
     uint32_t mask;
@@ -15,14 +16,11 @@ struct Opcodes {
     const char* mnemonic;
 };
 
-#define debuggerReadMemory(addr) \
-    READ32LE(((uint32_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
+#define debuggerReadMemory(addr) CPUReadMemoryQuick(addr)
 
-#define debuggerReadHalfWord(addr) \
-    READ16LE(((uint16_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
+#define debuggerReadHalfWord(addr) CPUReadHalfWordQuick(addr)
 
-#define debuggerReadByte(addr) \
-    map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]
+#define debuggerReadByte(addr) CPUReadByteQuick(addr)
 
 const char hdig[] = "0123456789abcdef";
 
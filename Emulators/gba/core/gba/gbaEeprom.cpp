@@ -29,6 +29,19 @@ variable_desc eepromSaveData[] = {
     { NULL, 0 }
 };
 
+// Unlike the save state, a GbaContext keeps the whole chip
+variable_desc eepromContextState[] = {
+    { &eepromMode, sizeof(int) },
+    { &eepromByte, sizeof(int) },
+    { &eepromBits, sizeof(int) },
+    { &eepromAddress, sizeof(int) },
+    { &eepromInUse, sizeof(bool) },
+    { &eepromSize, sizeof(int) },
+    { &eepromData[0], sizeof(eepromData) },
+    { &eepromBuffer[0], sizeof(eepromBuffer) },
+    { NULL, 0 }
+};
+
 void eepromInit()
 {
     eepromInUse = false;
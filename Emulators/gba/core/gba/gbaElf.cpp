@@ -8,9 +8,9 @@
 #include "core/base/port.h"
 #include "core/gba/gba.h"
 #include "core/gba/gbaGlobals.h"
+#include "core/gba/gbaInline.h"
 
-#define elfReadMemory(addr) \
-    READ32LE((&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
+#define elfReadMemory(addr) CPUReadMemoryQuick(addr)
 
 #define DW_TAG_array_type 0x01
 #define DW_TAG_enumeration_type 0x04
@@ -236,31 +236,106 @@ int elfFdeCount = 0;
 
 CompileUnit* elfCurrentUnit = NULL;
 
+// Compile units, functions, objects and types are carved out of large chunks and
+// released together by elfCleanUp()
+struct ELFArenaChunk {
+    ELFArenaChunk* next;
+    size_t used;
+    size_t size;
+};
+
+ELFArenaChunk* elfArena = NULL;
+
 uint32_t elfRead4Bytes(uint8_t*);
 uint16_t elfRead2Bytes(uint8_t*);
+uint8_t* elfParseCompileUnitChildren(uint8_t* data, CompileUnit* unit);
+void elfParseLineInfo(CompileUnit* unit);
+
+void* elfArenaAlloc(size_t size)
+{
+    size = (size + 7) & ~(size_t)7;
+
+    ELFArenaChunk* chunk = elfArena;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        size_t chunkSize = size > 0x10000 ? size : 0x10000;
+        chunk = (ELFArenaChunk*)malloc(sizeof(ELFArenaChunk) + chunkSize);
+        chunk->next = elfArena;
+        chunk->used = 0;
+        chunk->size = chunkSize;
+        elfArena = chunk;
+    }
+
+    void* p = (uint8_t*)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    memset(p, 0, size);
+    return p;
+}
+
+void elfArenaFree()
+{
+    while (elfArena) {
+        ELFArenaChunk* next = elfArena->next;
+        free(elfArena);
+        elfArena = next;
+    }
+}
+
+// Units are only read up to their first child when the file is loaded; the rest
+// of their DIEs are parsed the first time something is looked up in them
+void elfLoadCompileUnit(CompileUnit* unit)
+{
+    if (unit->parsed)
+        return;
+
+    unit->parsed = true;
+    if (unit->children) {
+        elfCurrentUnit = unit;
+        elfParseCompileUnitChildren(unit->children, unit);
+    }
+}
+
+bool elfLoadLineInfo(CompileUnit* unit)
+{
+    if (unit->hasLineInfo && unit->lineInfoTable == NULL) {
+        elfParseLineInfo(unit);
+        if (unit->lineInfoTable == NULL)
+            unit->hasLineInfo = false;
+    }
+    return unit->hasLineInfo;
+}
 
 CompileUnit* elfGetCompileUnit(uint32_t addr)
 {
-    if (elfCompileUnits) {
-        CompileUnit* unit = elfCompileUnits;
-        while (unit) {
-            if (unit->lowPC) {
-                if (addr >= unit->lowPC && addr < unit->highPC)
-                    return unit;
-            } else {
-                ARanges* r = unit->ranges;
-                if (r) {
-                    int count = r->count;
-                    for (int j = 0; j < count; j++) {
-                        if (addr >= r->ranges[j].lowPC && addr < r->ranges[j].highPC)
-                            return unit;
-                    }
-                }
-            }
-            unit = unit->next;
+    if (elfDebugInfo == NULL)
+        return NULL;
+
+    // find the last range starting at or below addr
+    UnitRange* ranges = elfDebugInfo->unitRanges;
+    int low = 0;
+    int high = elfDebugInfo->numUnitRanges;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (ranges[mid].lowPC <= addr)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    // ranges can nest or overlap, so check every earlier one that still reaches addr
+    // and keep the unit that comes first in elfCompileUnits
+    CompileUnit* unit = NULL;
+    int order = 0;
+    for (int i = low - 1; i >= 0 && ranges[i].maxHighPC > addr; i--) {
+        if (addr < ranges[i].highPC && (unit == NULL || ranges[i].order < order)) {
+            unit = ranges[i].unit;
+            order = ranges[i].order;
         }
     }
-    return NULL;
+    if (unit == NULL)
+        return NULL;
+
+    elfLoadCompileUnit(unit);
+    return unit;
 }
 
 const char* elfGetAddressSymbol(uint32_t addr)
@@ -322,7 +397,7 @@ bool elfFindLineInModule(uint32_t* addr, const char* name, int line)
     CompileUnit* unit = elfCompileUnits;
 
     while (unit) {
-        if (unit->lineInfoTable) {
+        if (elfLoadLineInfo(unit)) {
             int i;
             int count = unit->lineInfoTable->fileCount;
             char* found = NULL;
@@ -354,7 +429,7 @@ bool elfFindLineInModule(uint32_t* addr, const char* name, int line)
 int elfFindLine(CompileUnit* unit, Function* /* func */, uint32_t addr, const char** f)
 {
     int currentLine = -1;
-    if (unit->hasLineInfo) {
+    if (elfLoadLineInfo(unit)) {
         int count = unit->lineInfoTable->number;
         LineInfoItem* table = unit->lineInfoTable->lines;
         int i;
@@ -372,7 +447,7 @@ int elfFindLine(CompileUnit* unit, Function* /* func */, uint32_t addr, const ch
 
 bool elfFindLineInUnit(uint32_t* addr, CompileUnit* unit, int line)
 {
-    if (unit->hasLineInfo) {
+    if (elfLoadLineInfo(unit)) {
         int count = unit->lineInfoTable->number;
         LineInfoItem* table = unit->lineInfoTable->lines;
         int i;
@@ -438,6 +513,7 @@ bool elfGetObject(const char* name, Function* f, CompileUnit* u, Object** o)
 
     while (c) {
         if (c != u) {
+            elfLoadCompileUnit(c);
             Object* v = c->variables;
             while (v) {
                 if (strcmp(name, v->name) == 0) {
@@ -1136,20 +1212,17 @@ void elfAddLine(LineInfo* l, uint32_t a, int file, int line, int* max)
     l->number++;
 }
 
-void elfParseLineInfo(CompileUnit* unit, uint8_t* top)
+void elfParseLineInfo(CompileUnit* unit)
 {
-    ELFSectionHeader* h = elfGetSectionByName(".debug_line");
-    if (h == NULL) {
-        fprintf(stderr, "No line information found\n");
+    if (elfDebugInfo->linedata == NULL)
         return;
-    }
+
     LineInfo* l = unit->lineInfoTable = (LineInfo*)calloc(1, sizeof(LineInfo));
     l->number = 0;
     int max = 1000;
     l->lines = (LineInfoItem*)malloc(1000 * sizeof(LineInfoItem));
 
-    uint8_t* data = elfReadSection(top, h);
-    data += unit->lineInfo;
+    uint8_t* data = elfDebugInfo->linedata + unit->lineInfo;
     uint32_t totalLen = elfRead4Bytes(data);
     data += 4;
     uint8_t* end = data + totalLen;
@@ -1364,13 +1437,13 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
     } break;
     case DW_TAG_union_type:
     case DW_TAG_structure_type: {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
         if (abbrev->tag == DW_TAG_structure_type)
             t->type = TYPE_struct;
         else
             t->type = TYPE_union;
 
-        Struct* s = (Struct*)calloc(sizeof(Struct), 1);
+        Struct* s = (Struct*)elfArenaAlloc(sizeof(Struct));
         t->structure = s;
         elfAddType(t, unit, offset);
 
@@ -1484,7 +1557,7 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
         return;
     } break;
     case DW_TAG_base_type: {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
 
         t->type = TYPE_base;
         elfAddType(t, unit, offset);
@@ -1516,7 +1589,7 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
         return;
     } break;
     case DW_TAG_pointer_type: {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
 
         t->type = TYPE_pointer;
 
@@ -1543,7 +1616,7 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
         return;
     } break;
     case DW_TAG_reference_type: {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
 
         t->type = TYPE_reference;
 
@@ -1612,9 +1685,9 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
         return;
     } break;
     case DW_TAG_enumeration_type: {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
         t->type = TYPE_enum;
-        Enum* e = (Enum*)calloc(sizeof(Enum), 1);
+        Enum* e = (Enum*)elfArenaAlloc(sizeof(Enum));
         t->enumeration = e;
         elfAddType(t, unit, offset);
         int count = 0;
@@ -1679,9 +1752,9 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
         return;
     } break;
     case DW_TAG_subroutine_type: {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
         t->type = TYPE_function;
-        FunctionType* f = (FunctionType*)calloc(sizeof(FunctionType), 1);
+        FunctionType* f = (FunctionType*)elfArenaAlloc(sizeof(FunctionType));
         t->function = f;
         elfAddType(t, unit, offset);
         for (int i = 0; i < abbrev->numAttrs; i++) {
@@ -1739,8 +1812,8 @@ void elfParseType(uint8_t* data, uint32_t offset, ELFAbbrev* abbrev, CompileUnit
     case DW_TAG_array_type: {
         uint32_t typeref = 0;
         int i;
-        Array* array = (Array*)calloc(sizeof(Array), 1);
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Array* array = (Array*)elfArenaAlloc(sizeof(Array));
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
         t->type = TYPE_array;
         elfAddType(t, unit, offset);
 
@@ -1823,7 +1896,7 @@ Type* elfParseType(CompileUnit* unit, uint32_t offset)
         t = t->next;
     }
     if (offset == 0) {
-        Type* t = (Type*)calloc(sizeof(Type), 1);
+        Type* t = (Type*)elfArenaAlloc(sizeof(Type));
         t->type = TYPE_void;
         t->offset = 0;
         elfAddType(t, unit, 0);
@@ -1899,7 +1972,7 @@ void elfGetObjectAttributes(CompileUnit* unit, uint32_t offset, Object* o)
 uint8_t* elfParseObject(uint8_t* data, ELFAbbrev* abbrev, CompileUnit* unit,
     Object** object)
 {
-    Object* o = (Object*)calloc(sizeof(Object), 1);
+    Object* o = (Object*)elfArenaAlloc(sizeof(Object));
 
     o->next = NULL;
 
@@ -2109,7 +2182,7 @@ void elfGetFunctionAttributes(CompileUnit* unit, uint32_t offset, Function* func
 uint8_t* elfParseFunction(uint8_t* data, ELFAbbrev* abbrev, CompileUnit* unit,
     Function** f)
 {
-    Function* func = (Function*)calloc(sizeof(Function), 1);
+    Function* func = (Function*)elfArenaAlloc(sizeof(Function));
     *f = func;
 
     int bytes;
@@ -2178,7 +2251,6 @@ uint8_t* elfParseFunction(uint8_t* data, ELFAbbrev* abbrev, CompileUnit* unit,
 
     if (declaration) {
         elfCleanUp(func);
-        free(func);
         *f = NULL;
 
         while (1) {
@@ -2390,7 +2462,7 @@ CompileUnit* elfParseCompUnit(uint8_t* data, uint8_t* abbrevData)
 
     ELFAbbrev* abbrev = elfGetAbbrev(abbrevs, abbrevNum);
 
-    CompileUnit* unit = (CompileUnit*)calloc(sizeof(CompileUnit), 1);
+    CompileUnit* unit = (CompileUnit*)elfArenaAlloc(sizeof(CompileUnit));
     unit->top = top;
     unit->length = length;
     unit->abbrevs = abbrevs;
@@ -2434,7 +2506,7 @@ CompileUnit* elfParseCompUnit(uint8_t* data, uint8_t* abbrevData)
     }
 
     if (abbrev->hasChildren)
-        elfParseCompileUnitChildren(data, unit);
+        unit->children = data;
 
     return unit;
 }
@@ -2541,6 +2613,60 @@ void elfReadSymtab(uint8_t* data)
     //  free(symtab);
 }
 
+int elfCompareUnitRanges(const void* a, const void* b)
+{
+    uint32_t x = ((const UnitRange*)a)->lowPC;
+    uint32_t y = ((const UnitRange*)b)->lowPC;
+    return x < y ? -1 : x > y;
+}
+
+void elfAddUnitRange(UnitRange* ranges, int* count, uint32_t lowPC, uint32_t highPC, CompileUnit* unit, int order)
+{
+    if (lowPC < highPC) {
+        ranges[*count].lowPC = lowPC;
+        ranges[*count].highPC = highPC;
+        ranges[*count].order = order;
+        ranges[*count].unit = unit;
+        (*count)++;
+    }
+}
+
+void elfBuildUnitRanges()
+{
+    int max = 0;
+    CompileUnit* unit;
+    for (unit = elfCompileUnits; unit; unit = unit->next) {
+        if (unit->lowPC)
+            max++;
+        else if (unit->ranges)
+            max += unit->ranges->count;
+    }
+
+    UnitRange* ranges = (UnitRange*)malloc(sizeof(UnitRange) * (max + 1));
+    int count = 0;
+    int order = 0;
+    for (unit = elfCompileUnits; unit; unit = unit->next, order++) {
+        if (unit->lowPC) {
+            elfAddUnitRange(ranges, &count, unit->lowPC, unit->highPC, unit, order);
+        } else if (unit->ranges) {
+            ARanges* r = unit->ranges;
+            for (int j = 0; j < r->count; j++)
+                elfAddUnitRange(ranges, &count, r->ranges[j].lowPC, r->ranges[j].highPC, unit, order);
+        }
+    }
+    qsort(ranges, count, sizeof(UnitRange), elfCompareUnitRanges);
+
+    uint32_t maxHighPC = 0;
+    for (int i = 0; i < count; i++) {
+        if (ranges[i].highPC > maxHighPC)
+            maxHighPC = ranges[i].highPC;
+        ranges[i].maxHighPC = maxHighPC;
+    }
+
+    elfDebugInfo->numUnitRanges = count;
+    elfDebugInfo->unitRanges = ranges;
+}
+
 bool elfReadProgram(ELFHeader* eh, uint8_t* data, unsigned long data_size, int& size, bool parseDebug)
 {
     int count = READ16LE(&eh->e_phnum);
@@ -2583,6 +2709,7 @@ bool elfReadProgram(ELFHeader* eh, uint8_t* data, unsigned long data_size, int&
             unsigned effective_address = address - 0x8000000;
 
             if (effective_address + section_size < SIZE_ROM) {
+                gbaRomMaterialize(effective_address, section_size);
                 memcpy(&g_rom[effective_address], source, section_size);
                 size += section_size;
             }
@@ -2631,6 +2758,7 @@ bool elfReadProgram(ELFHeader* eh, uint8_t* data, unsigned long data_size, int&
                 }
             } else {
                 if (READ32LE(&sh[i]->addr) >= 0x8000000 && READ32LE(&sh[i]->addr) <= 0x9ffffff) {
+                    gbaRomMaterialize(READ32LE(&sh[i]->addr) & 0x1ffffff, READ32LE(&sh[i]->size));
                     memcpy(&g_rom[READ32LE(&sh[i]->addr) & 0x1ffffff],
                         data + READ32LE(&sh[i]->offset),
                         READ32LE(&sh[i]->size));
@@ -2657,6 +2785,13 @@ bool elfReadProgram(ELFHeader* eh, uint8_t* data, unsigned long data_size, int&
 
         elfDebugInfo = (DebugInfo*)calloc(sizeof(DebugInfo), 1);
         uint8_t* abbrevdata = elfReadSection(data, h);
+        elfDebugInfo->abbrevdata = abbrevdata;
+
+        h = elfGetSectionByName(".debug_line");
+        if (h == NULL)
+            fprintf(stderr, "No line information found\n");
+        else
+            elfDebugInfo->linedata = elfReadSection(data, h);
 
         h = elfGetSectionByName(".debug_str");
 
@@ -2680,7 +2815,6 @@ bool elfReadProgram(ELFHeader* eh, uint8_t* data, unsigned long data_size, int&
         while (ddata < end) {
             unit = elfParseCompUnit(ddata, abbrevdata);
             unit->offset = (uint32_t)(ddata - debugdata);
-            elfParseLineInfo(unit, data);
             if (last == NULL)
                 elfCompileUnits = unit;
             else
@@ -2699,6 +2833,7 @@ bool elfReadProgram(ELFHeader* eh, uint8_t* data, unsigned long data_size, int&
                 }
             comp = comp->next;
         }
+        elfBuildUnitRanges();
         elfParseCFA(data);
         elfReadSymtab(data);
     }
@@ -2754,21 +2889,10 @@ void elfCleanUp(Object* o)
 
 void elfCleanUp(Function* func)
 {
-    Object* o = func->parameters;
-    while (o) {
+    for (Object* o = func->parameters; o; o = o->next)
         elfCleanUp(o);
-        Object* next = o->next;
-        free(o);
-        o = next;
-    }
-
-    o = func->variables;
-    while (o) {
+    for (Object* o = func->variables; o; o = o->next)
         elfCleanUp(o);
-        Object* next = o->next;
-        free(o);
-        o = next;
-    }
     free(func->frameBase);
 }
 
@@ -2792,21 +2916,13 @@ void elfCleanUp(Type* t)
     switch (t->type) {
     case TYPE_function:
         if (t->function) {
-            Object* o = t->function->args;
-            while (o) {
+            for (Object* o = t->function->args; o; o = o->next)
                 elfCleanUp(o);
-                Object* next = o->next;
-                free(o);
-                o = next;
-            }
-            free(t->function);
         }
         break;
     case TYPE_array:
-        if (t->array) {
+        if (t->array)
             free(t->array->bounds);
-            free(t->array);
-        }
         break;
     case TYPE_struct:
     case TYPE_union:
@@ -2815,14 +2931,11 @@ void elfCleanUp(Type* t)
                 free(t->structure->members[i].location);
             }
             free(t->structure->members);
-            free(t->structure);
         }
         break;
     case TYPE_enum:
-        if (t->enumeration) {
+        if (t->enumeration)
             free(t->enumeration->members);
-            free(t->enumeration);
-        }
         break;
     case TYPE_base:
     case TYPE_pointer:
@@ -2836,27 +2949,12 @@ void elfCleanUp(CompileUnit* comp)
 {
     elfCleanUp(comp->abbrevs);
     free(comp->abbrevs);
-    Function* func = comp->functions;
-    while (func) {
+    for (Function* func = comp->functions; func; func = func->next)
         elfCleanUp(func);
-        Function* next = func->next;
-        free(func);
-        func = next;
-    }
-    Type* t = comp->types;
-    while (t) {
+    for (Type* t = comp->types; t; t = t->next)
         elfCleanUp(t);
-        Type* next = t->next;
-        free(t);
-        t = next;
-    }
-    Object* o = comp->variables;
-    while (o) {
+    for (Object* o = comp->variables; o; o = o->next)
         elfCleanUp(o);
-        Object* next = o->next;
-        free(o);
-        o = next;
-    }
     if (comp->lineInfoTable) {
         free(comp->lineInfoTable->lines);
         free(comp->lineInfoTable->files);
@@ -2866,15 +2964,11 @@ void elfCleanUp(CompileUnit* comp)
 
 void elfCleanUp()
 {
-    CompileUnit* comp = elfCompileUnits;
-
-    while (comp) {
+    for (CompileUnit* comp = elfCompileUnits; comp; comp = comp->next)
         elfCleanUp(comp);
-        CompileUnit* next = comp->next;
-        free(comp);
-        comp = next;
-    }
     elfCompileUnits = NULL;
+    elfCurrentUnit = NULL;
+    elfArenaFree();
     free(elfSymbols);
     elfSymbols = NULL;
     //  free(elfSymbolsStrTab);
@@ -2888,6 +2982,7 @@ void elfCleanUp()
             free(elfDebugInfo->ranges[i].ranges);
         }
         free(elfDebugInfo->ranges);
+        free(elfDebugInfo->unitRanges);
         free(elfDebugInfo);
         elfDebugInfo = NULL;
     }
@@ -214,6 +214,9 @@ struct CompileUnit {
     uint32_t length;
     uint8_t* top;
     uint32_t offset;
+    // First child DIE, parsed on the first lookup in the unit
+    uint8_t* children;
+    bool parsed;
     ELFAbbrev** abbrevs;
     ARanges* ranges;
     char* name;
@@ -230,13 +233,25 @@ struct CompileUnit {
     CompileUnit* next;
 };
 
+struct UnitRange {
+    uint32_t lowPC;
+    uint32_t highPC;
+    uint32_t maxHighPC; // highest highPC of this and every range sorted before it
+    int order;          // position of the unit in elfCompileUnits
+    CompileUnit* unit;
+};
+
 struct DebugInfo {
     uint8_t* debugfile;
     uint8_t* abbrevdata;
     uint8_t* debugdata;
     uint8_t* infodata;
+    uint8_t* linedata;
     int numRanges;
     ARanges* ranges;
+    // Address ranges of every compile unit, sorted by lowPC
+    int numUnitRanges;
+    UnitRange* unitRanges;
 };
 
 struct Symbol {
@@ -3,6 +3,12 @@
 #include <cstdio>
 #include <cstring>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "core/base/file_util.h"
 #include "core/base/port.h"
 #include "core/gba/gba.h"
@@ -30,48 +36,124 @@ int flashDeviceID = 0x1b;
 int flashManufacturerID = 0x32;
 int flashBank = 0;
 
-void flashDetectSaveType(const int size) {
-    uint32_t* p = (uint32_t*)&g_rom[0];
-    uint32_t* end = (uint32_t*)(&g_rom[0] + size);
-    int detectedSaveType = 0;
-    int flashSize = 0x10000;
-    bool rtcFound = false;
+// Kept per GbaContext
+variable_desc flashContextState[] = {
+    { &flashSaveMemory[0], sizeof(flashSaveMemory) },
+    { &flashState, sizeof(int) },
+    { &flashReadState, sizeof(int) },
+    { &g_flashSize, sizeof(int) },
+    { &flashDeviceID, sizeof(int) },
+    { &flashManufacturerID, sizeof(int) },
+    { &flashBank, sizeof(int) },
+    { NULL, 0 }
+};
 
-    while (p < end) {
-        uint32_t d = READ32LE(p);
+// Save library markers as little endian words. The SDK only places them at
+// 4-byte aligned offsets, so only aligned words are checked.
+enum {
+    FLASH_MARKER_EEPROM = 0x52504545, // "EEPR"
+    FLASH_MARKER_SRAM = 0x4D415253,   // "SRAM"
+    FLASH_MARKER_FLASH = 0x53414C46,  // "FLAS"
+    FLASH_MARKER_SIIRTC = 0x52494953  // "SIIR"
+};
+
+// Filters 32 bytes at once: false when none of their 8 words starts a marker.
+static inline bool flashHasMarker(const uint8_t* p)
+{
+#if defined(__SSE2__)
+    const __m128i eeprom = _mm_set1_epi32(FLASH_MARKER_EEPROM);
+    const __m128i sram = _mm_set1_epi32(FLASH_MARKER_SRAM);
+    const __m128i flash = _mm_set1_epi32(FLASH_MARKER_FLASH);
+    const __m128i siirtc = _mm_set1_epi32(FLASH_MARKER_SIIRTC);
+    const __m128i a = _mm_loadu_si128((const __m128i*)p);
+    const __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+    const __m128i hit = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(a, eeprom), _mm_cmpeq_epi32(a, sram)),
+            _mm_or_si128(_mm_cmpeq_epi32(a, flash), _mm_cmpeq_epi32(a, siirtc))),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(b, eeprom), _mm_cmpeq_epi32(b, sram)),
+            _mm_or_si128(_mm_cmpeq_epi32(b, flash), _mm_cmpeq_epi32(b, siirtc))));
+    return _mm_movemask_epi8(hit) != 0;
+#elif defined(__ARM_NEON)
+    const uint32x4_t eeprom = vdupq_n_u32(FLASH_MARKER_EEPROM);
+    const uint32x4_t sram = vdupq_n_u32(FLASH_MARKER_SRAM);
+    const uint32x4_t flash = vdupq_n_u32(FLASH_MARKER_FLASH);
+    const uint32x4_t siirtc = vdupq_n_u32(FLASH_MARKER_SIIRTC);
+    const uint32x4_t a = vreinterpretq_u32_u8(vld1q_u8(p));
+    const uint32x4_t b = vreinterpretq_u32_u8(vld1q_u8(p + 16));
+    const uint32x4_t hit = vorrq_u32(
+        vorrq_u32(vorrq_u32(vceqq_u32(a, eeprom), vceqq_u32(a, sram)),
+            vorrq_u32(vceqq_u32(a, flash), vceqq_u32(a, siirtc))),
+        vorrq_u32(vorrq_u32(vceqq_u32(b, eeprom), vceqq_u32(b, sram)),
+            vorrq_u32(vceqq_u32(b, flash), vceqq_u32(b, siirtc))));
+    const uint16x4_t narrowed = vmovn_u32(hit);
+    return vget_lane_u64(vreinterpret_u64_u16(narrowed), 0) != 0;
+#else
+    for (int i = 0; i < 32; i += 4) {
+        const uint32_t d = READ32LE((p + i));
+        if (d == FLASH_MARKER_EEPROM || d == FLASH_MARKER_SRAM || d == FLASH_MARKER_FLASH || d == FLASH_MARKER_SIIRTC)
+            return true;
+    }
+    return false;
+#endif
+}
+
+static inline void flashCheckMarker(const uint8_t* p, int* saveType, int* flashSize, bool* rtcFound)
+{
+    uint32_t d = READ32LE(p);
 
-        if (d == 0x52504545) {
-            if (memcmp(p, "EEPROM_", 7) == 0) {
-                if (detectedSaveType == 0 || detectedSaveType == 4)
-                    detectedSaveType = 1;
+    if (d == FLASH_MARKER_EEPROM) {
+        if (memcmp(p, "EEPROM_", 7) == 0) {
+            if (*saveType == 0 || *saveType == 4)
+                *saveType = 1;
+        }
+    } else if (d == FLASH_MARKER_SRAM) {
+        if (memcmp(p, "SRAM_", 5) == 0) {
+            if (*saveType == 0 || *saveType == 1 || *saveType == 4)
+                *saveType = 2;
+        }
+    } else if (d == FLASH_MARKER_FLASH) {
+        if (memcmp(p, "FLASH1M_", 8) == 0) {
+            if (*saveType == 0) {
+                *saveType = 3;
+                *flashSize = 0x20000;
             }
-        } else if (d == 0x4D415253) {
-            if (memcmp(p, "SRAM_", 5) == 0) {
-                if (detectedSaveType == 0 || detectedSaveType == 1 || detectedSaveType == 4)
-                    detectedSaveType = 2;
+        } else if (memcmp(p, "FLASH512_", 9) == 0) {
+            if (*saveType == 0) {
+                *saveType = 3;
+                *flashSize = 0x10000;
             }
-        } else if (d == 0x53414C46) {
-            if (memcmp(p, "FLASH1M_", 8) == 0) {
-                if (detectedSaveType == 0) {
-                    detectedSaveType = 3;
-                    flashSize = 0x20000;
-                }
-            } else if (memcmp(p, "FLASH512_", 9) == 0) {
-                if (detectedSaveType == 0) {
-                    detectedSaveType = 3;
-                    flashSize = 0x10000;
-                }
-            } else if (memcmp(p, "FLASH", 5) == 0) {
-                if (detectedSaveType == 0) {
-                    detectedSaveType = 4;
-                    flashSize = 0x10000;
-                }
+        } else if (memcmp(p, "FLASH", 5) == 0) {
+            if (*saveType == 0) {
+                *saveType = 4;
+                *flashSize = 0x10000;
             }
-        } else if (d == 0x52494953) {
-            if (memcmp(p, "SIIRTC_V", 8) == 0)
-                rtcFound = true;
         }
-        p++;
+    } else if (d == FLASH_MARKER_SIIRTC) {
+        if (memcmp(p, "SIIRTC_V", 8) == 0)
+            *rtcFound = true;
+    }
+}
+
+void flashScanSaveType(const uint8_t* rom, const int size, int* saveType, int* flashSize, bool* rtcFound)
+{
+    const uint8_t* p = rom;
+    const uint8_t* end = rom + size;
+    int detectedSaveType = 0;
+    *flashSize = 0x10000;
+    *rtcFound = false;
+
+    // Markers are rare, so blocks without one are skipped whole and the few
+    // hits are checked in ROM order, which the save type priorities rely on.
+    while (end - p >= 32) {
+        if (flashHasMarker(p)) {
+            for (int i = 0; i < 32; i += 4)
+                flashCheckMarker(p + i, &detectedSaveType, flashSize, rtcFound);
+        }
+        p += 32;
+    }
+    while (p < end) {
+        flashCheckMarker(p, &detectedSaveType, flashSize, rtcFound);
+        p += 4;
     }
     // if no matches found, then set it to NONE
     if (detectedSaveType == 0) {
@@ -80,12 +162,25 @@ void flashDetectSaveType(const int size) {
     if (detectedSaveType == 4) {
         detectedSaveType = 3;
     }
+    *saveType = detectedSaveType;
+}
+
+void flashApplySaveType(int saveType, int flashSize, bool rtcFound)
+{
     rtcEnable(rtcFound);
     rtcEnableRumble(!rtcFound);
-    coreOptions.saveType = detectedSaveType;
+    coreOptions.saveType = saveType;
     flashSetSize(flashSize);
 }
 
+void flashDetectSaveType(const int size) {
+    int saveType;
+    int flashSize;
+    bool rtcFound;
+    flashScanSaveType(g_rom, size, &saveType, &flashSize, &rtcFound);
+    flashApplySaveType(saveType, flashSize, rtcFound);
+}
+
 void flashInit()
 {
     memset(flashSaveMemory, 0xff, sizeof(flashSaveMemory));
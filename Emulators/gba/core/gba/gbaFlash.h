@@ -9,7 +9,11 @@
 
 #define FLASH_128K_SZ 0x20000
 
+// Scans the ROM for the save library markers and applies the result
 void flashDetectSaveType(const int size);
+// The two halves of flashDetectSaveType, for callers that cache the result
+void flashScanSaveType(const uint8_t* rom, const int size, int* saveType, int* flashSize, bool* rtcFound);
+void flashApplySaveType(int saveType, int flashSize, bool rtcFound);
 
 #if defined(__LIBRETRO__)
 extern void flashSaveGame(uint8_t*& data);
@@ -1,5 +1,7 @@
 #include "core/gba/gbaGfx.h"
 
+#include "core/base/file_util.h"
+
 #if defined(TILED_RENDERING)
 #include <cstring>
 #endif  // defined(TILED_RENDERING)
@@ -29,6 +31,28 @@ int gfxBG3X = 0;
 int gfxBG3Y = 0;
 int gfxLastVCOUNT = 0;
 
+// Line buffers and affine/window state carried between scanlines, kept per GbaContext
+variable_desc gfxContextState[] = {
+    { &g_line0[0], sizeof(g_line0) },
+    { &g_line1[0], sizeof(g_line1) },
+    { &g_line2[0], sizeof(g_line2) },
+    { &g_line3[0], sizeof(g_line3) },
+    { &g_lineOBJ[0], sizeof(g_lineOBJ) },
+    { &g_lineOBJWin[0], sizeof(g_lineOBJWin) },
+    { &g_lineMix[0], sizeof(g_lineMix) },
+    { &gfxInWin0[0], sizeof(gfxInWin0) },
+    { &gfxInWin1[0], sizeof(gfxInWin1) },
+    { &lineOBJpixleft[0], sizeof(lineOBJpixleft) },
+    { &gfxBG2Changed, sizeof(int) },
+    { &gfxBG3Changed, sizeof(int) },
+    { &gfxBG2X, sizeof(int) },
+    { &gfxBG2Y, sizeof(int) },
+    { &gfxBG3X, sizeof(int) },
+    { &gfxBG3Y, sizeof(int) },
+    { &gfxLastVCOUNT, sizeof(int) },
+    { NULL, 0 }
+};
+
 #ifdef TILED_RENDERING
 #ifdef _MSC_VER
 union uint8_th
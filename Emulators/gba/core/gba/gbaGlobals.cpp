@@ -28,6 +28,8 @@ int customBackdropColor = -1;
 
 uint8_t* g_bios = 0;
 uint8_t* g_rom = 0;
+uint32_t g_romEnd = 0;
+uint8_t g_romTailPages[SIZE_ROM >> 15];
 uint8_t* g_internalRAM = 0;
 uint8_t* g_workRAM = 0;
 uint8_t* g_paletteRAM = 0;
@@ -32,6 +32,11 @@ extern int customBackdropColor;
 
 extern uint8_t* g_bios;
 extern uint8_t* g_rom;
+// End of the cartridge data in g_rom; reads past it return open bus
+extern uint32_t g_romEnd;
+// One bit per 4 KiB g_rom page past g_romEnd that holds real bytes: the
+// open-bus pattern plus whatever was written over it (see gbaRomMaterialize)
+extern uint8_t g_romTailPages[SIZE_ROM >> 15];
 extern uint8_t* g_internalRAM;
 extern uint8_t* g_workRAM;
 extern uint8_t* g_paletteRAM;
@@ -44,14 +44,6 @@ extern int timer3Ticks;
 extern int timer3ClockReload;
 extern int cpuTotalTicks;
 
-#define CPUReadByteQuick(addr) map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]
-
-#define CPUReadHalfWordQuick(addr) \
-    READ16LE(((uint16_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
-
-#define CPUReadMemoryQuick(addr) \
-    READ32LE(((uint32_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
-
 static inline uint16_t DowncastU16(uint32_t value) {
     return static_cast<uint16_t>(value);
 }
@@ -76,6 +68,76 @@ static inline int8_t Downcast8(T value) {
 
 extern uint32_t myROM[];
 
+// Cartridge space past the end of the ROM reads back the low address bits of
+// each halfword. It is computed here instead of being stored in g_rom, unless
+// something wrote to that page (see gbaRomMaterialize).
+static inline bool CPURomTailBacked(uint32_t offset)
+{
+    return (g_romTailPages[offset >> 15] >> ((offset >> 12) & 7)) & 1;
+}
+
+static inline uint32_t CPUReadRomHalfWord(uint32_t offset)
+{
+    if (offset < g_romEnd || CPURomTailBacked(offset))
+        return READ16LE(((uint16_t*)&g_rom[offset]));
+    return (offset >> 1) & 0xFFFF;
+}
+
+static inline uint32_t CPUReadRomMemory(uint32_t offset)
+{
+    if (offset + 4 <= g_romEnd || CPURomTailBacked(offset))
+        return READ32LE(((uint32_t*)&g_rom[offset]));
+    return CPUReadRomHalfWord(offset) | (CPUReadRomHalfWord(offset + 2) << 16);
+}
+
+static inline uint8_t CPUReadRomByte(uint32_t offset)
+{
+    if (offset < g_romEnd || CPURomTailBacked(offset))
+        return g_rom[offset];
+    return DowncastU8((offset & 1) ? (offset >> 9) : (offset >> 1));
+}
+
+// True when a `size` byte read at `address` goes through the cartridge past
+// the end of the ROM and has to take the open-bus path instead of map[]
+static inline bool CPUIsRomOpenBus(uint32_t address, uint32_t size)
+{
+    const uint32_t region = address >> 24;
+    if (region < 8 || region > 12 || region == 11)
+        return false;
+    const uint32_t offset = address & 0x1FFFFFF;
+    return offset + size > g_romEnd && !CPURomTailBacked(offset);
+}
+
+// Stores the open-bus pattern behind a write through map[] past the end of
+// the ROM, so later reads see the written value next to the pattern
+static inline void CPUMaterializeRom(uint32_t address, uint32_t size)
+{
+    if (CPUIsRomOpenBus(address, size))
+        gbaRomMaterialize(address & 0x1FFFFFF, size);
+}
+
+// Reads through map[] without timing, breakpoints or bus checks
+static inline uint8_t CPUReadByteQuick(uint32_t addr)
+{
+    if (CPUIsRomOpenBus(addr, 1))
+        return CPUReadRomByte(addr & 0x1FFFFFF);
+    return map[addr >> 24].address[addr & map[addr >> 24].mask];
+}
+
+static inline uint32_t CPUReadHalfWordQuick(uint32_t addr)
+{
+    if (CPUIsRomOpenBus(addr, 2))
+        return CPUReadRomHalfWord(addr & 0x1FFFFFF);
+    return READ16LE(((uint16_t*)&map[addr >> 24].address[addr & map[addr >> 24].mask]));
+}
+
+static inline uint32_t CPUReadMemoryQuick(uint32_t addr)
+{
+    if (CPUIsRomOpenBus(addr, 4))
+        return CPUReadRomMemory(addr & 0x1FFFFFF);
+    return READ32LE(((uint32_t*)&map[addr >> 24].address[addr & map[addr >> 24].mask]));
+}
+
 static inline uint32_t CPUReadMemory(uint32_t address)
 {
 #ifdef VBAM_ENABLE_DEBUGGER
@@ -147,7 +209,7 @@ static inline uint32_t CPUReadMemory(uint32_t address)
     case 10:
     case 11:
     case 12:
-        value = READ32LE(((uint32_t*)&g_rom[address & 0x1FFFFFC]));
+        value = CPUReadRomMemory(address & 0x1FFFFFC);
         break;
     case 13:
         if (cpuEEPROMEnabled)
@@ -296,7 +358,7 @@ static inline uint32_t CPUReadHalfWord(uint32_t address)
         if (address == 0x80000c4 || address == 0x80000c6 || address == 0x80000c8)
             value = rtcRead(address);
         else
-            value = READ16LE(((uint16_t*)&g_rom[address & 0x1FFFFFE]));
+            value = CPUReadRomHalfWord(address & 0x1FFFFFE);
         break;
     case 13:
         if (cpuEEPROMEnabled)
@@ -416,7 +478,7 @@ static inline uint8_t CPUReadByte(uint32_t address)
     case 10:
     case 11:
     case 12:
-        return g_rom[address & 0x1FFFFFF];
+        return CPUReadRomByte(address & 0x1FFFFFF);
     case 13:
         if (cpuEEPROMEnabled)
             return DowncastU8(eepromRead(address));
@@ -2,12 +2,15 @@
 
 #include "core/base/port.h"
 #include "core/gba/gbaGlobals.h"
+#include "core/gba/gbaInline.h"
 
-#define debuggerWriteHalfWord(addr, value) \
-    WRITE16LE((uint16_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask], (value))
+#define debuggerWriteHalfWord(addr, value)                                                       \
+    do {                                                                                         \
+        CPUMaterializeRom((addr), 2);                                                            \
+        WRITE16LE((uint16_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask], (value)); \
+    } while (0)
 
-#define debuggerReadHalfWord(addr) \
-    READ16LE(((uint16_t*)&map[(addr) >> 24].address[(addr)&map[(addr) >> 24].mask]))
+#define debuggerReadHalfWord(addr) CPUReadHalfWordQuick(addr)
 
 static bool agbPrintEnabled = false;
 static bool agbPrintProtect = false;
@@ -61,6 +64,8 @@ void agbPrintFlush()
         return;
     }
 
+    // The buffer is indexed by a 16-bit offset
+    gbaRomMaterialize(address, 0x10000);
     uint8_t* data = &g_rom[address];
 
     while (get != put) {
@@ -40,6 +40,16 @@ static bool rtcRumbleEnabled = false;
 
 uint32_t countTicks = 0;
 
+// Kept per GbaContext
+variable_desc rtcContextState[] = {
+    { &rtcClockData, sizeof(rtcClockData) },
+    { &rtcClockEnabled, sizeof(bool) },
+    { &rtcRumbleEnabled, sizeof(bool) },
+    { &gba_time, sizeof(gba_time) },
+    { &countTicks, sizeof(uint32_t) },
+    { NULL, 0 }
+};
+
 void rtcEnable(bool e)
 {
     rtcClockEnabled = e;
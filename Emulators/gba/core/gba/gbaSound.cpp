@@ -3,6 +3,12 @@
 #include <array>
 #include <cstring>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "core/apu/Gb_Apu.h"
 #include "core/apu/Multi_Buffer.h"
 #include "core/base/file_util.h"
@@ -41,6 +47,8 @@ extern bool stopState; // TODO: silence sound when true
 int const SOUND_CLOCK_TICKS_ = 280896; // ~1074 samples per frame
 
 static uint16_t soundFinalWave[1600];
+alignas(16) static float soundFinalLeft[800];
+alignas(16) static float soundFinalRight[800];
 long soundSampleRate = 44100;
 bool g_gbaSoundInterpolation = true;
 bool soundPaused = true;
@@ -96,6 +104,17 @@ static Stereo_Buffer* stereo_buffer;
 
 static Blip_Synth<blip_best_quality, 1> pcm_synth[3]; // 32 kHz, 16 kHz, 8 kHz
 
+// Each GbaContext has its own APU and mixing buffer; the PCM synths only hold
+// filter settings and are shared
+variable_desc soundContextState[] = {
+    { &pcm[0], sizeof(pcm) },
+    { &gb_apu, sizeof(gb_apu) },
+    { &stereo_buffer, sizeof(stereo_buffer) },
+    { &soundTicks, sizeof(int) },
+    { &SOUND_CLOCK_TICKS, sizeof(int) },
+    { NULL, 0 }
+};
+
 void Gba_Pcm::init()
 {
     output = 0;
@@ -345,6 +364,44 @@ void flush_samples(Multi_Buffer* buffer)
     systemOnWriteDataToSoundBuffer(soundFinalWave, numSamples);
 }
 #else
+// Splits interleaved 16-bit pairs into float planes scaled to [-1, 1)
+static void deinterleave_float(const blip_sample_t* in, float* left, float* right, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(1.0f / 32768);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i*)(in + i * 2));
+        // sign-extend the low and high halves of each 32-bit pair
+        const __m128i l = _mm_srai_epi32(_mm_slli_epi32(s, 16), 16);
+        const __m128i r = _mm_srai_epi32(s, 16);
+        _mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), scale));
+        _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), scale));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const int16x4x2_t s = vld2_s16(in + i * 2);
+        vst1q_f32(left + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(s.val[0])), 1.0f / 32768));
+        vst1q_f32(right + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(s.val[1])), 1.0f / 32768));
+    }
+#endif
+    for (; i < count; i++) {
+        left[i] = in[i * 2] * (1.0f / 32768);
+        right[i] = in[i * 2 + 1] * (1.0f / 32768);
+    }
+}
+
+static void write_samples(int numSamples)
+{
+    if (soundDriver->float_output()) {
+        const int count = numSamples / 2;
+        deinterleave_float((const blip_sample_t*)soundFinalWave, soundFinalLeft, soundFinalRight, count);
+        soundDriver->write_float(soundFinalLeft, soundFinalRight, count);
+    } else {
+        soundDriver->write(soundFinalWave, numSamples * sizeof *soundFinalWave);
+    }
+}
+
 void flush_samples(Multi_Buffer* buffer)
 {
     // We want to write the data frame by frame to support legacy audio drivers
@@ -365,7 +422,7 @@ void flush_samples(Multi_Buffer* buffer)
         if (soundPaused)
             soundResume();
 
-        soundDriver->write(soundFinalWave, soundBufferLen);
+        write_samples(out_buf_size);
         systemOnWriteDataToSoundBuffer(soundFinalWave, soundBufferLen);
     }
 }
@@ -473,11 +530,24 @@ void soundShutdown()
 
     systemOnSoundShutdown();
 
-    delete stereo_buffer;
+    soundReleaseContext();
+}
+
+void soundDetachContext()
+{
+    pcm[0].pcm.init();
+    pcm[1].pcm.init();
+
     stereo_buffer = 0;
+    gb_apu = 0;
+}
 
+void soundReleaseContext()
+{
+    delete stereo_buffer;
     delete gb_apu;
-    gb_apu = 0;
+
+    soundDetachContext();
 }
 
 void soundPause()
@@ -40,6 +40,11 @@ extern bool soundPaused; // current paused state
 // Cleans up sound. Afterwards, soundInit() can be called again.
 void soundShutdown();
 
+// Forgets or frees the APU and mixing buffer of the live GbaContext; the next
+// soundInit() or soundReset() makes new ones
+void soundDetachContext();
+void soundReleaseContext();
+
 //// GBA sound options
 
 long soundGetSampleRate();
@@ -15,6 +15,7 @@
 
 // Include our sound driver
 #include "SoolraSoundDriver.hpp"
+#include "SoolraGBABridge.hpp"
 
 // Include VBA sound driver header
 #include "core/base/sound_driver.h"
@@ -132,11 +133,19 @@ uint32_t systemGetClock() {
     return static_cast<uint32_t>(millis.count());
 }
 
-// Game recording/playback stubs
-void systemStartGameRecording(const std::string& fname, MVFormatID format) {}
-void systemStopGameRecording() {}
-void systemStartGamePlayback(const std::string& fname, MVFormatID format) {}
-void systemStopGamePlayback() {}
+// Game recording/playback, always in the bridge's own movie format
+void systemStartGameRecording(const std::string& fname, MVFormatID format) {
+    GBAStartMovieRecording(fname.c_str());
+}
+void systemStopGameRecording() {
+    if (GBAGetMovieState() == GBA_MOVIE_RECORDING) GBAStopMovie();
+}
+void systemStartGamePlayback(const std::string& fname, MVFormatID format) {
+    GBAStartMoviePlayback(fname.c_str());
+}
+void systemStopGamePlayback() {
+    if (GBAGetMovieState() == GBA_MOVIE_PLAYING) GBAStopMovie();
+}
 
 bool systemReadJoypads() { return true; }
 //uint32_t systemReadJoypad(int joy) { return 0; }
@@ -15,14 +15,23 @@
 #include "NstApiVideo.hpp"
 #include "NstApiSound.hpp"
 #include "NstApiCheats.hpp"
+#include "NstApiMovie.hpp"
 #include "NstApiUser.hpp"
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <cstring>
+#include <strings.h>
+#include <string>
 #include <vector>
 #include <functional>
 #include <memory>
 
+#include "core/base/patch.h"  // VBA-M's soft patcher, shared with the GBA and GB bridges
+#include "core/base/file_util.h"  // archive loading through fex
+#include "core/base/battery_writer.h"  // shared with the GBA and GB bridges
+
 // NES core components
 namespace {
 // Constants
@@ -33,79 +42,196 @@ constexpr size_t SAMPLE_RATE = 44100;
 constexpr size_t PAL_SAMPLES_PER_FRAME = SAMPLE_RATE / 50;  // 882 samples
 constexpr size_t NTSC_SAMPLES_PER_FRAME = SAMPLE_RATE / 60; // 735 samples
 
-std::unique_ptr<Nes::Api::Emulator> emulator;
-std::unique_ptr<Nes::Api::Machine> machine;
-std::unique_ptr<Nes::Api::Video> video;
-std::unique_ptr<Nes::Api::Sound> audio;
-std::unique_ptr<Nes::Api::Input> input;
-std::unique_ptr<Nes::Api::Cheats> cheats;
+constexpr uint32_t DIGEST_BASIS = 0x811C9DC5u;
 
+// Battery RAM is checked for changes this often; the checksum costs a few microseconds
+constexpr uint32_t BATTERY_CHECK_FRAMES = 30;
+}
 
-//    Nes::Api::Machine nes_machine(emulator);
-Nes::Api::Video::Output videoOutput;
-Nes::Api::Sound::Output audioOutput;
-Nes::Api::Input::Controllers controllers;
+struct NESInstance {
+    explicit NESInstance(void* userData)
+    : userData(userData), machine(emulator), video(emulator), audio(emulator),
+      input(emulator), cheats(emulator), movie(emulator) {}
+    
+    void* userData;
+    
+    Nes::Api::Emulator emulator;
+    Nes::Api::Machine machine;
+    Nes::Api::Video video;
+    Nes::Api::Sound audio;
+    Nes::Api::Input input;
+    Nes::Api::Cheats cheats;
+    Nes::Api::Movie movie;
+    
+    // The core reads and writes the movie stream for as long as it plays or records
+    std::unique_ptr<std::fstream> movieStream;
+    uint32_t movieFrame = 0;
+    
+    Nes::Api::Video::Output videoOutput;
+    Nes::Api::Sound::Output audioOutput;
+    Nes::Api::Input::Controllers controllers;
+    
+    // Fixed-size arrays instead of vectors
+    alignas(16) uint16_t frameBuffer[FRAME_BUFFER_SIZE];
+    alignas(16) uint16_t audioBuffer[PAL_SAMPLES_PER_FRAME]; // Use larger of the two sizes
+    alignas(16) float audioFloatBuffer[PAL_SAMPLES_PER_FRAME];
+    
+    // Callbacks
+    NESVideoCallback videoCallback = nullptr;
+    NESBufferCallback audioCallback = nullptr;
+    NESFloatBufferCallback audioFloatCallback = nullptr;
+    NESIndexedCallback indexedCallback = nullptr;
+    int indexedBits = 16;
+    unsigned long paletteRevision = 0;
+    bool paletteSent = false;
+    
+    // Save / Load game
+    std::string batterySavePath;
+    uint32_t batteryFrames = 0;
+    bool gameLoaded = false;
+    std::string gamePath;
+    
+    bool isInitialized = true;
+    
+    // Golden trace state, see NES_StartDigestTrace
+    bool traceActive = false;
+    uint32_t traceFrame = 0;
+    uint32_t traceAudio = DIGEST_BASIS;
+    uint32_t traceInterval = 0;
+    std::ofstream traceOutput;                  // recording
+    std::vector<NESFrameDigest> traceGolden;    // verifying
+    size_t traceNext = 0;
+    bool traceDiverged = false;
+    uint32_t traceDivergedFrame = 0;
+    uint32_t traceDivergedParts = 0;
+};
+
+// Nestopia's output and file callbacks are class statics shared by every emulator, so they
+// are registered once and find their instance through the one this thread is driving.
+static thread_local NESInstance* currentInstance = nullptr;
 
-// Fixed-size arrays instead of vectors
-alignas(16) uint16_t frameBuffer[FRAME_BUFFER_SIZE];
-alignas(16) uint16_t audioBuffer[PAL_SAMPLES_PER_FRAME]; // Use larger of the two sizes
+namespace {
+struct CurrentInstance {
+    explicit CurrentInstance(NESInstance* nes) : previous(currentInstance) { currentInstance = nes; }
+    ~CurrentInstance() { currentInstance = previous; }
+    NESInstance* previous;
+};
+}
 
-// Callbacks
-NESBufferCallback videoCallback;
-NESBufferCallback audioCallback;
+static void traceFrameDone(NESInstance* nes);
 
-// Save / Load game
-static char *batterySavePath = NULL;
-bool gameLoaded = false;
-char *gamePath = NULL;
+// FNV-1a; the digests only need to tell runs apart, not resist collisions
+static uint32_t digestBytes(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x01000193u;
+    }
+    return hash;
+}
 
-bool isInitialized = false;
+// Indexed output shares frameBuffer: 16-bit indices fill it, 8-bit ones use half of it.
+static bool applyRenderState(NESInstance* nes) {
+    Nes::Api::Video::RenderState renderState;
+    renderState.width = NES_WIDTH;
+    renderState.height = NES_HEIGHT;
+    
+    if (nes->indexedCallback) {
+        renderState.filter = Nes::Api::Video::RenderState::FILTER_INDEXED;
+        renderState.bits.count = nes->indexedBits;
+        nes->videoOutput.pitch = NES_WIDTH * (nes->indexedBits / 8);
+    } else {
+        renderState.filter = Nes::Api::Video::RenderState::FILTER_NONE;
+        renderState.bits.count = 16;
+        renderState.bits.mask.r = 0xF800;
+        renderState.bits.mask.g = 0x07E0;
+        renderState.bits.mask.b = 0x001F;
+        nes->videoOutput.pitch = NES_WIDTH * sizeof(uint16_t);
+    }
+    nes->videoOutput.pixels = nes->frameBuffer;
+    nes->paletteSent = false;
+    
+    return NES_SUCCEEDED(nes->video.SetRenderState(renderState));
+}
+
+// The core writes float samples straight into audioFloatBuffer once a float callback is set.
+static void applyAudioFormat(NESInstance* nes) {
+    if (nes->audioFloatCallback) {
+        nes->audio.SetSampleFormat(Nes::Api::Sound::SAMPLE_FLOAT32);
+        nes->audioOutput.samples[0] = nes->audioFloatBuffer;
+    } else {
+        nes->audio.SetSampleFormat(Nes::Api::Sound::SAMPLE_INT16);
+        nes->audioOutput.samples[0] = nes->audioBuffer;
+    }
 }
 
 // Internal callback handlers
-bool videoLock(void*, Nes::Api::Video::Output&) { return true; }
-void videoUnlock(void*, Nes::Api::Video::Output&) {
-    if (videoCallback) {
-        videoCallback(frameBuffer, FRAME_BUFFER_SIZE);
+static bool NST_CALLBACK videoLock(void*, Nes::Api::Video::Output&) { return currentInstance != nullptr; }
+static void NST_CALLBACK videoUnlock(void*, Nes::Api::Video::Output& output) {
+    NESInstance* nes = currentInstance;
+    
+    if (nes->indexedCallback) {
+        Nes::Api::Video::Palette palette = nes->video.GetPalette();
+        const unsigned long revision = palette.GetRevision();
+        const bool changed = !nes->paletteSent || revision != nes->paletteRevision;
+        nes->paletteRevision = revision;
+        nes->paletteSent = true;
+        nes->indexedCallback(nes->userData, nes->frameBuffer, FRAME_BUFFER_SIZE, nes->indexedBits / 8,
+                             &palette.GetColors()[0][0], changed, output.unchanged && !changed);
+    } else if (nes->videoCallback) {
+        nes->videoCallback(nes->userData, nes->frameBuffer, FRAME_BUFFER_SIZE, output.unchanged);
     }
 }
-bool audioLock(void*, Nes::Api::Sound::Output&) { return true; }
-void audioUnlock(void*, Nes::Api::Sound::Output& output) {
-    if (audioCallback) {
-        audioCallback(audioBuffer,
-                      machine->GetMode() == Nes::Api::Machine::PAL ?
-                      PAL_SAMPLES_PER_FRAME : NTSC_SAMPLES_PER_FRAME
-                      );
+static bool NST_CALLBACK audioLock(void*, Nes::Api::Sound::Output&) { return currentInstance != nullptr; }
+static void NST_CALLBACK audioUnlock(void*, Nes::Api::Sound::Output&) {
+    NESInstance* nes = currentInstance;
+    
+    const size_t samples = nes->machine.GetMode() == Nes::Api::Machine::PAL ?
+                           PAL_SAMPLES_PER_FRAME : NTSC_SAMPLES_PER_FRAME;
+    if (nes->traceActive) {
+        nes->traceAudio = nes->audioFloatCallback ?
+            digestBytes(nes->traceAudio, nes->audioFloatBuffer, samples * sizeof(float)) :
+            digestBytes(nes->traceAudio, nes->audioBuffer, samples * sizeof(uint16_t));
+    }
+    
+    if (nes->audioFloatCallback) {
+        nes->audioFloatCallback(nes->userData, nes->audioFloatBuffer, samples);
+    } else if (nes->audioCallback) {
+        nes->audioCallback(nes->userData, nes->audioBuffer, samples);
     }
 }
 
-bool NES_IsPAL(void) {
-    if (!machine) return false;  // Default to NTSC if not initialized
-    return machine->GetMode() == Nes::Api::Machine::PAL;
+bool NES_IsPAL(NESHandle nes) {
+    return nes->machine.GetMode() == Nes::Api::Machine::PAL;
 }
 
 static void NST_CALLBACK FileIO(void *context, Nes::Api::User::File& file)
 {
+    NESInstance* nes = currentInstance;
+    if (nes == nullptr || nes->batterySavePath.empty())
+    {
+        return;
+    }
+    
     switch (file.GetAction())
     {
         case Nes::Api::User::File::LOAD_BATTERY:
         case Nes::Api::User::File::LOAD_EEPROM:
         {
-            if (batterySavePath != nullptr)
-            {
-                std::ifstream fileStream(batterySavePath, std::ios::binary);
-                file.SetContent(fileStream);
-            }
+            // A save of this game may still be on its way to disk
+            batteryWriterFlush();
+            std::ifstream fileStream(nes->batterySavePath, std::ios::binary);
+            file.SetContent(fileStream);
             break;
         }
 
         case Nes::Api::User::File::SAVE_BATTERY:
         case Nes::Api::User::File::SAVE_EEPROM:
         {
-            if (batterySavePath != nullptr)
-            {
-                std::ofstream fileStream(batterySavePath, std::ios::binary);
-                file.GetContent(fileStream);
+            // Snapshot now, write from the battery writer's thread
+            const void* data;
+            unsigned long size;
+            if (NES_SUCCEEDED(file.GetContent(data, size)) && size) {
+                batteryWriterQueue(nes->batterySavePath.c_str(), data, size);
             }
             break;
         }
@@ -116,117 +242,248 @@ static void NST_CALLBACK FileIO(void *context, Nes::Api::User::File& file)
 }
 
 // --- NES Setup Functions ---
-void NES_Init() {
+NESHandle NES_Create(void* userData) {
     std::cout << "[NESBridge] Initializing NES Core..." << std::endl;
     
-    emulator = std::make_unique<Nes::Api::Emulator>();
-    machine = std::make_unique<Nes::Api::Machine>(*emulator);
-    video = std::make_unique<Nes::Api::Video>(*emulator);
-    audio = std::make_unique<Nes::Api::Sound>(*emulator);
-    input = std::make_unique<Nes::Api::Input>(*emulator);
-    cheats = std::make_unique<Nes::Api::Cheats>(*emulator);
-    
-    // Assign callbacks
-    Nes::Api::Video::Output::lockCallback.Set(videoLock, nullptr);
-    Nes::Api::Video::Output::unlockCallback.Set(videoUnlock, nullptr);
-    Nes::Api::Sound::Output::lockCallback.Set(audioLock, nullptr);
-    Nes::Api::Sound::Output::unlockCallback.Set(audioUnlock, nullptr);
-    Nes::Api::User::fileIoCallback.Set(FileIO, nullptr);
-    
-    isInitialized = true;
+    // Shared by all instances, see currentInstance
+    static const bool callbacksSet = [] {
+        Nes::Api::Video::Output::lockCallback.Set(videoLock, nullptr);
+        Nes::Api::Video::Output::unlockCallback.Set(videoUnlock, nullptr);
+        Nes::Api::Sound::Output::lockCallback.Set(audioLock, nullptr);
+        Nes::Api::Sound::Output::unlockCallback.Set(audioUnlock, nullptr);
+        Nes::Api::User::fileIoCallback.Set(FileIO, nullptr);
+        return true;
+    }();
+    (void)callbacksSet;
+    
+    NESInstance* nes = new NESInstance(userData);
+    
     std::cout << "[NESBridge] Initialization complete." << std::endl;
+    return nes;
 }
 
-bool NES_LoadROM(const char* romPath) {
-    if (!isInitialized) {
-        std::cerr << "[NESBridge] Error: NES Core not initialized!" << std::endl;
-        return false;
+void NES_Destroy(NESHandle nes) {
+    if (!nes) return;
+    
+    NES_Shutdown(nes);
+    
+    CurrentInstance current(nes);
+    delete nes;
+}
+
+namespace {
+// Lets the core read an image that is already in memory without copying it again
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const uint8_t* data, size_t size) {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
     }
     
-    std::cout << "[NESBridge] Loading ROM: " << romPath << std::endl;
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        char* base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        if (!(which & std::ios_base::in) || off < eback() - base || off > egptr() - base) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), base + off, egptr());
+        return pos_type(gptr() - eback());
+    }
     
-    std::ifstream romFile(romPath, std::ios::in | std::ios::binary);
-    if (!romFile.good()) {
-        std::cerr << "[NESBridge] Error: Failed to open ROM file." << std::endl;
-        return false;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
     }
+};
+
+bool isNESImage(const char* file) {
+    const char* ext = strrchr(file, '.');
+    return ext && (!strcasecmp(ext, ".nes") || !strcasecmp(ext, ".fds") ||
+                   !strcasecmp(ext, ".unf") || !strcasecmp(ext, ".unif"));
+}
+}
+
+// Reads the whole image into a malloc'd buffer. Archives are scanned for the first
+// NES member, which fex inflates straight into the buffer.
+static uint8_t* readROM(const char* romPath, int& size) {
+    if (utilIsArchive(romPath)) {
+        size = 0;
+        return utilLoad(romPath, isNESImage, nullptr, size);
+    }
+    
+    std::ifstream romFile(romPath, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!romFile.good()) return nullptr;
     
-    if (NES_FAILED(machine->Load(romFile, Nes::Api::Machine::FAVORED_NES_NTSC))) {
+    size = static_cast<int>(romFile.tellg());
+    uint8_t* rom = static_cast<uint8_t*>(malloc(size > 0 ? size : 1));
+    romFile.seekg(0);
+    if (rom && !romFile.read(reinterpret_cast<char*>(rom), size)) {
+        free(rom);
+        return nullptr;
+    }
+    return rom;
+}
+
+static bool loadROM(NESHandle nes, std::istream& romFile, const char* romPath) {
+    NES_StopMovie(nes);
+    NES_StopDigestTrace(nes);
+    
+    CurrentInstance current(nes);
+    
+    if (NES_FAILED(nes->machine.Load(romFile, Nes::Api::Machine::FAVORED_NES_NTSC))) {
         std::cerr << "[NESBridge] Error: Failed to load ROM." << std::endl;
         return false;
     }
     
-    machine->SetMode(machine->GetDesiredMode());
+    nes->machine.SetMode(nes->machine.GetDesiredMode());
     
     // Configure video output - simplified setup
-    video->EnableUnlimSprites(true);
-    videoOutput.pixels = frameBuffer;
-    videoOutput.pitch = NES_WIDTH * sizeof(uint16_t);
-    
-    // Create a RenderState object to configure video rendering parameters
-    Nes::Api::Video::RenderState renderState;
-    renderState.filter = Nes::Api::Video::RenderState::FILTER_NONE;
-    renderState.width = NES_WIDTH;
-    renderState.height = NES_HEIGHT;
-    renderState.bits.count = 16;
-    renderState.bits.mask.r = 0xF800;
-    renderState.bits.mask.g = 0x07E0;
-    renderState.bits.mask.b = 0x001F;
+    nes->video.EnableUnlimSprites(true);
+    nes->video.EnableDuplicateFrameDetection(true);
     
-    if (NES_FAILED(video->SetRenderState(renderState))) {
+    if (!applyRenderState(nes)) {
         std::cerr << "[NESBridge] Error: Failed to set render state." << std::endl;
         return false;
     }
-    gamePath = strdup(romPath);
+    nes->gamePath = romPath;
     
     // Configure audio with optimized buffer management
-    audio->SetSampleRate(SAMPLE_RATE);
-    audioOutput.samples[0] = audioBuffer;
-    audioOutput.length[0] = machine->GetMode() == Nes::Api::Machine::PAL ?
+    nes->audio.SetSampleRate(SAMPLE_RATE);
+    nes->audio.EnableBandLimiting(true);
+    applyAudioFormat(nes);
+    nes->audioOutput.length[0] = nes->machine.GetMode() == Nes::Api::Machine::PAL ?
     PAL_SAMPLES_PER_FRAME : NTSC_SAMPLES_PER_FRAME;
     
     // Set to null and 0 if not using a circular buffer
-    audioOutput.samples[1] = nullptr;
-    audioOutput.length[1] = 0;
+    nes->audioOutput.samples[1] = nullptr;
+    nes->audioOutput.length[1] = 0;
     
     // Configure controller
-    input->ConnectController(0, Nes::Api::Input::PAD1);
+    nes->input.ConnectController(0, Nes::Api::Input::PAD1);
     
     // Start emulation
-    machine->Power(true);
-    gameLoaded = true;
+    nes->machine.Power(true);
+    nes->gameLoaded = true;
     std::cout << "[NESBridge] ROM successfully loaded!" << std::endl;
     return true;
 }
 
-void NES_Shutdown() {
-    if (!isInitialized) return;
+bool NES_IsImageName(const char* name) {
+    return utilIsArchiveMember(name, isNESImage);
+}
+
+bool NES_LoadROM(NESHandle nes, const char* romPath) {
+    if (!nes->isInitialized) {
+        std::cerr << "[NESBridge] Error: NES Core not initialized!" << std::endl;
+        return false;
+    }
     
-    std::cout << "[NESBridge] Shutting down NES..." << std::endl;
+    std::cout << "[NESBridge] Loading ROM: " << romPath << std::endl;
     
+    // Zipped games are inflated in memory, with no extracted copy on disk
+    if (utilIsArchive(romPath)) {
+        int size = 0;
+        uint8_t* rom = readROM(romPath, size);
+        if (!rom) {
+            std::cerr << "[NESBridge] Error: No NES image in archive." << std::endl;
+            return false;
+        }
+        
+        MemoryBuffer buffer(rom, size);
+        std::istream romStream(&buffer);
+        bool loaded = loadROM(nes, romStream, romPath);
+        free(rom);
+        return loaded;
+    }
     
-    machine->Unload();
-    machine->Power(false);
+    std::ifstream romFile(romPath, std::ios::in | std::ios::binary);
+    if (!romFile.good()) {
+        std::cerr << "[NESBridge] Error: Failed to open ROM file." << std::endl;
+        return false;
+    }
     
-    videoCallback = nullptr;
-    audioCallback = nullptr;
+    return loadROM(nes, romFile, romPath);
+}
+
+bool NES_LoadPatchedROM(NESHandle nes, const char* romPath, const char* patchPath) {
+    if (!nes->isInitialized) {
+        std::cerr << "[NESBridge] Error: NES Core not initialized!" << std::endl;
+        return false;
+    }
+    
+    std::cout << "[NESBridge] Loading ROM: " << romPath << " patched with " << patchPath << std::endl;
+    
+    // applyPatch reallocates the image when the patch grows it
+    int size = 0;
+    uint8_t* rom = readROM(romPath, size);
+    if (!rom) {
+        std::cerr << "[NESBridge] Error: Failed to read ROM file." << std::endl;
+        return false;
+    }
+    
+    if (!applyPatch(patchPath, &rom, &size)) {
+        std::cerr << "[NESBridge] Error: Failed to apply patch." << std::endl;
+        free(rom);
+        return false;
+    }
+    
+    MemoryBuffer buffer(rom, size);
+    std::istream patched(&buffer);
+    bool loaded = loadROM(nes, patched, romPath);
+    free(rom);
+    return loaded;
+}
+
+void NES_Shutdown(NESHandle nes) {
+    if (!nes->isInitialized) return;
+    
+    std::cout << "[NESBridge] Shutting down NES..." << std::endl;
+    
+    NES_StopMovie(nes);
+    NES_StopDigestTrace(nes);
+    {
+        CurrentInstance current(nes);
+        nes->machine.Unload();
+        nes->machine.Power(false);
+    }
+    batteryWriterFlush();
     
-    isInitialized = false;
-    gameLoaded = false;
-    gamePath = NULL;
+    nes->videoCallback = nullptr;
+    nes->audioCallback = nullptr;
+    nes->audioFloatCallback = nullptr;
+    nes->indexedCallback = nullptr;
+    
+    nes->isInitialized = false;
+    nes->gameLoaded = false;
+    nes->gamePath.clear();
     
     std::cout << "[NESBridge] Shutdown complete." << std::endl;
 }
 
-void NES_RunFrame() {
+void NES_RunFrame(NESHandle nes) {
+    CurrentInstance current(nes);
+    
     // Execute a single frame
-    emulator->Execute(&videoOutput, &audioOutput, &controllers);
+    nes->emulator.Execute(&nes->videoOutput, &nes->audioOutput, &nes->controllers);
+    
+    if (!nes->movie.IsStopped()) {
+        nes->movieFrame++;
+    }
+    
+    // The core hands battery RAM to FileIO only when it changed since the last save
+    if (!nes->batterySavePath.empty() && ++nes->batteryFrames == BATTERY_CHECK_FRAMES) {
+        nes->batteryFrames = 0;
+        nes->machine.SaveBattery();
+    }
+    
+    if (nes->traceActive) {
+        traceFrameDone(nes);
+    }
 }
 
 
 
 
-bool NES_AddCheatCode(const char *cheatCode)
+bool NES_AddCheatCode(NESHandle nes, const char *cheatCode)
 {
     Nes::Api::Cheats::Code code;
     
@@ -235,7 +492,7 @@ bool NES_AddCheatCode(const char *cheatCode)
         return false;
     }
     
-    if (NES_FAILED(cheats->SetCode(code)))
+    if (NES_FAILED(nes->cheats.SetCode(code)))
     {
         return false;
     }
@@ -243,63 +500,80 @@ bool NES_AddCheatCode(const char *cheatCode)
     return true;
 }
 
-void NES_ResetCheats()
+void NES_ResetCheats(NESHandle nes)
 {
-    cheats->ClearCodes();
+    nes->cheats.ClearCodes();
 }
 
 
 
 // --- Input Management ---
-void NES_SetInput(int button) {
-    controllers.pad[0].buttons |= button;
+void NES_SetInput(NESHandle nes, int button) {
+    nes->controllers.pad[0].buttons |= button;
 }
 
-void NES_ClearInput(int button) {
-    controllers.pad[0].buttons &= ~button;
+void NES_ClearInput(NESHandle nes, int button) {
+    nes->controllers.pad[0].buttons &= ~button;
 }
 
-void NES_ResetInputs() {
-    controllers.pad[0].buttons = 0;
+void NES_ResetInputs(NESHandle nes) {
+    nes->controllers.pad[0].buttons = 0;
 }
 
 // --- Callback Management ---
-void NES_SetVideoCallback(NESBufferCallback callback) {
-    videoCallback = callback;
+void NES_SetVideoCallback(NESHandle nes, NESVideoCallback callback) {
+    nes->videoCallback = callback;
+}
+
+void NES_SetAudioCallback(NESHandle nes, NESBufferCallback callback) {
+    nes->audioCallback = callback;
+}
+
+void NES_SetFloatAudioCallback(NESHandle nes, NESFloatBufferCallback callback) {
+    nes->audioFloatCallback = callback;
+    
+    if (nes->gameLoaded) {
+        applyAudioFormat(nes);
+    }
 }
 
-void NES_SetAudioCallback(NESBufferCallback callback) {
-    audioCallback = callback;
+void NES_SetIndexedVideoCallback(NESHandle nes, NESIndexedCallback callback, int bitsPerIndex) {
+    nes->indexedCallback = callback;
+    nes->indexedBits = (bitsPerIndex == 8) ? 8 : 16;
+    
+    if (nes->gameLoaded && !applyRenderState(nes)) {
+        std::cerr << "[NESBridge] Error: Failed to set render state." << std::endl;
+    }
 }
 
 
 // --- Save / Load Game States ---
 
 
-void NESSaveSaveState(const char *saveStateFilepath)
+static void NESSaveSaveState(NESInstance* nes, const char *saveStateFilepath)
 {
     // Pure save-state API, completely independent from FileIO/battery:
     std::ofstream fileStream(saveStateFilepath, std::ios::binary);
-    machine->SaveState(fileStream);
+    nes->machine.SaveState(fileStream);
 }
 
-void NESLoadSaveState(const char *saveStateFilepath)
+static void NESLoadSaveState(NESInstance* nes, const char *saveStateFilepath)
 {
     // Pure load-state API, completely independent from FileIO/battery:
     std::ifstream fileStream(saveStateFilepath, std::ios::binary);
-    machine->LoadState(fileStream);
+    nes->machine.LoadState(fileStream);
 }
 
 
 
-void NESSaveGameSave(const char *gameSavePath)
+void NESSaveGameSave(NESHandle nes, const char *gameSavePath)
 {
     
     std::string saveStatePath(gameSavePath);
     //    saveStatePath += ".temp";
     
     // Create tempoary save state.
-    NESSaveSaveState(saveStatePath.c_str());
+    NESSaveSaveState(nes, saveStatePath.c_str());
     
     
     // Consider the following later when supporting ingame save/load functionality.
@@ -325,9 +599,9 @@ void NESSaveGameSave(const char *gameSavePath)
     //    remove(saveStatePath.c_str());
 }
 
-void NESLoadGameSave(const char *gameSavePath)
+void NESLoadGameSave(NESHandle nes, const char *gameSavePath)
 {
-    NESLoadSaveState(gameSavePath);
+    NESLoadSaveState(nes, gameSavePath);
     
     
     // Consider this later when supporting ingame save/load functionality.
@@ -335,7 +609,243 @@ void NESLoadGameSave(const char *gameSavePath)
     //    NES_LoadROM(gamePath);
     
 }
-void NES_SetBatterySavePath(const char* path) {
-    free(batterySavePath);
-    batterySavePath = strdup(path);
+void NES_SetBatterySavePath(NESHandle nes, const char* path) {
+    nes->batterySavePath = path ? path : "";
+}
+
+bool NES_FlushBatterySave(NESHandle nes) {
+    if (nes->gameLoaded && !nes->batterySavePath.empty()) {
+        CurrentInstance current(nes);
+        nes->machine.SaveBattery();
+    }
+    return batteryWriterFlush();
+}
+
+
+// --- Input Movies ---
+
+bool NES_StartMovieRecording(NESHandle nes, const char* moviePath)
+{
+    if (!nes->gameLoaded) return false;
+    NES_StopMovie(nes);
+    
+    nes->movieStream = std::make_unique<std::fstream>(moviePath, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!nes->movieStream->good() || NES_FAILED(nes->movie.Record(*nes->movieStream))) {
+        std::cerr << "[NESBridge] Error: Failed to start movie recording." << std::endl;
+        nes->movieStream.reset();
+        return false;
+    }
+    
+    nes->movieFrame = 0;
+    return true;
+}
+
+bool NES_StartMoviePlayback(NESHandle nes, const char* moviePath)
+{
+    if (!nes->gameLoaded) return false;
+    NES_StopMovie(nes);
+    
+    nes->movieStream = std::make_unique<std::fstream>(moviePath, std::ios::in | std::ios::binary);
+    if (!nes->movieStream->good() || NES_FAILED(nes->movie.Play(*nes->movieStream))) {
+        std::cerr << "[NESBridge] Error: Failed to start movie playback." << std::endl;
+        nes->movieStream.reset();
+        return false;
+    }
+    
+    nes->movieFrame = 0;
+    return true;
+}
+
+void NES_StopMovie(NESHandle nes)
+{
+    nes->movie.Stop();
+    nes->movieStream.reset();
+}
+
+NESMovieState NES_GetMovieState(NESHandle nes)
+{
+    if (nes->movie.IsStopped()) return NES_MOVIE_NONE;
+    return nes->movie.IsRecording() ? NES_MOVIE_RECORDING : NES_MOVIE_PLAYING;
+}
+
+uint32_t NES_GetMovieFrame(NESHandle nes)
+{
+    return nes->movieFrame;
+}
+
+
+// --- Golden Traces ---
+//
+// File layout, native endian: "SNDT" magic, u32 interval, u32 NES_DIGEST_PARTS,
+// then one NESFrameDigest every interval frames.
+
+static const char TRACE_MAGIC[4] = { 'S', 'N', 'D', 'T' };
+
+static constexpr uint32_t chunkId(char a, char b, char c) {
+    return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 | uint32_t(uint8_t(c)) << 16;
+}
+
+// Calls visit(id, chunk, size) for every chunk in [data, data + size); chunk includes its 8 byte header
+template<typename Visit>
+static void forEachChunk(const uint8_t* data, size_t size, Visit visit) {
+    size_t pos = 0;
+    while (pos + 8 <= size) {
+        const uint32_t id = data[pos] | data[pos + 1] << 8 | data[pos + 2] << 16 | uint32_t(data[pos + 3]) << 24;
+        const uint32_t length = data[pos + 4] | data[pos + 5] << 8 | data[pos + 6] << 16 | uint32_t(data[pos + 7]) << 24;
+        if (length > size - pos - 8) return;
+        visit(id, data + pos, size_t(length) + 8);
+        pos += size_t(length) + 8;
+    }
+}
+
+// Hashes an uncompressed save state chunk by chunk into the subsystem each belongs to.
+// The frame counter and input port chunks are left out.
+static void digestMachineState(NESInstance* nes, uint32_t* parts) {
+    std::ostringstream stream;
+    if (NES_FAILED(nes->machine.SaveState(stream, Nes::Api::Machine::NO_COMPRESSION))) return;
+    
+    const std::string state = stream.str();
+    if (state.size() < 8) return;
+    
+    const uint8_t* root = reinterpret_cast<const uint8_t*>(state.data()) + 8;
+    forEachChunk(root, state.size() - 8, [parts](uint32_t id, const uint8_t* chunk, size_t size) {
+        switch (id) {
+            case chunkId('C', 'P', 'U'):
+                forEachChunk(chunk + 8, size - 8, [parts](uint32_t sub, const uint8_t* data, size_t length) {
+                    const int part = (sub == chunkId('R', 'A', 'M')) ? NES_DIGEST_RAM : NES_DIGEST_CPU;
+                    parts[part] = digestBytes(parts[part], data, length);
+                });
+                break;
+            case chunkId('P', 'P', 'U'):
+                forEachChunk(chunk + 8, size - 8, [parts](uint32_t sub, const uint8_t* data, size_t length) {
+                    int part = NES_DIGEST_PPU;
+                    if (sub == chunkId('P', 'A', 'L') || sub == chunkId('N', 'M', 'T')) part = NES_DIGEST_VRAM;
+                    else if (sub == chunkId('O', 'A', 'M')) part = NES_DIGEST_OAM;
+                    parts[part] = digestBytes(parts[part], data, length);
+                });
+                break;
+            case chunkId('A', 'P', 'U'):
+                parts[NES_DIGEST_APU] = digestBytes(parts[NES_DIGEST_APU], chunk, size);
+                break;
+            case chunkId('I', 'M', 'G'):
+                parts[NES_DIGEST_CART] = digestBytes(parts[NES_DIGEST_CART], chunk, size);
+                break;
+        }
+    });
+}
+
+void NES_GetFrameDigest(NESHandle nes, NESFrameDigest* digest)
+{
+    digest->frame = nes->traceFrame;
+    for (uint32_t& part : digest->parts) {
+        part = DIGEST_BASIS;
+    }
+    
+    if (!nes->gameLoaded) return;
+    
+    digest->parts[NES_DIGEST_VIDEO] = digestBytes(DIGEST_BASIS, nes->frameBuffer, sizeof(nes->frameBuffer));
+    digest->parts[NES_DIGEST_AUDIO] = nes->traceAudio;
+    digestMachineState(nes, digest->parts);
+}
+
+static void traceFrameDone(NESInstance* nes) {
+    if (++nes->traceFrame % nes->traceInterval != 0) return;
+    
+    NESFrameDigest digest;
+    NES_GetFrameDigest(nes, &digest);
+    nes->traceAudio = DIGEST_BASIS;
+    
+    if (nes->traceOutput.is_open()) {
+        nes->traceOutput.write(reinterpret_cast<const char*>(&digest), sizeof(digest));
+        return;
+    }
+    
+    if (nes->traceDiverged) return;
+    
+    // Ran past the end of the golden: the trace lengths differ
+    if (nes->traceNext >= nes->traceGolden.size()) {
+        nes->traceDiverged = true;
+        nes->traceDivergedFrame = digest.frame;
+        nes->traceDivergedParts = 0;
+        return;
+    }
+    
+    const NESFrameDigest& golden = nes->traceGolden[nes->traceNext++];
+    uint32_t differs = 0;
+    for (int i = 0; i < NES_DIGEST_PARTS; i++) {
+        if (golden.parts[i] != digest.parts[i]) differs |= 1u << i;
+    }
+    
+    if (golden.frame != digest.frame || differs) {
+        nes->traceDiverged = true;
+        nes->traceDivergedFrame = digest.frame;
+        nes->traceDivergedParts = differs;
+    }
+}
+
+bool NES_StartDigestTrace(NESHandle nes, const char* tracePath, uint32_t interval, bool verify)
+{
+    if (!nes->gameLoaded || interval == 0) return false;
+    NES_StopDigestTrace(nes);
+    
+    uint32_t header[2] = { interval, NES_DIGEST_PARTS };
+    
+    if (verify) {
+        std::ifstream file(tracePath, std::ios::binary);
+        char magic[sizeof(TRACE_MAGIC)];
+        uint32_t recorded[2];
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 ||
+            !file.read(reinterpret_cast<char*>(recorded), sizeof(recorded)) || recorded[1] != NES_DIGEST_PARTS) {
+            std::cerr << "[NESBridge] Error: Not a digest trace." << std::endl;
+            return false;
+        }
+        
+        NESFrameDigest digest;
+        while (file.read(reinterpret_cast<char*>(&digest), sizeof(digest))) {
+            nes->traceGolden.push_back(digest);
+        }
+        interval = recorded[0];
+    } else {
+        nes->traceOutput.open(tracePath, std::ios::binary | std::ios::trunc);
+        if (!nes->traceOutput.good()) {
+            std::cerr << "[NESBridge] Error: Failed to create digest trace." << std::endl;
+            return false;
+        }
+        nes->traceOutput.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        nes->traceOutput.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+    
+    nes->traceInterval = interval;
+    nes->traceFrame = 0;
+    nes->traceAudio = DIGEST_BASIS;
+    nes->traceActive = true;
+    return true;
+}
+
+void NES_StopDigestTrace(NESHandle nes)
+{
+    if (nes->traceOutput.is_open()) {
+        nes->traceOutput.close();
+    }
+    nes->traceGolden.clear();
+    nes->traceGolden.shrink_to_fit();
+    nes->traceNext = 0;
+    nes->traceDiverged = false;
+    nes->traceActive = false;
+}
+
+bool NES_GetDigestDivergence(NESHandle nes, uint32_t* frame, uint32_t* partMask)
+{
+    // Stopped short of the end of the golden: the trace lengths differ
+    if (!nes->traceDiverged && nes->traceActive && !nes->traceOutput.is_open() &&
+        nes->traceNext < nes->traceGolden.size()) {
+        *frame = nes->traceGolden[nes->traceNext].frame;
+        *partMask = 0;
+        return true;
+    }
+    if (!nes->traceDiverged) return false;
+    
+    *frame = nes->traceDivergedFrame;
+    *partMask = nes->traceDivergedParts;
+    return true;
 }
@@ -22,30 +22,107 @@ extern "C" {
 
 #endif
 
-// Callback type definitions
-typedef void (*NESBufferCallback)(const uint16_t* buffer, size_t size);
+// One emulated console; create as many as needed. A handle may be driven from any
+// thread, but only from one thread at a time.
+typedef struct NESInstance* NESHandle;
+
+// Input movie modes
+typedef enum NESMovieState {
+    NES_MOVIE_NONE,
+    NES_MOVIE_RECORDING,
+    NES_MOVIE_PLAYING
+} NESMovieState;
+
+// Subsystems covered by a frame digest
+typedef enum NESDigestPart {
+    NES_DIGEST_VIDEO,   // frame buffer as last drawn
+    NES_DIGEST_AUDIO,   // samples output since the previous digest
+    NES_DIGEST_CPU,     // CPU registers and timing
+    NES_DIGEST_RAM,     // CPU work RAM
+    NES_DIGEST_PPU,     // PPU registers
+    NES_DIGEST_VRAM,    // name tables and palette
+    NES_DIGEST_OAM,
+    NES_DIGEST_APU,
+    NES_DIGEST_CART,    // mapper registers, cartridge RAM and expansion sound
+    NES_DIGEST_PARTS
+} NESDigestPart;
+
+typedef struct NESFrameDigest {
+    uint32_t frame;     // frames run since the trace started
+    uint32_t parts[NES_DIGEST_PARTS];
+} NESFrameDigest;
+
+// Callback type definitions; userData is the pointer given to NES_Create.
+typedef void (*NESBufferCallback)(void* userData, const uint16_t* buffer, size_t size);
+// Mono float32 samples in [-1, 1], ready for a standard (planar float) audio format.
+typedef void (*NESFloatBufferCallback)(void* userData, const float* buffer, size_t size);
+
+// unchanged is set when the frame is identical to the previous one; the buffer
+// then still holds that frame and the host can skip its upload.
+typedef void (*NESVideoCallback)(void* userData, const uint16_t* buffer, size_t size, bool unchanged);
+
+// Indexed video: raw PPU palette indices (1 or 2 bytes each) plus the 512 x RGB888
+// palette table. paletteChanged is set on the first frame and whenever the table was
+// recomputed, so the host only needs to re-upload it then. With 1 byte per index the
+// emphasis bits are dropped and only the first 64 palette entries are referenced.
+typedef void (*NESIndexedCallback)(void* userData, const void* indices, size_t count, size_t bytesPerIndex,
+                                   const uint8_t* palette, bool paletteChanged, bool unchanged);
 
 
 // Core functions
-void NES_Init(void);
-bool NES_LoadROM(const char* romPath);
-void NES_Shutdown(void);
-void NES_RunFrame(void);
-bool NES_IsPAL(void);
-bool NES_AddCheatCode(const char *_Nonnull cheatCode);
-void NES_ResetCheats();
-void NESSaveGameSave(const char *_Nonnull url);
-void NESLoadGameSave(const char *_Nonnull url);
-void NES_SetBatterySavePath(const char* path);
+// Every instance has its own machine, buffers and callbacks. NES_Shutdown unloads the
+// game and leaves the handle to be destroyed; NES_Destroy shuts down if still needed.
+NESHandle _Nonnull NES_Create(void* _Nullable userData);
+void NES_Destroy(NESHandle _Nullable nes);
+// romPath may also be a zip, 7z, rar or gz archive; its first .nes, .fds or .unf member is loaded
+bool NES_LoadROM(NESHandle _Nonnull nes, const char* romPath);
+// The rule NES_LoadROM picks archive members by
+bool NES_IsImageName(const char* name);
+// Loads romPath with an IPS, UPS, BPS or PPF patch applied in memory; the file is untouched
+bool NES_LoadPatchedROM(NESHandle _Nonnull nes, const char* romPath, const char* patchPath);
+void NES_Shutdown(NESHandle _Nonnull nes);
+void NES_RunFrame(NESHandle _Nonnull nes);
+bool NES_IsPAL(NESHandle _Nonnull nes);
+bool NES_AddCheatCode(NESHandle _Nonnull nes, const char *_Nonnull cheatCode);
+void NES_ResetCheats(NESHandle _Nonnull nes);
+void NESSaveGameSave(NESHandle _Nonnull nes, const char *_Nonnull url);
+void NESLoadGameSave(NESHandle _Nonnull nes, const char *_Nonnull url);
+// Battery RAM is written to this path in the background a moment after the game changes it
+void NES_SetBatterySavePath(NESHandle _Nonnull nes, const char* path);
+// Saves changed battery RAM now and waits for every pending battery write
+bool NES_FlushBatterySave(NESHandle _Nonnull nes);
+
+// Input movies (Nestopia's own format): a start state plus the controller input of every
+// frame. Playback checks the ROM's CRC and returns to live input after the last frame.
+bool NES_StartMovieRecording(NESHandle _Nonnull nes, const char *_Nonnull moviePath);
+bool NES_StartMoviePlayback(NESHandle _Nonnull nes, const char *_Nonnull moviePath);
+void NES_StopMovie(NESHandle _Nonnull nes);
+NESMovieState NES_GetMovieState(NESHandle _Nonnull nes);
+uint32_t NES_GetMovieFrame(NESHandle _Nonnull nes);
+
+// Golden traces: per-subsystem digests taken every interval frames, usually while a movie
+// plays, to check that a core change leaves emulation bit-exact. Recording writes them to
+// tracePath; verifying compares against a recorded trace (whose interval wins) and keeps
+// the first frame that differs along with a mask of the differing parts (1 << NESDigestPart).
+// A golden that is longer or shorter than the run diverges with an empty mask, at the
+// first frame one of them lacks.
+bool NES_StartDigestTrace(NESHandle _Nonnull nes, const char *_Nonnull tracePath, uint32_t interval, bool verify);
+void NES_StopDigestTrace(NESHandle _Nonnull nes);
+bool NES_GetDigestDivergence(NESHandle _Nonnull nes, uint32_t *_Nonnull frame, uint32_t *_Nonnull partMask);
+void NES_GetFrameDigest(NESHandle _Nonnull nes, NESFrameDigest *_Nonnull digest);
 
 // Input handling
-void NES_SetInput(int button);
-void NES_ClearInput(int button);
-void NES_ResetInputs(void);
+void NES_SetInput(NESHandle _Nonnull nes, int button);
+void NES_ClearInput(NESHandle _Nonnull nes, int button);
+void NES_ResetInputs(NESHandle _Nonnull nes);
 
 // Callback setters
-void NES_SetVideoCallback(NESBufferCallback callback);
-void NES_SetAudioCallback(NESBufferCallback callback);
+void NES_SetVideoCallback(NESHandle _Nonnull nes, NESVideoCallback callback);
+void NES_SetAudioCallback(NESHandle _Nonnull nes, NESBufferCallback callback);
+// Takes precedence over the 16-bit callback while set; pass NULL to go back to it.
+void NES_SetFloatAudioCallback(NESHandle _Nonnull nes, NESFloatBufferCallback callback);
+// Pass a callback and 8 or 16 to switch to indexed output, NULL to go back to RGB565.
+void NES_SetIndexedVideoCallback(NESHandle _Nonnull nes, NESIndexedCallback callback, int bitsPerIndex);
 
 #if defined(__cplusplus)
 }
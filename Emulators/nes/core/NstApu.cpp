@@ -22,6 +22,8 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 
+#include <new>
+#include <cmath>
 #include <cstring>
 #include "NstCpu.hpp"
 #include "NstState.hpp"
@@ -112,6 +114,22 @@ namespace Nes
 			0x10, 0x1C, 0x20, 0x1E
 		};
 
+		const byte Apu::Square::forms[4][8] =
+		{
+			{0x1F,0x00,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F},
+			{0x1F,0x00,0x00,0x1F,0x1F,0x1F,0x1F,0x1F},
+			{0x1F,0x00,0x00,0x00,0x00,0x1F,0x1F,0x1F},
+			{0x00,0x1F,0x1F,0x00,0x00,0x00,0x00,0x00}
+		};
+
+		const byte Apu::Triangle::pyramid[32] =
+		{
+			0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,
+			0x8,0x9,0xA,0xB,0xC,0xD,0xE,0xF,
+			0xF,0xE,0xD,0xC,0xB,0xA,0x9,0x8,
+			0x7,0x6,0x5,0x4,0x3,0x2,0x1,0x0
+		};
+
 		const word Apu::Noise::lut[3][16] =
 		{
 			{
@@ -200,13 +218,19 @@ namespace Nes
 		:
 		cpu        (c),
 		extChannel (NULL),
-		buffer     (16)
+		buffer     (16),
+		blip       (NULL)
 		{
 			NST_COMPILE_ASSERT( CPU_RP2A03 == 0 && CPU_RP2A07 == 1 && CPU_DENDY == 2 );
 
 			PowerOff();
 		}
 
+		Apu::~Apu()
+		{
+			delete blip;
+		}
+
 		void Apu::PowerOff()
 		{
 			Reset( false, true );
@@ -240,6 +264,9 @@ namespace Nes
 
 			buffer.Reset();
 
+			if (blip)
+				blip->Reset( cycles.rateCounter );
+
 			if (on)
 			{
 				cpu.Map( 0x4000 ).Set( this, &Apu::Peek_40xx, &Apu::Poke_4000 );
@@ -399,6 +426,39 @@ namespace Nes
 			}
 		}
 
+		void Apu::EnableFloatOutput(const bool enable)
+		{
+			settings.floating = enable;
+		}
+
+		Result Apu::EnableBandLimiting(const bool enable)
+		{
+			if (bool(blip) == enable)
+				return RESULT_NOP;
+
+			if (enable)
+			{
+				try
+				{
+					blip = new Blip;
+				}
+				catch (const std::bad_alloc&)
+				{
+					return RESULT_ERR_OUT_OF_MEMORY;
+				}
+			}
+			else
+			{
+				delete blip;
+				blip = NULL;
+			}
+
+			UpdateSettings();
+			BeginFrame( stream );
+
+			return RESULT_OK;
+		}
+
 		void Apu::UpdateSettings()
 		{
 			cycles.Update( settings.rate, settings.speed, cpu );
@@ -415,6 +475,9 @@ namespace Nes
 			noise.UpdateSettings     ( settings.muted ? 0 : settings.volumes[ Channel::APU_NOISE    ], rate, fixed );
 			dmc.UpdateSettings       ( settings.muted ? 0 : settings.volumes[ Channel::APU_DPCM     ] );
 
+			if (blip)
+				blip->UpdateSettings( settings, cycles.rate, cycles.rateCounter );
+
 			UpdateVolumes();
 		}
 
@@ -438,6 +501,14 @@ namespace Nes
 
 		void Apu::CalculateOscillatorClock(Cycle& rate,uint& fixed) const
 		{
+			if (blip)
+			{
+				// band-limited output steps the oscillators on the frame counter's time base
+				rate = cycles.rate;
+				fixed = cycles.fixed * cpu.GetClock();
+				return;
+			}
+
 			dword sampleRate = settings.rate;
 
 			if (settings.transpose && settings.speed)
@@ -648,12 +719,26 @@ namespace Nes
 				cycles.frameIrqClock = (cycles.frameCounter / cycles.fixed) + (3 - cycles.frameDivider) * (Cycles::frameClocks[cpu.GetModel()][0] / 4);
 				cycles.frameIrqRepeat = 0;
 			}
+
+			if (blip)
+				blip->Reset( cycles.rateCounter );
 		}
 
 		#ifdef NST_MSVC_OPTIMIZE
 		#pragma optimize("", on)
 		#endif
 
+		inline Apu::Channel::Sample Apu::MixSample()
+		{
+			dword dac[2];
+
+			return dcBlocker.Apply
+			(
+				(0 != (dac[0] = square[0].GetSample() + square[1].GetSample()) ? NLN_SQ_0 / (NLN_SQ_1 / dac[0] + NLN_SQ_2) : 0) +
+				(0 != (dac[1] = triangle.GetSample() + noise.GetSample() + dmc.GetSample()) ? NLN_TND_0 / (NLN_TND_1 / dac[1] + NLN_TND_2) : 0)
+			);
+		}
+
 		void NST_FASTCALL Apu::SyncOn(const Cycle target)
 		{
 			NST_ASSERT( (stream && settings.audible) && (cycles.rate && cycles.fixed) && (cycles.extCounter == Cpu::CYCLE_MAX) );
@@ -696,14 +781,33 @@ namespace Nes
 
 				do
 				{
-					buffer << GetSample();
+					Channel::Sample samples[EXT_BLOCK_LENGTH];
+					Channel::Sample extSamples[EXT_BLOCK_LENGTH];
+					uint length = 0;
+
+					// run up to the next expansion clock so the chip renders the stretch in one call
+
+					for (;;)
+					{
+						samples[length++] = MixSample();
+
+						if (cycles.frameCounter <= rateCounter)
+							ClockFrameCounter();
+
+						if (extCounter <= rateCounter || length == EXT_BLOCK_LENGTH || rateCounter + cycles.rate >= target)
+							break;
+
+						rateCounter += cycles.rate;
+					}
+
+					extChannel->RenderBlock( extSamples, length );
+
+					for (uint i=0; i < length; ++i)
+						buffer << Clamp<Channel::OUTPUT_MIN,Channel::OUTPUT_MAX>( samples[i] + extSamples[i] );
 
 					if (extCounter <= rateCounter)
 						extCounter = extChannel->Clock( extCounter, cycles.fixed, rateCounter );
 
-					if (cycles.frameCounter <= rateCounter)
-						ClockFrameCounter();
-
 					rateCounter += cycles.rate;
 				}
 				while (rateCounter < target);
@@ -746,10 +850,23 @@ namespace Nes
 			}
 		}
 
+		void NST_FASTCALL Apu::SyncOnBlip(const Cycle target)
+		{
+			NST_ASSERT( (stream && settings.audible) && blip && (cycles.extCounter == Cpu::CYCLE_MAX) );
+
+			while (cycles.frameCounter < target)
+			{
+				RenderBlip( cycles.frameCounter );
+				ClockFrameCounter();
+			}
+
+			RenderBlip( target );
+		}
+
 		void Apu::BeginFrame(Sound::Output* output)
 		{
 			stream = output;
-			updater = (output && settings.audible ? (cycles.extCounter == Cpu::CYCLE_MAX ? &Apu::SyncOn : &Apu::SyncOnExt) : &Apu::SyncOff);
+			updater = (output && settings.audible ? (cycles.extCounter == Cpu::CYCLE_MAX ? (blip ? &Apu::SyncOnBlip : &Apu::SyncOn) : &Apu::SyncOnExt) : &Apu::SyncOff);
 		}
 
 		inline void Apu::Update(const Cycle target)
@@ -792,6 +909,18 @@ namespace Nes
 
 					if (output << block)
 					{
+						if (updater == &Apu::SyncOnBlip)
+						{
+							// the frame was synthesized up front, pad any shortfall with the last level
+							do
+							{
+								output << blip->GetLast();
+							}
+							while (output);
+
+							continue;
+						}
+
 						const Cycle target = cpu.GetCycles() * cycles.fixed;
 
 						if (cycles.rateCounter < target)
@@ -840,16 +969,32 @@ namespace Nes
 
 			if (updater != &Apu::SyncOff)
 			{
+				if (updater == &Apu::SyncOnBlip)
+				{
+					Update( cpu.GetCycles() );
+					SynthesizeBlip( cpu.GetCycles() * cycles.fixed );
+				}
+
 				dword streamed = 0;
 
 				if (Sound::Output::lockCallback( *stream ))
 				{
 					streamed = stream->length[0] + stream->length[1];
 
-					if (!settings.stereo)
-						FlushSound<iword,false>();
+					if (settings.floating)
+					{
+						if (!settings.stereo)
+							FlushSound<float,false>();
+						else
+							FlushSound<float,true>();
+					}
 					else
-						FlushSound<iword,true>();
+					{
+						if (!settings.stereo)
+							FlushSound<iword,false>();
+						else
+							FlushSound<iword,true>();
+					}
 
 					Sound::Output::unlockCallback( *stream );
 				}
@@ -887,6 +1032,19 @@ namespace Nes
 
 			if (cycles.extCounter != Cpu::CYCLE_MAX)
 				cycles.extCounter -= frame;
+
+			if (blip)
+			{
+				if (updater == &Apu::SyncOnBlip)
+				{
+					blip->origin -= frame;
+					blip->clock -= frame;
+				}
+				else
+				{
+					blip->Resync( cycles.rateCounter );
+				}
+			}
 		}
 
 		#ifdef NST_MSVC_OPTIMIZE
@@ -894,7 +1052,7 @@ namespace Nes
 		#endif
 
 		Apu::Settings::Settings()
-		: rate(44100), speed(0), muted(false), transpose(false), stereo(false), audible(true)
+		: rate(44100), speed(0), muted(false), transpose(false), stereo(false), floating(false), audible(true)
 		{
 			for (uint i=0; i < MAX_CHANNELS; ++i)
 				volumes[i] = Channel::DEFAULT_VOLUME;
@@ -1015,6 +1173,121 @@ namespace Nes
 		#pragma optimize("s", on)
 		#endif
 
+		Apu::Blip::Blip()
+		{
+			const double pi = 3.14159265358979323846;
+			const double cutoff = 0.9;
+
+			for (uint phase=0; phase < PHASES; ++phase)
+			{
+				double taps[TAPS];
+				double sum = 0;
+
+				for (uint i=0; i < TAPS; ++i)
+				{
+					const double x = double(int(i) - int(HALF_TAPS) + 1) - double(phase) / double(PHASES);
+					const double window = 0.42 + 0.5 * std::cos( pi * x / double(HALF_TAPS) ) + 0.08 * std::cos( 2 * pi * x / double(HALF_TAPS) );
+
+					taps[i] = (x != 0 ? std::sin( pi * cutoff * x ) / (pi * x) : cutoff) * window;
+					sum += taps[i];
+				}
+
+				idword total = 0;
+
+				for (uint i=0; i < TAPS; ++i)
+				{
+					kernel[phase][i] = iword(std::floor( taps[i] * double(UNIT) / sum + 0.5 ));
+					total += kernel[phase][i];
+				}
+
+				// every phase must settle on exactly one unit or steps would drift
+				kernel[phase][HALF_TAPS-1] += iword(UNIT - total);
+			}
+		}
+
+		void Apu::Blip::UpdateSettings(const Settings& settings,const Cycle rate,const Cycle time)
+		{
+			NST_ASSERT( rate );
+
+			uint volumes[5];
+
+			for (uint i=0; i < 5; ++i)
+				volumes[i] = settings.muted ? 0 : (settings.volumes[i] * Channel::OUTPUT_MUL + Channel::DEFAULT_VOLUME/2) / Channel::DEFAULT_VOLUME;
+
+			for (uint a=0; a < 16; ++a)
+			{
+				for (uint b=0; b < 16; ++b)
+				{
+					const dword dac = a * volumes[SQUARE1] + b * volumes[SQUARE2];
+					squareMix[a][b] = (dac ? NLN_SQ_0 / (NLN_SQ_1 / dac + NLN_SQ_2) : 0);
+				}
+			}
+
+			for (uint t=0; t < 16; ++t)
+			{
+				for (uint n=0; n < 16; ++n)
+				{
+					for (uint d=0; d < 128; ++d)
+					{
+						const dword dac = t * volumes[TRIANGLE] * 3 + n * volumes[NOISE] * 2 + d * volumes[DMC];
+						tndMix[t][n][d] = (dac ? NLN_TND_0 / (NLN_TND_1 / dac + NLN_TND_2) : 0);
+					}
+				}
+			}
+
+			factor = (qaword(PHASES) << 32) / rate;
+			span = Cycle(NST_MIN(qaword(rate) * MAX_LENGTH,qaword(MAX_SPAN)));
+
+			Reset( time );
+		}
+
+		void Apu::Blip::Reset(const Cycle time)
+		{
+			accumulator = 0;
+			mix = 0;
+			last = 0;
+
+			for (uint i=0; i < 5; ++i)
+				levels[i] = 0;
+
+			Resync( time );
+		}
+
+		void Apu::Blip::Resync(const Cycle time)
+		{
+			origin = time;
+			clock = time;
+			accumulator = idword(mix) << UNIT_BITS;
+
+			std::memset( deltas, 0, sizeof(deltas) );
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("", on)
+		#endif
+
+		void Apu::Blip::Synthesize(const uint count,Sound::Buffer& buffer,Channel::DcBlocker& dcBlocker)
+		{
+			NST_ASSERT( count && count <= MAX_LENGTH );
+
+			idword sum = accumulator;
+
+			for (uint i=0; i < count; ++i)
+			{
+				sum += deltas[i];
+				buffer << (last = Clamp<Channel::OUTPUT_MIN,Channel::OUTPUT_MAX>( dcBlocker.Apply( sum >> UNIT_BITS ) ));
+			}
+
+			accumulator = sum;
+
+			std::memmove( deltas, deltas + count, sizeof(deltas[0]) * TAPS );
+			std::memset( deltas + TAPS, 0, sizeof(deltas[0]) * count );
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("s", on)
+		#endif
+
 		Apu::Channel::LengthCounter::LengthCounter()
 		{
 			Reset();
@@ -1272,6 +1545,12 @@ namespace Nes
 			apu.Update();
 		}
 
+		void Apu::Channel::RenderBlock(Sample* NST_RESTRICT out,uint count)
+		{
+			for (; count; --count)
+				*out++ = GetSample();
+		}
+
 		Cycle Apu::Channel::Clock(Cycle,Cycle,Cycle)
 		{
 			return Cpu::CYCLE_MAX;
@@ -1583,14 +1862,6 @@ namespace Nes
 
 			if (active)
 			{
-				static const byte forms[4][8] =
-				{
-					{0x1F,0x00,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F},
-					{0x1F,0x00,0x00,0x1F,0x1F,0x1F,0x1F,0x1F},
-					{0x1F,0x00,0x00,0x00,0x00,0x1F,0x1F,0x1F},
-					{0x00,0x1F,0x1F,0x00,0x00,0x00,0x00,0x00}
-				};
-
 				const byte* const NST_RESTRICT form = forms[duty];
 
 				if (timer >= 0)
@@ -1634,6 +1905,40 @@ namespace Nes
 			return amp;
 		}
 
+		void Apu::Square::Render(Blip& blip,const uint channel,const Cycle time,const Cycle target)
+		{
+			NST_VERIFY( bool(active) == CanOutput() && timer >= 0 );
+
+			const uint volume = (active ? envelope.Level() : 0);
+			const byte* const NST_RESTRICT form = forms[duty];
+
+			blip.SetLevel( channel, volume >> form[step], time );
+
+			Cycle next = time + timer;
+
+			if (next < target)
+			{
+				if (volume)
+				{
+					do
+					{
+						step = (step + 1) & 0x7;
+						blip.SetLevel( channel, volume >> form[step], next );
+						next += frequency;
+					}
+					while (next < target);
+				}
+				else
+				{
+					const uint count = (target - next + frequency - 1) / frequency;
+					step = (step + count) & 0x7;
+					next += count * frequency;
+				}
+			}
+
+			timer = idword(next - target);
+		}
+
 		#ifdef NST_MSVC_OPTIMIZE
 		#pragma optimize("s", on)
 		#endif
@@ -1818,14 +2123,6 @@ namespace Nes
 
 			if (active)
 			{
-				static const byte pyramid[32] =
-				{
-					0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,
-					0x8,0x9,0xA,0xB,0xC,0xD,0xE,0xF,
-					0xF,0xE,0xD,0xC,0xB,0xA,0x9,0x8,
-					0x7,0x6,0x5,0x4,0x3,0x2,0x1,0x0
-				};
-
 				dword sum = timer;
 				timer -= idword(rate);
 
@@ -1861,6 +2158,33 @@ namespace Nes
 			return amp;
 		}
 
+		NST_SINGLE_CALL void Apu::Triangle::Render(Blip& blip,const Cycle time,const Cycle target)
+		{
+			NST_VERIFY( bool(active) == CanOutput() && timer >= 0 );
+
+			if (active)
+			{
+				blip.SetLevel( Blip::TRIANGLE, pyramid[step], time );
+
+				Cycle next = time + timer;
+
+				while (next < target)
+				{
+					step = (step + 1) & 0x1F;
+					blip.SetLevel( Blip::TRIANGLE, pyramid[step], next );
+					next += frequency;
+				}
+
+				timer = idword(next - target);
+				amp = pyramid[step] * outputVolume * 3;
+			}
+			else
+			{
+				// a halted triangle holds whatever it last output, silent after a reset
+				blip.SetLevel( Blip::TRIANGLE, outputVolume ? amp / (outputVolume * 3) : 0, time );
+			}
+		}
+
 		inline uint Apu::Triangle::GetLengthCounter() const
 		{
 			return lengthCounter.GetCount();
@@ -2067,6 +2391,33 @@ namespace Nes
 			return 0;
 		}
 
+		NST_SINGLE_CALL void Apu::Noise::Render(Blip& blip,const Cycle time,const Cycle target)
+		{
+			NST_VERIFY( bool(active) == CanOutput() && timer >= 0 );
+
+			const uint volume = (active ? envelope.Level() : 0);
+
+			blip.SetLevel( Blip::NOISE, (bits & 0x4000) ? 0 : volume, time );
+
+			Cycle next = time + timer;
+
+			if (volume)
+			{
+				for (; next < target; next += frequency)
+				{
+					bits = (bits << 1) | ((bits >> 14 ^ bits >> shifter) & 0x1);
+					blip.SetLevel( Blip::NOISE, (bits & 0x4000) ? 0 : volume, next );
+				}
+			}
+			else
+			{
+				for (; next < target; next += frequency)
+					bits = (bits << 1) | ((bits >> 14 ^ bits >> shifter) & 0x1);
+			}
+
+			timer = idword(next - target);
+		}
+
 		inline uint Apu::Noise::GetLengthCounter() const
 		{
 			return lengthCounter.GetCount();
@@ -2425,6 +2776,11 @@ namespace Nes
 			return dma.lengthCounter;
 		}
 
+		inline uint Apu::Dmc::GetLevel() const
+		{
+			return outputVolume ? curSample / outputVolume : 0;
+		}
+
 		#ifdef NST_MSVC_OPTIMIZE
 		#pragma optimize("s", on)
 		#endif
@@ -2448,6 +2804,9 @@ namespace Nes
 			dcBlocker.Reset();
 
 			buffer.Reset( false );
+
+			if (blip)
+				blip->Reset( cycles.rateCounter );
 		}
 
 		#ifdef NST_MSVC_OPTIMIZE
@@ -2506,6 +2865,45 @@ namespace Nes
 			while (cycles.dmcClock <= target);
 		}
 
+		NST_NO_INLINE void Apu::RenderBlip(const Cycle target)
+		{
+			NST_ASSERT( blip );
+
+			Blip& b = *blip;
+
+			while (b.clock < target)
+			{
+				const Cycle next = (target > b.origin + b.span ? b.origin + b.span : target);
+
+				b.SetLevel( Blip::DMC, dmc.GetLevel(), b.clock );
+
+				square[0].Render( b, Blip::SQUARE1, b.clock, next );
+				square[1].Render( b, Blip::SQUARE2, b.clock, next );
+				triangle.Render( b, b.clock, next );
+				noise.Render( b, b.clock, next );
+
+				b.clock = next;
+
+				if (next != target)
+					SynthesizeBlip( next );
+			}
+		}
+
+		void Apu::SynthesizeBlip(const Cycle target)
+		{
+			NST_ASSERT( blip && cycles.rate );
+
+			if (cycles.rateCounter < target)
+			{
+				const uint count = (target - cycles.rateCounter + cycles.rate - 1) / cycles.rate;
+
+				blip->Synthesize( count, buffer, dcBlocker );
+
+				cycles.rateCounter += count * cycles.rate;
+				blip->origin = cycles.rateCounter;
+			}
+		}
+
 		NST_NO_INLINE void Apu::ClockFrameCounter()
 		{
 			NST_COMPILE_ASSERT( STATUS_SEQUENCE_5_STEP == 0x80 );
@@ -2538,16 +2936,7 @@ namespace Nes
 
 		NST_NO_INLINE Apu::Channel::Sample Apu::GetSample()
 		{
-			dword dac[2];
-
-			return Clamp<Channel::OUTPUT_MIN,Channel::OUTPUT_MAX>
-			(
-				dcBlocker.Apply
-				(
-					(0 != (dac[0] = square[0].GetSample() + square[1].GetSample()) ? NLN_SQ_0 / (NLN_SQ_1 / dac[0] + NLN_SQ_2) : 0) +
-					(0 != (dac[1] = triangle.GetSample() + noise.GetSample() + dmc.GetSample()) ? NLN_TND_0 / (NLN_TND_1 / dac[1] + NLN_TND_2) : 0)
-				) + (extChannel ? extChannel->GetSample() : 0)
-			);
+			return Clamp<Channel::OUTPUT_MIN,Channel::OUTPUT_MAX>( MixSample() + (extChannel ? extChannel->GetSample() : 0) );
 		}
 
 		NES_POKE_AD(Apu,4000)
@@ -50,6 +50,8 @@ namespace Nes
 		public:
 
 			explicit Apu(Cpu&);
+			~Apu();
+
 			void  Reset(bool);
 			void  PowerOff();
 			void  ClearBuffers();
@@ -68,6 +70,8 @@ namespace Nes
 			void   SetAutoTranspose(bool);
 			void   SetGenie(bool);
 			void   EnableStereo(bool);
+			void   EnableFloatOutput(bool);
+			Result EnableBandLimiting(bool);
 
 			void SaveState(State::Saver&,dword) const;
 			void LoadState(State::Loader&);
@@ -122,6 +126,7 @@ namespace Nes
 
 				virtual void Reset() = 0;
 				virtual Sample GetSample() = 0;
+				virtual void RenderBlock(Sample*,uint);
 				virtual Cycle Clock(Cycle,Cycle,Cycle);
 				virtual bool UpdateSettings() = 0;
 
@@ -212,6 +217,11 @@ namespace Nes
 						return output;
 					}
 
+					uint Level() const
+					{
+						return regs[regs[1] >> 4 & 1U] & 0xFU;
+					}
+
 					void ResetClock()
 					{
 						reset = true;
@@ -246,6 +256,8 @@ namespace Nes
 
 			typedef void (NST_FASTCALL Apu::*Updater)(Cycle);
 
+			class Blip;
+
 			inline void Update(Cycle);
 			void Update();
 			void UpdateLatency();
@@ -259,6 +271,7 @@ namespace Nes
 			enum
 			{
 				MAX_CHANNELS            = 11,
+				EXT_BLOCK_LENGTH        = 64,
 				STATUS_NO_FRAME_IRQ     = 0x40,
 				STATUS_SEQUENCE_5_STEP  = 0x80,
 				STATUS_FRAME_IRQ_ENABLE = 0,
@@ -296,11 +309,16 @@ namespace Nes
 			NES_DECL_PEEK( 4015 );
 			NES_DECL_PEEK( 40xx );
 
+			inline Channel::Sample MixSample();
 			NST_NO_INLINE Channel::Sample GetSample();
 
 			void NST_FASTCALL SyncOn    (Cycle);
 			void NST_FASTCALL SyncOnExt (Cycle);
 			void NST_FASTCALL SyncOff   (Cycle);
+			void NST_FASTCALL SyncOnBlip(Cycle);
+
+			NST_NO_INLINE void RenderBlip(Cycle);
+			void SynthesizeBlip(Cycle);
 
 			NST_NO_INLINE void ClockFrameIRQ(Cycle);
 			NST_NO_INLINE void ClockFrameCounter();
@@ -392,6 +410,7 @@ namespace Nes
 				NST_SINGLE_CALL void Disable(bool);
 
 				dword GetSample();
+				void Render(Blip&,uint,Cycle,Cycle);
 
 				NST_SINGLE_CALL void ClockEnvelope();
 				NST_SINGLE_CALL void ClockSweep(uint);
@@ -428,6 +447,8 @@ namespace Nes
 				uint sweepIncrease;
 				word sweepShift;
 				word waveLength;
+
+				static const byte forms[4][8];
 			};
 
 			class Triangle : public Oscillator
@@ -447,6 +468,7 @@ namespace Nes
 				NST_SINGLE_CALL void Disable(bool);
 
 				NST_SINGLE_CALL dword GetSample();
+				NST_SINGLE_CALL void Render(Blip&,Cycle,Cycle);
 
 				NST_SINGLE_CALL void ClockLinearCounter();
 				NST_SINGLE_CALL void ClockLengthCounter();
@@ -480,6 +502,8 @@ namespace Nes
 				byte linearCtrl;
 				byte linearCounter;
 				Channel::LengthCounter lengthCounter;
+
+				static const byte pyramid[32];
 			};
 
 			class Noise : public Oscillator
@@ -497,6 +521,7 @@ namespace Nes
 				NST_SINGLE_CALL void Disable(bool);
 
 				NST_SINGLE_CALL dword GetSample();
+				NST_SINGLE_CALL void Render(Blip&,Cycle,Cycle);
 
 				NST_SINGLE_CALL void ClockEnvelope();
 				NST_SINGLE_CALL void ClockLengthCounter();
@@ -547,6 +572,7 @@ namespace Nes
 
 				inline void ClearAmp();
 				inline uint GetLengthCounter() const;
+				inline uint GetLevel() const;
 
 				static Cycle GetResetFrequency(CpuModel);
 
@@ -603,10 +629,88 @@ namespace Nes
 				bool transpose;
 				bool genie;
 				bool stereo;
+				bool floating;
 				bool audible;
 				byte volumes[MAX_CHANNELS];
 			};
 
+			class Blip
+			{
+			public:
+
+				Blip();
+
+				void UpdateSettings(const Settings&,Cycle,Cycle);
+				void Reset(Cycle);
+				void Resync(Cycle);
+				void Synthesize(uint,Sound::Buffer&,Channel::DcBlocker&);
+
+				enum
+				{
+					SQUARE1,
+					SQUARE2,
+					TRIANGLE,
+					NOISE,
+					DMC,
+					PHASE_BITS = 5,
+					PHASES     = 1U << PHASE_BITS,
+					HALF_TAPS  = 8,
+					TAPS       = HALF_TAPS * 2,
+					UNIT_BITS  = 12,
+					UNIT       = 1L << UNIT_BITS,
+					MAX_LENGTH = 0x1000,
+					MAX_SPAN   = 0x40000000
+				};
+
+			private:
+
+				void AddDelta(const Cycle time,const idword delta)
+				{
+					const dword position = (time > origin ? dword(qaword(time - origin) * factor >> 32) : 0);
+
+					NST_ASSERT( (position >> PHASE_BITS) < MAX_LENGTH );
+
+					idword* const NST_RESTRICT dst = deltas + (position >> PHASE_BITS);
+					const iword* const NST_RESTRICT src = kernel[position & (PHASES-1)];
+
+					for (uint i=0; i < TAPS; ++i)
+						dst[i] += src[i] * delta;
+				}
+
+				qaword factor;
+				idword accumulator;
+				dword mix;
+				uint levels[5];
+				Channel::Sample last;
+				idword deltas[MAX_LENGTH + TAPS];
+				iword kernel[PHASES][TAPS];
+				dword squareMix[16][16];
+				dword tndMix[16][16][128];
+
+			public:
+
+				Cycle origin;
+				Cycle clock;
+				Cycle span;
+
+				void SetLevel(const uint channel,const uint level,const Cycle time)
+				{
+					if (levels[channel] != level)
+					{
+						levels[channel] = level;
+
+						const dword next = squareMix[levels[SQUARE1]][levels[SQUARE2]] + tndMix[levels[TRIANGLE]][levels[NOISE]][levels[DMC]];
+						AddDelta( time, idword(next - mix) );
+						mix = next;
+					}
+				}
+
+				Channel::Sample GetLast() const
+				{
+					return last;
+				}
+			};
+
 			uint ctrl;
 			Updater updater;
 			Cpu& cpu;
@@ -621,6 +725,7 @@ namespace Nes
 			Sound::Output* stream;
 			Sound::Buffer buffer;
 			Settings settings;
+			Blip* blip;
 
 		public:
 
@@ -649,11 +754,21 @@ namespace Nes
 				return settings.stereo;
 			}
 
+			bool InFloat() const
+			{
+				return settings.floating;
+			}
+
 			bool IsMuted() const
 			{
 				return settings.muted;
 			}
 
+			bool IsBandLimited() const
+			{
+				return blip != NULL;
+			}
+
 			bool IsAudible() const
 			{
 				return settings.audible && !settings.muted;
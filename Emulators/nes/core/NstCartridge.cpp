@@ -397,6 +397,21 @@ namespace Nes
 			}
 		}
 
+		bool Cartridge::SaveBattery()
+		{
+			try
+			{
+				if (board)
+					board->Save( savefile );
+
+				return true;
+			}
+			catch (...)
+			{
+				return false;
+			}
+		}
+
 		void Cartridge::SaveState(State::Saver& state,const dword baseChunk) const
 		{
 			state.Begin( baseChunk );
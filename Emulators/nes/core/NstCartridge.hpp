@@ -102,6 +102,7 @@ namespace Nes
 
 			void Reset(bool);
 			bool PowerOff();
+			bool SaveBattery();
 			void LoadState(State::Loader&);
 			void SaveState(State::Saver&,dword) const;
 			void Destroy();
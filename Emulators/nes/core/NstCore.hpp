@@ -145,6 +145,25 @@
 
 #endif
 
+#ifndef NST_NO_SIMD
+
+ #if !defined(NST_SSE2) && !defined(NST_NEON)
+
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define NST_SSE2
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #define NST_NEON
+  #endif
+
+ #endif
+
+#else
+
+ #undef NST_SSE2
+ #undef NST_NEON
+
+#endif
+
 #define NST_NOP() ((void)0)
 
 #ifndef NST_FORCE_INLINE
@@ -2022,7 +2022,7 @@ namespace Nes
 			return rateCycles;
 		}
 
-		NST_SINGLE_CALL dword Fds::Sound::GetModulation() const
+		inline dword Fds::Sound::GetModulation() const
 		{
 			if (dword pos = envelopes.units[SWEEP].Gain())
 			{
@@ -2059,36 +2059,54 @@ namespace Nes
 			return wave.length;
 		}
 
-		Fds::Sound::Sample Fds::Sound::GetSample()
+		void Fds::Sound::RenderBlock(Sample* NST_RESTRICT out,uint count)
 		{
 			NST_ASSERT( modulator.active == CanModulate() && bool(active) == CanOutput() );
 
-			if (modulator.active)
+			const dword range = Wave::SIZE * wave.rate;
+
+			// without the modulator the pitch can't change before the next register write or clock
+			dword step = (active && !modulator.active ? dword(qaword(GetModulation()) * wave.frame / wave.clock) : 0);
+
+			for (; count; --count)
 			{
-				for (modulator.timer -= modulator.length * modulator.rate; modulator.timer & Modulator::TIMER_CARRY; modulator.timer += modulator.clock)
+				if (modulator.active)
 				{
-					const uint value = modulator.pos >> 1;
-					modulator.pos = (modulator.pos + 1U) & 0x3F;
-					modulator.sweep = (modulator.table[value] != 0x80) ? (modulator.sweep + modulator.table[value]) & 0x7FU : 0x00U;
+					for (modulator.timer -= modulator.length * modulator.rate; modulator.timer & Modulator::TIMER_CARRY; modulator.timer += modulator.clock)
+					{
+						const uint value = modulator.pos >> 1;
+						modulator.pos = (modulator.pos + 1U) & 0x3F;
+						modulator.sweep = (modulator.table[value] != 0x80) ? (modulator.sweep + modulator.table[value]) & 0x7FU : 0x00U;
+					}
+
+					if (active)
+						step = dword(qaword(GetModulation()) * wave.frame / wave.clock);
 				}
-			}
 
-			dword sample = 0;
+				dword sample = 0;
 
-			if (active)
-			{
-				const dword pos = wave.pos;
-				wave.pos = (wave.pos + dword(qaword(GetModulation()) * wave.frame / wave.clock) + Wave::SIZE * wave.rate) % (Wave::SIZE * wave.rate);
+				if (active)
+				{
+					const dword pos = wave.pos;
+					wave.pos = (wave.pos + step + range) % range;
 
-				if (wave.pos < pos)
-					wave.volume = envelopes.units[VOLUME].Output();
+					if (wave.pos < pos)
+						wave.volume = envelopes.units[VOLUME].Output();
 
-				sample = wave.volume * volume * wave.table[(wave.pos / wave.rate) & 0x3F] / 30;
-			}
+					sample = wave.volume * volume * wave.table[(wave.pos / wave.rate) & 0x3F] / 30;
+				}
+
+				amp = (amp * 2 + sample) / 3;
 
-			amp = (amp * 2 + sample) / 3;
+				*out++ = dcBlocker.Apply( amp * output / DEFAULT_VOLUME );
+			}
+		}
 
-			return dcBlocker.Apply( amp * output / DEFAULT_VOLUME );
+		Fds::Sound::Sample Fds::Sound::GetSample()
+		{
+			Sample sample;
+			RenderBlock( &sample, 1 );
+			return sample;
 		}
 	}
 }
@@ -86,6 +86,7 @@ namespace Nes
 				void Reset();
 				bool UpdateSettings();
 				Sample GetSample();
+				void RenderBlock(Sample*,uint);
 				Cycle Clock(Cycle,Cycle,Cycle);
 
 			private:
@@ -93,7 +94,7 @@ namespace Nes
 				bool CanOutput() const;
 				inline bool CanModulate() const;
 
-				NST_SINGLE_CALL dword GetModulation() const;
+				inline dword GetModulation() const;
 
 				enum
 				{
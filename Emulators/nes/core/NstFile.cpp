@@ -526,6 +526,9 @@ namespace Nes
 
 				Saver saver( type, saveBlock, saveBlockCount, context.data );
 				Api::User::fileIoCallback( saver );
+
+				// what was handed out is now the saved copy, so later saves skip it until it changes
+				context.checksum = checksum;
 			}
 		}
 	}
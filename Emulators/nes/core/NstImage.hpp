@@ -95,6 +95,11 @@ namespace Nes
 				return true;
 			}
 
+			virtual bool SaveBattery()
+			{
+				return true;
+			}
+
 			virtual void VSync() {}
 
 			virtual void LoadState(State::Loader&) {}
@@ -130,11 +130,19 @@ namespace Nes
 				Cycle fds;
 			};
 
+			enum
+			{
+				BLOCK_LENGTH = 64
+			};
+
 			void Reset();
 			bool UpdateSettings();
 			Sample GetSample();
+			void RenderBlock(Sample*,uint);
 			Cycle Clock(Cycle,Cycle,Cycle);
 
+			static void Mix(Apu::Channel&,Sample*,uint);
+
 			Clocks clocks;
 
 		public:
@@ -713,6 +721,35 @@ namespace Nes
 			);
 		}
 
+		void Nsf::Chips::Mix(Apu::Channel& chip,Sample* NST_RESTRICT out,uint count)
+		{
+			while (count)
+			{
+				const uint length = NST_MIN(count,uint(BLOCK_LENGTH));
+				Sample block[BLOCK_LENGTH];
+
+				chip.RenderBlock( block, length );
+
+				for (uint i=0; i < length; ++i)
+					*out++ += block[i];
+
+				count -= length;
+			}
+		}
+
+		void Nsf::Chips::RenderBlock(Sample* const out,const uint count)
+		{
+			for (uint i=0; i < count; ++i)
+				out[i] = 0;
+
+			if (mmc5) Mix( *mmc5, out, count );
+			if (vrc6) Mix( *vrc6, out, count );
+			if (vrc7) Mix( *vrc7, out, count );
+			if (fds)  Mix( *fds,  out, count );
+			if (s5b)  Mix( *s5b,  out, count );
+			if (n163) Mix( *n163, out, count );
+		}
+
 		inline uint Nsf::FetchLast(uint offset) const
 		{
 			NST_ASSERT( offset <= 0xFFF );
@@ -26,6 +26,12 @@
 #include "NstCpu.hpp"
 #include "NstSoundRenderer.hpp"
 
+#if defined(NST_SSE2)
+#include <emmintrin.h>
+#elif defined(NST_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Nes
 {
 	namespace Core
@@ -61,6 +67,38 @@ namespace Nes
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("", on)
 			#endif
+
+			void Buffer::Convert(float* NST_RESTRICT dst,const iword* NST_RESTRICT src,const uint length)
+			{
+				uint i = 0;
+
+				#if defined(NST_SSE2)
+
+				const __m128 scale = _mm_set1_ps( 1.f / 32768 );
+
+				for (; i + 8 <= length; i += 8)
+				{
+					const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i) );
+
+					_mm_storeu_ps( dst + i + 0, _mm_mul_ps( _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 ) ), scale ) );
+					_mm_storeu_ps( dst + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( s, s ), 16 ) ), scale ) );
+				}
+
+				#elif defined(NST_NEON)
+
+				for (; i + 8 <= length; i += 8)
+				{
+					const int16x8_t s = vld1q_s16( src + i );
+
+					vst1q_f32( dst + i + 0, vmulq_n_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( s ) ) ), 1.f / 32768 ) );
+					vst1q_f32( dst + i + 4, vmulq_n_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( s ) ) ), 1.f / 32768 ) );
+				}
+
+				#endif
+
+				for (; i < length; ++i)
+					dst[i] = src[i] * (1.f / 32768);
+			}
 		}
 	}
 }
@@ -99,6 +99,8 @@ namespace Nes
 					iword buffer[SIZE];
 				};
 
+				static void Convert(float* NST_RESTRICT,const iword* NST_RESTRICT,uint);
+
 				uint pos;
 				uint start;
 				iword* const NST_RESTRICT output;
@@ -157,6 +159,30 @@ namespace Nes
 				inline void operator << (Sample);
 				NST_FORCE_INLINE bool operator << (Block&);
 			};
+
+			template<>
+			class Buffer::Renderer<float,0U> : public Buffer::BaseRenderer<float>
+			{
+			public:
+
+				inline Renderer(void*,uint,const History&);
+
+				inline void operator << (Sample);
+				NST_FORCE_INLINE bool operator << (const Block&);
+			};
+
+			template<>
+			class Buffer::Renderer<float,1U> : public Buffer::BaseRenderer<float>
+			{
+				History& history;
+
+			public:
+
+				inline Renderer(void*,uint,History&);
+
+				inline void operator << (Sample);
+				NST_FORCE_INLINE bool operator << (Block&);
+			};
 		}
 	}
 }
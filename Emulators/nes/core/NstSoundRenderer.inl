@@ -180,6 +180,62 @@ namespace Nes
 
 				return dst != end;
 			}
+
+			inline Buffer::Renderer<float,0U>::Renderer(void* samples,uint length,const History&)
+			: BaseRenderer<float>(samples,length) {}
+
+			inline void Buffer::Renderer<float,0U>::operator << (Sample sample)
+			{
+				*dst++ = sample * (1.f / 32768);
+			}
+
+			NST_FORCE_INLINE bool Buffer::Renderer<float,0U>::operator << (const Block& block)
+			{
+				NST_ASSERT( end - dst >= block.length );
+
+				if (block.length)
+				{
+					if (block.start + block.length <= SIZE)
+					{
+						Convert( dst, block.data + block.start, block.length );
+					}
+					else
+					{
+						const uint chunk = SIZE - block.start;
+						Convert( dst, block.data + block.start, chunk );
+						Convert( dst + chunk, block.data, (block.start + block.length) - SIZE );
+					}
+
+					dst += block.length;
+				}
+
+				return dst != end;
+			}
+
+			inline Buffer::Renderer<float,1U>::Renderer(void* samples,uint length,History& h)
+			: BaseRenderer<float>(samples,length << 1), history(h) {}
+
+			inline void Buffer::Renderer<float,1U>::operator << (Sample sample)
+			{
+				iword delayed;
+				history >> delayed;
+				history << sample;
+				dst[0] = delayed * (1.f / 32768);
+				dst[1] = sample * (1.f / 32768);
+				dst += 2;
+			}
+
+			NST_FORCE_INLINE bool Buffer::Renderer<float,1U>::operator << (Block& block)
+			{
+				NST_ASSERT( end - dst >= block.length );
+
+				block.length += block.start;
+
+				for (uint i=block.start; i < block.length; ++i)
+					(*this) << Sample( block.data[i & MASK] );
+
+				return dst != end;
+			}
 		}
 	}
 }
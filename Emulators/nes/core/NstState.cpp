@@ -24,6 +24,7 @@
 
 #include "NstState.hpp"
 #include "NstZlib.hpp"
+#include "NstLz.hpp"
 
 namespace Nes
 {
@@ -31,18 +32,12 @@ namespace Nes
 	{
 		namespace State
 		{
-			enum Compression
-			{
-				NO_COMPRESSION,
-				ZLIB_COMPRESSION
-			};
-
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("s", on)
 			#endif
 
-			Saver::Saver(StdStream p,bool c,bool i,dword append)
-			: stream(p), chunks(CHUNK_RESERVE), useCompression(c), internal(i)
+			Saver::Saver(StdStream p,Compression c,bool i,dword append)
+			: stream(p), chunks(CHUNK_RESERVE), compression(c), internal(i)
 			{
 				NST_COMPILE_ASSERT( CHUNK_RESERVE >= 2 );
 
@@ -128,14 +123,31 @@ namespace Nes
 			{
 				NST_VERIFY( length );
 
-				if (Zlib::AVAILABLE && useCompression && length > 1)
+				if (compression != NO_COMPRESSION && length > 1)
 				{
 					Vector<byte> buffer( length - 1 );
+					dword compressed = 0;
+
+					switch (compression)
+					{
+						case ZLIB_COMPRESSION:
+
+							compressed = Zlib::Compress( data, length, buffer.Begin(), buffer.Size(), Zlib::NORMAL_COMPRESSION );
+							break;
 
-					if (const dword compressed = Zlib::Compress( data, length, buffer.Begin(), buffer.Size(), Zlib::BEST_COMPRESSION ))
+						case LZ_COMPRESSION:
+
+							compressed = Lz::Compress( data, length, buffer.Begin(), buffer.Size() );
+							break;
+
+						default:
+							break;
+					}
+
+					if (compressed)
 					{
 						chunks.Back() += 1 + compressed;
-						stream.Write8( ZLIB_COMPRESSION );
+						stream.Write8( compression );
 						stream.Write( buffer.Begin(), compressed );
 						return *this;
 					}
@@ -277,6 +289,19 @@ namespace Nes
 								break;
 						}
 
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					case LZ_COMPRESSION:
+
+						if (chunks.Back())
+						{
+							Vector<byte> buffer( chunks.Back() );
+							Read( buffer.Begin(), buffer.Size() );
+
+							if (Lz::Uncompress( buffer.Begin(), buffer.Size(), data, length ))
+								break;
+						}
+
 					default:
 
 						throw RESULT_ERR_CORRUPT_FILE;
@@ -41,11 +41,20 @@ namespace Nes
 	{
 		namespace State
 		{
+			// Tag in front of every compressed block, naming the codec that packed it.
+			// A Saver writes with the codec it was given, a Loader reads any of them.
+			enum Compression
+			{
+				NO_COMPRESSION,
+				ZLIB_COMPRESSION,
+				LZ_COMPRESSION
+			};
+
 			class Saver
 			{
 			public:
 
-				Saver(StdStream,bool,bool,dword=0);
+				Saver(StdStream,Compression,bool,dword=0);
 				~Saver();
 
 				Saver& Begin(dword);
@@ -69,7 +78,7 @@ namespace Nes
 				};
 
 				Vector<dword> chunks;
-				const bool useCompression;
+				const Compression compression;
 				const bool internal;
 
 			public:
@@ -292,7 +292,7 @@ namespace Nes
 			struct Saver : State::Saver
 			{
 				Saver(std::ostream& s,dword a)
-				: State::Saver(&s,true,true,a) {}
+				: State::Saver(&s,State::LZ_COMPRESSION,true,a) {}
 
 				bool operator == (std::ostream& s) const
 				{
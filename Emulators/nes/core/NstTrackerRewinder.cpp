@@ -30,7 +30,7 @@
 #include "NstState.hpp"
 #include "NstTrackerRewinder.hpp"
 #include "api/NstApiRewinder.hpp"
-#include "NstZlib.hpp"
+#include "NstLz.hpp"
 
 namespace Nes
 {
@@ -324,11 +324,11 @@ namespace Nes
 			{
 				pos = buffer.Size();
 
-				if (Zlib::AVAILABLE && pos >= MIN_COMPRESSION_SIZE)
+				if (pos >= MIN_COMPRESSION_SIZE)
 				{
 					Buffer tmp( pos - 1 );
 
-					if (const dword size = Zlib::Compress( buffer.Begin(), buffer.Size(), tmp.Begin(), tmp.Size(), Zlib::NORMAL_COMPRESSION ))
+					if (const dword size = Lz::Compress( buffer.Begin(), buffer.Size(), tmp.Begin(), tmp.Size() ))
 					{
 						NST_ASSERT( size < pos );
 						tmp.SetTo( size );
@@ -353,10 +353,10 @@ namespace Nes
 			dword size = pos;
 			pos = 0;
 
-			if (Zlib::AVAILABLE && size > buffer.Size())
+			if (size > buffer.Size())
 			{
 				Buffer tmp( size );
-				size = Zlib::Uncompress( buffer.Begin(), buffer.Size(), tmp.Begin(), tmp.Size() );
+				size = Lz::Uncompress( buffer.Begin(), buffer.Size(), tmp.Begin(), tmp.Size() );
 
 				if (!size)
 					throw RESULT_ERR_CORRUPT_FILE;
@@ -443,7 +443,8 @@ namespace Nes
 				stream.seekp( 0, std::stringstream::beg );
 				stream.clear();
 
-				State::Saver saver( &static_cast<std::ostream&>(stream), false, true );
+				// Lz packs a key in a fraction of a frame and keeps the sixty of them small
+				State::Saver saver( &static_cast<std::ostream&>(stream), State::LZ_COMPRESSION, true );
 				(emulator.*saveState)( saver );
 			}
 			else if (loadState)
@@ -28,6 +28,7 @@
 #ifndef NST_NO_2XSAI
 
 #include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
 #include "NstVideoFilter2xSaI.hpp"
 
 namespace Nes
@@ -40,11 +41,12 @@ namespace Nes
 			#pragma optimize("s", on)
 			#endif
 
-			Renderer::Filter2xSaI::Filter2xSaI(const RenderState& state)
+			Renderer::Filter2xSaI::Filter2xSaI(const RenderState& state,Workers& w)
 			:
-			Filter (state),
-			lsb0   (~((1UL << format.shifts[0]) | (1UL << format.shifts[1]) | (1UL << format.shifts[2]))),
-			lsb1   (~((3UL << format.shifts[0]) | (3UL << format.shifts[1]) | (3UL << format.shifts[2])))
+			Filter  (state),
+			lsb0    (~((1UL << format.shifts[0]) | (1UL << format.shifts[1]) | (1UL << format.shifts[2]))),
+			lsb1    (~((3UL << format.shifts[0]) | (3UL << format.shifts[1]) | (3UL << format.shifts[2]))),
+			workers (w)
 			{
 			}
 
@@ -76,20 +78,20 @@ namespace Nes
 			}
 
 			template<typename T>
-			void Renderer::Filter2xSaI::BlitType(const Input& input,const Output& output) const
+			void Renderer::Filter2xSaI::BlitType(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const word* NST_RESTRICT src = input.pixels;
+				const word* NST_RESTRICT src = input.pixels + first * WIDTH;
 				const long pitch = output.pitch;
 
 				T* NST_RESTRICT dst[2] =
 				{
-					static_cast<T*>(output.pixels),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch)
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch * long(first*2+0)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch * long(first*2+1))
 				};
 
 				dword a,b,c,d,e=0,f=0,g,h,i=0,j=0,k,l,m,n,o;
 
-				for (uint y=0; y < HEIGHT; ++y)
+				for (uint y=first; y < last; ++y)
 				{
 					for (uint x=0; x < WIDTH; ++x, ++src, dst[0] += 2, dst[1] += 2)
 					{
@@ -254,11 +256,28 @@ namespace Nes
 
 			void Renderer::Filter2xSaI::Blit(const Input& input,const Output& output,uint)
 			{
-				switch (format.bpp)
+				const Band band =
 				{
-					case 32: BlitType< dword >( input, output ); break;
-					case 16: BlitType< word  >( input, output ); break;
-					default: NST_UNREACHABLE();
+					this,
+					&input,
+					&output
+				};
+
+				workers.Run( &Filter2xSaI::BlitBand, &band, HEIGHT );
+			}
+
+			void Renderer::Filter2xSaI::BlitBand(const void* data,const uint first,const uint last)
+			{
+				const Band& band = *static_cast<const Band*>(data);
+
+				if (first < last)
+				{
+					switch (band.filter->format.bpp)
+					{
+						case 32: band.filter->BlitType< dword >( *band.input, *band.output, first, last ); break;
+						case 16: band.filter->BlitType< word  >( *band.input, *band.output, first, last ); break;
+						default: NST_UNREACHABLE();
+					}
 				}
 			}
 		}
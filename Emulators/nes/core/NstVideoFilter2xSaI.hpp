@@ -39,22 +39,32 @@ namespace Nes
 			{
 			public:
 
-				explicit Filter2xSaI(const RenderState&);
+				Filter2xSaI(const RenderState&,Workers&);
 
 				static bool Check(const RenderState&);
 
 			private:
 
+				struct Band
+				{
+					const Filter2xSaI* filter;
+					const Input* input;
+					const Output* output;
+				};
+
 				void Blit(const Input&,const Output&,uint);
 
+				static void BlitBand(const void*,uint,uint);
+
 				template<typename T>
-				void BlitType(const Input&,const Output&) const;
+				void BlitType(const Input&,const Output&,uint,uint) const;
 
 				inline dword Blend(dword,dword) const;
 				inline dword Blend(dword,dword,dword,dword) const;
 
 				const dword lsb0;
 				const dword lsb1;
+				Workers& workers;
 			};
 		}
 	}
@@ -23,14 +23,22 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
 #include "NstCore.hpp"
 
 #ifndef NST_NO_HQ2X
 
 #include "NstAssert.hpp"
 #include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
 #include "NstVideoFilterHqX.hpp"
 
+#if defined(NST_SSE2)
+#include <emmintrin.h>
+#elif defined(NST_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Nes
 {
 	namespace Core
@@ -39,7 +47,25 @@ namespace Nes
 		{
 			void Renderer::FilterHqX::Blit(const Input& input,const Output& output,uint)
 			{
-				(*this.*path)( input, output );
+				for (uint i=0; i < PALETTE; ++i)
+					yuv[i] = lut.yuv[input.palette[i]];
+
+				const Band band =
+				{
+					this,
+					&input,
+					&output
+				};
+
+				workers.Run( &FilterHqX::BlitBand, &band, HEIGHT );
+			}
+
+			void Renderer::FilterHqX::BlitBand(const void* data,const uint first,const uint last)
+			{
+				const Band& band = *static_cast<const Band*>(data);
+
+				if (first < last)
+					(*band.filter.*band.filter->path)( *band.input, *band.output, first, last );
 			}
 
 			template<dword R,dword G,dword B>
@@ -125,16 +151,166 @@ namespace Nes
 				return (lut.yuv[w1] - lut.yuv[w2] + Lut::YUV_OFFSET) & Lut::YUV_MASK;
 			}
 
+		#if defined(NST_SSE2)
+
+			static NST_FORCE_INLINE __m128i Differs(const __m128i center,const dword* const neighbour,const __m128i mask,const int bit)
+			{
+				const __m128i diff = _mm_and_si128( _mm_sub_epi32( center, _mm_loadu_si128( reinterpret_cast<const __m128i*>(neighbour) ) ), mask );
+				return _mm_andnot_si128( _mm_cmpeq_epi32( diff, _mm_setzero_si128() ), _mm_set1_epi32( bit ) );
+			}
+
+		#elif defined(NST_NEON)
+
+			static NST_FORCE_INLINE uint32x4_t Differs(const uint32x4_t center,const dword* const neighbour,const uint32x4_t mask,const uint bit)
+			{
+				return vandq_u32( vtstq_u32( vsubq_u32( center, vld1q_u32( neighbour ) ), mask ), vdupq_n_u32( bit ) );
+			}
+
+		#endif
+
+			void Renderer::FilterHqX::Detect(const Input& input,const uint first,const uint y,Edges& edges) const
+			{
+				// YUV of the row and the ones above and below it, edge pixels repeated on both
+				// sides. Going down the band only the row below has to be converted.
+
+				uint row = 0;
+
+				if (y != first)
+				{
+					std::memmove( edges.yuv[0], edges.yuv[1], sizeof(edges.yuv[0]) * 2 );
+					row = 2;
+				}
+
+				for (; row < 3; ++row)
+				{
+					const uint line = (y + row == 0) ? 0 : (y + row - 1 < HEIGHT) ? y + row - 1 : HEIGHT - 1;
+					const Input::Pixel* const NST_RESTRICT src = input.pixels + line * WIDTH;
+					dword* const NST_RESTRICT dst = edges.yuv[row];
+
+					for (uint x=0; x < WIDTH; ++x)
+						dst[1+x] = yuv[src[x]];
+
+					dst[0] = dst[1];
+					dst[1+WIDTH] = dst[WIDTH];
+				}
+
+				// bit k set where neighbour k differs noticeably from the center pixel
+
+			#if defined(NST_SSE2)
+
+				const __m128i mask = _mm_set1_epi32( Lut::YUV_MASK );
+
+				for (uint x=0; x < WIDTH; x += 4)
+				{
+					const dword* const NST_RESTRICT t = edges.yuv[0] + x;
+					const dword* const NST_RESTRICT m = edges.yuv[1] + x;
+					const dword* const NST_RESTRICT b = edges.yuv[2] + x;
+
+					const __m128i center = _mm_loadu_si128( reinterpret_cast<const __m128i*>(m + 1) );
+
+					_mm_storeu_si128
+					(
+						reinterpret_cast<__m128i*>(edges.patterns + x),
+						_mm_or_si128
+						(
+							_mm_or_si128
+							(
+								_mm_or_si128( Differs( center, t+0, mask, 0x01 ), Differs( center, t+1, mask, 0x02 ) ),
+								_mm_or_si128( Differs( center, t+2, mask, 0x04 ), Differs( center, m+0, mask, 0x08 ) )
+							),
+							_mm_or_si128
+							(
+								_mm_or_si128( Differs( center, m+2, mask, 0x10 ), Differs( center, b+0, mask, 0x20 ) ),
+								_mm_or_si128( Differs( center, b+1, mask, 0x40 ), Differs( center, b+2, mask, 0x80 ) )
+							)
+						)
+					);
+				}
+
+			#elif defined(NST_NEON)
+
+				const uint32x4_t mask = vdupq_n_u32( Lut::YUV_MASK );
+
+				for (uint x=0; x < WIDTH; x += 4)
+				{
+					const dword* const NST_RESTRICT t = edges.yuv[0] + x;
+					const dword* const NST_RESTRICT m = edges.yuv[1] + x;
+					const dword* const NST_RESTRICT b = edges.yuv[2] + x;
+
+					const uint32x4_t center = vld1q_u32( m + 1 );
+
+					vst1q_u32
+					(
+						edges.patterns + x,
+						vorrq_u32
+						(
+							vorrq_u32
+							(
+								vorrq_u32( Differs( center, t+0, mask, 0x01 ), Differs( center, t+1, mask, 0x02 ) ),
+								vorrq_u32( Differs( center, t+2, mask, 0x04 ), Differs( center, m+0, mask, 0x08 ) )
+							),
+							vorrq_u32
+							(
+								vorrq_u32( Differs( center, m+2, mask, 0x10 ), Differs( center, b+0, mask, 0x20 ) ),
+								vorrq_u32( Differs( center, b+1, mask, 0x40 ), Differs( center, b+2, mask, 0x80 ) )
+							)
+						)
+					);
+				}
+
+			#else
+
+				for (uint x=0; x < WIDTH; ++x)
+				{
+					const dword* const NST_RESTRICT t = edges.yuv[0] + x;
+					const dword* const NST_RESTRICT m = edges.yuv[1] + x;
+					const dword* const NST_RESTRICT b = edges.yuv[2] + x;
+
+					const dword center = m[1];
+
+					edges.patterns[x] =
+					(
+						((center - t[0]) & Lut::YUV_MASK ? 0x01U : 0x0U) |
+						((center - t[1]) & Lut::YUV_MASK ? 0x02U : 0x0U) |
+						((center - t[2]) & Lut::YUV_MASK ? 0x04U : 0x0U) |
+						((center - m[0]) & Lut::YUV_MASK ? 0x08U : 0x0U) |
+						((center - m[2]) & Lut::YUV_MASK ? 0x10U : 0x0U) |
+						((center - b[0]) & Lut::YUV_MASK ? 0x20U : 0x0U) |
+						((center - b[1]) & Lut::YUV_MASK ? 0x40U : 0x0U) |
+						((center - b[2]) & Lut::YUV_MASK ? 0x80U : 0x0U)
+					);
+				}
+
+			#endif
+			}
+
 			template<typename T>
 			struct Renderer::FilterHqX::Buffer
 			{
 				uint w[10];
 				dword c[10];
 
+				NST_FORCE_INLINE void Begin(const Lut& lut)
+				{
+					c[2] = (c[1] = lut.rgb[w[2]]);
+					c[5] = (c[4] = lut.rgb[w[5]]);
+					c[8] = (c[7] = lut.rgb[w[8]]);
+				}
+
 				NST_FORCE_INLINE void Convert(const Lut& lut)
 				{
-					for (uint k=0; k < 9; ++k)
-						c[k] = lut.rgb[w[k]];
+					// the two left columns were converted for the previous pixel
+
+					c[0] = c[1];
+					c[1] = c[2];
+					c[3] = c[4];
+					c[4] = c[5];
+					c[6] = c[7];
+					c[7] = c[8];
+
+					c[2] = lut.rgb[w[2]];
+					c[5] = lut.rgb[w[5]];
+					c[8] = lut.rgb[w[8]];
 				}
 			};
 
@@ -147,37 +323,48 @@ namespace Nes
 					dword c[10];
 				};
 
+				void Begin(const Lut&)
+				{
+				}
+
 				void Convert(const Lut&)
 				{
 				}
 			};
 
 			template<typename T,dword R,dword G,dword B>
-			void Renderer::FilterHqX::Blit2x(const Input& input,const Output& output) const
+			void Renderer::FilterHqX::Blit2x(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels);
+				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels + first * WIDTH);
 				const long pitch = output.pitch + output.pitch - (WIDTH*2 * sizeof(T));
 
 				T* NST_RESTRICT dst[2] =
 				{
-					static_cast<T*>(output.pixels) - 2,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch) - 2
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*2+0)) - 2,
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*2+1)) - 2
 				};
 
-				for (uint y=HEIGHT; y; --y)
+				Edges edges;
+
+				for (uint y=first; y < last; ++y)
 				{
 					const uint lines[2] =
 					{
-						y < HEIGHT ? WIDTH * sizeof(Input::Pixel) : 0,
-						y > 1      ? WIDTH * sizeof(Input::Pixel) : 0
+						uint(y > 0        ? WIDTH * sizeof(Input::Pixel) : 0),
+						uint(y < HEIGHT-1 ? WIDTH * sizeof(Input::Pixel) : 0)
 					};
 
+					Detect( input, first, y, edges );
+					const dword* NST_RESTRICT pattern = edges.patterns;
+
 					Buffer<T> b;
 
 					b.w[2] = (b.w[1] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])]);
 					b.w[5] = (b.w[4] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)]);
 					b.w[8] = (b.w[7] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])]);
 
+					b.Begin( lut );
+
 					for (uint x=WIDTH; x; )
 					{
 						src += sizeof(Input::Pixel);
@@ -200,7 +387,7 @@ namespace Nes
 
 						b.Convert( lut );
 
-						const uint yuv5 = lut.yuv[b.w[4]];
+						const uint flags = *pattern++;
 
 						#include "NstVideoFilterHq2x.inl"
 					}
@@ -211,32 +398,39 @@ namespace Nes
 			}
 
 			template<typename T,dword R,dword G,dword B>
-			void Renderer::FilterHqX::Blit3x(const Input& input,const Output& output) const
+			void Renderer::FilterHqX::Blit3x(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels);
+				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels + first * WIDTH);
 				const long pitch = (output.pitch * 2) + output.pitch - (WIDTH*3 * sizeof(T));
 
 				T* NST_RESTRICT dst[3] =
 				{
-					static_cast<T*>(output.pixels) - 3,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch) - 3,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 2) - 3
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3+0)) - 3,
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3+1)) - 3,
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3+2)) - 3
 				};
 
-				for (uint y=HEIGHT; y; --y)
+				Edges edges;
+
+				for (uint y=first; y < last; ++y)
 				{
 					const uint lines[2] =
 					{
-						y < HEIGHT ? WIDTH * sizeof(Input::Pixel) : 0,
-						y > 1      ? WIDTH * sizeof(Input::Pixel) : 0
+						uint(y > 0        ? WIDTH * sizeof(Input::Pixel) : 0),
+						uint(y < HEIGHT-1 ? WIDTH * sizeof(Input::Pixel) : 0)
 					};
 
+					Detect( input, first, y, edges );
+					const dword* NST_RESTRICT pattern = edges.patterns;
+
 					Buffer<T> b;
 
 					b.w[2] = (b.w[1] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])]);
 					b.w[5] = (b.w[4] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)]);
 					b.w[8] = (b.w[7] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])]);
 
+					b.Begin( lut );
+
 					for (uint x=WIDTH; x; )
 					{
 						src += sizeof(Input::Pixel);
@@ -260,7 +454,7 @@ namespace Nes
 
 						b.Convert( lut );
 
-						const uint yuv5 = lut.yuv[b.w[4]];
+						const uint flags = *pattern++;
 
 						#include "NstVideoFilterHq3x.inl"
 					}
@@ -272,33 +466,40 @@ namespace Nes
 			}
 
 			template<typename T,dword R,dword G,dword B>
-			void Renderer::FilterHqX::Blit4x(const Input& input,const Output& output) const
+			void Renderer::FilterHqX::Blit4x(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels);
+				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels + first * WIDTH);
 				const long pitch = (output.pitch * 3) + output.pitch - (WIDTH*4 * sizeof(T));
 
 				T* NST_RESTRICT dst[4] =
 				{
-					static_cast<T*>(output.pixels) - 4,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch) - 4,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 2) - 4,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 3) - 4
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+0)) - 4,
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+1)) - 4,
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+2)) - 4,
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+3)) - 4
 				};
 
-				for (uint y=HEIGHT; y; --y)
+				Edges edges;
+
+				for (uint y=first; y < last; ++y)
 				{
 					const uint lines[2] =
 					{
-						y < HEIGHT ? WIDTH * sizeof(Input::Pixel) : 0,
-						y > 1      ? WIDTH * sizeof(Input::Pixel) : 0
+						uint(y > 0        ? WIDTH * sizeof(Input::Pixel) : 0),
+						uint(y < HEIGHT-1 ? WIDTH * sizeof(Input::Pixel) : 0)
 					};
 
+					Detect( input, first, y, edges );
+					const dword* NST_RESTRICT pattern = edges.patterns;
+
 					Buffer<T> b;
 
 					b.w[2] = (b.w[1] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])]);
 					b.w[5] = (b.w[4] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)]);
 					b.w[8] = (b.w[7] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])]);
 
+					b.Begin( lut );
+
 					for (uint x=WIDTH; x; )
 					{
 						src += sizeof(Input::Pixel);
@@ -323,7 +524,7 @@ namespace Nes
 
 						b.Convert( lut );
 
-						const uint yuv5 = lut.yuv[b.w[4]];
+						const uint flags = *pattern++;
 
 						#include "NstVideoFilterHq4x.inl"
 					}
@@ -344,9 +545,9 @@ namespace Nes
 			{
 				const uint shifts[3] =
 				{
-					bpp32 ? 11 : formatShifts[0],
-					bpp32 ?  5 : formatShifts[1],
-					bpp32 ?  0 : formatShifts[2]
+					uint(bpp32 ? 11 : formatShifts[0]),
+					uint(bpp32 ?  5 : formatShifts[1]),
+					uint(bpp32 ?  0 : formatShifts[2])
 				};
 
 				for (uint i=0; i < 32; ++i)
@@ -429,11 +630,12 @@ namespace Nes
 				}
 			}
 
-			Renderer::FilterHqX::FilterHqX(const RenderState& state)
+			Renderer::FilterHqX::FilterHqX(const RenderState& state,Workers& w)
 			:
-			Filter (state),
-			path   (GetPath(state)),
-			lut    (state.bits.count == 32,format.shifts)
+			Filter  (state),
+			path    (GetPath(state)),
+			lut     (state.bits.count == 32,format.shifts),
+			workers (w)
 			{
 			}
 
@@ -40,7 +40,7 @@ namespace Nes
 			{
 			public:
 
-				explicit FilterHqX(const RenderState&);
+				FilterHqX(const RenderState&,Workers&);
 
 				static bool Check(const RenderState&);
 
@@ -48,11 +48,21 @@ namespace Nes
 
 				~FilterHqX() {}
 
-				typedef void (FilterHqX::*Path)(const Input&,const Output&) const;
+				typedef void (FilterHqX::*Path)(const Input&,const Output&,uint,uint) const;
+
+				struct Band
+				{
+					const FilterHqX* filter;
+					const Input* input;
+					const Output* output;
+				};
 
 				static Path GetPath(const RenderState&);
 
 				void Blit(const Input&,const Output&,uint);
+
+				static void BlitBand(const void*,uint,uint);
+
 				void Transform(const byte (&)[PALETTE][3],Input::Palette&) const;
 
 				template<dword R,dword G,dword B> static dword Interpolate1(dword,dword);
@@ -68,14 +78,22 @@ namespace Nes
 
 				inline dword Diff(uint,uint) const;
 
+				struct Edges
+				{
+					dword yuv[3][1+WIDTH+1];
+					dword patterns[WIDTH];
+				};
+
+				void Detect(const Input&,uint,uint,Edges&) const;
+
 				template<typename T,dword R,dword G,dword B>
-				void Blit2x(const Input&,const Output&) const;
+				void Blit2x(const Input&,const Output&,uint,uint) const;
 
 				template<typename T,dword R,dword G,dword B>
-				void Blit3x(const Input&,const Output&) const;
+				void Blit3x(const Input&,const Output&,uint,uint) const;
 
 				template<typename T,dword R,dword G,dword B>
-				void Blit4x(const Input&,const Output&) const;
+				void Blit4x(const Input&,const Output&,uint,uint) const;
 
 				template<typename T>
 				struct Buffer;
@@ -97,6 +115,8 @@ namespace Nes
 
 				const Path path;
 				const Lut lut;
+				dword yuv[PALETTE];
+				Workers& workers;
 			};
 		}
 	}
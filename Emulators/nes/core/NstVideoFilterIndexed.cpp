@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2003-2008 Martin Freij
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "NstCore.hpp"
+#include "NstVideoRenderer.hpp"
+#include "NstVideoFilterIndexed.hpp"
+
+namespace Nes
+{
+	namespace Core
+	{
+		namespace Video
+		{
+			void Renderer::FilterIndexed::Blit8(const Input& input,const Output& output)
+			{
+				const Input::Pixel* NST_RESTRICT src = input.pixels;
+				byte* NST_RESTRICT dst = static_cast<byte*>(output.pixels);
+
+				const long pad = output.pitch - WIDTH;
+
+				for (uint y=HEIGHT; y; --y)
+				{
+					for (uint x=WIDTH; x; --x)
+						*dst++ = *src++ & 0x3F;
+
+					dst += pad;
+				}
+			}
+
+			void Renderer::FilterIndexed::Blit16(const Input& input,const Output& output)
+			{
+				if (output.pitch == WIDTH * sizeof(Input::Pixel))
+				{
+					std::memcpy( output.pixels, input.pixels, PIXELS * sizeof(Input::Pixel) );
+				}
+				else
+				{
+					const Input::Pixel* NST_RESTRICT src = input.pixels;
+					byte* NST_RESTRICT dst = static_cast<byte*>(output.pixels);
+
+					for (uint y=HEIGHT; y; --y)
+					{
+						std::memcpy( dst, src, WIDTH * sizeof(Input::Pixel) );
+
+						src += WIDTH;
+						dst += output.pitch;
+					}
+				}
+			}
+
+			void Renderer::FilterIndexed::Blit(const Input& input,const Output& output,uint)
+			{
+				if (format.bpp == 16)
+					Blit16( input, output );
+				else
+					Blit8( input, output );
+			}
+
+			void Renderer::FilterIndexed::Transform(const byte (&)[PALETTE][3],Input::Palette&) const
+			{
+				// colors are looked up by the host, nothing to convert
+			}
+
+			#ifdef NST_MSVC_OPTIMIZE
+			#pragma optimize("s", on)
+			#endif
+
+			Renderer::FilterIndexed::FilterIndexed(const RenderState& state)
+			: Filter(state)
+			{
+				NST_COMPILE_ASSERT( PALETTE == 0x200 );
+			}
+
+			bool Renderer::FilterIndexed::Check(const RenderState& state)
+			{
+				return
+				(
+					(state.bits.count == 8 || state.bits.count == 16) &&
+					(state.width == WIDTH && state.height == HEIGHT)
+				);
+			}
+
+			#ifdef NST_MSVC_OPTIMIZE
+			#pragma optimize("", on)
+			#endif
+		}
+	}
+}
@@ -24,6 +24,7 @@
 
 #include "NstAssert.hpp"
 #include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
 #include "NstVideoFilterNtsc.hpp"
 #include "NstFpuPrecision.hpp"
 
@@ -35,22 +36,39 @@ namespace Nes
 		{
 			void Renderer::FilterNtsc::Blit(const Input& input,const Output& output,uint phase)
 			{
-				(*this.*path)( input, output, phase );
+				NST_ASSERT( phase < 3 );
+
+				const Band band =
+				{
+					this,
+					&input,
+					&output,
+					phase & lut.noFieldMerging
+				};
+
+				workers.Run( &FilterNtsc::BlitBand, &band, HEIGHT );
 			}
 
-			template<typename Pixel,uint BITS>
-			void Renderer::FilterNtsc::BlitType(const Input& input,const Output& output,uint phase) const
+			void Renderer::FilterNtsc::BlitBand(const void* data,const uint first,const uint last)
 			{
-				NST_ASSERT( phase < 3 );
+				const Band& band = *static_cast<const Band*>(data);
+
+				if (first < last)
+					(*band.filter.*band.filter->path)( *band.input, *band.output, band.phase, first, last );
+			}
 
+			template<typename Pixel,uint BITS>
+			void Renderer::FilterNtsc::BlitType(const Input& input,const Output& output,uint phase,const uint first,const uint last) const
+			{
 				const uint bgcolor = this->bgColor;
-				const Input::Pixel* NST_RESTRICT src = input.pixels;
-				Pixel* NST_RESTRICT dst = static_cast<Pixel*>(output.pixels);
+				const Input::Pixel* NST_RESTRICT src = input.pixels + first * WIDTH;
+				Pixel* NST_RESTRICT dst = reinterpret_cast<Pixel*>(static_cast<byte*>(output.pixels) + long(first) * output.pitch);
 				const long pad = output.pitch - (NTSC_WIDTH-7) * sizeof(Pixel);
 
-				phase &= lut.noFieldMerging;
+				// each row starts on the burst phase it would have in a full frame blit
+				phase = (phase + first) % 3;
 
-				for (uint y=HEIGHT; y; --y)
+				for (uint y=last-first; y; --y)
 				{
 					NES_NTSC_BEGIN_ROW( &lut, phase, bgcolor, bgcolor, *src++ );
 
@@ -182,12 +200,14 @@ namespace Nes
 				schar bleed,
 				schar artifacts,
 				schar fringing,
-				bool fieldMerging
+				bool fieldMerging,
+				Workers& w
 			)
 			:
-			Filter (state),
-			path   (GetPath(state,lut)),
-			lut    (palette,sharpness,resolution,bleed,artifacts,fringing,fieldMerging)
+			Filter  (state),
+			path    (GetPath(state,lut)),
+			lut     (palette,sharpness,resolution,bleed,artifacts,fringing,fieldMerging),
+			workers (w)
 			{
 			}
 
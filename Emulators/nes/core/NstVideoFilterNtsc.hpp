@@ -41,7 +41,7 @@ namespace Nes
 			{
 			public:
 
-				FilterNtsc(const RenderState&,const byte (&)[PALETTE][3],schar,schar,schar,schar,schar,bool);
+				FilterNtsc(const RenderState&,const byte (&)[PALETTE][3],schar,schar,schar,schar,schar,bool,Workers&);
 
 				static bool Check(const RenderState&);
 
@@ -54,12 +54,22 @@ namespace Nes
 					NTSC_WIDTH = 602
 				};
 
-				typedef void (FilterNtsc::*Path)(const Input&,const Output&,uint) const;
+				typedef void (FilterNtsc::*Path)(const Input&,const Output&,uint,uint,uint) const;
+
+				struct Band
+				{
+					const FilterNtsc* filter;
+					const Input* input;
+					const Output* output;
+					uint phase;
+				};
 
 				void Blit(const Input&,const Output&,uint);
 
+				static void BlitBand(const void*,uint,uint);
+
 				template<typename T,uint BITS>
-				void BlitType(const Input&,const Output&,uint) const;
+				void BlitType(const Input&,const Output&,uint,uint,uint) const;
 
 				class Lut : public nes_ntsc_t
 				{
@@ -82,6 +92,7 @@ namespace Nes
 
 				const Path path;
 				const Lut lut;
+				Workers& workers;
 			};
 		}
 	}
@@ -28,6 +28,7 @@
 #ifndef NST_NO_SCALEX
 
 #include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
 #include "NstVideoFilterScaleX.hpp"
 
 namespace Nes
@@ -38,7 +39,22 @@ namespace Nes
 		{
 			void Renderer::FilterScaleX::Blit(const Input& input,const Output& output,uint)
 			{
-				path( input, output );
+				const Band band =
+				{
+					path,
+					&input,
+					&output
+				};
+
+				workers.Run( &FilterScaleX::BlitBand, &band, HEIGHT );
+			}
+
+			void Renderer::FilterScaleX::BlitBand(const void* data,const uint first,const uint last)
+			{
+				const Band& band = *static_cast<const Band*>(data);
+
+				if (first < last)
+					band.path( *band.input, *band.output, first, last );
 			}
 
 			template<typename T,int PREV,int NEXT>
@@ -196,33 +212,39 @@ namespace Nes
 			}
 
 			template<typename T>
-			void Renderer::FilterScaleX::Blit2x(const Input& input,const Output& output)
+			void Renderer::FilterScaleX::Blit2x(const Input& input,const Output& output,const uint first,const uint last)
 			{
-				const Input::Pixel* src = input.pixels;
-				T* dst = static_cast<T*>(output.pixels);
+				const Input::Pixel* src = input.pixels + first * WIDTH;
+				T* dst = reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*2));
 				const long pad = output.pitch - long(sizeof(T) * WIDTH*2);
 
-				dst = Blit2xLine<T,0,WIDTH>( dst, src, input.palette, pad );
-
-				for (uint y=HEIGHT-2; y; --y)
-					dst = Blit2xLine<T,-WIDTH,WIDTH>( dst, src += WIDTH, input.palette, pad );
-
-				Blit2xLine<T,-WIDTH,0>( dst, src + WIDTH, input.palette, pad );
+				for (uint y=first; y < last; ++y, src += WIDTH)
+				{
+					if (y == 0)
+						dst = Blit2xLine<T,0,WIDTH>( dst, src, input.palette, pad );
+					else if (y < HEIGHT-1)
+						dst = Blit2xLine<T,-WIDTH,WIDTH>( dst, src, input.palette, pad );
+					else
+						dst = Blit2xLine<T,-WIDTH,0>( dst, src, input.palette, pad );
+				}
 			}
 
 			template<typename T>
-			void Renderer::FilterScaleX::Blit3x(const Input& input,const Output& output)
+			void Renderer::FilterScaleX::Blit3x(const Input& input,const Output& output,const uint first,const uint last)
 			{
-				const Input::Pixel* src = input.pixels;
-				T* dst = static_cast<T*>(output.pixels);
+				const Input::Pixel* src = input.pixels + first * WIDTH;
+				T* dst = reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3));
 				const long pad = output.pitch - long(sizeof(T) * WIDTH*3);
 
-				dst = Blit3xLine<T,0,WIDTH>( dst, src, input.palette, pad );
-
-				for (uint y=HEIGHT-2; y; --y)
-					dst = Blit3xLine<T,-WIDTH,WIDTH>( dst, src += WIDTH, input.palette, pad );
-
-				Blit3xLine<T,-WIDTH,0>( dst, src + WIDTH, input.palette, pad );
+				for (uint y=first; y < last; ++y, src += WIDTH)
+				{
+					if (y == 0)
+						dst = Blit3xLine<T,0,WIDTH>( dst, src, input.palette, pad );
+					else if (y < HEIGHT-1)
+						dst = Blit3xLine<T,-WIDTH,WIDTH>( dst, src, input.palette, pad );
+					else
+						dst = Blit3xLine<T,-WIDTH,0>( dst, src, input.palette, pad );
+				}
 			}
 
 			#ifdef NST_MSVC_OPTIMIZE
@@ -247,10 +269,11 @@ namespace Nes
 				}
 			}
 
-			Renderer::FilterScaleX::FilterScaleX(const RenderState& state)
+			Renderer::FilterScaleX::FilterScaleX(const RenderState& state,Workers& w)
 			:
-			Filter (state),
-			path   (GetPath(state))
+			Filter  (state),
+			path    (GetPath(state)),
+			workers (w)
 			{
 			}
 
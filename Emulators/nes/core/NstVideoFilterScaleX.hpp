@@ -40,7 +40,7 @@ namespace Nes
 			{
 			public:
 
-				explicit FilterScaleX(const RenderState&);
+				FilterScaleX(const RenderState&,Workers&);
 
 				static bool Check(const RenderState&);
 
@@ -48,12 +48,21 @@ namespace Nes
 
 				~FilterScaleX() {}
 
-				typedef void (*Path)(const Input&,const Output&);
+				typedef void (*Path)(const Input&,const Output&,uint,uint);
+
+				struct Band
+				{
+					Path path;
+					const Input* input;
+					const Output* output;
+				};
 
 				static Path GetPath(const RenderState&);
 
 				void Blit(const Input&,const Output&,uint);
 
+				static void BlitBand(const void*,uint,uint);
+
 				template<typename T,int PREV,int NEXT>
 				static NST_FORCE_INLINE T* Blit2xBorder(T* NST_RESTRICT,const Input::Pixel* NST_RESTRICT,const Input::Palette&);
 
@@ -70,12 +79,13 @@ namespace Nes
 				static NST_FORCE_INLINE T* Blit3xLine(T*,const Input::Pixel*,const Input::Palette&,long);
 
 				template<typename T>
-				static void Blit2x(const Input&,const Output&);
+				static void Blit2x(const Input&,const Output&,uint,uint);
 
 				template<typename T>
-				static void Blit3x(const Input&,const Output&);
+				static void Blit3x(const Input&,const Output&,uint,uint);
 
 				const Path path;
+				Workers& workers;
 			};
 		}
 	}
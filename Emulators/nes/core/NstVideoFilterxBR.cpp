@@ -22,8 +22,15 @@
 #include <cmath>
 #include "NstAssert.hpp"
 #include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
 #include "NstVideoFilterxBR.hpp"
 
+#if defined(NST_SSE2)
+#include <emmintrin.h>
+#elif defined(NST_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Nes
 {
 	namespace Core
@@ -37,11 +44,12 @@ namespace Nes
 			/**
 			 * Constructor
 			 */
-			Renderer::FilterxBR::FilterxBR(const RenderState& state, const bool blend, const schar corner_rounding)
+			Renderer::FilterxBR::FilterxBR(const RenderState& state, const bool blend, const schar corner_rounding, Workers& w)
 			:
 			_blend(blend),
 			Filter (state),
-			path   (GetPath(state, blend, corner_rounding))
+			path   (GetPath(state, blend, corner_rounding)),
+			workers(w)
 			{
 				_index = new YUVPixel*[32768];
 
@@ -252,7 +260,7 @@ namespace Nes
 			 * 4x filtering, with blend support
 			 */
 			template<typename T, dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
-			void Renderer::FilterxBR::Xbr4X(const Input& input,const Output& output)
+			void Renderer::FilterxBR::Xbr4X(const Input& input,const Output& output,const uint first,const uint last)
 			{
 				#pragma region Sets up pointers to source pixels
 
@@ -268,10 +276,10 @@ namespace Nes
 				//points at the start of the next three lines. 
 				T* NST_RESTRICT dst[4] =
 				{
-					static_cast<T*>(output.pixels),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 2),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 3)
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+0)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+1)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+2)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*4+3))
 				};
 
 				//const long pad = output.pitch - long(sizeof(dword) * WIDTH);
@@ -279,7 +287,8 @@ namespace Nes
 
 				#pragma endregion
 
-				for (int y=0; y < MAX_PIXELS; y += WIDTH)
+				//Only the rows of this band are written, neighbours are still clamped to the frame
+				for (int y=int(first*WIDTH); y < int(last*WIDTH); y += WIDTH)
 				{
 					#pragma region Clamps y coords
 
@@ -390,7 +399,7 @@ namespace Nes
 			 * 3x filtering, with blend support
 			 */
 			template<typename T, dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
-			void Renderer::FilterxBR::Xbr3X(const Input& input,const Output& output)
+			void Renderer::FilterxBR::Xbr3X(const Input& input,const Output& output,const uint first,const uint last)
 			{
 				#pragma region Sets up pointers to source pixels
 
@@ -406,9 +415,9 @@ namespace Nes
 				//points at the start of the next two lines.
 				T* NST_RESTRICT dst[3] =
 				{
-					static_cast<T*>(output.pixels),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 2)
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3+0)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3+1)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * long(first*3+2))
 				};
 
 				//const long pad = output.pitch - long(sizeof(dword) * WIDTH);
@@ -416,7 +425,8 @@ namespace Nes
 
 				#pragma endregion
 
-				for (int y=0; y < MAX_PIXELS; y += WIDTH)
+				//Only the rows of this band are written, neighbours are still clamped to the frame
+				for (int y=int(first*WIDTH); y < int(last*WIDTH); y += WIDTH)
 				{
 					#pragma region Clamps y coords
 
@@ -522,7 +532,7 @@ namespace Nes
 			 * Implements 2xBR
 			 */
 			template<typename T, dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
-			void Renderer::FilterxBR::Xbr2X(const Input& input,const Output& output)
+			void Renderer::FilterxBR::Xbr2X(const Input& input,const Output& output,const uint first,const uint last)
 			{
 				#pragma region Sets up pointers to source pixels
 
@@ -538,15 +548,16 @@ namespace Nes
 				//points at the start of the next line.
 				T* NST_RESTRICT dst[2] =
 				{
-					static_cast<T*>(output.pixels),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch)
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch * long(first*2+0)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch * long(first*2+1))
 				};
 				//const long pad = output.pitch - long(sizeof(dword) * WIDTH);
 				const uint MAX_PIXELS = WIDTH * HEIGHT;
 
 				#pragma endregion
 
-				for (int y=0; y < MAX_PIXELS; y += WIDTH)
+				//Only the rows of this band are written, neighbours are still clamped to the frame
+				for (int y=int(first*WIDTH); y < int(last*WIDTH); y += WIDTH)
 				{
 					#pragma region Clamps y coords
 
@@ -641,9 +652,113 @@ namespace Nes
 
 			void Renderer::FilterxBR::Blit(const Input& input,const Output& output,uint)
 			{
-				(*this.*path)( input, output );
+				const Band band =
+				{
+					this,
+					&input,
+					&output
+				};
+
+				workers.Run( &FilterxBR::BlitBand, &band, HEIGHT );
+			}
+
+			void Renderer::FilterxBR::BlitBand(const void* data,const uint first,const uint last)
+			{
+				const Band& band = *static_cast<const Band*>(data);
+
+				if (first < last)
+					(*band.filter.*band.filter->path)( *band.input, *band.output, first, last );
+			}
+
+			#pragma region Edge detection
+
+		#if defined(NST_SSE2)
+
+			/**
+			 * YuvDifference of four pixel pairs at once
+			 */
+			static inline __m128i YuvDifference4(const __m128i a, const __m128i b)
+			{
+				//|a-b| of each Y, U and V byte, widened to 16-bit
+				const __m128i d = _mm_sub_epi8(_mm_max_epu8(a, b), _mm_min_epu8(a, b));
+				const __m128i w = _mm_setr_epi16(6, 7, 48, 0, 6, 7, 48, 0);
+
+				const __m128 lo = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(d, _mm_setzero_si128()), w));
+				const __m128 hi = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(d, _mm_setzero_si128()), w));
+
+				//6*V + 7*U and 48*Y of each pair, summed
+				return _mm_add_epi32
+				(
+					_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0))),
+					_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1)))
+				);
+			}
+
+		#elif defined(NST_NEON)
+
+			/**
+			 * YuvDifference of four pixel pairs at once
+			 */
+			static inline uint32x4_t YuvDifference4(const uint32x4_t a, const uint32x4_t b)
+			{
+				//|a-b| of each Y, U and V byte, widened to 16-bit
+				const uint8x16_t d = vabdq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b));
+				const uint16_t weights[8] = { 6, 7, 48, 0, 6, 7, 48, 0 };
+				const uint16x8_t w = vld1q_u16(weights);
+
+				const uint32x4_t lo = vpaddlq_u16(vmulq_u16(vmovl_u8(vget_low_u8(d)), w));
+				const uint32x4_t hi = vpaddlq_u16(vmulq_u16(vmovl_u8(vget_high_u8(d)), w));
+
+				//6*V + 7*U and 48*Y of each pair, summed
+				const uint32x4x2_t sums = vuzpq_u32(lo, hi);
+
+				return vaddq_u32(sums.val[0], sums.val[1]);
+			}
+
+		#endif
+
+			/**
+			 * Weighs the two edges through pe, e along pg-pc and i along pd-pb,
+			 * and tells if pf is closer to pe than ph.
+			 */
+			void Renderer::FilterxBR::Weigh(const YUVPixel pe, const YUVPixel pi, 
+					const YUVPixel ph, const YUVPixel pf, const YUVPixel pg, 
+					const YUVPixel pc, const YUVPixel pd, const YUVPixel pb, 
+					const YUVPixel f4, const YUVPixel i4, const YUVPixel h5, 
+					const YUVPixel i5, uint &e, uint &i, bool &closer)
+			{
+			#if defined(NST_SSE2) || defined(NST_NEON)
+
+				dword d[12];
+
+			#if defined(NST_SSE2)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d+0), YuvDifference4(_mm_setr_epi32(pe.yuv, pe.yuv, pi.yuv, pi.yuv), _mm_setr_epi32(pc.yuv, pg.yuv, h5.yuv, f4.yuv)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d+4), YuvDifference4(_mm_setr_epi32(ph.yuv, ph.yuv, ph.yuv, pf.yuv), _mm_setr_epi32(pf.yuv, pd.yuv, i5.yuv, i4.yuv)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d+8), YuvDifference4(_mm_setr_epi32(pf.yuv, pe.yuv, pe.yuv, pe.yuv), _mm_setr_epi32(pb.yuv, pi.yuv, pf.yuv, ph.yuv)));
+			#else
+				const dword a[12] = { pe.yuv, pe.yuv, pi.yuv, pi.yuv, ph.yuv, ph.yuv, ph.yuv, pf.yuv, pf.yuv, pe.yuv, pe.yuv, pe.yuv };
+				const dword b[12] = { pc.yuv, pg.yuv, h5.yuv, f4.yuv, pf.yuv, pd.yuv, i5.yuv, i4.yuv, pb.yuv, pi.yuv, pf.yuv, ph.yuv };
+
+				vst1q_u32(d+0, YuvDifference4(vld1q_u32(a+0), vld1q_u32(b+0)));
+				vst1q_u32(d+4, YuvDifference4(vld1q_u32(a+4), vld1q_u32(b+4)));
+				vst1q_u32(d+8, YuvDifference4(vld1q_u32(a+8), vld1q_u32(b+8)));
+			#endif
+
+				e = (d[0] + d[1] + d[2] + d[3]) + (d[4] << 2);
+				i = (d[5] + d[6] + d[7] + d[8]) + (d[9] << 2);
+				closer = d[10] <= d[11];
+
+			#else
+
+				e = (pe.YuvDifference(pc) + pe.YuvDifference(pg) + pi.YuvDifference(h5) + pi.YuvDifference(f4)) + (ph.YuvDifference(pf) << 2);
+				i = (ph.YuvDifference(pd) + ph.YuvDifference(i5) + pf.YuvDifference(i4) + pf.YuvDifference(pb)) + (pe.YuvDifference(pi) << 2);
+				closer = pe.YuvDifference(pf) <= pe.YuvDifference(ph);
+
+			#endif
 			}
 
+			#pragma endregion
+
 			#pragma region Kernels
 
 			template<dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
@@ -653,9 +768,10 @@ namespace Nes
 			{
 				if (!(pe != ph && pe != pf))
 					return;
-				uint e = (pe.YuvDifference(pc) + pe.YuvDifference(pg) + pi.YuvDifference(h5) + pi.YuvDifference(f4)) + (ph.YuvDifference(pf) << 2);
-				uint i = (ph.YuvDifference(pd) + ph.YuvDifference(i5) + pf.YuvDifference(i4) + pf.YuvDifference(pb)) + (pe.YuvDifference(pi) << 2);
-				YUVPixel px = (pe.YuvDifference(pf) <= pe.YuvDifference(ph)) ? pf : ph;
+				uint e, i;
+				bool closer;
+				Weigh(pe, pi, ph, pf, pg, pc, pd, pb, f4, i4, h5, i5, e, i, closer);
+				YUVPixel px = closer ? pf : ph;
 				
 				//A
 				if (NONE && ((e < i) && (!pf.isLike(pb) && !pf.isLike(pc) || !ph.isLike(pd) && !ph.isLike(pg) || pe.isLike(pi) && (!pf.isLike(f4) && !pf.isLike(i4) || !ph.isLike(h5) && !ph.isLike(i5)) || pe.isLike(pg) || pe.isLike(pc)))
@@ -695,8 +811,9 @@ namespace Nes
 					YUVPixel &n7, YUVPixel &n8) const
 			{
 				if (!(pe != ph && pe != pf)) return;
-				uint e = (pe.YuvDifference(pc) + pe.YuvDifference(pg) + pi.YuvDifference(h5) + pi.YuvDifference(f4)) + (ph.YuvDifference(pf) << 2);
-				uint i = (ph.YuvDifference(pd) + ph.YuvDifference(i5) + pf.YuvDifference(i4) + pf.YuvDifference(pb)) + (pe.YuvDifference(pi) << 2);
+				uint e, i;
+				bool closer;
+				Weigh(pe, pi, ph, pf, pg, pc, pd, pb, f4, i4, h5, i5, e, i, closer);
 
 				//A
 				if (NONE && ((e < i) && (!pf.isLike(pb) && !pf.isLike(pc) || !ph.isLike(pd) && !ph.isLike(pg) || pe.isLike(pi) && (!pf.isLike(f4) && !pf.isLike(i4) || !ph.isLike(h5) && !ph.isLike(i5)) || pe.isLike(pg) || pe.isLike(pc)))
@@ -711,7 +828,7 @@ namespace Nes
 					uint ki = ph.YuvDifference(pc);
 					bool ex2 = (pe != pc && pb != pc);
 					bool ex3 = (pe != pg && pd != pg);
-					YUVPixel px = (pe.YuvDifference(pf) <= pe.YuvDifference(ph)) ? pf : ph;
+					YUVPixel px = closer ? pf : ph;
 					if (((ke << 1) <= ki) && ex3 && (ke >= (ki << 1)) && ex2) {
 						LeftUp2_3X<R_MASK, R_SHIFT, G_MASK, G_SHIFT, B_MASK, B_SHIFT, BLEND>(n7, n5, n6, n2, n8, px);
 					} else if (((ke << 1) <= ki) && ex3) {
@@ -722,7 +839,7 @@ namespace Nes
 						Dia_3X<R_MASK, R_SHIFT, G_MASK, G_SHIFT, B_MASK, B_SHIFT, BLEND>(n8, n5, n7, px);
 					}
 				} else if (BLEND && e <= i) {
-					AlphaBlend128W<R_MASK, R_SHIFT, G_MASK, G_SHIFT, B_MASK, B_SHIFT>(n8, (pe.YuvDifference(pf) <= pe.YuvDifference(ph)) ? pf : ph);
+					AlphaBlend128W<R_MASK, R_SHIFT, G_MASK, G_SHIFT, B_MASK, B_SHIFT>(n8, closer ? pf : ph);
 				}
 			}
 			
@@ -735,9 +852,10 @@ namespace Nes
 					YUVPixel &n7, YUVPixel &n10, YUVPixel &n13, YUVPixel &n12) const
 			{
 				if (!(pe != ph && pe != pf)) return;
-				uint e = (pe.YuvDifference(pc) + pe.YuvDifference(pg) + pi.YuvDifference(h5) + pi.YuvDifference(f4)) + (ph.YuvDifference(pf) << 2);
-				uint i = (ph.YuvDifference(pd) + ph.YuvDifference(i5) + pf.YuvDifference(i4) + pf.YuvDifference(pb)) + (pe.YuvDifference(pi) << 2);
-				YUVPixel px = (pe.YuvDifference(pf) <= pe.YuvDifference(ph)) ? pf : ph;
+				uint e, i;
+				bool closer;
+				Weigh(pe, pi, ph, pf, pg, pc, pd, pb, f4, i4, h5, i5, e, i, closer);
+				YUVPixel px = closer ? pf : ph;
 
 				//A
 				if (NONE && ((e < i) && (!pf.isLike(pb) && !pf.isLike(pc) || !ph.isLike(pd) && !ph.isLike(pg) || pe.isLike(pi) && (!pf.isLike(f4) && !pf.isLike(i4) || !ph.isLike(h5) && !ph.isLike(i5)) || pe.isLike(pg) || pe.isLike(pc)))
@@ -41,7 +41,7 @@ namespace Nes
 			{
 			public:
 
-				explicit FilterxBR(const RenderState&, const bool blend, const schar corner_rounding);
+				FilterxBR(const RenderState&, const bool blend, const schar corner_rounding, Workers&);
 
 				static bool Check(const RenderState&);
 
@@ -50,20 +50,34 @@ namespace Nes
 				void freeCache() const;
 				void initCache() const;
 
-				typedef void (FilterxBR::*Path)(const Input&,const Output&);
+				typedef void (FilterxBR::*Path)(const Input&,const Output&,uint,uint);
 				static Path GetPath(const RenderState&, const bool blend, const schar corner_rounding);
 
+				struct Band
+				{
+					FilterxBR* filter;
+					const Input* input;
+					const Output* output;
+				};
+
 				void Blit(const Input&,const Output&,uint);
+				static void BlitBand(const void*,uint,uint);
 				void Transform(const byte (&)[PALETTE][3],Input::Palette&) const;
 
 				template<typename T, dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
-					void Xbr4X(const Input&,const Output&);
+					void Xbr4X(const Input&,const Output&,uint,uint);
 
 				template<typename T, dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
-					void Xbr3X(const Input&,const Output&);
+					void Xbr3X(const Input&,const Output&,uint,uint);
 
 				template<typename T, dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE> 
-					void Xbr2X(const Input&,const Output&);
+					void Xbr2X(const Input&,const Output&,uint,uint);
+
+				static inline void Weigh(const YUVPixel pe, const YUVPixel pi, 
+					const YUVPixel ph, const YUVPixel pf, const YUVPixel pg, 
+					const YUVPixel pc, const YUVPixel pd, const YUVPixel pb, 
+					const YUVPixel f4, const YUVPixel i4, const YUVPixel h5, 
+					const YUVPixel i5, uint &e, uint &i, bool &closer);
 
 				template<dword R_MASK, dword R_SHIFT, dword G_MASK, dword G_SHIFT, dword B_MASK, dword B_SHIFT, bool BLEND, bool ALL, bool SOME, bool NONE>
 				inline void Kernel2X(YUVPixel pe, YUVPixel pi, YUVPixel ph, YUVPixel pf, YUVPixel pg, 
@@ -151,6 +165,9 @@ namespace Nes
 
 				//Execution path
 				const Path path;
+
+				//Pool the frame is blitted on, in horizontal bands
+				Workers& workers;
 			};
 		}
 	}
@@ -30,7 +30,9 @@
 #include "NstFpuPrecision.hpp"
 #include "api/NstApiVideo.hpp"
 #include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
 #include "NstVideoFilterNone.hpp"
+#include "NstVideoFilterIndexed.hpp"
 
 #ifndef NO_NTSC
 #include "NstVideoFilterNtsc.hpp"
@@ -541,12 +543,16 @@ namespace Nes
 				mask.b = 0;
 			}
 
+			Renderer::FrameCheck::FrameCheck()
+			: enabled(false), valid(false) {}
+
 			Renderer::Renderer()
-			: filter(NULL) {}
+			: filter(NULL), workers(NULL), paletteRevision(0) {}
 
 			Renderer::~Renderer()
 			{
 				delete filter;
+				delete workers;
 			}
 
 			Result Renderer::SetState(const RenderState& renderState)
@@ -571,6 +577,9 @@ namespace Nes
 
 				try
 				{
+					if (renderState.filter != RenderState::FILTER_NONE && renderState.filter != RenderState::FILTER_INDEXED && !workers)
+						workers = new Workers;
+
 					switch (renderState.filter)
 					{
 						case RenderState::FILTER_NONE:
@@ -580,13 +589,20 @@ namespace Nes
 
 							break;
 
+						case RenderState::FILTER_INDEXED:
+
+							if (FilterIndexed::Check( renderState ))
+								filter = new FilterIndexed( renderState );
+
+							break;
+
 					#ifndef NST_NO_SCALEX
 
 						case RenderState::FILTER_SCALE2X:
 						case RenderState::FILTER_SCALE3X:
 
 							if (FilterScaleX::Check( renderState ))
-								filter = new FilterScaleX( renderState );
+								filter = new FilterScaleX( renderState, *workers );
 
 							break;
 					#endif
@@ -597,7 +613,7 @@ namespace Nes
 						case RenderState::FILTER_HQ4X:
 
 							if (FilterHqX::Check( renderState ))
-								filter = new FilterHqX( renderState );
+								filter = new FilterHqX( renderState, *workers );
 
 							break;
 
@@ -607,7 +623,7 @@ namespace Nes
 						case RenderState::FILTER_2XSAI:
 
 							if (Filter2xSaI::Check( renderState ))
-								filter = new Filter2xSaI( renderState );
+								filter = new Filter2xSaI( renderState, *workers );
 
 							break;
 
@@ -627,7 +643,8 @@ namespace Nes
 									state.bleed,
 									state.artifacts,
 									state.fringing,
-									state.fieldMerging
+									state.fieldMerging,
+									*workers
 								);
 							}
 							break;
@@ -639,7 +656,7 @@ namespace Nes
 						case RenderState::FILTER_4XBR:
 
 							if (FilterxBR::Check( renderState ))
-								filter = new FilterxBR( renderState, state.blendPixels, state.xbr_corner_rounding );
+								filter = new FilterxBR( renderState, state.blendPixels, state.xbr_corner_rounding, *workers );
 							break;
 					#endif
 					}
@@ -659,6 +676,8 @@ namespace Nes
 					state.height = renderState.height;
 					state.mask = renderState.bits.mask;
 
+					frameCheck.Reset();
+
 					if (state.filter == RenderState::FILTER_NTSC)
 						state.update = 0;
 					else
@@ -712,6 +731,12 @@ namespace Nes
 					state.update |= uint(State::UPDATE_NTSC);
 			}
 
+			void Renderer::EnableDuplicateFrameDetection(bool enable)
+			{
+				frameCheck.enabled = enable;
+				frameCheck.Reset();
+			}
+
 			Result Renderer::SetHue(int hue)
 			{
 				if (hue < -45 || hue > 45)
@@ -782,11 +807,18 @@ namespace Nes
 				{
 					state.update &= ~uint(State::UPDATE_PALETTE);
 					palette.Update( state.brightness, state.saturation, state.contrast, state.hue );
+					++paletteRevision;
 				}
 
 				return palette.Get();
 			}
 
+			dword Renderer::GetPaletteRevision()
+			{
+				GetPalette();
+				return paletteRevision;
+			}
+
 			void Renderer::UpdateFilter(Input& input)
 			{
 				NST_VERIFY( state.update );
@@ -813,20 +845,79 @@ namespace Nes
 			#pragma optimize("", on)
 			#endif
 
+			bool Renderer::FrameCheck::Unchanged(const Input& input,const Output& output,uint bgColor,uint phase)
+			{
+				NST_COMPILE_ASSERT( PIXELS % (LANES * 2) == 0 );
+
+				// FNV-1a over pixel pairs, split in lanes to keep the multiplies independent.
+				// A new hash proves a change; an equal one is confirmed against the saved frame.
+
+				dword lanes[LANES];
+
+				for (uint i=0; i < LANES; ++i)
+					lanes[i] = 0x811C9DC5UL + i;
+
+				for (const Input::Pixel* NST_RESTRICT src=input.pixels, *const end=src+PIXELS; src != end; src += LANES * 2)
+				{
+					for (uint i=0; i < LANES; ++i)
+						lanes[i] = ((lanes[i] ^ (src[i*2] | dword(src[i*2+1]) << 16)) * 0x01000193UL) & 0xFFFFFFFF;
+				}
+
+				bool same =
+				(
+					valid &&
+					this->pixels == output.pixels &&
+					this->pitch == output.pitch &&
+					this->bgColor == bgColor &&
+					this->phase == phase
+				);
+
+				for (uint i=0; i < LANES; ++i)
+				{
+					same &= (hash[i] == lanes[i]);
+					hash[i] = lanes[i];
+				}
+
+				if (same)
+					same = std::memcmp( last, input.pixels, sizeof(last) ) == 0;
+
+				if (!same)
+					std::memcpy( last, input.pixels, sizeof(last) );
+
+				valid = true;
+				this->pixels = output.pixels;
+				this->pitch = output.pitch;
+				this->bgColor = bgColor;
+				this->phase = phase;
+
+				return same;
+			}
+
 			void Renderer::Blit(Output& output,Input& input,uint burstPhase)
 			{
 				if (filter)
 				{
 					if (state.update)
+					{
 						UpdateFilter( input );
+						frameCheck.Reset();
+					}
 
 					if (Output::lockCallback( output ))
 					{
 						NST_VERIFY( std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16) );
 
+						output.unchanged = frameCheck.enabled && frameCheck.Unchanged
+						(
+							input,
+							output,
+							bgColor,
+							state.filter == RenderState::FILTER_NTSC ? burstPhase : 0
+						);
+
 						filter->bgColor = bgColor;
 
-						if (std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16))
+						if (!output.unchanged && std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16))
 							filter->Blit( input, output, burstPhase );
 
 						Output::unlockCallback( output );
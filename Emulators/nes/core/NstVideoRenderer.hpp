@@ -83,10 +83,12 @@ namespace Nes
 
 				void EnableFieldMerging(bool);
 				void EnableForcedFieldMerging(bool);
+				void EnableDuplicateFrameDetection(bool);
 
 				typedef byte PaletteEntries[PALETTE][3];
 
 				const PaletteEntries& GetPalette();
+				dword GetPaletteRevision();
 
 			private:
 
@@ -160,8 +162,10 @@ namespace Nes
 					}
 				};
 
+				class Workers;
 				class FilterNone;
 				class FilterNtsc;
+				class FilterIndexed;
 
 				#ifndef NST_NO_SCALEX
 				class FilterScaleX;
@@ -239,11 +243,45 @@ namespace Nes
 					RenderState::Bits::Mask mask;
 				};
 
+				class FrameCheck
+				{
+				public:
+
+					FrameCheck();
+
+					bool Unchanged(const Input&,const Output&,uint,uint);
+
+					void Reset()
+					{
+						valid = false;
+					}
+
+					bool enabled;
+
+				private:
+
+					enum
+					{
+						LANES = 4
+					};
+
+					bool valid;
+					const void* pixels;
+					long pitch;
+					uint bgColor;
+					uint phase;
+					dword hash[LANES];
+					Input::Pixel last[PIXELS];
+				};
+
 				Result SetLevel(schar&,int,uint=State::UPDATE_PALETTE|State::UPDATE_FILTER);
 
 				Filter* filter;
+				Workers* workers;
 				State state;
 				Palette palette;
+				dword paletteRevision;
+				FrameCheck frameCheck;
 
 			public:
 
@@ -368,6 +406,11 @@ namespace Nes
 					return state.fieldMerging & uint(State::FIELD_MERGING_USER);
 				}
 
+				bool IsDuplicateFrameDetectionEnabled() const
+				{
+					return frameCheck.enabled;
+				}
+
 				PaletteType GetPaletteType() const
 				{
 					return palette.GetType();
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2003-2008 Martin Freij
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "NstCore.hpp"
+#include "NstAssert.hpp"
+#include "NstVideoRenderer.hpp"
+#include "NstVideoWorkers.hpp"
+
+namespace Nes
+{
+	namespace Core
+	{
+		namespace Video
+		{
+			#ifdef NST_MSVC_OPTIMIZE
+			#pragma optimize("s", on)
+			#endif
+
+			uint Renderer::Workers::GetBands()
+			{
+			#ifndef NST_NO_THREADS
+				const uint cores = std::thread::hardware_concurrency();
+				return cores > MAX_BANDS ? MAX_BANDS : cores ? cores : 1;
+			#else
+				return 1;
+			#endif
+			}
+
+		#ifndef NST_NO_THREADS
+
+			Renderer::Workers::Workers()
+			:
+			job        (NULL),
+			context    (NULL),
+			rows       (0),
+			count      (1),
+			pending    (0),
+			generation (0),
+			quit       (false),
+			bands      (GetBands())
+			{
+			}
+
+			Renderer::Workers::~Workers()
+			{
+				{
+					std::lock_guard<std::mutex> lock( mutex );
+					quit = true;
+				}
+
+				ready.notify_all();
+
+				for (std::vector<std::thread>::iterator it(threads.begin()), end(threads.end()); it != end; ++it)
+					it->join();
+			}
+
+		#else
+
+			Renderer::Workers::Workers()
+			: bands(GetBands()) {}
+
+			Renderer::Workers::~Workers() {}
+
+		#endif
+
+			#ifdef NST_MSVC_OPTIMIZE
+			#pragma optimize("", on)
+			#endif
+
+		#ifndef NST_NO_THREADS
+
+			void Renderer::Workers::Main(const uint band)
+			{
+				dword seen = 0;
+
+				for (;;)
+				{
+					Job current;
+					const void* data;
+					uint total;
+					uint split;
+
+					{
+						std::unique_lock<std::mutex> lock( mutex );
+
+						while (!quit && generation == seen)
+							ready.wait( lock );
+
+						if (quit)
+							return;
+
+						seen = generation;
+						current = job;
+						data = context;
+						total = rows;
+						split = count;
+					}
+
+					current( data, total * band / split, total * (band + 1) / split );
+
+					{
+						std::lock_guard<std::mutex> lock( mutex );
+
+						if (--pending)
+							continue;
+					}
+
+					done.notify_one();
+				}
+			}
+
+		#endif
+
+			void Renderer::Workers::Run(Job fn,const void* data,uint total)
+			{
+				NST_ASSERT( fn );
+
+			#ifndef NST_NO_THREADS
+
+				if (bands > 1 && total >= bands)
+				{
+					uint split;
+
+					{
+						std::lock_guard<std::mutex> lock( mutex );
+
+						if (threads.empty())
+						{
+							try
+							{
+								threads.reserve( bands - 1 );
+
+								for (uint i=1; i < bands; ++i)
+									threads.push_back( std::thread(&Workers::Main,this,i) );
+							}
+							catch (...)
+							{
+								// run with whatever could be spawned
+							}
+						}
+
+						split = threads.size() + 1;
+
+						job = fn;
+						context = data;
+						rows = total;
+						count = split;
+						pending = split - 1;
+						++generation;
+					}
+
+					if (split > 1)
+					{
+						ready.notify_all();
+
+						fn( data, 0, total / split );
+
+						std::unique_lock<std::mutex> lock( mutex );
+
+						while (pending)
+							done.wait( lock );
+
+						return;
+					}
+				}
+
+			#endif
+
+				fn( data, 0, total );
+			}
+		}
+	}
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2003-2008 Martin Freij
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NST_VIDEO_WORKERS_H
+#define NST_VIDEO_WORKERS_H
+
+#ifndef NST_NO_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#endif
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		namespace Video
+		{
+			class Renderer::Workers
+			{
+			public:
+
+				typedef void (*Job)(const void*,uint,uint);
+
+				Workers();
+				~Workers();
+
+				void Run(Job,const void*,uint);
+
+			private:
+
+				enum
+				{
+					MAX_BANDS = 4
+				};
+
+			#ifndef NST_NO_THREADS
+
+				void Main(uint);
+
+				std::vector<std::thread> threads;
+				std::mutex mutex;
+				std::condition_variable ready;
+				std::condition_variable done;
+
+				Job job;
+				const void* context;
+				uint rows;
+				uint count;
+				uint pending;
+				dword generation;
+				bool quit;
+
+			#endif
+
+				const uint bands;
+
+				static uint GetBands();
+			};
+		}
+	}
+}
+
+#endif
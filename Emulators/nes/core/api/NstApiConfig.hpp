@@ -52,6 +52,12 @@
 //                             xmmintrin.h/emmintrin.h/mmintrin.h. Auto-defined if
 //                             compiler is Win32 MSVC and _M_IX86 is defined.
 //
+// NST_SSE2                  - For SSE2 compiler intrinsics support through emmintrin.h.
+//                             Used by some of the video filters. Auto-defined if the
+//                             target has SSE2 and NST_NO_SIMD isn't defined.
+//
+// NST_NEON                  - Same as above but for NEON through arm_neon.h.
+//
 // NST_CALL <attribute>      - Compiler/platform specific calling convention for non-member
 //                             functions. Placed between return type and function name, e.g
 //                             void NST_CALL DoSomething().
@@ -130,5 +136,12 @@
 //
 // NST_NO_2XSAI   - 2xSaI video filter
 //
+// NST_NO_THREADS - Worker threads used by the video filters to blit the
+//                  frame in horizontal bands. Blitting is then done on the
+//                  calling thread only.
+//
+// NST_NO_SIMD    - SSE2/NEON code paths in the video filters. Plain C++
+//                  versions of them are used instead.
+//
 ////////////////////////////////////////////////////////////////////////////////////////
 */
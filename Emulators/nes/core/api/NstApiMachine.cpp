@@ -186,6 +186,14 @@ namespace Nes
 			return RESULT_OK;
 		}
 
+		Result Machine::SaveBattery() throw()
+		{
+			if (!Is(ON) || !emulator.image)
+				return RESULT_ERR_NOT_READY;
+
+			return emulator.image->SaveBattery() ? RESULT_OK : RESULT_ERR_GENERIC;
+		}
+
 		Result Machine::SetRamPowerState(const uint state) throw()
 		{
 			emulator.SetRamPowerState(state);
@@ -256,7 +264,14 @@ namespace Nes
 
 			try
 			{
-				Core::State::Saver saver( &stream, compression != NO_COMPRESSION, false );
+				Core::State::Saver saver
+				(
+					&stream,
+					compression == NO_COMPRESSION ? Core::State::NO_COMPRESSION :
+					compression == USE_ZLIB_COMPRESSION ? Core::State::ZLIB_COMPRESSION :
+					Core::State::LZ_COMPRESSION,
+					false
+				);
 				emulator.SaveState( saver );
 			}
 			catch (Result result)
@@ -256,6 +256,14 @@ namespace Nes
 			*/
 			Result Reset(bool state) throw();
 
+			/**
+			* Saves the battery-backed RAM of a running cartridge without powering it off.
+			* The file callback only gets it if it changed since it was last loaded or saved.
+			*
+			* @return result code
+			*/
+			Result SaveBattery() throw();
+
 			/**
 			* Sets the RAM's power state.
 			*
@@ -296,9 +304,13 @@ namespace Nes
 				*/
 				NO_COMPRESSION,
 				/**
-				* Compression enabled (default).
+				* Compression with the fastest codec, Lz (default).
+				*/
+				USE_COMPRESSION,
+				/**
+				* Compression with Zlib. Smaller states, several times slower to write.
 				*/
-				USE_COMPRESSION
+				USE_ZLIB_COMPRESSION
 			};
 
 			/**
@@ -313,7 +325,7 @@ namespace Nes
 			* Saves a state.
 			*
 			* @param stream output stream which the state will be written to
-			* @param compression to allow internal compression in the state, default is USE_COMPRESSION
+			* @param compression to allow internal compression in the state and pick its codec, default is USE_COMPRESSION
 			* @return result code
 			*/
 			Result SaveState(std::ostream& stream,Compression compression=USE_COMPRESSION) const throw();
@@ -82,11 +82,21 @@ namespace Nes
 			emulator.cpu.GetApu().SetGenie( enable );
 		}
 
+		Result Sound::EnableBandLimiting(bool enable) throw()
+		{
+			return emulator.cpu.GetApu().EnableBandLimiting( enable );
+		}
+
 		void Sound::SetSpeaker(Speaker speaker) throw()
 		{
 			emulator.cpu.GetApu().EnableStereo( speaker == SPEAKER_STEREO );
 		}
 
+		void Sound::SetSampleFormat(SampleFormat format) throw()
+		{
+			emulator.cpu.GetApu().EnableFloatOutput( format == SAMPLE_FLOAT32 );
+		}
+
 		ulong Sound::GetSampleRate() const throw()
 		{
 			return emulator.cpu.GetApu().GetSampleRate();
@@ -127,11 +137,21 @@ namespace Nes
 			return emulator.cpu.GetApu().IsGenie();
 		}
 
+		bool Sound::IsBandLimited() const throw()
+		{
+			return emulator.cpu.GetApu().IsBandLimited();
+		}
+
 		Sound::Speaker Sound::GetSpeaker() const throw()
 		{
 			return emulator.cpu.GetApu().InStereo() ? SPEAKER_STEREO : SPEAKER_MONO;
 		}
 
+		Sound::SampleFormat Sound::GetSampleFormat() const throw()
+		{
+			return emulator.cpu.GetApu().InFloat() ? SAMPLE_FLOAT32 : SAMPLE_INT16;
+		}
+
 		void Sound::EmptyBuffer() throw()
 		{
 			emulator.cpu.GetApu().ClearBuffers();
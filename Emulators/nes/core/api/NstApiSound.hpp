@@ -63,6 +63,7 @@ namespace Nes
 				/**
 				* Pointer to sound memory to be written to.
 				*
+				* Samples are 16-bit integers or floats depending on Api::Sound::SetSampleFormat().
 				* Assign NULL to samples[1] if circular buffers aren't needed.
 				*/
 				void* samples[2];
@@ -249,6 +250,21 @@ namespace Nes
 				SPEAKER_STEREO
 			};
 
+			/**
+			* Sample format.
+			*/
+			enum SampleFormat
+			{
+				/**
+				* Signed 16-bit integer samples (default).
+				*/
+				SAMPLE_INT16,
+				/**
+				* 32-bit float samples in the range -1 to 1.
+				*/
+				SAMPLE_FLOAT32
+			};
+
 			enum
 			{
 				DEFAULT_VOLUME = 85,
@@ -288,6 +304,22 @@ namespace Nes
 			*/
 			Speaker GetSpeaker() const throw();
 
+			/**
+			* Sets the sample format written to Output::samples.
+			*
+			* Stereo output is interleaved in either format.
+			*
+			* @param format sample format, default is SAMPLE_INT16
+			*/
+			void SetSampleFormat(SampleFormat format) throw();
+
+			/**
+			* Returns the sample format.
+			*
+			* @return sample format
+			*/
+			SampleFormat GetSampleFormat() const throw();
+
 			/**
 			* Sets one or more channel volumes.
 			*
@@ -348,6 +380,18 @@ namespace Nes
 			*/
 			void SetGenie(bool genie) throw();
 
+			/**
+			* Enables band-limited synthesis of the built-in APU channels.
+			*
+			* Level changes are recorded as they happen and resampled once per
+			* frame instead of being averaged per output sample. Cartridges with
+			* expansion sound keep using the regular mixer.
+			*
+			* @param enable true to enable
+			* @return result code
+			*/
+			Result EnableBandLimiting(bool enable) throw();
+
 			/**
 			* Checks if automatic transposing is enabled.
 			*
@@ -362,6 +406,13 @@ namespace Nes
 			*/
 			bool IsGenie() const throw();
 
+			/**
+			* Checks if band-limited synthesis is enabled.
+			*
+			* @return true if enabled
+			*/
+			bool IsBandLimited() const throw();
+
 			/**
 			* Checks if sound is audible at all.
 			*
@@ -188,6 +188,16 @@ namespace Nes
 			return emulator.renderer.IsFieldMergingEnabled();
 		}
 
+		void Video::EnableDuplicateFrameDetection(bool state) throw()
+		{
+			emulator.renderer.EnableDuplicateFrameDetection( state );
+		}
+
+		bool Video::IsDuplicateFrameDetectionEnabled() const throw()
+		{
+			return emulator.renderer.IsDuplicateFrameDetectionEnabled();
+		}
+
 		Result Video::SetRenderState(const RenderState& state) throw()
 		{
 			const Result result = emulator.renderer.SetState( state );
@@ -350,6 +360,11 @@ namespace Nes
 			return emulator.renderer.GetPalette();
 		}
 
+		ulong Video::Palette::GetRevision() const throw()
+		{
+			return emulator.renderer.GetPaletteRevision();
+		}
+
 		#ifdef NST_MSVC_OPTIMIZE
 		#pragma optimize("", on)
 		#endif
@@ -75,8 +75,15 @@ namespace Nes
 				*/
 				long pitch;
 
+				/**
+				* Set by the core before the unlock callback. True if duplicate frame
+				* detection is enabled and the frame was identical to the previous one,
+				* in which case the surface was left untouched.
+				*/
+				bool unchanged;
+
 				Output(void* v=0,long p=0)
-				: pixels(v), pitch(p) {}
+				: pixels(v), pitch(p), unchanged(false) {}
 
 				/**
 				* Surface lock callback prototype.
@@ -405,6 +412,24 @@ namespace Nes
 			*/
 			bool IsFieldMergingEnabled() const throw();
 
+			/**
+			* Enables duplicate frame detection.
+			*
+			* When enabled, a frame whose PPU output, palette and filter settings match the
+			* previous one is not blitted and Output::unchanged is set instead. The surface
+			* must then keep its contents between frames.
+			*
+			* @param state true to enable, default is false
+			*/
+			void EnableDuplicateFrameDetection(bool state) throw();
+
+			/**
+			* Checks if duplicate frame detection is enabled.
+			*
+			* @return true if enabled
+			*/
+			bool IsDuplicateFrameDetectionEnabled() const throw();
+
 			/**
 			* Performs a manual blit to the video output object.
 			*
@@ -606,6 +631,15 @@ namespace Nes
 				*/
 				Colors GetColors() const throw();
 
+				/**
+				* Returns the palette revision.
+				*
+				* The value changes every time the colors returned by GetColors() are recomputed.
+				*
+				* @return revision number
+				*/
+				ulong GetRevision() const throw();
+
 				/**
 				* Sets the palette mode.
 				*
@@ -723,6 +757,16 @@ namespace Nes
 					FILTER_3XBR,
 					FILTER_4XBR
 				#endif
+					,
+					/**
+					* Raw PPU color indices, colors are looked up by the client.
+					*
+					* At 16 bpp each pixel holds the full 9-bit palette index (color | emphasis << 6),
+					* at 8 bpp only the 6-bit color index is kept and the emphasis bits are dropped.
+					* Color masks are ignored. Use Palette::GetColors() and Palette::GetRevision()
+					* to map indices to RGB.
+					*/
+					FILTER_INDEXED
 				};
 
 				/**
@@ -31,6 +31,12 @@
 #include "NstBoardKonamiVrc4.hpp"
 #include "NstBoardKonamiVrc7.hpp"
 
+#if defined(NST_SSE2)
+#include <emmintrin.h>
+#elif defined(NST_NEON)
+#include <arm_neon.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 // VRC7 Sound Reference:
@@ -220,6 +226,9 @@ namespace Nes
 				Vrc7::Sound::Sound(Apu& a,bool connect)
 				: Channel(a)
 				{
+					for (uint i=0; i < NUM_OPLL_CHANNELS; ++i)
+						channels[i].Connect( operators, i );
+
 					Reset();
 					bool audible = UpdateSettings();
 
@@ -275,6 +284,36 @@ namespace Nes
 						prg.SwapBanks<SIZE_8K,0x0000>(0U,0U,0U,~0U);
 				}
 
+				void Vrc7::Sound::Operators::Reset()
+				{
+					for (uint i=0; i < 2; ++i)
+					{
+						Slot& slot = slots[i];
+
+						for (uint j=0; j < NUM_OPLL_LANES; ++j)
+						{
+							slot.pgCounter[j] = 0;
+							slot.pgPhase[j] = 0;
+							slot.pgVibrato[j] = 0;
+							slot.egCounter[j] = EG_BEGIN;
+							slot.egStep[j] = 0;
+							slot.egEnd[j] = 0xFFFFFFFF;
+							slot.egLimit[j] = 0x7FFFFFFF;
+							slot.egCeiling[j] = 0x7FFFFFFF;
+							slot.tl[j] = 0;
+							slot.am[j] = 0;
+						}
+					}
+				}
+
+				void Vrc7::Sound::OpllChannel::Connect(Operators& o,uint i)
+				{
+					NST_ASSERT( i < NUM_OPLL_LANES );
+
+					operators = &o;
+					lane = i;
+				}
+
 				void Vrc7::Sound::OpllChannel::Reset()
 				{
 					frequency = 0;
@@ -290,14 +329,21 @@ namespace Nes
 
 					for (uint i=0; i < NUM_SLOTS; ++i)
 					{
-						slots[i].pg.phase = 0;
-						slots[i].pg.counter = 0;
 						slots[i].eg.mode = EG_SETTLE;
-						slots[i].eg.counter = EG_BEGIN;
 						slots[i].eg.phase = 0;
-						slots[i].tl = 0;
 						slots[i].sl = 0;
 						slots[i].output = 0;
+
+						Operators::Slot& slot = operators->slots[i];
+
+						slot.pgPhase[lane] = 0;
+						slot.pgCounter[lane] = 0;
+						slot.pgVibrato[lane] = 0;
+						slot.egCounter[lane] = EG_BEGIN;
+						slot.tl[lane] = 0;
+						slot.am[lane] = 0;
+
+						UpdateEnvelope( i );
 					}
 				}
 
@@ -305,6 +351,8 @@ namespace Nes
 				{
 					regSelect = 0;
 
+					operators.Reset();
+
 					for (uint i=0; i < NUM_OPLL_CHANNELS; ++i)
 						channels[i].Reset();
 
@@ -612,12 +660,74 @@ namespace Nes
 							slots[i].eg.phase = 0;
 							break;
 					}
+
+					UpdateEnvelope( i );
+				}
+
+				void Vrc7::Sound::OpllChannel::UpdateEnvelope(const uint i)
+				{
+					NST_ASSERT( i < NUM_SLOTS );
+
+					// Per-lane parameters for Operators::Clock(). A lane whose counter
+					// reaches egLimit after stepping, or egCeiling before it, leaves the
+					// vector path and is clocked by ClockEnvelope() instead.
+
+					Operators::Slot& slot = operators->slots[i];
+
+					dword step = 0, end = 0, limit = 0x7FFFFFFF, ceiling = 0x7FFFFFFF;
+
+					switch (slots[i].eg.mode)
+					{
+						case EG_ATTACK:
+
+							ceiling = 0;
+							break;
+
+						case EG_DECAY:
+
+							step = slots[i].eg.phase;
+							limit = patch.tone[6+i] & uint(REG67_SUSTAIN_LEVEL);
+
+							if (limit == REG67_SUSTAIN_LEVEL)
+								limit = SUSTAIN_LEVEL_MAX;
+
+							limit <<= (EG_PHASE_SHIFT-1);
+							break;
+
+						case EG_HOLD:
+
+							if (!(patch.tone[0+i] & uint(REG01_HOLD)))
+								limit = 0;
+
+							break;
+
+						case EG_SUSTAIN:
+						case EG_RELEASE:
+
+							step = slots[i].eg.phase;
+							ceiling = dword(EG_END+1) << EG_PHASE_SHIFT;
+							break;
+
+						default:
+
+							end = 0xFFFFFFFF;
+							break;
+					}
+
+					slot.egStep[lane] = step;
+					slot.egEnd[lane] = end;
+					slot.egLimit[lane] = limit;
+					slot.egCeiling[lane] = ceiling;
 				}
 
 				void Vrc7::Sound::OpllChannel::UpdatePhase(const Tables& tables,const uint i)
 				{
 					NST_ASSERT( i < NUM_SLOTS );
-					slots[i].pg.phase = tables.GetPhase( frequency, block, patch.tone[0+i] & uint(REG01_MULTIPLE) );
+					Operators::Slot& slot = operators->slots[i];
+
+					slot.pgPhase[lane] = tables.GetPhase( frequency, block, patch.tone[0+i] & uint(REG01_MULTIPLE) );
+					slot.pgVibrato[lane] = (patch.tone[0+i] & uint(REG01_USE_VIBRATO)) ? 0xFFFFFFFF : 0;
+					slot.am[lane] = (patch.tone[0+i] & uint(REG01_USE_AMP)) ? 0xFFFFFFFF : 0;
 				}
 
 				void Vrc7::Sound::OpllChannel::UpdateSustainLevel(const Tables& tables,const uint i)
@@ -629,7 +739,7 @@ namespace Nes
 				void Vrc7::Sound::OpllChannel::UpdateTotalLevel(const Tables& tables,const uint i)
 				{
 					NST_ASSERT( i < NUM_SLOTS );
-					slots[i].tl = tables.GetTotalLevel( frequency, block, (i != MODULATOR) ? volume : (patch.tone[2] & uint(REG2_TOTAL_LEVEL)), patch.tone[2+i] >> 6 );
+					operators->slots[i].tl[lane] = tables.GetTotalLevel( frequency, block, (i != MODULATOR) ? volume : (patch.tone[2] & uint(REG2_TOTAL_LEVEL)), patch.tone[2+i] >> 6 );
 				}
 
 				void Vrc7::Sound::OpllChannel::Update(const Tables& tables)
@@ -753,14 +863,16 @@ namespace Nes
 							for (uint i=0; i < NUM_SLOTS; ++i)
 							{
 								slots[i].eg.mode = EG_ATTACK;
-								slots[i].eg.counter = 0;
-								slots[i].pg.counter = 0;
+								operators->slots[i].egCounter[lane] = 0;
+								operators->slots[i].pgCounter[lane] = 0;
 							}
 						}
 						else
 						{
+							dword& counter = operators->slots[CARRIER].egCounter[lane];
+
 							if (slots[CARRIER].eg.mode == EG_ATTACK)
-								slots[CARRIER].eg.counter = dword(tables.GetLog( slots[CARRIER].eg.counter >> EG_PHASE_SHIFT )) << EG_PHASE_SHIFT;
+								counter = dword(tables.GetLog( counter >> EG_PHASE_SHIFT )) << EG_PHASE_SHIFT;
 
 							slots[CARRIER].eg.mode = EG_RELEASE;
 						}
@@ -877,87 +989,85 @@ namespace Nes
 					}
 				}
 
-				NST_SINGLE_CALL Vrc7::Sound::Sample Vrc7::Sound::OpllChannel::GetSample(const uint pitch,const uint amp,const Tables& tables)
+				NST_SINGLE_CALL uint Vrc7::Sound::OpllChannel::ClockEnvelope(const uint i,const Tables& tables)
 				{
-					uint pgOut[NUM_SLOTS], egOut[NUM_SLOTS];
+					NST_ASSERT( i < NUM_SLOTS );
 
-					for (uint i=0; i < NUM_SLOTS; ++i)
+					dword& counter = operators->slots[i].egCounter[lane];
+					uint egOut = counter >> EG_PHASE_SHIFT;
+
+					switch (slots[i].eg.mode)
 					{
-						if (patch.tone[i] & uint(REG01_USE_VIBRATO))
-							slots[i].pg.counter += (slots[i].pg.phase * pitch) >> AMP_SHIFT;
-						else
-							slots[i].pg.counter += slots[i].pg.phase;
+						case EG_ATTACK:
 
-						slots[i].pg.counter &= PG_PHASE_RANGE;
-						pgOut[i] = slots[i].pg.counter >> PG_PHASE_SHIFT;
-						egOut[i] = slots[i].eg.counter >> EG_PHASE_SHIFT;
+							egOut = tables.GetLog( egOut );
+							counter += slots[i].eg.phase;
 
-						switch (slots[i].eg.mode)
-						{
-							case EG_ATTACK:
+							if (counter >= EG_BEGIN || (patch.tone[4+i] & uint(REG45_ATTACK)) == REG45_ATTACK)
+							{
+								egOut = 0;
+								counter = 0;
+								slots[i].eg.mode = EG_DECAY;
+								UpdateEgPhase( tables, i );
+							}
+							break;
 
-								egOut[i] = tables.GetLog( egOut[i] );
-								slots[i].eg.counter += slots[i].eg.phase;
+						case EG_DECAY:
+						{
+							counter += slots[i].eg.phase;
 
-								if (slots[i].eg.counter >= EG_BEGIN || (patch.tone[4+i] & uint(REG45_ATTACK)) == REG45_ATTACK)
-								{
-									egOut[i] = 0;
-									slots[i].eg.counter = 0;
-									slots[i].eg.mode = EG_DECAY;
-									UpdateEgPhase( tables, i );
-								}
-								break;
+							dword level = patch.tone[6+i] & uint(REG67_SUSTAIN_LEVEL);
 
-							case EG_DECAY:
-							{
-								slots[i].eg.counter += slots[i].eg.phase;
+							if (level == REG67_SUSTAIN_LEVEL)
+								level = SUSTAIN_LEVEL_MAX;
 
-								dword level = patch.tone[6+i] & uint(REG67_SUSTAIN_LEVEL);
+							level <<= (EG_PHASE_SHIFT-1);
 
-								if (level == REG67_SUSTAIN_LEVEL)
-									level = SUSTAIN_LEVEL_MAX;
+							if (counter >= level)
+							{
+								counter = level;
+								slots[i].eg.mode = (patch.tone[0+i] & uint(REG01_HOLD)) ? EG_HOLD : EG_SUSTAIN;
+								UpdateEgPhase( tables, i );
+							}
+							break;
+						}
 
-								level <<= (EG_PHASE_SHIFT-1);
+						case EG_HOLD:
 
-								if (slots[i].eg.counter >= level)
-								{
-									slots[i].eg.counter = level;
-									slots[i].eg.mode = (patch.tone[0+i] & uint(REG01_HOLD)) ? EG_HOLD : EG_SUSTAIN;
-									UpdateEgPhase( tables, i );
-								}
-								break;
+							if (!(patch.tone[0+i] & uint(REG01_HOLD)))
+							{
+								slots[i].eg.mode = EG_SUSTAIN;
+								UpdateEgPhase( tables, i );
 							}
+							break;
 
-							case EG_HOLD:
-
-								if (!(patch.tone[0+i] & uint(REG01_HOLD)))
-								{
-									slots[i].eg.mode = EG_SUSTAIN;
-									UpdateEgPhase( tables, i );
-								}
-								break;
+						case EG_SUSTAIN:
+						case EG_RELEASE:
 
-							case EG_SUSTAIN:
-							case EG_RELEASE:
+							counter += slots[i].eg.phase;
 
-								slots[i].eg.counter += slots[i].eg.phase;
+							if (egOut <= EG_END)
+								break;
 
-								if (egOut[i] <= EG_END)
-									break;
+							slots[i].eg.mode = EG_FINISH;
+							UpdateEnvelope( i );
 
-								slots[i].eg.mode = EG_FINISH;
+						default:
 
-							default:
+							egOut = EG_END;
+							break;
+					}
 
-								egOut[i] = EG_END;
-								break;
-						}
+					return egOut;
+				}
 
-						egOut[i] = (egOut[i] + slots[i].tl) * 2;
+				NST_SINGLE_CALL Vrc7::Sound::Sample Vrc7::Sound::OpllChannel::GetSample(const uint pgMod,const uint pgCar,const uint egMod,const uint egCar,const uint amp,const Tables& tables)
+				{
+					uint pgOut[NUM_SLOTS] = { pgMod, pgCar };
+					uint egOut[NUM_SLOTS] = { egMod, egCar };
 
-						if (patch.tone[i+0] & uint(REG01_USE_AMP))
-							egOut[i] += amp;
-					}
+					for (uint i=0; i < NUM_SLOTS; ++i)
+						egOut[i] = (egOut[i] + operators->slots[i].tl[lane]) * 2 + (amp & operators->slots[i].am[lane]);
 
 					if (slots[CARRIER].eg.mode == EG_FINISH)
 						return 0;
@@ -987,39 +1097,182 @@ namespace Nes
 					return (output + slots[CARRIER].output) / 2;
 				}
 
-				Vrc7::Sound::Sample Vrc7::Sound::GetSample()
+				NST_SINGLE_CALL dword Vrc7::Sound::Operators::Clock(const uint i,const uint pitch,dword (&pgOut)[NUM_OPLL_LANES],dword (&egOut)[NUM_OPLL_LANES])
 				{
-					if (output)
+					NST_ASSERT( i < 2 );
+					NST_COMPILE_ASSERT( sizeof(dword) == 4 && NUM_OPLL_LANES % 4 == 0 );
+
+					// Phase and envelope generators of one operator slot for all
+					// channels at once. Returns a bit per lane whose envelope must
+					// be clocked by OpllChannel::ClockEnvelope() instead.
+
+					Slot& slot = slots[i];
+					dword irregular = 0;
+
+				#if defined(NST_SSE2)
+
+					const __m128i vPitch = _mm_set1_epi32( pitch );
+					const __m128i vRange = _mm_set1_epi32( PG_PHASE_RANGE );
+					const __m128i vEnd = _mm_set1_epi32( EG_END );
+
+					for (uint j=0; j < NUM_OPLL_LANES; j += 4)
+					{
+						__m128i phase = _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.pgPhase+j) );
+
+						const __m128i even = _mm_mul_epu32( phase, vPitch );
+						const __m128i odd = _mm_mul_epu32( _mm_srli_epi64( phase, 32 ), vPitch );
+
+						const __m128i vibrato = _mm_srli_epi32
+						(
+							_mm_unpacklo_epi32
+							(
+								_mm_shuffle_epi32( even, _MM_SHUFFLE(3,1,2,0) ),
+								_mm_shuffle_epi32( odd, _MM_SHUFFLE(3,1,2,0) )
+							),
+							AMP_SHIFT
+						);
+
+						const __m128i useVibrato = _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.pgVibrato+j) );
+						phase = _mm_or_si128( _mm_and_si128( useVibrato, vibrato ), _mm_andnot_si128( useVibrato, phase ) );
+
+						const __m128i pg = _mm_and_si128( _mm_add_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.pgCounter+j) ), phase ), vRange );
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(slot.pgCounter+j), pg );
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(pgOut+j), _mm_srli_epi32( pg, PG_PHASE_SHIFT ) );
+
+						const __m128i eg = _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.egCounter+j) );
+						const __m128i next = _mm_add_epi32( eg, _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.egStep+j) ) );
+
+						const __m128i regular = _mm_and_si128
+						(
+							_mm_cmpgt_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.egLimit+j) ), next ),
+							_mm_cmpgt_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.egCeiling+j) ), eg )
+						);
+
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(slot.egCounter+j), _mm_or_si128( _mm_and_si128( regular, next ), _mm_andnot_si128( regular, eg ) ) );
+
+						const __m128i end = _mm_loadu_si128( reinterpret_cast<const __m128i*>(slot.egEnd+j) );
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(egOut+j), _mm_or_si128( _mm_and_si128( end, vEnd ), _mm_andnot_si128( end, _mm_srli_epi32( eg, EG_PHASE_SHIFT ) ) ) );
+
+						irregular |= dword(_mm_movemask_ps( _mm_castsi128_ps( regular ) ) ^ 0xF) << j;
+					}
+
+				#elif defined(NST_NEON)
+
+					const uint32x4_t vPitch = vdupq_n_u32( pitch );
+					const uint32x4_t vRange = vdupq_n_u32( PG_PHASE_RANGE );
+					const uint32x4_t vEnd = vdupq_n_u32( EG_END );
+					static const uint32_t bits[4] = {1,2,4,8};
+					const uint32x4_t vBits = vld1q_u32( bits );
+
+					for (uint j=0; j < NUM_OPLL_LANES; j += 4)
 					{
-						while (samplePhase < sampleRate)
+						const uint32x4_t phase = vbslq_u32
+						(
+							vld1q_u32( slot.pgVibrato+j ),
+							vshrq_n_u32( vmulq_u32( vld1q_u32( slot.pgPhase+j ), vPitch ), AMP_SHIFT ),
+							vld1q_u32( slot.pgPhase+j )
+						);
+
+						const uint32x4_t pg = vandq_u32( vaddq_u32( vld1q_u32( slot.pgCounter+j ), phase ), vRange );
+						vst1q_u32( slot.pgCounter+j, pg );
+						vst1q_u32( pgOut+j, vshrq_n_u32( pg, PG_PHASE_SHIFT ) );
+
+						const uint32x4_t eg = vld1q_u32( slot.egCounter+j );
+						const uint32x4_t next = vaddq_u32( eg, vld1q_u32( slot.egStep+j ) );
+						const uint32x4_t regular = vandq_u32( vcltq_u32( next, vld1q_u32( slot.egLimit+j ) ), vcltq_u32( eg, vld1q_u32( slot.egCeiling+j ) ) );
+
+						vst1q_u32( slot.egCounter+j, vbslq_u32( regular, next, eg ) );
+						vst1q_u32( egOut+j, vbslq_u32( vld1q_u32( slot.egEnd+j ), vEnd, vshrq_n_u32( eg, EG_PHASE_SHIFT ) ) );
+
+						uint32x2_t mask = vget_low_u32( vandq_u32( vmvnq_u32( regular ), vBits ) );
+						mask = vorr_u32( mask, vget_high_u32( vandq_u32( vmvnq_u32( regular ), vBits ) ) );
+						irregular |= dword(vget_lane_u32( vpadd_u32( mask, mask ), 0 )) << j;
+					}
+
+				#else
+
+					for (uint j=0; j < NUM_OPLL_LANES; ++j)
+					{
+						const dword phase = slot.pgVibrato[j] ? (slot.pgPhase[j] * pitch) >> AMP_SHIFT : slot.pgPhase[j];
+
+						slot.pgCounter[j] = (slot.pgCounter[j] + phase) & PG_PHASE_RANGE;
+						pgOut[j] = slot.pgCounter[j] >> PG_PHASE_SHIFT;
+
+						const dword eg = slot.egCounter[j];
+						const dword next = eg + slot.egStep[j];
+
+						if (next < slot.egLimit[j] && eg < slot.egCeiling[j])
+							slot.egCounter[j] = next;
+						else
+							irregular |= 1UL << j;
+
+						egOut[j] = slot.egEnd[j] ? EG_END : eg >> EG_PHASE_SHIFT;
+					}
+
+				#endif
+
+					return irregular & ((1UL << NUM_OPLL_CHANNELS) - 1);
+				}
+
+				NST_SINGLE_CALL Vrc7::Sound::Sample Vrc7::Sound::Synthesize(const uint pitch,const uint amp)
+				{
+					dword pgOut[2][NUM_OPLL_LANES], egOut[2][NUM_OPLL_LANES];
+
+					for (uint i=0; i < 2; ++i)
+					{
+						if (const dword irregular = operators.Clock( i, pitch, pgOut[i], egOut[i] ))
 						{
-							samplePhase += CLOCK_RATE;
+							for (uint j=0; j < NUM_OPLL_CHANNELS; ++j)
+							{
+								if (irregular & (1UL << j))
+									egOut[i][j] = channels[j].ClockEnvelope( i, tables );
+							}
+						}
+					}
+
+					Sample sample = 0;
+
+					for (uint j=0; j < NUM_OPLL_CHANNELS; ++j)
+						sample += channels[j].GetSample( pgOut[0][j], pgOut[1][j], egOut[0][j], egOut[1][j], amp, tables );
 
-							pitchPhase = (pitchPhase + PITCH_RATE) & PITCH_RANGE;
-							ampPhase = (ampPhase + AMP_RATE) & AMP_RANGE;
+					return sample;
+				}
 
-							const uint lfo[2] =
+				void Vrc7::Sound::RenderBlock(Sample* NST_RESTRICT out,uint count)
+				{
+					if (output)
+					{
+						for (; count; --count)
+						{
+							while (samplePhase < sampleRate)
 							{
-								tables.GetPitch( pitchPhase >> PITCH_SHIFT ),
-								tables.GetAmp( ampPhase >> AMP_SHIFT )
-							};
+								samplePhase += CLOCK_RATE;
 
-							prevSample = nextSample;
-							nextSample = 0;
+								pitchPhase = (pitchPhase + PITCH_RATE) & PITCH_RANGE;
+								ampPhase = (ampPhase + AMP_RATE) & AMP_RANGE;
 
-							for (uint i=0; i < NUM_OPLL_CHANNELS; ++i)
-								nextSample += channels[i].GetSample( lfo[0], lfo[1], tables );
-						}
+								prevSample = nextSample;
+								nextSample = Synthesize( tables.GetPitch( pitchPhase >> PITCH_SHIFT ), tables.GetAmp( ampPhase >> AMP_SHIFT ) );
+							}
 
-						samplePhase -= sampleRate;
+							samplePhase -= sampleRate;
 
-						return signed_shl( (prevSample * idword(samplePhase) + nextSample * idword(CLOCK_RATE - samplePhase)) / idword(CLOCK_RATE), 3 ) * idword(output) / DEFAULT_VOLUME;
+							*out++ = signed_shl( (prevSample * idword(samplePhase) + nextSample * idword(CLOCK_RATE - samplePhase)) / idword(CLOCK_RATE), 3 ) * idword(output) / DEFAULT_VOLUME;
+						}
 					}
 					else
 					{
-						return 0;
+						for (; count; --count)
+							*out++ = 0;
 					}
 				}
+
+				Vrc7::Sound::Sample Vrc7::Sound::GetSample()
+				{
+					Sample sample;
+					RenderBlock( &sample, 1 );
+					return sample;
+				}
 			}
 		}
 	}
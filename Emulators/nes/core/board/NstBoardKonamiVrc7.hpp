@@ -54,6 +54,8 @@ namespace Nes
 						void SaveState(State::Saver&,dword) const;
 						void LoadState(State::Loader&);
 
+						void RenderBlock(Sample*,uint);
+
 					protected:
 
 						void Reset();
@@ -124,13 +126,37 @@ namespace Nes
 
 						enum
 						{
-							NUM_OPLL_CHANNELS = 6
+							NUM_OPLL_CHANNELS = 6,
+							NUM_OPLL_LANES = 8
+						};
+
+						struct Operators
+						{
+							struct Slot
+							{
+								dword pgCounter[NUM_OPLL_LANES];
+								dword pgPhase[NUM_OPLL_LANES];
+								dword pgVibrato[NUM_OPLL_LANES];
+								dword egCounter[NUM_OPLL_LANES];
+								dword egStep[NUM_OPLL_LANES];
+								dword egEnd[NUM_OPLL_LANES];
+								dword egLimit[NUM_OPLL_LANES];
+								dword egCeiling[NUM_OPLL_LANES];
+								dword tl[NUM_OPLL_LANES];
+								dword am[NUM_OPLL_LANES];
+							};
+
+							void Reset();
+							NST_SINGLE_CALL dword Clock(uint,uint,dword (&)[NUM_OPLL_LANES],dword (&)[NUM_OPLL_LANES]);
+
+							Slot slots[2];
 						};
 
 						class OpllChannel
 						{
 						public:
 
+							void Connect(Operators&,uint);
 							void Reset();
 							void Update(const Tables&);
 							void SaveState(State::Saver&,dword) const;
@@ -148,7 +174,8 @@ namespace Nes
 							NST_SINGLE_CALL void WriteReg9 (uint,const Tables&);
 							NST_SINGLE_CALL void WriteRegA (uint,const Tables&);
 
-							NST_SINGLE_CALL Sample GetSample(uint,uint,const Tables&);
+							NST_SINGLE_CALL uint ClockEnvelope(uint,const Tables&);
+							NST_SINGLE_CALL Sample GetSample(uint,uint,uint,uint,uint,const Tables&);
 
 						private:
 
@@ -156,6 +183,7 @@ namespace Nes
 							void UpdateSustainLevel (const Tables&,uint);
 							void UpdateTotalLevel   (const Tables&,uint);
 							void UpdateEgPhase      (const Tables&,uint);
+							void UpdateEnvelope     (uint);
 
 							enum Mode
 							{
@@ -220,27 +248,23 @@ namespace Nes
 
 							struct
 							{
-								struct
-								{
-									dword phase;
-									dword counter;
-								}   pg;
-
 								struct
 								{
 									Mode mode;
 									dword phase;
-									dword counter;
 								}   eg;
 
-								uint tl;
 								uint sl;
 								Sample output;
 							}   slots[NUM_SLOTS];
 
 							Sample feedback;
+							Operators* operators;
+							uint lane;
 						};
 
+						NST_SINGLE_CALL Sample Synthesize(uint,uint);
+
 						uint output;
 						uint regSelect;
 
@@ -253,6 +277,7 @@ namespace Nes
 						Sample nextSample;
 
 						OpllChannel channels[NUM_OPLL_CHANNELS];
+						Operators operators;
 						const Tables tables;
 
 					public:
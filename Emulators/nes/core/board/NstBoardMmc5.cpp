@@ -1629,15 +1629,12 @@ namespace Nes
 				pcm.WriteReg1( data );
 			}
 
-			NST_SINGLE_CALL dword Mmc5::Sound::Square::GetSample(const Cycle rate)
+			NST_SINGLE_CALL void Mmc5::Sound::Square::Render(dword* NST_RESTRICT mix,uint count,const Cycle rate)
 			{
 				NST_VERIFY( bool(active) == CanOutput() && timer >= 0 );
 
 				if (active)
 				{
-					dword sum = timer;
-					timer -= idword(rate);
-
 					static const byte duties[4][8] =
 					{
 						{0x1F,0x00,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F},
@@ -1646,27 +1643,33 @@ namespace Nes
 						{0x00,0x1F,0x1F,0x00,0x00,0x00,0x00,0x00}
 					};
 
-					if (timer >= 0)
-					{
-						return dword(envelope.Volume()) >> duties[duty][step];
-					}
-					else
+					const byte* const NST_RESTRICT form = duties[duty];
+					const dword volume = envelope.Volume();
+
+					do
 					{
-						sum >>= duties[duty][step];
+						dword sum = timer;
+						timer -= idword(rate);
 
-						do
+						if (timer >= 0)
 						{
-							sum += NST_MIN(dword(-timer),frequency) >> duties[duty][step = (step + 1) & 0x7];
-							timer += idword(frequency);
+							*mix++ += volume >> form[step];
 						}
-						while (timer < 0);
+						else
+						{
+							sum >>= form[step];
 
-						return (sum * envelope.Volume() + rate/2) / rate;
+							do
+							{
+								sum += NST_MIN(dword(-timer),frequency) >> form[step = (step + 1) & 0x7];
+								timer += idword(frequency);
+							}
+							while (timer < 0);
+
+							*mix++ += (sum * volume + rate/2) / rate;
+						}
 					}
-				}
-				else
-				{
-					return 0;
+					while (--count);
 				}
 			}
 
@@ -1675,25 +1678,42 @@ namespace Nes
 				return sample;
 			}
 
-			Mmc5::Sound::Sample Mmc5::Sound::GetSample()
+			void Mmc5::Sound::RenderBlock(Sample* NST_RESTRICT out,uint count)
 			{
 				if (output)
 				{
-					dword sample = 0;
+					while (count)
+					{
+						const uint length = NST_MIN(count,uint(BLOCK_LENGTH));
+						const dword sample = pcm.GetSample();
+						dword mix[BLOCK_LENGTH];
 
-					for (uint i=0; i < NUM_SQUARES; ++i)
-						sample += square[i].GetSample( rate );
+						for (uint i=0; i < length; ++i)
+							mix[i] = sample;
+
+						for (uint i=0; i < NUM_SQUARES; ++i)
+							square[i].Render( mix, length, rate );
 
-					sample += pcm.GetSample();
+						for (uint i=0; i < length; ++i)
+							*out++ = dcBlocker.Apply( mix[i] * 2 * output / DEFAULT_VOLUME );
 
-					return dcBlocker.Apply( sample * 2 * output / DEFAULT_VOLUME );
+						count -= length;
+					}
 				}
 				else
 				{
-					return 0;
+					for (; count; --count)
+						*out++ = 0;
 				}
 			}
 
+			Mmc5::Sound::Sample Mmc5::Sound::GetSample()
+			{
+				Sample sample;
+				RenderBlock( &sample, 1 );
+				return sample;
+			}
+
 			NST_SINGLE_CALL void Mmc5::Sound::Square::ClockQuarter()
 			{
 				envelope.Clock();
@@ -68,12 +68,14 @@ namespace Nes
 					bool UpdateSettings();
 					Cycle Clock(Cycle,Cycle,Cycle);
 					Sample GetSample();
+					void RenderBlock(Sample*,uint);
 
 				private:
 
 					enum
 					{
-						NUM_SQUARES = 2
+						NUM_SQUARES = 2,
+						BLOCK_LENGTH = 64
 					};
 
 					class Square
@@ -82,7 +84,7 @@ namespace Nes
 
 						void Reset();
 
-						NST_SINGLE_CALL dword GetSample(Cycle);
+						NST_SINGLE_CALL void Render(dword*,uint,Cycle);
 
 						NST_SINGLE_CALL void WriteReg0(uint);
 						NST_SINGLE_CALL void WriteReg1(uint,uint);
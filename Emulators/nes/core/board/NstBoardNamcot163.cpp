@@ -311,8 +311,10 @@ namespace Nes
 					volume = (data & REG_VOLUME) * VOLUME;
 				}
 
-				inline dword N163::Sound::BaseChannel::GetSample
+				inline void N163::Sound::BaseChannel::Render
 				(
+					dword* NST_RESTRICT mix,
+					uint count,
 					const Cycle rate,
 					const Cycle factor,
 					const byte (&wave)[0x100]
@@ -322,32 +324,69 @@ namespace Nes
 
 					if (active)
 					{
-						phase = (phase + (timer + rate) / factor * frequency) % waveLength;
-						timer = (timer + rate) % factor;
+						// split the per-sample division by the channel divider into a fixed quotient and a carry
+						const Cycle steps = rate / factor;
+						const Cycle rest = rate % factor;
 
-						return wave[(waveOffset + (phase >> PHASE_SHIFT)) & 0xFF] * dword(volume);
-					}
+						Cycle t = timer;
+						Cycle p = phase;
+
+						do
+						{
+							Cycle advance = steps;
+
+							for (t += rest; t >= factor; t -= factor)
+								++advance;
+
+							p += advance * frequency;
 
-					return 0;
+							if (p >= waveLength)
+								p %= waveLength;
+
+							*mix++ += wave[(waveOffset + (p >> PHASE_SHIFT)) & 0xFF] * dword(volume);
+						}
+						while (--count);
+
+						timer = t;
+						phase = p;
+					}
 				}
 
-				N163::Sound::Sample N163::Sound::GetSample()
+				void N163::Sound::RenderBlock(Sample* NST_RESTRICT out,uint count)
 				{
 					if (output)
 					{
-						dword sample = 0;
+						while (count)
+						{
+							const uint length = NST_MIN(count,uint(BLOCK_LENGTH));
+							dword mix[BLOCK_LENGTH];
+
+							for (uint i=0; i < length; ++i)
+								mix[i] = 0;
 
-						for (BaseChannel* channel = channels+startChannel; channel != channels+NUM_CHANNELS; ++channel)
-							sample += channel->GetSample( rate, frequency, wave );
+							for (BaseChannel* channel = channels+startChannel; channel != channels+NUM_CHANNELS; ++channel)
+								channel->Render( mix, length, rate, frequency, wave );
 
-						return dcBlocker.Apply( sample * output / DEFAULT_VOLUME );
+							for (uint i=0; i < length; ++i)
+								*out++ = dcBlocker.Apply( mix[i] * output / DEFAULT_VOLUME );
+
+							count -= length;
+						}
 					}
 					else
 					{
-						return 0;
+						for (; count; --count)
+							*out++ = 0;
 					}
 				}
 
+				N163::Sound::Sample N163::Sound::GetSample()
+				{
+					Sample sample;
+					RenderBlock( &sample, 1 );
+					return sample;
+				}
+
 				bool N163::Sound::UpdateSettings()
 				{
 					uint volume = GetVolume(EXT_N163) * 68U / DEFAULT_VOLUME;
@@ -69,6 +69,7 @@ namespace Nes
 						void Reset();
 						bool UpdateSettings();
 						Sample GetSample();
+						void RenderBlock(Sample*,uint);
 
 					private:
 
@@ -80,6 +81,7 @@ namespace Nes
 						enum
 						{
 							NUM_CHANNELS     = 8,
+							BLOCK_LENGTH     = 64,
 							EXRAM_INC        = 0x80,
 							//REG_WAVELENGTH   = 0x1C,
 							REG_WAVELENGTH   = 0xFC,
@@ -95,7 +97,7 @@ namespace Nes
 
 							void Reset();
 
-							inline dword GetSample(Cycle,Cycle,const byte (&)[0x100]);
+							inline void Render(dword*,uint,Cycle,Cycle,const byte (&)[0x100]);
 
 							inline void SetFrequency  (uint);
 							inline void SetWaveLength (uint);
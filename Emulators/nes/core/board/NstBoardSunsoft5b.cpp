@@ -542,63 +542,87 @@ namespace Nes
 					return dc;
 				}
 
-				NST_SINGLE_CALL dword S5b::Sound::Square::GetSample(const Cycle rate,const uint envelope,const uint noise)
+				NST_SINGLE_CALL void S5b::Sound::Square::Render(dword* NST_RESTRICT mix,const uint count,const Cycle rate,const dword* NST_RESTRICT envelope,const dword* NST_RESTRICT noise)
 				{
-					dword sum = timer;
-					timer -= idword(rate);
+					for (uint i=0; i < count; ++i)
+					{
+						dword sum = timer;
+						timer -= idword(rate);
 
-					const uint out = (ctrl & 0x10) ? envelope : volume;
+						const uint out = (ctrl & 0x10) ? uint(envelope[i]) : volume;
 
-					if ((noise|status) & 0x8 && out)
-					{
-						if (timer >= 0)
+						if ((noise[i]|status) & 0x8 && out)
 						{
-							return out & dc;
+							if (timer >= 0)
+							{
+								mix[i] += out & dc;
+							}
+							else
+							{
+								sum &= dc;
+
+								do
+								{
+									dc ^= (status & 0x1) - 1UL;
+									sum += NST_MIN(dword(-timer),frequency) & dc;
+									timer += idword(frequency);
+								}
+								while (timer < 0);
+
+								NST_VERIFY( sum <= 0xFFFFFFFF / out + rate/2 );
+								mix[i] += (sum * out + rate/2) / rate;
+							}
 						}
 						else
 						{
-							sum &= dc;
-
-							do
+							while (timer < 0)
 							{
 								dc ^= (status & 0x1) - 1UL;
-								sum += NST_MIN(dword(-timer),frequency) & dc;
 								timer += idword(frequency);
 							}
-							while (timer < 0);
-
-							NST_VERIFY( sum <= 0xFFFFFFFF / out + rate/2 );
-							return (sum * out + rate/2) / rate;
 						}
 					}
-					else
-					{
-						while (timer < 0)
-						{
-							dc ^= (status & 0x1) - 1UL;
-							timer += idword(frequency);
-						}
-
-						return 0;
-					}
 				}
 
-				S5b::Sound::Sample S5b::Sound::GetSample()
+				void S5b::Sound::RenderBlock(Sample* NST_RESTRICT out,uint count)
 				{
 					if (active && output)
 					{
-						dword sample = 0;
+						while (count)
+						{
+							const uint length = NST_MIN(count,uint(BLOCK_LENGTH));
+							dword e[BLOCK_LENGTH], n[BLOCK_LENGTH], mix[BLOCK_LENGTH];
+
+							// the envelope and noise generators are shared, clock them once for the whole run
+							for (uint i=0; i < length; ++i)
+							{
+								e[i] = envelope.Clock( rate );
+								n[i] = noise.Clock( rate );
+								mix[i] = 0;
+							}
+
+							for (uint i=0; i < NUM_SQUARES; ++i)
+								squares[i].Render( mix, length, rate, e, n );
 
-						for (dword i=0, e=envelope.Clock( rate ), n=noise.Clock( rate ); i < NUM_SQUARES; ++i)
-							sample += squares[i].GetSample( rate, e, n );
+							for (uint i=0; i < length; ++i)
+								*out++ = dcBlocker.Apply( mix[i] * output / DEFAULT_VOLUME );
 
-						return dcBlocker.Apply( sample * output / DEFAULT_VOLUME );
+							count -= length;
+						}
 					}
 					else
 					{
-						return 0;
+						for (; count; --count)
+							*out++ = 0;
 					}
 				}
+
+				S5b::Sound::Sample S5b::Sound::GetSample()
+				{
+					Sample sample;
+					RenderBlock( &sample, 1 );
+					return sample;
+				}
 			}
 		}
 	}
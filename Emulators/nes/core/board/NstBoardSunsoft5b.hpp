@@ -59,12 +59,14 @@ namespace Nes
 						void Reset();
 						bool UpdateSettings();
 						Sample GetSample();
+						void RenderBlock(Sample*,uint);
 
 					private:
 
 						enum
 						{
-							NUM_SQUARES = 3
+							NUM_SQUARES = 3,
+							BLOCK_LENGTH = 64
 						};
 
 						class Envelope
@@ -135,7 +137,7 @@ namespace Nes
 							void WriteReg2(uint);
 							void WriteReg3(uint);
 
-							NST_SINGLE_CALL dword GetSample(Cycle,uint,uint);
+							NST_SINGLE_CALL void Render(dword*,uint,Cycle,const dword*,const dword*);
 
 						private:
 
@@ -0,0 +1,204 @@
+//
+//  SOOLRA
+//
+//  Copyright © 2025 SOOLRA. All rights reserved.
+//
+//  Plays a generated VRC7 test cartridge for a fixed number of frames and writes the
+//  raw 16-bit samples to a file. Like SoolraFilterCheck, the Makefile builds it against
+//  the normal NES core and against the NST_NO_SIMD / NST_NO_THREADS one; the SIMD build
+//  compares its samples against the scalar ones with --compare.
+//
+//  Both also check a hash of the samples against regression/vrc7.golden, recorded from
+//  the per-channel VRC7 synthesis the operator lanes replaced. --update rewrites it.
+//
+
+#include "NstBase.hpp"
+#include "NstApiEmulator.hpp"
+#include "NstApiMachine.hpp"
+#include "NstApiSound.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr unsigned FRAMES = 600;
+constexpr unsigned SAMPLE_RATE = 44100;
+constexpr unsigned SAMPLES_PER_FRAME = SAMPLE_RATE / 60;
+constexpr unsigned VRC7_VOLUME = 20;
+
+// Mapper 85 cartridge, 16 KiB of PRG and 8 KiB of CHR. The fixed bank at $E000 loads
+// all six channels and the custom instrument, then keeps stepping a counter and
+// rewrites one channel's frequency, key, block, instrument and volume from it, plus
+// one custom instrument register, roughly every one and a half frames.
+constexpr unsigned PRG_SIZE = 0x4000;
+constexpr unsigned CHR_SIZE = 0x2000;
+constexpr unsigned CODE_OFFSET = 0x2000;    // $E000
+constexpr unsigned NMI_HANDLER = 0xE070;    // RTI
+
+const uint8_t PROGRAM[] = {
+    0x78, 0xD8, 0xA2, 0xFF, 0x9A, 0xA9, 0x00, 0x85, 0x00, 0xA2, 0x00, 0xBD, 0x71, 0xE0, 0x30, 0x0D,
+    0x8D, 0x10, 0x90, 0xE8, 0xBD, 0x71, 0xE0, 0x8D, 0x30, 0x90, 0xE8, 0xD0, 0xEE, 0xA0, 0x20, 0xA2,
+    0x00, 0xCA, 0xD0, 0xFD, 0x88, 0xD0, 0xF8, 0xE6, 0x00, 0xA5, 0x00, 0x29, 0x03, 0x85, 0x01, 0x09,
+    0x10, 0x8D, 0x10, 0x90, 0xA5, 0x00, 0x0A, 0x0A, 0x18, 0x65, 0x00, 0x8D, 0x30, 0x90, 0xA5, 0x01,
+    0x09, 0x30, 0x8D, 0x10, 0x90, 0xA5, 0x00, 0x0A, 0x0A, 0x0A, 0x0A, 0x18, 0x65, 0x00, 0x8D, 0x30,
+    0x90, 0xA5, 0x01, 0x09, 0x20, 0x8D, 0x10, 0x90, 0xA5, 0x00, 0x29, 0x1F, 0x8D, 0x30, 0x90, 0xA5,
+    0x00, 0x29, 0x07, 0x8D, 0x10, 0x90, 0xA5, 0x00, 0x49, 0xA5, 0x8D, 0x30, 0x90, 0x4C, 0x1D, 0xE0,
+    0x40, 0x00, 0x21, 0x01, 0x01, 0x02, 0x1A, 0x03, 0x07, 0x04, 0xF0, 0x05, 0xD4, 0x06, 0x11, 0x07,
+    0x37, 0x10, 0xAC, 0x11, 0x58, 0x12, 0x21, 0x13, 0x90, 0x14, 0xC3, 0x15, 0x6E, 0x30, 0x10, 0x31,
+    0x32, 0x32, 0x50, 0x33, 0x74, 0x34, 0x96, 0x35, 0x02, 0x20, 0x19, 0x21, 0x17, 0x22, 0x1B, 0x23,
+    0x14, 0x24, 0x1D, 0x25, 0x18, 0xFF,
+};
+
+std::string buildCartridge() {
+    std::string image(16 + PRG_SIZE + CHR_SIZE, '\0');
+    const uint8_t header[16] = { 'N', 'E', 'S', 0x1A, PRG_SIZE / 0x4000, CHR_SIZE / 0x2000, (85 & 0xF) << 4, 85 & 0xF0 };
+    std::memcpy(&image[0], header, sizeof(header));
+
+    char* prg = &image[16];
+    std::memcpy(prg + CODE_OFFSET, PROGRAM, sizeof(PROGRAM));
+    const uint8_t vectors[6] = { NMI_HANDLER & 0xFF, NMI_HANDLER >> 8, 0x00, 0xE0, NMI_HANDLER & 0xFF, NMI_HANDLER >> 8 };
+    std::memcpy(prg + PRG_SIZE - 6, vectors, sizeof(vectors));
+    return image;
+}
+
+// Mono 16-bit samples of every frame, or empty if the core refused the cartridge
+std::vector<int16_t> playCartridge() {
+    Nes::Api::Emulator emulator;
+    Nes::Api::Machine machine(emulator);
+    Nes::Api::Sound sound(emulator);
+
+    std::istringstream rom(buildCartridge());
+    if (NES_FAILED(machine.Load(rom, Nes::Api::Machine::FAVORED_NES_NTSC))) return {};
+    if (NES_FAILED(sound.SetSampleRate(SAMPLE_RATE))) return {};
+    sound.SetSpeaker(Nes::Api::Sound::SPEAKER_MONO);
+    // Quiet enough that six keyed channels never clip, so every sample carries the synthesis
+    if (NES_FAILED(sound.SetVolume(Nes::Api::Sound::CHANNEL_VRC7, VRC7_VOLUME))) return {};
+
+    machine.Power(true);
+
+    std::vector<int16_t> samples(size_t(FRAMES) * SAMPLES_PER_FRAME);
+    for (unsigned frame = 0; frame < FRAMES; frame++) {
+        Nes::Api::Sound::Output output(&samples[size_t(frame) * SAMPLES_PER_FRAME], SAMPLES_PER_FRAME);
+        emulator.Execute(nullptr, &output, nullptr);
+    }
+    return samples;
+}
+
+// 64-bit FNV-1a over every byte
+uint64_t hashSamples(const std::vector<int16_t>& samples) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(samples.data());
+    for (size_t i = 0; i < samples.size() * sizeof(int16_t); i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// The "vrc7 <hash>" line of a golden file
+std::string readGolden(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name, hash;
+        if (fields >> name >> hash && name == "vrc7") return hash;
+    }
+    return {};
+}
+
+void usage() {
+    std::cerr << "usage: SoolraAudioCheck [--compare reference] [--golden file [--update]] <output>" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string referencePath;
+    std::string goldenPath;
+    bool update = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            referencePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            goldenPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 1 || (update && goldenPath.empty())) {
+        usage();
+        return 1;
+    }
+
+    const std::vector<int16_t> samples = playCartridge();
+    if (samples.empty()) {
+        std::cerr << "[AudioCheck] vrc7: FAILED, could not load the test cartridge" << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(paths[0], std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(samples.data()), std::streamsize(samples.size() * sizeof(int16_t)));
+    if (!out.good()) {
+        std::cerr << "[AudioCheck] Error: Failed to write " << paths[0] << std::endl;
+        return 1;
+    }
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, hashSamples(samples));
+
+    if (update) {
+        std::ofstream goldenOut(goldenPath, std::ios::trunc);
+        goldenOut << "# VRC7 test cartridge, " << FRAMES << " frames at " << SAMPLE_RATE
+                  << " Hz, written by SoolraAudioCheck --update\n"
+                  << "vrc7 " << hash << "\n";
+        if (!goldenOut.good()) {
+            std::cerr << "[AudioCheck] Error: Failed to write " << goldenPath << std::endl;
+            return 1;
+        }
+        std::cerr << "[AudioCheck] Golden hash written to " << goldenPath << std::endl;
+        return 0;
+    }
+
+    bool passed = true;
+    if (!goldenPath.empty()) {
+        const std::string expected = readGolden(goldenPath);
+        if (expected != hash) {
+            std::cerr << "[AudioCheck] vrc7: FAILED, hash " << hash << " is not the golden "
+                      << (expected.empty() ? std::string("(missing)") : expected) << std::endl;
+            passed = false;
+        }
+    }
+
+    if (!referencePath.empty()) {
+        std::ifstream reference(referencePath, std::ios::binary);
+        std::vector<int16_t> expected(samples.size());
+        reference.read(reinterpret_cast<char*>(expected.data()), std::streamsize(expected.size() * sizeof(int16_t)));
+        if (size_t(reference.gcount()) != expected.size() * sizeof(int16_t)) {
+            std::cerr << "[AudioCheck] vrc7: FAILED, " << referencePath << " is missing or too short" << std::endl;
+            return 1;
+        }
+
+        const auto mismatch = std::mismatch(samples.begin(), samples.end(), expected.begin());
+        if (mismatch.first != samples.end()) {
+            const size_t offset = size_t(mismatch.first - samples.begin());
+            std::cerr << "[AudioCheck] vrc7: FAILED, frame " << offset / SAMPLES_PER_FRAME << " sample "
+                      << offset % SAMPLES_PER_FRAME << " is " << *mismatch.first << ", reference "
+                      << *mismatch.second << std::endl;
+            passed = false;
+        }
+    }
+
+    if (passed) std::cerr << "[AudioCheck] vrc7: ok" << std::endl;
+    return passed ? 0 : 2;
+}
@@ -0,0 +1,622 @@
+//
+//  SOOLRA
+//
+//  Copyright © 2025 SOOLRA. All rights reserved.
+//
+//  Headless batch runner for compatibility and performance sweeps. Boots every
+//  .nes, .gba, .gb and .gbc file under a directory for a fixed number of frames and
+//  writes a CSV or JSON report. Not part of the app target; the Makefile next to this
+//  file builds it against the NES and GBA cores (the latter also runs Game Boy titles):
+//
+//      make -C Emulators/tools
+//
+//  Titles are handed out to worker threads that steal from each other once their
+//  own queue runs dry. Each worker runs its title in a child process: the GBA and GB
+//  cores keep their state in globals, a crashing title must not take the sweep down with
+//  it, and the child's resource usage gives that title's peak memory. A child that
+//  reports no frame progress for --hang-seconds is killed and marked as hung.
+//
+
+#include "SoolraNESBridge.hpp"
+#include "SoolraGBABridge.hpp"
+#include "SoolraGBBridge.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+extern char** environ;
+
+namespace {
+
+constexpr int START_BUTTON = 0x08;      // same bit on every system
+constexpr int PROGRESS_INTERVAL = 60;   // frames between reports from the child
+
+enum class System { NES, GBA, GB };
+
+struct Options {
+    std::string romDirectory;
+    std::string reportPath;             // .json for JSON, anything else for CSV; stdout if empty
+    std::string resourcePath;           // directory holding vba-over.ini
+    uint32_t frames = 3600;
+    unsigned jobs = 0;
+    unsigned hangSeconds = 10;
+};
+
+struct Job {
+    std::string path;
+    System system;
+    uintmax_t size;
+};
+
+struct Result {
+    std::string path;
+    System system = System::NES;
+    std::string status;                 // ok, load-failed, crashed, hung, failed
+    std::string detail;
+    uint32_t frames = 0;
+    double loadMs = 0;
+    double runMs = 0;
+    uint32_t frameHash = 0;
+    long peakKiB = 0;
+};
+
+const char* systemName(System system) {
+    switch (system) {
+    case System::NES: return "nes";
+    case System::GBA: return "gba";
+    case System::GB: return "gb";
+    }
+    return "";
+}
+
+// FNV-1a, as used by the bridges' frame digests
+uint32_t hashBytes(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 0x811C9DC5u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x01000193u;
+    }
+    return hash;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Tap Start now and then so titles get past their attract screens
+bool startHeld(uint32_t frame) {
+    return frame % 240 >= 120 && frame % 240 < 126;
+}
+
+std::string resourcePath;
+
+} // namespace
+
+// Normally implemented in Swift; the overrides file is optional
+extern "C" const char* getBundleResourcePath(void) {
+    return resourcePath.empty() ? nullptr : resourcePath.c_str();
+}
+
+// --- Child side ---
+//
+// Reports to the parent over `report`, one line each:
+//   P <frames>                              progress
+//   R <frames> <load ms> <run ms> <hash>    finished
+//   L                                       the ROM did not load
+
+namespace {
+
+struct NESFrame {
+    const uint16_t* pixels = nullptr;
+    size_t size = 0;
+};
+
+void nesVideo(void* userData, const uint16_t* buffer, size_t size, bool) {
+    NESFrame* frame = static_cast<NESFrame*>(userData);
+    frame->pixels = buffer;
+    frame->size = size;
+}
+
+void gbaVideo(const uint8_t*, int32_t, bool) {}
+void gbaAudio(const uint8_t*, int32_t) {}
+
+// The GB core's frame, valid until the next GB_RunFrame
+struct GBFrame {
+    const uint16_t* pixels = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t pitch = 0;
+} gbFrame;
+
+void gbVideo(const uint16_t* pixels, int32_t width, int32_t height, int32_t pitch, bool) {
+    gbFrame = { pixels, width, height, pitch };
+}
+void gbAudio(const uint8_t*, int32_t) {}
+
+int runChild(FILE* report, System system, const char* romPath, uint32_t frames) {
+    auto loadStart = std::chrono::steady_clock::now();
+
+    NESHandle nes = nullptr;
+    NESFrame nesFrame;
+    static uint8_t gbaVideoBuffer[GBA_WIDTH * GBA_HEIGHT * GBA_BYTES_PER_PIXEL];
+    static uint8_t gbaAudioBuffer[AUDIO_BUFFER_SIZE];
+
+    bool loaded;
+    if (system == System::NES) {
+        nes = NES_Create(&nesFrame);
+        NES_SetVideoCallback(nes, nesVideo);
+        loaded = NES_LoadROM(nes, romPath);
+    } else if (system == System::GBA) {
+        GBASetVideoBuffer(gbaVideoBuffer);
+        GBASetAudioBuffer(gbaAudioBuffer);
+        GBAInitialize(gbaVideo, gbaAudio);
+        loaded = GBALoadGame(romPath);
+    } else {
+        GB_SetAudioBuffer(gbaAudioBuffer);
+        GB_Initialize(gbVideo, gbAudio);
+        loaded = GB_LoadGame(romPath);
+    }
+
+    if (!loaded) {
+        std::fprintf(report, "L\n");
+        std::fflush(report);
+        return 2;
+    }
+
+    const double loadMs = millisecondsSince(loadStart);
+    auto runStart = std::chrono::steady_clock::now();
+
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        if (system == System::NES) {
+            startHeld(frame) ? NES_SetInput(nes, START_BUTTON) : NES_ClearInput(nes, START_BUTTON);
+            NES_RunFrame(nes);
+        } else if (system == System::GBA) {
+            startHeld(frame) ? GBAActivateInput(START_BUTTON) : GBADeactivateInput(START_BUTTON);
+            GBARunFrame(true);
+        } else {
+            startHeld(frame) ? GB_ActivateInput(START_BUTTON) : GB_DeactivateInput(START_BUTTON);
+            GB_RunFrame();
+        }
+
+        if ((frame + 1) % PROGRESS_INTERVAL == 0) {
+            std::fprintf(report, "P %u\n", frame + 1);
+            std::fflush(report);
+        }
+    }
+
+    const double runMs = millisecondsSince(runStart);
+
+    uint32_t hash;
+    if (system == System::NES) {
+        hash = nesFrame.pixels ? hashBytes(nesFrame.pixels, nesFrame.size * sizeof(uint16_t)) : 0;
+    } else if (system == System::GBA) {
+        hash = hashBytes(GBAGetVideoBuffer(), sizeof(gbaVideoBuffer));
+    } else {
+        // Only the visible part of each line, so the core's padding stays out of it
+        std::vector<uint16_t> pixels;
+        for (int32_t y = 0; gbFrame.pixels && y < gbFrame.height; y++) {
+            const uint16_t* line = gbFrame.pixels + size_t(y) * gbFrame.pitch;
+            pixels.insert(pixels.end(), line, line + gbFrame.width);
+        }
+        hash = pixels.empty() ? 0 : hashBytes(pixels.data(), pixels.size() * sizeof(uint16_t));
+    }
+
+    std::fprintf(report, "R %u %.3f %.3f %08x\n", frames, loadMs, runMs, hash);
+    std::fflush(report);
+
+    // The report is flushed; no need to tear the core down
+    std::_Exit(0);
+}
+
+} // namespace
+
+// --- Parent side ---
+
+namespace {
+
+std::string executablePath(const char* argv0) {
+#ifdef __APPLE__
+    char path[4096];
+    uint32_t size = sizeof(path);
+    if (_NSGetExecutablePath(path, &size) == 0) return path;
+#else
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length > 0) return std::string(path, length);
+#endif
+    return argv0;
+}
+
+std::string selfPath;
+
+// Only one child is spawned at a time, so a report pipe is never inherited by another child
+std::mutex spawnMutex;
+
+Result runJob(const Job& job, const Options& options) {
+    Result result;
+    result.path = job.path;
+    result.system = job.system;
+
+    int fds[2];
+    pid_t pid;
+    {
+        std::lock_guard<std::mutex> lock(spawnMutex);
+        if (pipe(fds) != 0) {
+            result.status = "failed";
+            result.detail = "pipe";
+            return result;
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+        const std::string fd = std::to_string(fds[1]);
+        const std::string frames = std::to_string(options.frames);
+        const char* argv[] = { selfPath.c_str(), "--child", fd.c_str(), systemName(job.system),
+                               job.path.c_str(), frames.c_str(), nullptr };
+
+        // The cores log to stdout; keep that out of the report
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+        const int error = posix_spawn(&pid, selfPath.c_str(), &actions, nullptr,
+                                      const_cast<char* const*>(argv), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[1]);
+
+        if (error != 0) {
+            close(fds[0]);
+            result.status = "failed";
+            result.detail = std::strerror(error);
+            return result;
+        }
+    }
+
+    // Frame watchdog: every progress line resets the clock
+    std::string pending;
+    bool finished = false;
+    bool loadFailed = false;
+    bool hung = false;
+
+    while (true) {
+        pollfd poller = { fds[0], POLLIN, 0 };
+        const int ready = poll(&poller, 1, int(options.hangSeconds * 1000));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready == 0) {
+            hung = true;
+            kill(pid, SIGKILL);
+            break;
+        }
+
+        char buffer[256];
+        const ssize_t length = read(fds[0], buffer, sizeof(buffer));
+        if (length <= 0) break;
+        pending.append(buffer, size_t(length));
+
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::istringstream line(pending.substr(0, newline));
+            pending.erase(0, newline + 1);
+
+            char kind = 0;
+            line >> kind;
+            if (kind == 'P') {
+                line >> result.frames;
+            } else if (kind == 'R') {
+                std::string hash;
+                line >> result.frames >> result.loadMs >> result.runMs >> hash;
+                result.frameHash = uint32_t(std::strtoul(hash.c_str(), nullptr, 16));
+                finished = true;
+            } else if (kind == 'L') {
+                loadFailed = true;
+            }
+        }
+    }
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage = {};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+
+#ifdef __APPLE__
+    result.peakKiB = long(usage.ru_maxrss / 1024);   // bytes on Darwin
+#else
+    result.peakKiB = long(usage.ru_maxrss);
+#endif
+
+    if (hung) {
+        result.status = "hung";
+        result.detail = "no progress after frame " + std::to_string(result.frames);
+    } else if (WIFSIGNALED(status)) {
+        result.status = "crashed";
+        result.detail = std::string("signal ") + std::to_string(WTERMSIG(status)) + " (" + strsignal(WTERMSIG(status)) + ")";
+    } else if (loadFailed) {
+        result.status = "load-failed";
+    } else if (finished) {
+        result.status = "ok";
+    } else {
+        result.status = "failed";
+        result.detail = "exit " + std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    }
+    return result;
+}
+
+// One queue per worker; a worker takes from the back of its own and steals from the front of others
+class WorkQueues {
+public:
+    explicit WorkQueues(unsigned workers) : queues(workers) {}
+
+    void push(unsigned worker, const Job& job) {
+        queues[worker].jobs.push_back(job);
+    }
+
+    bool take(unsigned worker, Job& job) {
+        if (popBack(queues[worker], job)) return true;
+
+        for (size_t i = 1; i < queues.size(); i++) {
+            if (popFront(queues[(worker + i) % queues.size()], job)) return true;
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    static bool popBack(Queue& queue, Job& job) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) return false;
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+
+    static bool popFront(Queue& queue, Job& job) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) return false;
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    std::vector<Queue> queues;
+};
+
+std::vector<Job> findRoms(const std::string& directory) {
+    std::vector<Job> jobs;
+    std::error_code error;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (error || !it->is_regular_file(error)) continue;
+
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+        if (extension == ".nes") {
+            jobs.push_back({ it->path().string(), System::NES, it->file_size(error) });
+        } else if (extension == ".gba") {
+            jobs.push_back({ it->path().string(), System::GBA, it->file_size(error) });
+        } else if (extension == ".gb" || extension == ".gbc") {
+            jobs.push_back({ it->path().string(), System::GB, it->file_size(error) });
+        }
+    }
+    return jobs;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += char(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += char(c);
+        }
+    }
+    return out + "\"";
+}
+
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+double framesPerSecond(const Result& result) {
+    return result.runMs > 0 ? result.frames * 1000.0 / result.runMs : 0;
+}
+
+void writeReport(std::ostream& out, const std::vector<Result>& results, bool json) {
+    char hash[9];
+    char number[32];
+
+    if (json) {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            std::snprintf(hash, sizeof(hash), "%08x", r.frameHash);
+            out << "  { \"rom\": " << jsonString(r.path)
+                << ", \"system\": \"" << systemName(r.system) << "\""
+                << ", \"status\": \"" << r.status << "\""
+                << ", \"detail\": " << jsonString(r.detail)
+                << ", \"frames\": " << r.frames;
+            std::snprintf(number, sizeof(number), "%.1f", framesPerSecond(r));
+            out << ", \"fps\": " << number;
+            std::snprintf(number, sizeof(number), "%.1f", r.loadMs);
+            out << ", \"load_ms\": " << number
+                << ", \"frame_hash\": \"" << hash << "\""
+                << ", \"peak_kib\": " << r.peakKiB << " }"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+        return;
+    }
+
+    out << "rom,system,status,detail,frames,fps,load_ms,frame_hash,peak_kib\n";
+    for (const Result& r : results) {
+        std::snprintf(hash, sizeof(hash), "%08x", r.frameHash);
+        out << csvField(r.path) << ',' << systemName(r.system) << ',' << r.status << ','
+            << csvField(r.detail) << ',' << r.frames << ',';
+        std::snprintf(number, sizeof(number), "%.1f,%.1f", framesPerSecond(r), r.loadMs);
+        out << number << ',' << hash << ',' << r.peakKiB << '\n';
+    }
+}
+
+void usage() {
+    std::cerr << "usage: SoolraBatchRunner [--frames N] [--jobs N] [--hang-seconds N]\n"
+                 "                         [--report file.csv|file.json] [--resources dir] <rom directory>\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--frames" && hasValue) {
+            options.frames = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--jobs" && hasValue) {
+            options.jobs = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--hang-seconds" && hasValue) {
+            options.hangSeconds = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--report" && hasValue) {
+            options.reportPath = argv[++i];
+        } else if (arg == "--resources" && hasValue) {
+            options.resourcePath = argv[++i];
+        } else if (arg[0] != '-' && options.romDirectory.empty()) {
+            options.romDirectory = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.romDirectory.empty() && options.frames > 0 && options.hangSeconds > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 6 && std::strcmp(argv[1], "--child") == 0) {
+        FILE* report = fdopen(std::atoi(argv[2]), "w");
+        if (!report) return 1;
+
+        if (const char* resources = std::getenv("SOOLRA_RESOURCES")) {
+            resourcePath = resources;
+        }
+        const System system = std::strcmp(argv[3], "gba") == 0 ? System::GBA
+                            : std::strcmp(argv[3], "gb") == 0  ? System::GB
+                                                               : System::NES;
+        return runChild(report, system, argv[4], uint32_t(std::strtoul(argv[5], nullptr, 10)));
+    }
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+    if (!options.resourcePath.empty()) {
+        setenv("SOOLRA_RESOURCES", options.resourcePath.c_str(), 1);
+    }
+    selfPath = executablePath(argv[0]);
+
+    std::vector<Job> jobs = findRoms(options.romDirectory);
+    if (jobs.empty()) {
+        std::cerr << "[BatchRunner] No .nes, .gba, .gb or .gbc files under " << options.romDirectory << std::endl;
+        return 1;
+    }
+
+    // Largest first, dealt round-robin, so the long runs start early and stealing evens out the tail
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+
+    unsigned workers = options.jobs ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min<unsigned>(workers, unsigned(jobs.size()));
+
+    WorkQueues queues(workers);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        // Each worker pops from its back, so push in reverse to keep the largest first
+        queues.push(unsigned(i % workers), jobs[jobs.size() - 1 - i]);
+    }
+
+    std::cerr << "[BatchRunner] " << jobs.size() << " ROMs, " << options.frames << " frames each, "
+              << workers << " workers" << std::endl;
+
+    std::vector<Result> results;
+    std::mutex resultsMutex;
+    std::atomic<size_t> done(0);
+    const auto sweepStart = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (unsigned worker = 0; worker < workers; worker++) {
+        threads.emplace_back([&, worker] {
+            Job job;
+            while (queues.take(worker, job)) {
+                Result result = runJob(job, options);
+
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                std::fprintf(stderr, "[%zu/%zu] %-8s %6.0f fps  %s\n", ++done, jobs.size(),
+                             result.status.c_str(), framesPerSecond(result), job.path.c_str());
+                results.push_back(std::move(result));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.path < b.path; });
+
+    const bool json = options.reportPath.size() >= 5 &&
+                      options.reportPath.compare(options.reportPath.size() - 5, 5, ".json") == 0;
+    if (options.reportPath.empty()) {
+        writeReport(std::cout, results, json);
+    } else {
+        std::ofstream file(options.reportPath);
+        if (!file.good()) {
+            std::cerr << "[BatchRunner] Error: Failed to create " << options.reportPath << std::endl;
+            return 1;
+        }
+        writeReport(file, results, json);
+    }
+
+    const size_t failures = size_t(std::count_if(results.begin(), results.end(),
+                                                 [](const Result& r) { return r.status != "ok"; }));
+    std::cerr << "[BatchRunner] " << results.size() - failures << " ok, " << failures << " failed in "
+              << millisecondsSince(sweepStart) / 1000.0 << " s" << std::endl;
+    return failures ? 2 : 0;
+}
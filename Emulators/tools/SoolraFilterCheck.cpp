@@ -0,0 +1,257 @@
+//
+//  SOOLRA
+//
+//  Copyright © 2025 SOOLRA. All rights reserved.
+//
+//  Renders fixed frames of a NES game through every scaling filter at 16 and 32 bpp
+//  and writes the raw output to a file. The Makefile builds it twice: against the
+//  normal NES core, and against one built with NST_NO_SIMD and NST_NO_THREADS. The
+//  second build's output is the reference; the first compares against it with
+//  --compare and reports the first differing pixel per filter. `make check` runs both.
+//
+//  Both also check a hash of every filter's frames against regression/filters.golden,
+//  recorded from the filters as they were before the band-parallel and SIMD blits.
+//  --update rewrites that file after an intended change in filter output.
+//
+
+#include "NstBase.hpp"
+#include "NstApiEmulator.hpp"
+#include "NstApiMachine.hpp"
+#include "NstApiVideo.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Nes::Api::Video;
+typedef Video::RenderState RenderState;
+
+constexpr unsigned WARMUP_FRAMES = 150;     // past the power-on screens
+constexpr unsigned SKIPPED_FRAMES = 37;     // between the rendered frames
+constexpr unsigned RENDERED_FRAMES = 3;
+
+struct Config {
+    const char* name;
+    RenderState::Filter filter;
+    unsigned width;
+    unsigned height;
+    int blend;                              // xBR only
+    int cornerRounding;                     // xBR only
+};
+
+const Config CONFIGS[] = {
+    { "ntsc",       RenderState::FILTER_NTSC,    Video::Output::NTSC_WIDTH, Video::Output::HEIGHT, 0, 0 },
+    { "scale2x",    RenderState::FILTER_SCALE2X, Video::Output::WIDTH * 2, Video::Output::HEIGHT * 2, 0, 0 },
+    { "scale3x",    RenderState::FILTER_SCALE3X, Video::Output::WIDTH * 3, Video::Output::HEIGHT * 3, 0, 0 },
+    { "hq2x",       RenderState::FILTER_HQ2X,    Video::Output::WIDTH * 2, Video::Output::HEIGHT * 2, 0, 0 },
+    { "hq3x",       RenderState::FILTER_HQ3X,    Video::Output::WIDTH * 3, Video::Output::HEIGHT * 3, 0, 0 },
+    { "hq4x",       RenderState::FILTER_HQ4X,    Video::Output::WIDTH * 4, Video::Output::HEIGHT * 4, 0, 0 },
+    { "2xsai",      RenderState::FILTER_2XSAI,   Video::Output::WIDTH * 2, Video::Output::HEIGHT * 2, 0, 0 },
+    { "2xbr",       RenderState::FILTER_2XBR,    Video::Output::WIDTH * 2, Video::Output::HEIGHT * 2, 0, 0 },
+    { "2xbr-blend", RenderState::FILTER_2XBR,    Video::Output::WIDTH * 2, Video::Output::HEIGHT * 2, 1, 0 },
+    { "3xbr-blend", RenderState::FILTER_3XBR,    Video::Output::WIDTH * 3, Video::Output::HEIGHT * 3, 1, 1 },
+    { "4xbr",       RenderState::FILTER_4XBR,    Video::Output::WIDTH * 4, Video::Output::HEIGHT * 4, 0, 2 },
+    { "4xbr-blend", RenderState::FILTER_4XBR,    Video::Output::WIDTH * 4, Video::Output::HEIGHT * 4, 1, 2 },
+};
+
+// Frames rendered through one filter at one depth, or empty if the core refused it
+std::vector<uint8_t> renderFrames(const std::string& romPath, const Config& config, unsigned bpp) {
+    Nes::Api::Emulator emulator;
+    Nes::Api::Machine machine(emulator);
+    Video video(emulator);
+
+    std::ifstream rom(romPath, std::ios::binary);
+    if (NES_FAILED(machine.Load(rom, Nes::Api::Machine::FAVORED_NES_NTSC))) return {};
+
+    RenderState state;
+    state.filter = config.filter;
+    state.width = config.width;
+    state.height = config.height;
+    state.bits.count = bpp;
+    state.bits.mask.r = bpp == 32 ? 0xFF0000 : 0xF800;
+    state.bits.mask.g = bpp == 32 ? 0x00FF00 : 0x07E0;
+    state.bits.mask.b = bpp == 32 ? 0x0000FF : 0x001F;
+
+    video.SetBlend(config.blend != 0);
+    video.SetCornerRounding(config.cornerRounding);
+    if (NES_FAILED(video.SetRenderState(state))) return {};
+
+    machine.Power(true);
+    for (unsigned i = 0; i < WARMUP_FRAMES; i++) {
+        emulator.Execute(nullptr, nullptr, nullptr);
+    }
+
+    const size_t pitch = size_t(config.width) * bpp / 8;
+    std::vector<uint8_t> surface(pitch * config.height);
+    std::vector<uint8_t> frames;
+    for (unsigned frame = 0; frame < RENDERED_FRAMES; frame++) {
+        std::fill(surface.begin(), surface.end(), 0);
+        Video::Output output(surface.data(), long(pitch));
+        emulator.Execute(&output, nullptr, nullptr);
+        frames.insert(frames.end(), surface.begin(), surface.end());
+
+        for (unsigned i = 0; i < SKIPPED_FRAMES; i++) {
+            emulator.Execute(nullptr, nullptr, nullptr);
+        }
+    }
+    return frames;
+}
+
+// 64-bit FNV-1a over every byte
+uint64_t hashFrames(const std::vector<uint8_t>& frames) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint8_t byte : frames) {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string hashString(uint64_t hash) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016" PRIx64, hash);
+    return text;
+}
+
+// One "<filter> <bpp> <hash>" line per rendered configuration
+std::map<std::string, std::string> readGolden(const std::string& path) {
+    std::map<std::string, std::string> hashes;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string filter, bpp, hash;
+        if (fields >> filter >> bpp >> hash) hashes[filter + " " + bpp] = hash;
+    }
+    return hashes;
+}
+
+void usage() {
+    std::cerr << "usage: SoolraFilterCheck [--compare reference] [--golden file [--update]] <rom.nes> <output>"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string referencePath;
+    std::string goldenPath;
+    bool update = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            referencePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            goldenPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 2 || (update && goldenPath.empty())) {
+        usage();
+        return 1;
+    }
+
+    std::map<std::string, std::string> golden;
+    if (!goldenPath.empty() && !update) {
+        golden = readGolden(goldenPath);
+        if (golden.empty()) {
+            std::cerr << "[FilterCheck] Error: No hashes in " << goldenPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostringstream updated;
+    updated << "# Filter output hashes for " << paths[0].substr(paths[0].find_last_of('/') + 1)
+            << ", written by SoolraFilterCheck --update\n";
+
+    std::ifstream reference;
+    if (!referencePath.empty()) {
+        reference.open(referencePath, std::ios::binary);
+        if (!reference.good()) {
+            std::cerr << "[FilterCheck] Error: Failed to open " << referencePath << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream out(paths[1], std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+        std::cerr << "[FilterCheck] Error: Failed to create " << paths[1] << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (const Config& config : CONFIGS) {
+        for (unsigned bpp : { 16u, 32u }) {
+            const std::string name = std::string(config.name) + " " + std::to_string(bpp) + " bpp";
+            const std::vector<uint8_t> frames = renderFrames(paths[0], config, bpp);
+            if (frames.empty()) {
+                std::cerr << "[FilterCheck] " << name << ": FAILED, could not render" << std::endl;
+                return 1;
+            }
+            out.write(reinterpret_cast<const char*>(frames.data()), std::streamsize(frames.size()));
+
+            const std::string hash = hashString(hashFrames(frames));
+            const std::string key = std::string(config.name) + " " + std::to_string(bpp);
+            bool passed = true;
+            if (update) {
+                updated << key << " " << hash << "\n";
+            } else if (!goldenPath.empty()) {
+                const auto expected = golden.find(key);
+                if (expected == golden.end() || expected->second != hash) {
+                    std::cerr << "[FilterCheck] " << name << ": FAILED, hash " << hash << " is not the golden "
+                              << (expected == golden.end() ? std::string("(missing)") : expected->second)
+                              << std::endl;
+                    passed = false;
+                }
+            }
+
+            if (!referencePath.empty()) {
+                std::vector<uint8_t> expected(frames.size());
+                reference.read(reinterpret_cast<char*>(expected.data()), std::streamsize(expected.size()));
+                if (size_t(reference.gcount()) != expected.size()) {
+                    std::cerr << "[FilterCheck] " << name << ": FAILED, reference is too short" << std::endl;
+                    return 1;
+                }
+
+                const auto mismatch = std::mismatch(frames.begin(), frames.end(), expected.begin());
+                if (mismatch.first != frames.end()) {
+                    const size_t offset = size_t(mismatch.first - frames.begin());
+                    const size_t pitch = size_t(config.width) * bpp / 8;
+                    const size_t frameSize = pitch * config.height;
+                    const size_t inFrame = offset % frameSize;
+                    std::cerr << "[FilterCheck] " << name << ": FAILED, frame " << offset / frameSize
+                              << " first differs at (" << (inFrame % pitch) / (bpp / 8) << ", " << inFrame / pitch
+                              << ")" << std::endl;
+                    passed = false;
+                }
+            }
+
+            if (!passed) {
+                failures++;
+            } else if (!update && (!goldenPath.empty() || !referencePath.empty())) {
+                std::cerr << "[FilterCheck] " << name << ": ok" << std::endl;
+            }
+        }
+    }
+    if (update) {
+        std::ofstream goldenOut(goldenPath, std::ios::trunc);
+        goldenOut << updated.str();
+        if (!goldenOut.good()) {
+            std::cerr << "[FilterCheck] Error: Failed to write " << goldenPath << std::endl;
+            return 1;
+        }
+        std::cerr << "[FilterCheck] Golden hashes written to " << goldenPath << std::endl;
+    }
+    return failures ? 2 : 0;
+}
@@ -0,0 +1,660 @@
+//
+//  SOOLRA
+//
+//  Copyright © 2025 SOOLRA. All rights reserved.
+//
+//  Golden-trace regression runner for the NES and GBA cores. Every case assembles a
+//  small test ROM, records an input movie for it from a fixed input script, then
+//  replays the movie under a golden trace (see NES_StartDigestTrace and
+//  GBAStartDigestTrace) checked in next to this file. The first frame whose digests
+//  differ is reported with the subsystems that changed. Built and run by
+//
+//      make -C Emulators/tools check
+//
+//  After an intended change in emulation output, rewrite the goldens with
+//
+//      make -C Emulators/tools golden
+//
+//  The GBA case leaves sound off: the core mixes in float, so its audio digest could
+//  differ between compilers that contract multiply-adds differently.
+//
+
+#include "SoolraNESBridge.hpp"
+#include "SoolraGBABridge.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t FRAMES = 600;
+constexpr uint32_t DIGEST_INTERVAL = 10;
+
+const char* const NES_PART_NAMES[NES_DIGEST_PARTS] = {
+    "video", "audio", "cpu", "ram", "ppu", "vram", "oam", "apu", "cart"
+};
+const char* const GBA_PART_NAMES[GBA_DIGEST_PARTS] = {
+    "video", "audio", "cpu", "ram", "vram", "oam", "apu", "io"
+};
+
+// Buttons the input script presses, in each system's own bits
+struct Buttons {
+    int right, down, left, up, a;
+};
+
+constexpr Buttons NES_BUTTONS = { 0x80, 0x20, 0x40, 0x10, 0x01 };
+constexpr Buttons GBA_BUTTONS = { 0x10, 0x80, 0x20, 0x40, 0x01 };
+
+// Walks a square, with a tap of A every 64 frames and a few idle frames between sides
+int scriptedInput(const Buttons& buttons, uint32_t frame) {
+    const int directions[] = { buttons.right, buttons.down, buttons.left, buttons.up };
+    int input = frame % 40 < 34 ? directions[(frame / 40) % 4] : 0;
+    if (frame % 64 < 6) input |= buttons.a;
+    return input;
+}
+
+std::string partList(const char* const* names, int count, uint32_t mask) {
+    std::string list;
+    for (int i = 0; i < count; i++) {
+        if (!(mask & (1u << i))) continue;
+        if (!list.empty()) list += ", ";
+        list += names[i];
+    }
+    return list;
+}
+
+bool writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+    return file.good();
+}
+
+// --- NES test ROM ---
+//
+// NROM-128 with vertical mirroring. Draws a patterned name table that scrolls one
+// pixel per frame, moves a sprite with the d-pad and holds a pulse tone whose pitch
+// follows the sprite while A is down.
+
+class Assembler6502 {
+public:
+    explicit Assembler6502(uint16_t origin) : origin(origin) {}
+
+    uint16_t here() const { return uint16_t(origin + code.size()); }
+    void label(const std::string& name) { labels[name] = here(); }
+
+    void op(uint8_t opcode) { code.push_back(opcode); }
+    void imm(uint8_t opcode, uint8_t value) { code.insert(code.end(), { opcode, value }); }
+    void zp(uint8_t opcode, uint8_t address) { code.insert(code.end(), { opcode, address }); }
+    void abs(uint8_t opcode, uint16_t address) {
+        code.insert(code.end(), { opcode, uint8_t(address), uint8_t(address >> 8) });
+    }
+    void abs(uint8_t opcode, const std::string& target) {
+        absolutes.push_back({ code.size() + 1, target });
+        abs(opcode, uint16_t(0));
+    }
+    void branch(uint8_t opcode, const std::string& target) {
+        branches.push_back({ code.size() + 1, target });
+        imm(opcode, 0);
+    }
+    void data(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); }
+
+    uint16_t address(const std::string& name) const { return labels.at(name); }
+
+    std::vector<uint8_t> finish() const {
+        std::vector<uint8_t> out = code;
+        for (const Fixup& fixup : absolutes) {
+            const uint16_t target = labels.at(fixup.target);
+            out[fixup.offset] = uint8_t(target);
+            out[fixup.offset + 1] = uint8_t(target >> 8);
+        }
+        for (const Fixup& fixup : branches) {
+            const int delta = labels.at(fixup.target) - int(origin + fixup.offset + 1);
+            if (delta < -128 || delta > 127) throw std::runtime_error("branch out of range: " + fixup.target);
+            out[fixup.offset] = uint8_t(delta);
+        }
+        return out;
+    }
+
+private:
+    struct Fixup {
+        size_t offset;
+        std::string target;
+    };
+
+    uint16_t origin;
+    std::vector<uint8_t> code;
+    std::map<std::string, uint16_t> labels;
+    std::vector<Fixup> absolutes;
+    std::vector<Fixup> branches;
+};
+
+std::vector<uint8_t> buildNesRom() {
+    constexpr size_t PRG_SIZE = 0x4000;
+    constexpr size_t CHR_SIZE = 0x2000;
+    constexpr uint8_t BUTTONS = 0x10;   // zero page: this frame's pad, A in bit 7 down to Right in bit 0
+    constexpr uint8_t FRAME = 0x11;     // zero page: frame counter, used as the scroll
+
+    Assembler6502 a(0xC000);
+
+    a.label("reset");
+    a.op(0x78);                         // sei
+    a.op(0xD8);                         // cld
+    a.imm(0xA2, 0xFF);                  // ldx #$ff
+    a.op(0x9A);                         // txs
+    a.imm(0xA9, 0x00);                  // lda #0
+    a.abs(0x8D, 0x2000);                // sta PPUCTRL
+    a.abs(0x8D, 0x2001);                // sta PPUMASK
+    a.zp(0x85, BUTTONS);                // sta BUTTONS
+    a.zp(0x85, FRAME);                  // sta FRAME
+    a.label("vblank1");
+    a.abs(0x2C, 0x2002);                // bit PPUSTATUS
+    a.branch(0x10, "vblank1");          // bpl vblank1
+    a.label("vblank2");
+    a.abs(0x2C, 0x2002);
+    a.branch(0x10, "vblank2");
+
+    a.imm(0xA9, 0x3F);                  // PPUADDR = $3f00
+    a.abs(0x8D, 0x2006);
+    a.imm(0xA9, 0x00);
+    a.abs(0x8D, 0x2006);
+    a.imm(0xA2, 0x00);                  // ldx #0
+    a.label("palette");
+    a.abs(0xBD, "paletteTable");        // lda paletteTable,x
+    a.abs(0x8D, 0x2007);                // sta PPUDATA
+    a.op(0xE8);                         // inx
+    a.imm(0xE0, 0x20);                  // cpx #32
+    a.branch(0xD0, "palette");          // bne palette
+
+    a.imm(0xA9, 0x20);                  // PPUADDR = $2000
+    a.abs(0x8D, 0x2006);
+    a.imm(0xA9, 0x00);
+    a.abs(0x8D, 0x2006);
+    a.imm(0xA0, 0x04);                  // ldy #4: four pages, attributes included
+    a.imm(0xA2, 0x00);
+    a.label("fill");
+    a.op(0x8A);                         // txa
+    a.imm(0x29, 0x03);                  // and #3
+    a.abs(0x8D, 0x2007);
+    a.op(0xE8);
+    a.branch(0xD0, "fill");
+    a.op(0x88);                         // dey
+    a.branch(0xD0, "fill");
+
+    a.imm(0xA9, 0xFF);                  // park every sprite below the screen
+    a.imm(0xA2, 0x00);
+    a.label("hide");
+    a.abs(0x9D, 0x0200);                // sta $0200,x
+    a.op(0xE8);
+    a.branch(0xD0, "hide");
+    a.imm(0xA9, 0x70);                  // sprite 0: y, tile, attributes, x
+    a.abs(0x8D, 0x0200);
+    a.imm(0xA9, 0x01);
+    a.abs(0x8D, 0x0201);
+    a.imm(0xA9, 0x00);
+    a.abs(0x8D, 0x0202);
+    a.imm(0xA9, 0x78);
+    a.abs(0x8D, 0x0203);
+
+    a.imm(0xA9, 0x01);                  // pulse 1 on: 50% duty, constant volume, no sweep
+    a.abs(0x8D, 0x4015);
+    a.imm(0xA9, 0xBF);
+    a.abs(0x8D, 0x4000);
+    a.imm(0xA9, 0x08);
+    a.abs(0x8D, 0x4001);
+    a.imm(0xA9, 0xC9);
+    a.abs(0x8D, 0x4002);
+    a.imm(0xA9, 0x00);
+    a.abs(0x8D, 0x4003);
+
+    a.imm(0xA9, 0x80);                  // NMI on, then rendering on
+    a.abs(0x8D, 0x2000);
+    a.imm(0xA9, 0x1E);
+    a.abs(0x8D, 0x2001);
+    a.label("idle");
+    a.abs(0x4C, "idle");                // jmp idle
+
+    a.label("nmi");
+    a.imm(0xA9, 0x00);                  // OAM DMA from page 2
+    a.abs(0x8D, 0x2003);
+    a.imm(0xA9, 0x02);
+    a.abs(0x8D, 0x4014);
+    a.imm(0xA9, 0x01);                  // strobe and read pad 1
+    a.abs(0x8D, 0x4016);
+    a.imm(0xA9, 0x00);
+    a.abs(0x8D, 0x4016);
+    a.imm(0xA2, 0x08);
+    a.label("read");
+    a.abs(0xAD, 0x4016);                // lda $4016
+    a.op(0x4A);                         // lsr a
+    a.zp(0x26, BUTTONS);                // rol BUTTONS
+    a.op(0xCA);                         // dex
+    a.branch(0xD0, "read");
+
+    const struct {
+        uint8_t mask;
+        uint8_t opcode;                 // inc or dec
+        uint16_t address;               // sprite x or y
+        const char* skip;
+    } moves[] = {
+        { 0x01, 0xEE, 0x0203, "noRight" },
+        { 0x02, 0xCE, 0x0203, "noLeft" },
+        { 0x04, 0xEE, 0x0200, "noDown" },
+        { 0x08, 0xCE, 0x0200, "noUp" },
+    };
+    for (const auto& move : moves) {
+        a.zp(0xA5, BUTTONS);            // lda BUTTONS
+        a.imm(0x29, move.mask);         // and #mask
+        a.branch(0xF0, move.skip);      // beq skip
+        a.abs(move.opcode, move.address);
+        a.label(move.skip);
+    }
+    a.zp(0xA5, BUTTONS);                // A held: pitch follows sprite x
+    a.imm(0x29, 0x80);
+    a.branch(0xF0, "noA");
+    a.abs(0xAD, 0x0203);
+    a.abs(0x8D, 0x4002);
+    a.label("noA");
+
+    a.zp(0xE6, FRAME);                  // inc FRAME
+    a.zp(0xA5, FRAME);                  // PPUSCROLL = FRAME, 0
+    a.abs(0x8D, 0x2005);
+    a.imm(0xA9, 0x00);
+    a.abs(0x8D, 0x2005);
+    a.imm(0xA9, 0x80);
+    a.abs(0x8D, 0x2000);
+    a.label("irq");
+    a.op(0x40);                         // rti
+
+    a.label("paletteTable");
+    a.data({ 0x0F, 0x11, 0x21, 0x30, 0x0F, 0x16, 0x26, 0x36, 0x0F, 0x1A, 0x2A, 0x3A, 0x0F, 0x13, 0x23, 0x33,
+             0x0F, 0x30, 0x27, 0x17, 0x0F, 0x30, 0x27, 0x17, 0x0F, 0x30, 0x27, 0x17, 0x0F, 0x30, 0x27, 0x17 });
+
+    const std::vector<uint8_t> code = a.finish();
+    if (code.size() > PRG_SIZE - 6) throw std::runtime_error("NES test program does not fit");
+
+    std::vector<uint8_t> rom = { 'N', 'E', 'S', 0x1A, 1, 1, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    std::vector<uint8_t> prg(PRG_SIZE, 0xFF);
+    std::copy(code.begin(), code.end(), prg.begin());
+    const uint16_t vectors[] = { a.address("nmi"), a.address("reset"), a.address("irq") };
+    for (int i = 0; i < 3; i++) {
+        prg[PRG_SIZE - 6 + i * 2] = uint8_t(vectors[i]);
+        prg[PRG_SIZE - 5 + i * 2] = uint8_t(vectors[i] >> 8);
+    }
+
+    // Tiles: 0 blank, 1 solid, 2 checkerboard, 3 stripes
+    std::vector<uint8_t> chr(CHR_SIZE, 0);
+    for (int row = 0; row < 8; row++) {
+        chr[16 * 1 + row] = 0xFF;
+        chr[16 * 2 + row] = row & 1 ? 0x55 : 0xAA;
+        chr[16 * 2 + 8 + row] = 0xFF;
+        chr[16 * 3 + 8 + row] = row & 2 ? 0xFF : 0x00;
+    }
+
+    rom.insert(rom.end(), prg.begin(), prg.end());
+    rom.insert(rom.end(), chr.begin(), chr.end());
+    return rom;
+}
+
+// --- GBA test ROM ---
+//
+// ARM code in mode 3 with objects on. Once per frame it polls for VCOUNT 160, moves
+// object 0 with the d-pad, plots the frame counter as a pixel under it (A speeds the
+// colour up) and stores its state to internal and work RAM.
+
+constexpr uint32_t COND_EQ = 0x0;
+constexpr uint32_t COND_NE = 0x1;
+constexpr uint32_t COND_AL = 0xE;
+
+enum ArmOp : uint32_t { AND = 0x0, SUB = 0x2, ADD = 0x4, TST = 0x8, CMP = 0xA, ORR = 0xC, MOV = 0xD };
+
+// value as an 8-bit immediate rotated right by an even amount
+uint32_t armImmediate(uint32_t value) {
+    for (uint32_t rotate = 0; rotate < 16; rotate++) {
+        const uint32_t shift = rotate * 2;
+        const uint32_t unrotated = shift ? (value << shift) | (value >> (32 - shift)) : value;
+        if (unrotated < 0x100) return rotate << 8 | unrotated;
+    }
+    throw std::runtime_error("ARM immediate out of range");
+}
+
+class AssemblerArm {
+public:
+    uint32_t here() const { return uint32_t(code.size() * 4); }
+    void label(const std::string& name) { labels[name] = here(); }
+
+    void dataImm(ArmOp op, int rd, int rn, uint32_t value, uint32_t cond = COND_AL) {
+        const bool setFlags = op == TST || op == CMP;
+        emit(cond << 28 | 1u << 25 | uint32_t(op) << 21 | uint32_t(setFlags) << 20 | rn << 16 | rd << 12 |
+             armImmediate(value));
+    }
+    // rd = rn op (rm << shift)
+    void dataReg(ArmOp op, int rd, int rn, int rm, int shift = 0) {
+        emit(COND_AL << 28 | uint32_t(op) << 21 | rn << 16 | rd << 12 | shift << 7 | rm);
+    }
+    void subs(int rd, int rn, uint32_t value) {
+        emit(COND_AL << 28 | 1u << 25 | uint32_t(SUB) << 21 | 1u << 20 | rn << 16 | rd << 12 | armImmediate(value));
+    }
+    // Builds any constant a byte at a time
+    void loadConstant(int rd, uint32_t value) {
+        bool first = true;
+        for (int shift = 0; shift < 32; shift += 8) {
+            const uint32_t part = value & (0xFFu << shift);
+            if (!part) continue;
+            first ? dataImm(MOV, rd, 0, part) : dataImm(ORR, rd, rd, part);
+            first = false;
+        }
+        if (first) dataImm(MOV, rd, 0, 0);
+    }
+    void ldrh(int rd, int rn, uint32_t offset) { halfword(true, rd, rn, offset); }
+    void strh(int rd, int rn, uint32_t offset) { halfword(false, rd, rn, offset); }
+    // strh rd, [rn, rm]
+    void strhIndexed(int rd, int rn, int rm) {
+        emit(COND_AL << 28 | 1u << 24 | 1u << 23 | rn << 16 | rd << 12 | 0xB0 | rm);
+    }
+    void str(int rd, int rn, uint32_t offset) {
+        if (offset > 0xFFF) throw std::runtime_error("ARM word offset out of range");
+        emit(COND_AL << 28 | 1u << 26 | 1u << 24 | 1u << 23 | rn << 16 | rd << 12 | offset);
+    }
+    // str rd, [rn], #offset
+    void strPostIndexed(int rd, int rn, uint32_t offset) {
+        emit(COND_AL << 28 | 1u << 26 | 1u << 23 | rn << 16 | rd << 12 | offset);
+    }
+    void branch(const std::string& target, uint32_t cond = COND_AL) {
+        branches.push_back({ code.size(), target });
+        emit(cond << 28 | 0xAu << 24);
+    }
+
+    uint32_t address(const std::string& name) const { return labels.at(name); }
+
+    std::vector<uint32_t> finish() const {
+        std::vector<uint32_t> out = code;
+        for (const Fixup& fixup : branches) {
+            const int32_t delta = (int32_t(labels.at(fixup.target)) - int32_t(fixup.index * 4 + 8)) >> 2;
+            out[fixup.index] |= uint32_t(delta) & 0xFFFFFF;
+        }
+        return out;
+    }
+
+private:
+    struct Fixup {
+        size_t index;
+        std::string target;
+    };
+
+    void emit(uint32_t word) { code.push_back(word); }
+    void halfword(bool load, int rd, int rn, uint32_t offset) {
+        if (offset > 0xFF) throw std::runtime_error("ARM halfword offset out of range");
+        emit(COND_AL << 28 | 1u << 24 | 1u << 23 | 1u << 22 | uint32_t(load) << 20 | rn << 16 | rd << 12 |
+             (offset >> 4) << 8 | 0xB0 | (offset & 0xF));
+    }
+
+    std::vector<uint32_t> code;
+    std::map<std::string, uint32_t> labels;
+    std::vector<Fixup> branches;
+};
+
+std::vector<uint8_t> buildGbaRom() {
+    constexpr uint32_t HEADER_SIZE = 0xC0;
+    constexpr uint32_t ROM_SIZE = 0x1000;
+    enum { IO = 0, TMP = 1, PTR = 2, COUNT = 3, X = 4, Y = 5, FRAME = 6, VRAM = 7, OAM = 8, IWRAM = 9, EWRAM = 10 };
+
+    AssemblerArm a;
+    a.branch("start");                  // entry point, over the header
+    while (a.here() < HEADER_SIZE) a.dataImm(MOV, 0, 0, 0);
+
+    a.label("start");
+    a.loadConstant(IO, 0x04000000);
+    a.loadConstant(TMP, 0x1443);        // mode 3, BG2, objects, 1D object tiles
+    a.strh(TMP, IO, 0x00);
+    a.loadConstant(PTR, 0x05000200);    // object palette colour 1: white
+    a.loadConstant(TMP, 0x7FFF);
+    a.strh(TMP, PTR, 2);
+    a.loadConstant(PTR, 0x06014000);    // object tile 512, solid colour 1
+    a.loadConstant(TMP, 0x11111111);
+    a.dataImm(MOV, COUNT, 0, 8);
+    a.label("tile");
+    a.strPostIndexed(TMP, PTR, 4);
+    a.subs(COUNT, COUNT, 1);
+    a.branch("tile", COND_NE);
+
+    a.dataImm(MOV, X, 0, 60);
+    a.dataImm(MOV, Y, 0, 40);
+    a.dataImm(MOV, FRAME, 0, 0);
+    a.loadConstant(VRAM, 0x06000000);
+    a.loadConstant(OAM, 0x07000000);
+    a.loadConstant(IWRAM, 0x03000000);
+    a.loadConstant(EWRAM, 0x02000000);
+
+    a.label("frame");
+    a.label("leaveVblank");             // wait for the start of the next VBlank
+    a.ldrh(TMP, IO, 0x06);
+    a.dataImm(CMP, 0, TMP, 160);
+    a.branch("leaveVblank", COND_EQ);
+    a.label("enterVblank");
+    a.ldrh(TMP, IO, 0x06);
+    a.dataImm(CMP, 0, TMP, 160);
+    a.branch("enterVblank", COND_NE);
+
+    a.dataImm(ADD, PTR, IO, 0x100);     // KEYINPUT, pressed keys read as 0
+    a.ldrh(TMP, PTR, 0x30);
+    a.dataImm(TST, 0, TMP, 0x10);
+    a.dataImm(ADD, X, X, 1, COND_EQ);
+    a.dataImm(TST, 0, TMP, 0x20);
+    a.dataImm(SUB, X, X, 1, COND_EQ);
+    a.dataImm(TST, 0, TMP, 0x40);
+    a.dataImm(SUB, Y, Y, 1, COND_EQ);
+    a.dataImm(TST, 0, TMP, 0x80);
+    a.dataImm(ADD, Y, Y, 1, COND_EQ);
+    a.dataImm(TST, 0, TMP, 0x01);
+    a.dataImm(ADD, FRAME, FRAME, 0x20, COND_EQ);
+    a.dataImm(AND, X, X, 0x7F);
+    a.dataImm(AND, Y, Y, 0x7F);
+    a.dataImm(ADD, FRAME, FRAME, 1);
+
+    a.strh(Y, OAM, 0);                  // object 0: 8x8 at (X, Y), tile 512
+    a.strh(X, OAM, 2);
+    a.loadConstant(TMP, 512);
+    a.strh(TMP, OAM, 4);
+
+    a.dataReg(MOV, PTR, 0, Y, 8);       // PTR = (Y * 240 + X) * 2
+    a.dataReg(SUB, PTR, PTR, Y, 4);
+    a.dataReg(ADD, PTR, PTR, X);
+    a.dataReg(ADD, PTR, PTR, PTR);
+    a.strhIndexed(FRAME, VRAM, PTR);
+
+    a.str(FRAME, IWRAM, 0);
+    a.str(X, EWRAM, 0);
+    a.str(Y, EWRAM, 4);
+    a.branch("frame");
+
+    std::vector<uint8_t> rom(ROM_SIZE, 0);
+    const std::vector<uint32_t> code = a.finish();
+    if (code.size() * 4 > ROM_SIZE) throw std::runtime_error("GBA test program does not fit");
+    for (size_t i = 0; i < code.size(); i++) {
+        for (int byte = 0; byte < 4; byte++) {
+            rom[i * 4 + byte] = uint8_t(code[i] >> (byte * 8));
+        }
+    }
+
+    // Header fields past the branch; the Nintendo logo is only checked by the BIOS
+    std::memcpy(&rom[0xA0], "SOOLRA TEST", 11);
+    std::memcpy(&rom[0xAC], "ZSRT00", 6);
+    rom[0xB2] = 0x96;
+    uint8_t check = 0;
+    for (int i = 0xA0; i < 0xBD; i++) check -= rom[i];
+    rom[0xBD] = uint8_t(check - 0x19);
+    return rom;
+}
+
+// --- Runs ---
+
+struct Paths {
+    std::filesystem::path rom;
+    std::filesystem::path movie;
+    std::filesystem::path golden;
+};
+
+bool reportTrace(const char* name, bool diverged, uint32_t frame, const std::string& parts) {
+    if (diverged && parts.empty()) {
+        // No part differs, so the run and the golden disagree on how many frames there are
+        std::cerr << "[Regression] " << name << ": FAILED, frame count differs from the golden at frame " << frame
+                  << std::endl;
+        return false;
+    }
+    if (diverged) {
+        std::cerr << "[Regression] " << name << ": FAILED, first differs at frame " << frame << " in " << parts
+                  << std::endl;
+        return false;
+    }
+    std::cerr << "[Regression] " << name << ": ok" << std::endl;
+    return true;
+}
+
+bool runNes(const char* name, const Paths& paths, bool update) {
+    if (!writeFile(paths.rom, buildNesRom())) return false;
+
+    NESHandle nes = NES_Create(nullptr);
+    bool ok = NES_LoadROM(nes, paths.rom.c_str()) && NES_StartMovieRecording(nes, paths.movie.c_str());
+    for (uint32_t frame = 0; ok && frame < FRAMES; frame++) {
+        NES_ResetInputs(nes);
+        NES_SetInput(nes, scriptedInput(NES_BUTTONS, frame));
+        NES_RunFrame(nes);
+    }
+    NES_Destroy(nes);
+
+    // A fresh console for playback, as the app would have
+    nes = NES_Create(nullptr);
+    ok = ok && NES_LoadROM(nes, paths.rom.c_str()) && NES_StartMoviePlayback(nes, paths.movie.c_str()) &&
+         NES_StartDigestTrace(nes, paths.golden.c_str(), DIGEST_INTERVAL, !update);
+    if (!ok) {
+        std::cerr << "[Regression] " << name << ": could not set up the run"
+                  << (update ? "" : " (is the golden trace missing?)") << std::endl;
+        NES_Destroy(nes);
+        return false;
+    }
+
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        NES_RunFrame(nes);
+    }
+
+    uint32_t frame = 0;
+    uint32_t mask = 0;
+    const bool diverged = NES_GetDigestDivergence(nes, &frame, &mask);
+    NES_Destroy(nes);
+    return reportTrace(name, diverged, frame, partList(NES_PART_NAMES, NES_DIGEST_PARTS, mask));
+}
+
+void gbaVideo(const uint8_t*, int32_t, bool) {}
+void gbaAudio(const uint8_t*, int32_t) {}
+
+bool runGba(const char* name, const Paths& paths, bool update) {
+    static uint8_t videoBuffer[GBA_WIDTH * GBA_HEIGHT * GBA_BYTES_PER_PIXEL];
+    static uint8_t audioBuffer[AUDIO_BUFFER_SIZE];
+
+    if (!writeFile(paths.rom, buildGbaRom())) return false;
+
+    GBASetVideoBuffer(videoBuffer);
+    GBASetAudioBuffer(audioBuffer);
+    GBAInitialize(gbaVideo, gbaAudio);
+
+    bool ok = GBALoadGame(paths.rom.c_str()) && GBAStartMovieRecording(paths.movie.c_str());
+    for (uint32_t frame = 0; ok && frame < FRAMES; frame++) {
+        GBAResetInputs();
+        GBAActivateInput(scriptedInput(GBA_BUTTONS, frame));
+        GBARunFrame(true);
+    }
+    GBAStopMovie();
+    GBAShutdown();
+    GBAResetInputs();
+
+    ok = ok && GBALoadGame(paths.rom.c_str()) && GBAStartMoviePlayback(paths.movie.c_str()) &&
+         GBAStartDigestTrace(paths.golden.c_str(), DIGEST_INTERVAL, !update);
+    if (!ok) {
+        std::cerr << "[Regression] " << name << ": could not set up the run"
+                  << (update ? "" : " (is the golden trace missing?)") << std::endl;
+        GBAShutdown();
+        return false;
+    }
+
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        GBARunFrame(true);
+    }
+
+    uint32_t frame = 0;
+    uint32_t mask = 0;
+    const bool diverged = GBAGetDigestDivergence(&frame, &mask);
+    GBAShutdown();
+    return reportTrace(name, diverged, frame, partList(GBA_PART_NAMES, GBA_DIGEST_PARTS, mask));
+}
+
+struct Case {
+    const char* name;
+    const char* romExtension;
+    bool (*run)(const char* name, const Paths& paths, bool update);
+};
+
+const Case CASES[] = {
+    { "nes-sprite", ".nes", runNes },
+    { "gba-sprite", ".gba", runGba },
+};
+
+void usage() {
+    std::cerr << "usage: SoolraRegression [--update] [--work dir] <golden directory>" << std::endl;
+}
+
+} // namespace
+
+// Normally implemented in Swift; no overrides are needed for the test ROMs
+extern "C" const char* getBundleResourcePath(void) {
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    bool update = false;
+    std::filesystem::path goldenDirectory;
+    std::filesystem::path workDirectory = std::filesystem::temp_directory_path() / "soolra-regression";
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--update") {
+            update = true;
+        } else if (arg == "--work" && i + 1 < argc) {
+            workDirectory = argv[++i];
+        } else if (arg[0] != '-' && goldenDirectory.empty()) {
+            goldenDirectory = arg;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (goldenDirectory.empty()) {
+        usage();
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(workDirectory, error);
+    if (update) std::filesystem::create_directories(goldenDirectory, error);
+
+    int failures = 0;
+    for (const Case& test : CASES) {
+        const Paths paths = {
+            workDirectory / (std::string(test.name) + test.romExtension),
+            workDirectory / (std::string(test.name) + ".movie"),
+            goldenDirectory / (std::string(test.name) + ".trace"),
+        };
+        if (!test.run(test.name, paths, update)) failures++;
+    }
+
+    if (update) {
+        std::cerr << "[Regression] Golden traces written to " << goldenDirectory.string() << std::endl;
+    }
+    return failures ? 2 : 0;
+}
@@ -12,7 +12,7 @@ class GBAAudioMaker: NSObject, AudioMakerProtocol {
     private var audioEngine: AVAudioEngine
     private var audioPlayerNode: AVAudioPlayerNode
     private var audioFormat: AVAudioFormat
-    private var audioConverter: AVAudioConverter?
+    private let bufferPool: AudioBufferPool
     private weak var bridge: GBABridge?
     private var isEngineRunning = false
     private var pendingBuffers: [AVAudioPCMBuffer] = []
@@ -30,7 +30,8 @@ class GBAAudioMaker: NSObject, AudioMakerProtocol {
         }
         
         self.bridge = bridge
-        audioFormat = AVAudioFormat(commonFormat: .pcmFormatFloat32, sampleRate: 44100, channels: 2, interleaved: false)! // Supported format
+        audioFormat = bridge.audioFormat  // Planar float32, written directly by the core
+        bufferPool = AudioBufferPool(format: audioFormat)
         
         super.init()
         
@@ -53,13 +54,6 @@ class GBAAudioMaker: NSObject, AudioMakerProtocol {
         audioEngine.connect(audioPlayerNode, to: timePitch, format: audioFormat)
         audioEngine.connect(timePitch, to: audioEngine.mainMixerNode, format: audioFormat)
 
-        // Setup audio converter
-        if let inputFormat = bridge?.audioFormat {
-            audioConverter = AVAudioConverter(from: inputFormat, to: audioFormat)
-        } else {
-            print("❌ Error: GBABridge audioFormat is nil, cannot create audio converter.")
-        }
-
         // Start the engine
         startEngine()
     }
@@ -90,7 +84,9 @@ class GBAAudioMaker: NSObject, AudioMakerProtocol {
         guard isEngineRunning else { return }
         
         for buffer in pendingBuffers {
-            audioPlayerNode.scheduleBuffer(buffer, completionHandler: nil)
+            audioPlayerNode.scheduleBuffer(buffer) { [bufferPool] in
+                bufferPool.recycle(buffer)
+            }
         }
         pendingBuffers.removeAll()
         
@@ -99,41 +95,20 @@ class GBAAudioMaker: NSObject, AudioMakerProtocol {
         }
     }
     
-    func queueBuffer(_ buffer: UnsafePointer<UInt16>, size: Int) {
-        guard size > 0 else { return }
-        
-        // Create input buffer from raw data
-        let samplesPerFrame = size / 4  // 4 bytes per frame (2 channels * 2 bytes per sample)
-        guard let inputFormat = AVAudioFormat(commonFormat: .pcmFormatInt16, sampleRate: 44100, channels: 2, interleaved: true),
-              let inputBuffer = AVAudioPCMBuffer(pcmFormat: inputFormat, frameCapacity: AVAudioFrameCount(samplesPerFrame)) else {
-            print("Failed to create input buffer")
-            return
-        }
+    func queueBuffer(_ planes: UnsafePointer<Float>, frameCount: Int) {
+        guard frameCount > 0 else { return }
         
-        inputBuffer.frameLength = inputBuffer.frameCapacity
-        memcpy(inputBuffer.int16ChannelData?[0], buffer, size)
-        
-        // Convert to supported format
-        guard let outputBuffer = AVAudioPCMBuffer(pcmFormat: audioFormat, frameCapacity: inputBuffer.frameCapacity) else {
+        guard let outputBuffer = bufferPool.buffer(copying: planes, frameCount: frameCount) else {
             print("Failed to create output buffer")
             return
         }
         
-        var error: NSError?
-        let status = audioConverter?.convert(to: outputBuffer, error: &error) { inNumPackets, outStatus in
-            outStatus.pointee = .haveData
-            return inputBuffer
-        }
-        
-        if status == .error {
-            print("Audio conversion failed: \(error?.localizedDescription ?? "Unknown error")")
-            return
-        }
-        
         pendingBufferLock.lock()
         if isEngineRunning {
             // If engine is running, schedule immediately
-            audioPlayerNode.scheduleBuffer(outputBuffer, completionHandler: nil)
+            audioPlayerNode.scheduleBuffer(outputBuffer) { [bufferPool] in
+                bufferPool.recycle(outputBuffer)
+            }
             if !audioPlayerNode.isPlaying {
                 audioPlayerNode.play()
             }
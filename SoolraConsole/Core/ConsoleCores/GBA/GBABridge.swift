@@ -39,7 +39,7 @@ enum GBAButton: UInt32 {
 // MARK: - GBA Bridge
 class GBABridge: NSObject {
     public static var shared: GBABridge!
-    public let audioFormat = AVAudioFormat(commonFormat: .pcmFormatInt16, sampleRate: 44100, channels: 2, interleaved: true)!
+    public let audioFormat = AVAudioFormat(commonFormat: .pcmFormatFloat32, sampleRate: 44100, channels: 2, interleaved: false)!
     
     // Video properties
     public let screenWidth: Int = 240
@@ -51,7 +51,7 @@ class GBABridge: NSObject {
     private var audioBufferSize: Int
     
     private var _videoBuffer: UnsafeMutablePointer<UInt16>?
-    private var _audioBuffer: UnsafeMutablePointer<UInt16>?
+    private var _audioBuffer: UnsafeMutablePointer<Float>?
     
     // Audio processing properties
     private let frameDuration: TimeInterval = 1.0 / 60.0
@@ -61,7 +61,7 @@ class GBABridge: NSObject {
         return _videoBuffer
     }
     
-    public var audioBufferPublic: UnsafeMutablePointer<UInt16>? {
+    public var audioBufferPublic: UnsafeMutablePointer<Float>? {
         return _audioBuffer
     }
     
@@ -70,7 +70,11 @@ class GBABridge: NSObject {
     public private(set) var audioFrameLength: UInt32 = 0
     
     // Video callback
-    private let videoCallback: @convention(c) (UnsafePointer<UInt8>?, Int32) -> Void = { buffer, size in
+    private let videoCallback: @convention(c) (UnsafePointer<UInt8>?, Int32, Bool) -> Void = { buffer, size, unchanged in
+        // Identical to the previous frame, which is still in our buffer
+        if unchanged {
+            return
+        }
         guard let videoBuffer = GBABridge.shared?.videoBufferPublic,
               let sourceBuffer = buffer else {
             print("⚠️ Video buffer not available")
@@ -95,16 +99,16 @@ class GBABridge: NSObject {
         
         // Calculate buffer size with some headroom
         let bufferAudioBufferCount = 10  // Provide enough headroom
-        let preferredBufferSize = inputAudioBufferFrameCount * Int(audioFormat.channelCount) * 2 * bufferAudioBufferCount
+        let preferredBufferSize = inputAudioBufferFrameCount * Int(audioFormat.channelCount) * bufferAudioBufferCount
         
         print("🎵 Allocating audio buffer:")
         print("  - Sample rate: \(audioFormat.sampleRate)Hz")
         print("  - Channels: \(audioFormat.channelCount)")
         print("  - Frame count: \(inputAudioBufferFrameCount)")
-        print("  - Buffer size: \(preferredBufferSize) bytes")
+        print("  - Buffer size: \(preferredBufferSize) samples")
         
         // Allocate the audio buffer
-        _audioBuffer = UnsafeMutablePointer<UInt16>.allocate(capacity: preferredBufferSize)
+        _audioBuffer = UnsafeMutablePointer<Float>.allocate(capacity: preferredBufferSize)
         audioBufferSize = preferredBufferSize
         
         print("✅ Audio buffer allocated successfully")
@@ -136,6 +140,14 @@ class GBABridge: NSObject {
         GBASetVideoBuffer(_videoBuffer!)
         GBASetAudioBuffer(_audioBuffer!)
         
+        // Let the core keep per-ROM detection results across launches
+        if let cachesURL = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first {
+            cachesURL.withUnsafeFileSystemRepresentation { path in
+                guard let path = path else { return }
+                GBASetCacheDirectory(path)
+            }
+        }
+        
         // Initialize the emulator
         GBAInitialize(videoCallback, audioCallback)
         
@@ -242,6 +254,13 @@ class GBABridge: NSObject {
 
     }
     
+    func setAutosavePath(to url: URL)
+    {
+        if let path = url.path.cString(using: .utf8) {
+            GBASetBatterySavePath(path)
+        }
+    }
+    
 }
 
 
@@ -167,6 +167,8 @@ class GBACore: ConsoleCore {
         // Start the bridge with new ROM
         bridge?.start(withGameURL: romPath)
         self.loadAutoSave()
+        // Later writes to save memory reach the autosave in the background
+        bridge?.setAutosavePath(to: autosavePath)
         
         // Start audio playback if available
         _audioMaker?.play()
@@ -195,10 +197,9 @@ class GBACore: ConsoleCore {
         if let audioBuffer = bridge?.audioBufferPublic {
             let samplesPerFrame = Int(bridge?.audioFrameLength ?? 0)
             if samplesPerFrame > 0 {
-                let audioSize = samplesPerFrame * 4  // 2 bytes per sample * 2 channels
                 if (!firstFrame) {
                     // hack to skip the 'click' in the first frame
-                    audioMaker?.queueBuffer(audioBuffer, size: audioSize)
+                    audioMaker?.queueBuffer(audioBuffer, frameCount: samplesPerFrame)
                 }
             }
         }
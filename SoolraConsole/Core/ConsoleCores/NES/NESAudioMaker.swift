@@ -16,9 +16,8 @@ public class NESAudioMaker : AudioMakerProtocol {
         private let sampleRate: Int
         private let frameRate: Int
         private let samplesPerFrame: Int
-        private let audioConverter: AVAudioConverter?
-        private let inputFormat: AVAudioFormat
         private let format: AVAudioFormat
+        private let bufferPool: AudioBufferPool
         private var timePitchNode: AVAudioUnitTimePitch?
         private var currentRate: Float = 1.0
     
@@ -45,32 +44,19 @@ public class NESAudioMaker : AudioMakerProtocol {
             self.frameRate = frameRate
             self.samplesPerFrame = sampleRate / frameRate
             
-            // Create input format (mono, 16-bit integer)
-            guard let inputAudioFormat = AVAudioFormat(commonFormat: .pcmFormatInt16,
-                                                     sampleRate: Double(sampleRate),
-                                                     channels: 1,
-                                                     interleaved: true) else {
-                fatalError("Failed to create input audio format")
-            }
-            self.inputFormat = inputAudioFormat
-            
-            // Create output format (mono, 32-bit float)
+            // Create output format (mono, 32-bit float), which the core renders directly
             guard let audioFormat = AVAudioFormat(standardFormatWithSampleRate: Double(sampleRate),
                                                 channels: 1) else {
                 fatalError("Failed to create audio format")
             }
             self.format = audioFormat
+            self.bufferPool = AudioBufferPool(format: audioFormat)
             
             // Initialize audio components
             self.ae = AVAudioEngine()
             self.player = AVAudioPlayerNode()
             self.mainMixer = AVAudioMixerNode()
             
-            // Create converter
-            self.audioConverter = AVAudioConverter(from: inputFormat, to: format)
-            
-       
-            
             setupAudio()
         }
         
@@ -124,7 +110,9 @@ public class NESAudioMaker : AudioMakerProtocol {
             guard isEngineRunning else { return }
             
             for buffer in pendingBuffers {
-                player.scheduleBuffer(buffer, completionHandler: nil)
+                player.scheduleBuffer(buffer) { [bufferPool] in
+                    bufferPool.recycle(buffer)
+                }
             }
             pendingBuffers.removeAll()
             
@@ -167,49 +155,20 @@ public class NESAudioMaker : AudioMakerProtocol {
             setupAudio()
         }
         
-        public func queueBuffer(_ buffer: UnsafePointer<UInt16>, size: Int) {
-            guard size > 0 else { return }
-            
-            // Create input buffer
-            guard let inputBuffer = AVAudioPCMBuffer(pcmFormat: inputFormat,
-                                                   frameCapacity: AVAudioFrameCount(size)) else {
-                print("❌ Failed to create input buffer")
-                return
-            }
-            
-            inputBuffer.frameLength = AVAudioFrameCount(size)
-            
-            // Copy input data directly
-            memcpy(inputBuffer.int16ChannelData?[0], buffer, size * MemoryLayout<Int16>.size)
+        public func queueBuffer(_ planes: UnsafePointer<Float>, frameCount: Int) {
+            guard frameCount > 0 else { return }
             
-            // Create output buffer
-            guard let outputBuffer = AVAudioPCMBuffer(pcmFormat: format,
-                                                    frameCapacity: inputBuffer.frameCapacity) else {
+            guard let outputBuffer = bufferPool.buffer(copying: planes, frameCount: frameCount) else {
                 print("❌ Failed to create output buffer")
                 return
             }
             
-            // Convert to float format
-            var error: NSError?
-            guard let converter = audioConverter else {
-                print("❌ No audio converter available")
-                return
-            }
-            
-            let status = converter.convert(to: outputBuffer, error: &error) { inNumPackets, outStatus in
-                outStatus.pointee = .haveData
-                return inputBuffer
-            }
-            
-            if status == .error {
-                print("❌ Audio conversion failed: \(error?.localizedDescription ?? "Unknown error")")
-                return
-            }
-            
             pendingBufferLock.lock()
             if isEngineRunning {
                 // If engine is running, schedule immediately
-                player.scheduleBuffer(outputBuffer, completionHandler: nil)
+                player.scheduleBuffer(outputBuffer) { [bufferPool] in
+                    bufferPool.recycle(outputBuffer)
+                }
                 if !player.isPlaying {
                     player.play()
                 }
@@ -221,7 +180,7 @@ public class NESAudioMaker : AudioMakerProtocol {
             }
             pendingBufferLock.unlock()
             
-            totalSamplesQueued += size
+            totalSamplesQueued += frameCount
         }
         
         deinit {
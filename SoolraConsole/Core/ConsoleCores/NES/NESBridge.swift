@@ -6,10 +6,6 @@
 
 import Foundation
 
-// MARK: - C Function Declarations
-@_silgen_name("NES_IsPAL")
-func NES_IsPAL() -> Bool
-
 // MARK: - NES Button Mapping
 enum NESButton: UInt32 {
     case right   = 0b10000000
@@ -24,16 +20,17 @@ enum NESButton: UInt32 {
 
 // MARK: - NES Bridge
 class NESBridge: NSObject {
-    public static var shared: NESBridge!
+    // Our own emulator instance; the core hands self back to the callbacks as userData
+    private var nes: NESHandle!
 
     private var _videoBuffer: UnsafeMutablePointer<UInt16>?
-    private var _audioBuffer: UnsafeMutablePointer<UInt16>?
+    private var _audioBuffer: UnsafeMutablePointer<Float>?
     
     public var videoBufferPublic: UnsafeMutablePointer<UInt16>? {
         return _videoBuffer
     }
     
-    public var audioBufferPublic: UnsafeMutablePointer<UInt16>? {
+    public var audioBufferPublic: UnsafeMutablePointer<Float>? {
         return _audioBuffer
     }
 
@@ -42,8 +39,17 @@ class NESBridge: NSObject {
     public private(set) var frameDuration: TimeInterval = (1.0 / 60.0)
     
     // Static callbacks
-    private static let videoCallback: @convention(c) (UnsafePointer<UInt16>?, Int) -> Void = { buffer, size in
-        guard let videoBuffer = NESBridge.shared?.videoBufferPublic,
+    private static func bridge(from userData: UnsafeMutableRawPointer?) -> NESBridge? {
+        guard let userData = userData else { return nil }
+        return Unmanaged<NESBridge>.fromOpaque(userData).takeUnretainedValue()
+    }
+    
+    private static let videoCallback: @convention(c) (UnsafeMutableRawPointer?, UnsafePointer<UInt16>?, Int, Bool) -> Void = { userData, buffer, size, unchanged in
+        // Identical to the previous frame, which is still in our buffer
+        if unchanged {
+            return
+        }
+        guard let videoBuffer = NESBridge.bridge(from: userData)?.videoBufferPublic,
               let sourceBuffer = buffer else {
             print("⚠️ Video buffer not available")
             return
@@ -52,19 +58,18 @@ class NESBridge: NSObject {
     }
     
     
-    private static let audioCallback: @convention(c) (UnsafePointer<UInt16>?, Int) -> Void = { buffer, size in
-        guard let audioBuffer = NESBridge.shared?.audioBufferPublic,
+    private static let audioCallback: @convention(c) (UnsafeMutableRawPointer?, UnsafePointer<Float>?, Int) -> Void = { userData, buffer, size in
+        guard let audioBuffer = NESBridge.bridge(from: userData)?.audioBufferPublic,
               let sourceBuffer = buffer else {
             print("⚠️ Audio buffer not available")
             return
         }
-        memcpy(audioBuffer, sourceBuffer, size * MemoryLayout<Int16>.size)
-        //memcpy(audioBuffer, sourceBuffer, size)
+        memcpy(audioBuffer, sourceBuffer, size * MemoryLayout<Float>.size)
     }
     
     public init(
         videoBuffer: UnsafeMutablePointer<UInt16>,
-        audioBuffer: UnsafeMutablePointer<UInt16>
+        audioBuffer: UnsafeMutablePointer<Float>
     ) {
         self._videoBuffer = videoBuffer
         self._audioBuffer = audioBuffer
@@ -72,21 +77,19 @@ class NESBridge: NSObject {
         
         print("🎮 Initializing NESBridge")
         
-        // Set shared instance before setting callbacks
-        NESBridge.shared = self
-        
         // Initialize core
-        NES_Init()
+        nes = NES_Create(Unmanaged.passUnretained(self).toOpaque())
         
         // Set callbacks
-        NES_SetVideoCallback(NESBridge.videoCallback)
-        NES_SetAudioCallback(NESBridge.audioCallback)
+        NES_SetVideoCallback(nes, NESBridge.videoCallback)
+        NES_SetFloatAudioCallback(nes, NESBridge.audioCallback)
         
         print("✅ NESBridge initialization complete")
         self.isReady = true
     }
     
     deinit {
+        NES_Destroy(nes)
         deallocateBuffers()
     }
     
@@ -111,7 +114,7 @@ class NESBridge: NSObject {
         self.gameURL = gameURL
         gameURL.withUnsafeFileSystemRepresentation { path in
             guard let path = path else { return }
-            _ = NES_LoadROM(path)
+            _ = NES_LoadROM(nes, path)
         }
         
         print("✅ Game loaded successfully")
@@ -122,7 +125,7 @@ class NESBridge: NSObject {
         self.isReady = false
 
         // Shutdown the emulator first - this will stop the PPU
-        NES_Shutdown()
+        NES_Shutdown(nes)
 
         // Finally cleanup our own resources
         self.gameURL = nil
@@ -132,52 +135,57 @@ class NESBridge: NSObject {
     
     public func runFrame() {
         if self.isReady {
-            NES_RunFrame()
+            NES_RunFrame(nes)
         }
     }
     
     public func activateInput(_ input: Int32) {
-        NES_SetInput(input)
+        NES_SetInput(nes, input)
     }
     
     public func deactivateInput(_ input: Int32) {
-        NES_ClearInput(input)
+        NES_ClearInput(nes, input)
     }
     
     public func resetInputs() {
-        NES_ResetInputs()
+        NES_ResetInputs(nes)
     }
     
     public func isPAL() -> Bool {
-        return NES_IsPAL()
+        return NES_IsPAL(nes)
     }
     
     func activateCheat(_ cheat: Cheat)
     {
         cheat.code.withCString { codeStr in
-            NES_AddCheatCode(codeStr)
+            NES_AddCheatCode(nes, codeStr)
         }
     }
     
     func resetCheats()
     {
-        NES_ResetCheats()
+        NES_ResetCheats(nes)
     }
     
     func loadSaveState(from url: URL)
     {
-        url.withUnsafeFileSystemRepresentation { NESLoadGameSave($0!) }
+        url.withUnsafeFileSystemRepresentation { NESLoadGameSave(nes, $0!) }
     }
     
     func saveGameSave(to url: URL)
     {
-        url.withUnsafeFileSystemRepresentation { NESSaveGameSave($0!) }
+        url.withUnsafeFileSystemRepresentation { NESSaveGameSave(nes, $0!) }
 
     }
     
     func setAutosavePath(to url: URL)
     {
-        url.withUnsafeFileSystemRepresentation { NES_SetBatterySavePath($0!) }
+        url.withUnsafeFileSystemRepresentation { NES_SetBatterySavePath(nes, $0!) }
 
     }
+    
+    func flushAutosave()
+    {
+        _ = NES_FlushBatterySave(nes)
+    }
 }
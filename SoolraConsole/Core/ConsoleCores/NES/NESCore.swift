@@ -38,7 +38,7 @@ class NESCore: ConsoleCore {
     // MARK: - Properties
     private var frameCount: UInt = 0
     private var videoBuffer: UnsafeMutablePointer<UInt16>
-    private var audioBuffer: UnsafeMutablePointer<UInt16>
+    private var audioBuffer: UnsafeMutablePointer<Float>
     private var renderer: NESRenderer?
     private var bridge: NESBridge?
     private var isPaused: Bool = false
@@ -88,7 +88,7 @@ class NESCore: ConsoleCore {
         if let audioMaker = _audioMaker {
             let samplesPerFrame = bridge?.isPAL() == true ? 
                 Constants.palSamplesPerFrame : Constants.ntscSamplesPerFrame
-            audioMaker.queueBuffer(audioBuffer, size: samplesPerFrame)
+            audioMaker.queueBuffer(audioBuffer, frameCount: samplesPerFrame)
         }
         
         frameCount += 1
@@ -152,6 +152,7 @@ class NESCore: ConsoleCore {
     func pause() {
         isPaused = true
         _audioMaker?.pause()
+        bridge?.flushAutosave()
     }
     
     func resume() {
@@ -4,6 +4,7 @@
 //  Copyright © 2025 SOOLRA. All rights reserved.
 //
 
+import AVFoundation
 import Foundation
 
 public protocol AudioMakerProtocol {
@@ -11,5 +12,45 @@ public protocol AudioMakerProtocol {
     func pause()
     func stop()
     func reset()
-    func queueBuffer(_ buffer: UnsafePointer<UInt16>, size: Int)
+    // Planar float32 samples: channel n starts at planes + n * frameCount.
+    func queueBuffer(_ planes: UnsafePointer<Float>, frameCount: Int)
+}
+
+// Reuses PCM buffers once the player has consumed them, so queueing a frame
+// of audio does not allocate.
+final class AudioBufferPool {
+    private let format: AVAudioFormat
+    private var freeBuffers: [AVAudioPCMBuffer] = []
+    private let lock = NSLock()
+    
+    init(format: AVAudioFormat) {
+        self.format = format
+    }
+    
+    // Returns a buffer holding a copy of the planar samples.
+    func buffer(copying planes: UnsafePointer<Float>, frameCount: Int) -> AVAudioPCMBuffer? {
+        lock.lock()
+        let index = freeBuffers.firstIndex { $0.frameCapacity >= AVAudioFrameCount(frameCount) }
+        let reused = index.map { freeBuffers.remove(at: $0) }
+        lock.unlock()
+        
+        guard let buffer = reused ?? AVAudioPCMBuffer(pcmFormat: format,
+                                                     frameCapacity: AVAudioFrameCount(frameCount)),
+              let channels = buffer.floatChannelData else {
+            return nil
+        }
+        
+        buffer.frameLength = AVAudioFrameCount(frameCount)
+        for channel in 0..<Int(format.channelCount) {
+            memcpy(channels[channel], planes + channel * frameCount, frameCount * MemoryLayout<Float>.size)
+        }
+        return buffer
+    }
+    
+    // Hands a buffer back once the player is done with it.
+    func recycle(_ buffer: AVAudioPCMBuffer) {
+        lock.lock()
+        freeBuffers.append(buffer)
+        lock.unlock()
+    }
 }
@@ -99,69 +99,89 @@ class RomManager {
     }
     
     private func handleZipFile(_ url: URL) async throws {
-        let soolraDirectory = getSoolraDirectory()
-        let tempDirectory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        let archive: Archive
+        do {
+            archive = try Archive(url: url, accessMode: .read)
+        } catch {
+            throw NSError(domain: "ZipError",
+                          code: -1,
+                          userInfo: [NSLocalizedDescriptionKey: "Failed to open zip file: \(error.localizedDescription)"])
+        }
         
-        try FileManager.default.createDirectory(at: tempDirectory, withIntermediateDirectories: true, attributes: nil)
-        defer {
-            try? FileManager.default.removeItem(at: tempDirectory)
+        let members = romMembers(of: archive)
+        guard let first = members.first else {
+            throw NSError(domain: "ZipError",
+                          code: -1,
+                          userInfo: [NSLocalizedDescriptionKey: "No ROM found in zip file"])
         }
         
-        // First, extract all files to temp directory
-        try extractZipFile(at: url, to: tempDirectory)
+        // A zip holding several ROMs is extracted, one library entry per ROM, since
+        // the cores would only ever load the first of them from the archive
+        if members.count > 1 {
+            try await extractRomMembers(members, from: archive)
+            return
+        }
         
-        // Then process each extracted file
-        let items = try FileManager.default.contentsOfDirectory(atPath: tempDirectory.path)
-        for romFile in items.filter({ isValidRomExtension(URL(fileURLWithPath: $0).pathExtension) }) {
-            let tempRomUrl = tempDirectory.appendingPathComponent(romFile)
-            guard let romName = getRomName(from: tempRomUrl) else {
-                continue
-            }
-            
-            let destinationURL = soolraDirectory.appendingPathComponent(romFile)
-            
-            if romExists(name: romName, url: destinationURL) {
+        // A single ROM stays zipped in the Soolra directory; the core picks the same
+        // member by the same rule at launch, so only its name and type are needed
+        let (entry, consoleType) = first
+        let romName = getRomName(fromMember: entry.path)
+        if romExists(name: romName, consoleType: consoleType) {
+            print("ROM '\(romName)' already exists in CoreData, skipping...")
+            return
+        }
+        
+        let destinationURL = getSoolraDirectory().appendingPathComponent(url.lastPathComponent)
+        
+        // If the zip is already in Soolra but not in CoreData, use it
+        if !FileManager.default.fileExists(atPath: destinationURL.path) {
+            try FileManager.default.copyItem(at: url, to: destinationURL)
+        }
+        await createRomEntity(name: romName, url: destinationURL, consoleType: consoleType)
+        Analytics.logEvent("rom_added", parameters: [
+            "rom_name": romName,
+            "timestamp": Date().timeIntervalSince1970
+        ])
+    }
+    
+    // The ROM members of an archive in archive order, classified by the rules the
+    // cores scan archives with, so the importer never disagrees with the loader
+    private func romMembers(of archive: Archive) -> [(Entry, ConsoleCoreManager.ConsoleType)] {
+        return archive.compactMap { entry in
+            guard entry.type == .file else { return nil }
+            if NES_IsImageName(entry.path) { return (entry, .nes) }
+            if GBAIsImageName(entry.path) { return (entry, .gba) }
+            return nil
+        }
+    }
+    
+    private func extractRomMembers(_ members: [(Entry, ConsoleCoreManager.ConsoleType)],
+                                   from archive: Archive) async throws {
+        let soolraDirectory = getSoolraDirectory()
+        for (entry, consoleType) in members {
+            let romFile = URL(fileURLWithPath: entry.path).lastPathComponent
+            let romName = getRomName(fromMember: romFile)
+            if romExists(name: romName, consoleType: consoleType) {
                 print("ROM '\(romName)' already exists in CoreData, skipping...")
                 continue
             }
             
-            // If file exists in Soolra but not in CoreData, use it
-            if FileManager.default.fileExists(atPath: destinationURL.path) {
-                print("ROM file exists but not in CoreData, adding to CoreData: \(romName)")
-                await createRomEntity(name: romName, url: destinationURL)
-                continue
-            }
-            
-            // If neither exists, move the file and create entity
-            do {
-                try FileManager.default.moveItem(at: tempRomUrl, to: destinationURL)
-                await createRomEntity(name: romName, url: destinationURL)
-                Analytics.logEvent("rom_added", parameters: [
-                    "rom_name": romName,
-                    "timestamp": Date().timeIntervalSince1970
-                ])
-            } catch {
-                print("Error moving ROM file \(romName): \(error.localizedDescription)")
-            }
-        }
-    }
-    
-    private func extractZipFile(at url: URL, to destination: URL) throws {
-        do {
-            let archive = try Archive(url: url, accessMode: .read)
-            // Extract all valid ROM types
-            for entry in archive {
-                let entryExtension = URL(fileURLWithPath: entry.path).pathExtension.lowercased()
-                if isValidRomExtension(entryExtension) {
-                    let destinationURL = destination.appendingPathComponent(entry.path)
+            // If the file is already in Soolra but not in CoreData, use it
+            let destinationURL = soolraDirectory.appendingPathComponent(romFile)
+            if !FileManager.default.fileExists(atPath: destinationURL.path) {
+                do {
                     _ = try archive.extract(entry, to: destinationURL)
-                    print("Extracted \(entry.path) to \(destinationURL.path)")
+                } catch {
+                    try? FileManager.default.removeItem(at: destinationURL)
+                    print("Error extracting ROM file \(romName): \(error.localizedDescription)")
+                    continue
                 }
             }
-        } catch {
-            throw NSError(domain: "ZipError",
-                          code: -1,
-                          userInfo: [NSLocalizedDescriptionKey: "Failed to extract zip file: \(error.localizedDescription)"])
+            await createRomEntity(name: romName, url: destinationURL, consoleType: consoleType)
+            Analytics.logEvent("rom_added", parameters: [
+                "rom_name": romName,
+                "timestamp": Date().timeIntervalSince1970
+            ])
         }
     }
     
@@ -204,6 +224,12 @@ class RomManager {
         return String(filename.dropLast(fileExtension.count + 1)) // +1 for the dot
     }
     
+    // Archive members may use extensions the library does not list (.bin, .agb, .fds),
+    // which the cores accept all the same
+    private func getRomName(fromMember path: String) -> String {
+        return URL(fileURLWithPath: path).deletingPathExtension().lastPathComponent
+    }
+    
     private func getConsoleType(from url: URL) -> ConsoleCoreManager.ConsoleType? {
         return ConsoleCoreManager.ConsoleType.from(fileExtension: url.pathExtension.lowercased())
     }
@@ -232,13 +258,16 @@ class RomManager {
     
     
     // MARK: - Private Methods - CoreData
-    private func createRomEntity(name: String, url: URL) async {
+    // consoleType defaults to the one the file extension names; ROMs from zips pass their member's
+    private func createRomEntity(name: String, url: URL,
+                                 consoleType: ConsoleCoreManager.ConsoleType? = nil) async {
+        let consoleType = consoleType ?? getConsoleType(from: url)
         let soolraDirectory = getSoolraDirectory()
         let relativeUrl = soolraDirectory.appendingPathComponent(url.lastPathComponent)
         
         let imageData: Data? = await {
             do {
-                if let consoleType = getConsoleType(from: url),
+                if let consoleType,
                    let image = try await RomArtworkLoader.shared.getRomArtwork(romName: name,
                                                                                consoleType: consoleType) {
                     return image.pngData()
@@ -257,7 +286,7 @@ class RomManager {
             rom.url = relativeUrl
             rom.isValid = FileManager.default.fileExists(atPath: relativeUrl.path)
             rom.imageData = imageData
-            rom.consoleType = getConsoleType(from: url)?.rawValue ?? "unknown"
+            rom.consoleType = consoleType?.rawValue ?? "unknown"
             rom.createdAt    = Date()
             rom.passiveScoreModifier = 1.0
             save()
@@ -265,12 +294,15 @@ class RomManager {
     }
     
     private func romExists(name: String, url: URL) -> Bool {
-        guard let consoleType = getConsoleType(from: url)?.rawValue else {
+        guard let consoleType = getConsoleType(from: url) else {
             return false
         }
-        
+        return romExists(name: name, consoleType: consoleType)
+    }
+    
+    private func romExists(name: String, consoleType: ConsoleCoreManager.ConsoleType) -> Bool {
         let fetchRequest: NSFetchRequest<Rom> = Rom.fetchRequest()
-        fetchRequest.predicate = NSPredicate(format: "name == %@ AND consoleType == %@", name, consoleType)
+        fetchRequest.predicate = NSPredicate(format: "name == %@ AND consoleType == %@", name, consoleType.rawValue)
         do {
             let count = try context.count(for: fetchRequest)
             return count > 0
@@ -1027,6 +1027,8 @@ struct HomeView: View {
             throw NSError(domain: "Invalid URL", code: -1, userInfo: nil)
         }
 
+        // Zipped ROMs keep the .zip path and ROMs extracted from zips may have any
+        // extension the cores accept; their type comes from the member recorded at import
         let consoleType: ConsoleCoreManager.ConsoleType
         switch url.pathExtension.lowercased() {
         case "nes":
@@ -1034,7 +1036,10 @@ struct HomeView: View {
         case "gba":
             consoleType = .gba
         default:
-            throw ConsoleCoreManagerError.invalidCoreType
+            guard let storedType = ConsoleCoreManager.ConsoleType(rawValue: rom.consoleType ?? "") else {
+                throw ConsoleCoreManagerError.invalidCoreType
+            }
+            consoleType = storedType
         }
 
         try await consoleManager.loadConsole(type: consoleType, romPath: url)